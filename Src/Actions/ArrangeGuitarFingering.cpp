@@ -0,0 +1,85 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Actions/ArrangeGuitarFingering.h"
+#include "Actions/EditAction.h"
+#include "Midi/Track.h"
+
+#include <wx/intl.h>
+
+using namespace AriaMaestosa::Action;
+
+ArrangeGuitarFingering::ArrangeGuitarFingering(const std::vector<GuitarFingering::Position>& positions,
+                                               const bool selectionOnly) :
+    //I18N: (undoable) action name
+    SingleTrackAction( _("arrange guitar fingering") )
+{
+    m_positions      = positions;
+    m_selection_only = selectionOnly;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+ArrangeGuitarFingering::~ArrangeGuitarFingering()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void ArrangeGuitarFingering::undo()
+{
+    Note* current_note;
+    m_relocator.setParent(m_track);
+    m_relocator.prepareToRelocate();
+
+    int n = 0;
+    while ((current_note = m_relocator.getNextNote()) and current_note != NULL)
+    {
+        current_note->setStringAndFret( m_strings[n], m_frets[n] );
+        n++;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void ArrangeGuitarFingering::perform()
+{
+    ASSERT(m_track != NULL);
+
+    ptr_vector<Note>& notes = m_visitor->getNotesVector();
+    ASSERT( MAGIC_NUMBER_OK_FOR(notes) );
+
+    const int amount_n = notes.size();
+    int position = 0;
+    for (int n=0; n<amount_n; n++)
+    {
+        if (m_selection_only and not notes[n].isSelected()) continue;
+
+        ASSERT_E(position, <, (int)m_positions.size());
+
+        m_frets.push_back( notes[n].getFret() );
+        m_strings.push_back( notes[n].getString() );
+
+        notes[n].setStringAndFret( m_positions[position].m_string, m_positions[position].m_fret );
+        position++;
+
+        m_relocator.rememberNote( notes[n] );
+    }
+
+    ASSERT_E(position, ==, (int)m_positions.size());
+}
+
+// ----------------------------------------------------------------------------------------------------------
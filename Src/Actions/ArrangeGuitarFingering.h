@@ -0,0 +1,61 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __ARRANGE_GUITAR_FINGERING_H__
+#define __ARRANGE_GUITAR_FINGERING_H__
+
+#include "Actions/EditAction.h"
+#include "Midi/GuitarFingering.h"
+#include <vector>
+
+namespace AriaMaestosa
+{
+    class Track;
+
+    namespace Action
+    {
+
+        /**
+          * @brief places the notes of the track (all of them or the selected ones) on the strings and
+          *        frets found by GuitarFingering::solve
+          * @ingroup actions
+          */
+        class ArrangeGuitarFingering : public SingleTrackAction
+        {
+            friend class AriaMaestosa::Track;
+
+            std::vector<GuitarFingering::Position> m_positions;
+            bool m_selection_only;
+
+            NoteRelocator m_relocator;
+            std::vector<int> m_frets;
+            std::vector<int> m_strings;
+
+        public:
+
+            /**
+              * @param positions      one position for each note concerned, in the order of the track
+              * @param selectionOnly  whether only the selected notes are concerned
+              */
+            ArrangeGuitarFingering(const std::vector<GuitarFingering::Position>& positions,
+                                   const bool selectionOnly);
+            void perform();
+            void undo();
+            virtual ~ArrangeGuitarFingering();
+        };
+    }
+}
+#endif
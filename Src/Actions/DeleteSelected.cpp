@@ -164,9 +164,12 @@ void DeleteSelected::perform()
         ptr_vector<Note>& notes        = m_visitor->getNotesVector();
         ptr_vector<Note, REF>& noteOff = m_visitor->getNoteOffVector();
 
-        for (int n=0; n<notes.size(); n++)
+        // each removal shifts the IDs of the notes after it by one
+        const std::vector<int> selection = m_track->getSelectedNotes();
+        const int selectedAmount = selection.size();
+        for (int i=0; i<selectedAmount; i++)
         {
-            if (not notes[n].isSelected()) continue;
+            const int n = selection[i] - i;
             
             // also delete corresponding note off event
             for (int i=0; i<noteOff.size(); i++)
@@ -181,8 +184,6 @@ void DeleteSelected::perform()
             //notes.erase(n);
             removedNotes.push_back( notes.get(n) );
             notes.remove(n);
-            
-            n--;
         }//next
         
     }
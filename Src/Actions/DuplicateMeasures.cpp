@@ -25,8 +25,6 @@
 #include "Midi/Track.h"
 #include "UnitTest.h"
 
-#include <map>
-
 using namespace AriaMaestosa;
 using namespace AriaMaestosa::Action;
 
@@ -57,6 +55,16 @@ void DuplicateMeasures::undo()
 
 // --------------------------------------------------------------------------------------------------------
 
+static int getNoteStartTick(Note* note)
+{
+    return note->getTick();
+}
+
+static int getEventTick(ControllerEvent* evt)
+{
+    return evt->getTick();
+}
+
 void DuplicateMeasures::perform()
 {
     ASSERT(m_sequence != NULL);
@@ -74,61 +82,45 @@ void DuplicateMeasures::perform()
     {
         ScopedMeasureTransaction tr(md->startTransaction());
         
-        // abusing the import feature to add notes sorting
-        OwnerPtr<Sequence::Import> import(m_sequence->startImport());
-        
         tr->setMeasureAmount( md->getMeasureAmount() + amount );
     
-        std::vector<Note> notesToDuplicate;
-        std::map<Track*, std::vector<ControllerEvent> > controllerEventsToDuplicate;
         std::vector<ControllerEvent> tempoEventsToDuplicate;
         
-        // move all notes that are after given start tick by the necessary amount
+        // copy what is in the duplicated measures, move everything after them by the necessary amount,
+        // then place the copies in the room that was made
         const int trackAmount = m_sequence->getTrackAmount();
         for (int t=0; t<trackAmount; t++)
         {
             Track* track = m_sequence->getTrack(t);
+            OwnerPtr<Track::TrackVisitor> tvisitor(m_visitor->getNewTrackVisitor(t));
             
             // ----------------- note events -----------------
-            const int noteAmount = track->getNoteAmount();
-            for (int n=0; n<noteAmount; n++)
+            ptr_vector<Note>& notes = tvisitor->getNotesVector();
+            std::vector<Note*> notesToDuplicate;
+            
+            const int noteAmount = notes.size();
+            for (int n=notes.findFirstAfter(getNoteStartTick, afterTick);
+                 n<noteAmount and notes[n].getTick() < stopDuplicatingAtTick; n++)
             {
-                Note* note = track->getNote(n);
-                if (note->getTick() > afterTick)
-                {
-                    if (note->getTick() < stopDuplicatingAtTick)
-                    {
-                        // duplicate
-                        notesToDuplicate.push_back(Note(track, note->getPitchID(), note->getTick(),
-                                                        note->getEndTick(), note->getVolume(),
-                                                        note->getString()));
-                    }
-                    
-                    note->setTick(note->getTick() + amountInTicks);
-                    note->setEndTick(note->getEndTick() + amountInTicks);
-                    
-                }
+                notesToDuplicate.push_back(new Note(track, notes[n].getPitchID(), notes[n].getTick(),
+                                                    notes[n].getEndTick(), notes[n].getVolume(),
+                                                    notes[n].getString()));
             }
             
             // ----------------- control events -----------------
-            OwnerPtr<Track::TrackVisitor> tvisitor(m_visitor->getNewTrackVisitor(t));
             ptr_vector<ControllerEvent>& ctrl = tvisitor->getControlEventVector();
+            std::vector<ControllerEvent*> controllerEventsToDuplicate;
             
             const int controlAmount = ctrl.size();
-            for (int n=0; n<controlAmount; n++)
+            for (int n=ctrl.findFirstAfter(getEventTick, afterTick);
+                 n<controlAmount and ctrl[n].getTick() < stopDuplicatingAtTick; n++)
             {
-                if (ctrl[n].getTick() > afterTick)
-                {
-                    if (ctrl[n].getTick() < stopDuplicatingAtTick)
-                    {
-                        controllerEventsToDuplicate[track].push_back(ControllerEvent(ctrl[n].getController(),
-                                                                                     ctrl[n].getTick(),
-                                                                                     ctrl[n].getValue()));
-                    }
-                    
-                    ctrl[n].setTick( ctrl[n].getTick() + amountInTicks );
-                }
+                controllerEventsToDuplicate.push_back(ctrl[n].clone());
             }
+            
+            track->shiftTicksAfter(afterTick, amountInTicks);
+            track->insertNotes(notesToDuplicate);
+            track->insertControlEvents(controllerEventsToDuplicate);
         }
         
         // ----------------- move tempo events -----------------
@@ -173,26 +165,6 @@ void DuplicateMeasures::perform()
             }//next
         }//endif
         
-        for (size_t n = 0; n < notesToDuplicate.size(); n++)
-        {
-            notesToDuplicate[n].getParent()->addNote_import(notesToDuplicate[n].getPitchID(),
-                                                            notesToDuplicate[n].getTick(),
-                                                            notesToDuplicate[n].getEndTick(), 
-                                                            notesToDuplicate[n].getVolume(),
-                                                            notesToDuplicate[n].getString());
-        }
-        
-        for (std::map<Track*, std::vector<ControllerEvent> >::iterator it = controllerEventsToDuplicate.begin();
-             it != controllerEventsToDuplicate.end();
-             it++)
-        {
-            for (size_t n = 0; n < it->second.size(); n++)
-            {
-                ControllerEvent& evt = it->second[n];
-                it->first->addControlEvent_import(evt.getTick(), evt.getValue(), evt.getController());
-            }
-        }
-        
         for (size_t n = 0; n < tempoEventsToDuplicate.size(); n++)
         {
             wxFloat64 previousEventValue;
@@ -202,15 +174,6 @@ void DuplicateMeasures::perform()
                                       &previousEventValue);
         }
     } // end transaction
-    
-    for (int n = 0; n < m_sequence->getTrackAmount(); n++)
-    {
-        m_sequence->getTrack(n)->reorderNoteVector();
-        m_sequence->getTrack(n)->reorderNoteOffVector();
-        m_sequence->getTrack(n)->reorderControlVector();
-    }
-    
-    
 }
 
 
@@ -146,6 +146,8 @@ namespace AriaMaestosa
             virtual void undo() = 0;
             
             void setParentTrack(Track* parent, Track::TrackVisitor* visitor);
+            
+            Track* getParentTrack() { return m_track; }
         };
         
         /**
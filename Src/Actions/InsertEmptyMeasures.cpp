@@ -71,39 +71,11 @@ void InsertEmptyMeasures::perform()
         
         tr->setMeasureAmount( md->getMeasureAmount() + m_amount );
     
-        // move all notes that are after given start tick by the necessary amount
+        // move all notes and control events that are after given start tick by the necessary amount
         const int trackAmount = m_sequence->getTrackAmount();
         for (int t=0; t<trackAmount; t++)
         {
-            Track* track = m_sequence->getTrack(t);
-            
-            // ----------------- move note events -----------------
-            const int noteAmount = track->getNoteAmount();
-            for (int n=0; n<noteAmount; n++)
-            {
-                Note* note = track->getNote(n);
-                if (note->getTick() > afterTick)
-                {
-                    note->setTick(note->getTick() + amountInTicks);
-                    note->setEndTick(note->getEndTick() + amountInTicks);
-                }
-            }
-            // ----------------- move control events -----------------
-            
-            OwnerPtr<Track::TrackVisitor> tvisitor(m_visitor->getNewTrackVisitor(t));
-            ptr_vector<ControllerEvent>& ctrl = tvisitor->getControlEventVector();
-            
-            const int controlAmount = ctrl.size();
-            for (int n=0; n<controlAmount; n++)
-            {
-                if (ctrl[n].getTick() > afterTick)
-                {
-                    ctrl[n].setTick( ctrl[n].getTick() + amountInTicks );
-                }
-            }
-            
-            track->reorderNoteVector();
-            track->reorderNoteOffVector();
+            m_sequence->getTrack(t)->shiftTicksAfter(afterTick, amountInTicks);
         }
         
         // ----------------- move tempo events -----------------
@@ -58,24 +58,27 @@ void MoveNotes::undo()
     relocator.setParent(m_track);
     relocator.prepareToRelocate();
     
+    // the editor the notes were moved in may have been released since
+    Editor* editor = m_track->getGraphics()->getEditorFor( (NotationType)m_mode );
+    
     int n = 0;
     while ((current_note = relocator.getNextNote()) and current_note != NULL)
     {
         if (m_move_mode == SCORE_VERTICAL or m_move_mode == DRUMS_VERTICAL)
         {
             current_note->setPitchID( undo_pitch[n] );
-            m_editor->moveNote(*current_note, -m_relativeX, 0);
+            editor->moveNote(*current_note, -m_relativeX, 0);
             n++;
         }
         else if (m_move_mode == GUITAR_VERTICAL)
         {
             current_note->setStringAndFret(undo_string[n], undo_fret[n]);
-            m_editor->moveNote(*current_note, -m_relativeX, 0);
+            editor->moveNote(*current_note, -m_relativeX, 0);
             n++;
         }
         else
         {
-            m_editor->moveNote(*current_note, -m_relativeX, -m_relativeY);
+            editor->moveNote(*current_note, -m_relativeX, -m_relativeY);
         }
     }
     m_track->reorderNoteVector();
@@ -107,10 +110,12 @@ void MoveNotes::perform()
 
         bool played = false;
         
-        const int noteAmount = notes.size();
-        for (int n=0; n<noteAmount; n++)
+        // copied, since moving notes does not change the selection
+        const std::vector<int> selection = m_track->getSelectedNotes();
+        const int selectedAmount = selection.size();
+        for (int i=0; i<selectedAmount; i++)
         {
-            if (not notes[n].isSelected()) continue;
+            const int n = selection[i];
 
             doMoveOneNote(n);
             
@@ -54,6 +54,7 @@ namespace AriaMaestosa
             std::vector<short> undo_fret;  // for GUITAR_VERTICAL mode
             std::vector<short> undo_string;
             
+            /** The editor the notes are moved in, only used by perform (editors may be released later on) */
             Editor* m_editor;
             
         public:
@@ -63,6 +63,9 @@ void Record::action(SingleTrackAction* actionObj)
 {
     ASSERT( MAGIC_NUMBER_OK() );
     
+    // the track's revision was only bumped when recording started
+    m_track->markChanged();
+    
     actionObj->setParentTrack(m_track, new Track::TrackVisitor(*m_visitor.raw_ptr));
     m_actions.push_back( actionObj );
     actionObj->perform();
@@ -23,6 +23,8 @@
 #include "Midi/TimeSigChange.h"
 #include "Midi/MeasureData.h"
 #include "AriaCore.h"
+#include "UnitTest.h"
+#include "UnitTestUtils.h"
 
 #include <iostream>
 #include <map>
@@ -66,22 +68,13 @@ void RemoveMeasures::undo()
     {
         RemovedTrackPart* removedBits = removedTrackParts.get(rm);
         
-        // add removed notes again
-        const int n_amount = removedBits->removedNotes.size();
-        for (int n=0; n<n_amount; n++)
-        {
-            removedBits->track->addNote( removedBits->removedNotes.get(n) );
-        }
-        // we are using the notes again, so make sure it won't delete them
-        removedBits->removedNotes.clearWithoutDeleting();
+        // add removed notes and control events again. They were taken in order from the measures that
+        // were just inserted back, which are empty, so they can be added as a block
+        removedBits->track->insertNotes( removedBits->removedNotes.contentsVector );
+        removedBits->track->insertControlEvents( removedBits->removedControlEvents.contentsVector );
         
-        // add removed control events again
-        const int c_amount = removedBits->removedControlEvents.size();
-        for (int n=0; n<c_amount; n++)
-        {
-            removedBits->track->addControlEvent( removedBits->removedControlEvents.get(n) );
-        }
-        // we are using the events again, so make sure it won't delete them
+        // we are using the notes and events again, so make sure it won't delete them
+        removedBits->removedNotes.clearWithoutDeleting();
         removedBits->removedControlEvents.clearWithoutDeleting();
     }
     
@@ -124,6 +117,11 @@ void RemoveMeasures::undo()
 
 // ----------------------------------------------------------------------------------------------------------
 
+static int getEventTick(ControllerEvent* evt)
+{
+    return evt->getTick();
+}
+
 void RemoveMeasures::perform()
 {
     
@@ -148,54 +146,29 @@ void RemoveMeasures::perform()
         Track* track = m_sequence->getTrack(t);
         removedBits->track = track;
         
-        OwnerPtr<Track::TrackVisitor> tvisitor(m_visitor->getNewTrackVisitor(t));
-        ptr_vector<Note>& notes = tvisitor->getNotesVector();
-        
-        // ------------------------ erase/move notes ------------------------
-        const int amount_n = notes.size();
-        for (int n=0; n<amount_n; n++)
-        {
-            Note* note = notes.get(n);
-            
-            // note is an area that is removed. remove it.
-            if (note->getTick() > fromTick and note->getTick() < toTick)
-            {
-                removedBits->removedNotes.push_back(note);
-                track->markNoteToBeRemoved(n);
-            }
-            // note is in after the removed area. move it back by necessary amound
-            else if (notes[n].getTick() >= toTick)
-            {
-                note->setTick( note->getTick() - amountInTicks);
-                note->setEndTick( note->getEndTick() - amountInTicks);
-            }
-        }
-        track->removeMarkedNotes();
+        // ------------------------ erase notes ------------------------
+        track->extractNotesInRange(fromTick, toTick, removedBits->removedNotes);
         
-        // ------------------------ erase/move control events ------------------------
+        // ------------------------ erase control events ------------------------
         
+        OwnerPtr<Track::TrackVisitor> tvisitor(m_visitor->getNewTrackVisitor(t));
         ptr_vector<ControllerEvent>& ctrl = tvisitor->getControlEventVector();
         
         std::map<int, wxFloat64> latest_value_by_controller;
         
+        // delete all controller events located in the area to be deleted
         const int c_amount = ctrl.size();
-        for (int n=0; n<c_amount; n++)
+        for (int n=ctrl.findFirstAfter(getEventTick, fromTick); n<c_amount and ctrl[n].getTick() < toTick; n++)
         {
-            // delete all controller events located in the area to be deleted
-            if (ctrl[n].getTick() > fromTick and ctrl[n].getTick() < toTick)
-            {
-                latest_value_by_controller[ctrl[n].getController()] = ctrl[n].getValue();
-                removedBits->removedControlEvents.push_back( ctrl.get(n) );
-                ctrl.markToBeRemoved(n);
-            }
-            // move all controller events that are after given start tick by the necessary amount
-            else if (ctrl[n].getTick() >= toTick)
-            {
-                ctrl[n].setTick(ctrl[n].getTick() - amountInTicks);
-            }
+            latest_value_by_controller[ctrl[n].getController()] = ctrl[n].getValue();
+            removedBits->removedControlEvents.push_back( ctrl.get(n) );
+            ctrl.markToBeRemoved(n);
         }
         ctrl.removeMarked();
         
+        // ------------------------ move back what follows ------------------------
+        track->shiftTicksAfter(fromTick, -amountInTicks);
+        
         // if needed, insert a new event at the end of the deleted section with the latest value
         // the controller had. This part is not undoable since the additional event doesn't hurt.
         for (std::map<int, wxFloat64>::iterator it = latest_value_by_controller.begin();
@@ -208,9 +181,6 @@ void RemoveMeasures::perform()
                                         &previousVal);
              }
         }
-        
-        track->reorderNoteVector();
-        track->reorderNoteOffVector();
     }
     
     
@@ -365,5 +335,95 @@ void RemoveMeasures::perform()
 }
 
 // ----------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------------------------
+
+using namespace AriaMaestosa;
 
+namespace TestRemoveMeasures
+{
+    
+    UNIT_TEST(TestRemove)
+    {
+        Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+        
+        TestSequenceProvider provider(seq);
+        AriaMaestosa::setCurrentSequenceProvider(&provider);
+        
+        Track* t = new Track(seq);
+        
+        const int beatLen = seq->ticksPerQuarterNote();
+        
+        // make a factory sequence to work from : a note on each beat, a control event every half beat
+        {
+            OwnerPtr<Sequence::Import> import(seq->startImport());
+            for (int n=0; n<16; n++)
+            {
+                t->addNote_import(100 + n           /* pitch  */,
+                                  n*beatLen         /* start  */,
+                                  (n+1)*beatLen - 1 /* end    */,
+                                  127               /* volume */, -1);
+            }
+            for (int n=0; n<32; n++)
+            {
+                t->addControlEvent_import((n*beatLen)/2 /* tick */, 64+n*2 /* value */,  0 /* controller */);
+                t->addControlEvent_import((n*beatLen)/2 /* tick */, 64-n*2 /* value */,  1 /* controller */);
+            }
+        }
+        require_e(t->getNoteAmount(), ==, 16, "sanity check"); // sanity check on the way...
+        
+        seq->addTrack(t);
+        
+        // remove the second measure
+        seq->action(new RemoveMeasures(1 /* from */, 2 /* to */));
+        
+        const int removedShift = beatLen*4;
+        
+        require(t->getNoteAmount() == 12, "the notes of the removed measure were removed");
+        require(t->getNoteOffVector().size() == 12, "Note off vector is fine");
+        require(t->getControllerEventAmount(0) == 24, "Controller 0 events OK");
+        require(t->getControllerEventAmount(1) == 24, "Controller 1 events OK");
+        
+        for (int n=0; n<12; n++)
+        {
+            const int original = (n < 4 ? n : n + 4);
+            const int shift    = (n < 4 ? 0 : removedShift);
+            require(t->getNote(n)->getTick()    == original*beatLen - shift, "events were properly modified by action");
+            require(t->getNote(n)->getPitchID() == 100 + original,           "events were properly modified by action");
+            require(t->getNoteOffVector()[n].getEndTick() == (original + 1)*beatLen - 1 - shift,
+                    "Note off vector was properly modified by action");
+        }
+        
+        // Now test undo
+        seq->undo();
+        
+        require(t->getNoteAmount() == 16, "the number of events is fine on undo");
+        require(t->getNoteOffVector().size() == 16, "Note off vector is fine on undo");
+        
+        for (int n=0; n<16; n++)
+        {
+            require(t->getNote(n)->getTick()    == n*beatLen, "events were properly restored");
+            require(t->getNote(n)->getPitchID() == 100 + n,   "events were properly restored");
+            require(t->getNoteOffVector()[n].getEndTick() == (n + 1)*beatLen - 1,
+                    "Note off vector was properly restored");
+        }
+        
+        require(t->getControllerEventAmount(0) == 32, "Controller 0 events were restored");
+        require(t->getControllerEventAmount(1) == 32, "Controller 1 events were restored");
+        for (int n=0; n<32; n++)
+        {
+            require(t->getControllerEvent(n, 0 /* controller */)->getTick() == (n*beatLen)/2,
+                    "control events were properly restored");
+            require(t->getControllerEvent(n, 0 /* controller */)->getValue() == 64+n*2,
+                    "control events were properly restored");
+            require(t->getControllerEvent(n, 1 /* controller */)->getTick() == (n*beatLen)/2,
+                    "control events were properly restored");
+            require(t->getControllerEvent(n, 1 /* controller */)->getValue() == 64-n*2,
+                    "control events were properly restored");
+        }
+        
+        delete seq;
+    }
+    
+}
+// ----------------------------------------------------------------------------------------------------------
 
@@ -58,22 +58,21 @@ void SetNoteVolume::perform()
     if (m_note_ID == SELECTED_NOTES)
     {
         bool played = false;
-        const int noteAmount = notes.size();
+        const std::vector<int>& selection = m_track->getSelectedNotes();
+        const int selectedAmount = selection.size();
         
-        for (int n=0; n<noteAmount; n++)
+        for (int i=0; i<selectedAmount; i++)
         {
-            if (notes[n].isSelected())
+            const int n = selection[i];
+            volume = notes[n].getVolume();
+            m_volumes.push_back(volume);
+            adjustVolume(volume);
+            notes[n].setVolume(volume);
+            relocator.rememberNote(notes[n]);
+            if (not played)
             {
-                volume = notes[n].getVolume();
-                m_volumes.push_back(volume);
-                adjustVolume(volume);
-                notes[n].setVolume(volume);
-                relocator.rememberNote(notes[n]);
-                if (not played)
-                {
-                    notes[n].play(true);
-                    played = true;
-                }
+                notes[n].play(true);
+                played = true;
             }
         }//next note
         
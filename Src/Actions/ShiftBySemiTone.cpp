@@ -72,13 +72,13 @@ void ShiftBySemiTone::perform()
     if (m_note_id == SELECTED_NOTES)
     {
         bool played = false;
-        const int amount_n = notes.size();
-        for (int n=0; n<amount_n; n++)
+        const std::vector<int>& selection = m_track->getSelectedNotes();
+        const int selectedAmount = selection.size();
+        for (int i=0; i<selectedAmount; i++)
         {
+            const int n = selection[i];
             Note* note = notes.get(n);
             
-            if (not note->isSelected()) continue;
-            
             note->setPitchID( note->getPitchID() + m_delta_y );
             m_relocator.rememberNote( notes[n] );
             
@@ -73,11 +73,10 @@ void UpdateGuitarTuning::perform()
         frets.push_back( notes[n].getFret() );
         strings.push_back( notes[n].getString() );
         
-        notes[n].checkIfStringAndFretMatchNote(true);
-        
         relocator.rememberNote( notes[n] );
     }//next
     
+    m_track->updateNotesForGuitarEditor();
 }
 
 
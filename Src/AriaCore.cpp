@@ -126,28 +126,44 @@ namespace AriaMaestosa
         wxDC* renderDC;
         //#endif
         
+        /** size of the display when rendering offscreen, without a main pane */
+        int g_offscreen_width  = 0;
+        int g_offscreen_height = 0;
+        
+        void setOffscreenSize(const int width, const int height)
+        {
+            ASSERT(mainPane == NULL);
+            g_offscreen_width  = width;
+            g_offscreen_height = height;
+        }
+        
         void render()
         {
-            mainPane->renderNow();
+            if (mainPane != NULL) mainPane->renderNow();
         }
         int getWidth()
         {
+            if (mainPane == NULL) return g_offscreen_width;
             return mainPane->getWidth();
         }
         int getHeight()
         {
+            if (mainPane == NULL) return g_offscreen_height;
             return mainPane->getHeight();
         }
         bool isMouseDown()
         {
+            if (mainPane == NULL) return false;
             return mainPane->isMouseDown();
         }
         bool isSelectLessPressed()
         {
+            if (mainPane == NULL) return false;
             return mainPane->isSelectLessPressed();
         }
         bool isSelectMorePressed()
         {
+            if (mainPane == NULL) return false;
             return mainPane->isSelectMorePressed();
         }
         
@@ -157,34 +173,42 @@ namespace AriaMaestosa
         }
         
         
+        // offscreen, the mouse is never over the display
         RelativeXCoord getMouseX_current()
         {
+            if (mainPane == NULL) return RelativeXCoord(NULL);
             return mainPane->getMouseX_current();
         }
         int getMouseY_current()
         {
+            if (mainPane == NULL) return -1;
             return mainPane->getMouseY_current();
         }
         RelativeXCoord getMouseX_initial()
         {
+            if (mainPane == NULL) return RelativeXCoord(NULL);
             return mainPane->getMouseX_initial();
         }
         int getMouseY_initial()
         {
+            if (mainPane == NULL) return -1;
             return mainPane->getMouseY_initial();
         }
         
         bool leftArrow()
         {
+            if (mainPane == NULL) return false;
             return mainPane->isLeftArrowVisible();
         }
         bool rightArrow()
         {
+            if (mainPane == NULL) return false;
             return mainPane->isRightArrowVisible();
         }
         
         bool isVisible()
         {
+            if (mainPane == NULL) return false;
             return mainPane->isVisible();
         }
         
@@ -97,6 +97,12 @@ namespace AriaMaestosa
         void render();
         int getWidth();
         int getHeight();
+        
+        /**
+          * @brief when there is no main pane (e.g. rendering offscreen in RenderBenchmark), the display
+          *        reports this size, and the mouse as outside of it
+          */
+        void setOffscreenSize(const int width, const int height);
         bool isMouseDown();
         bool isSelectLessPressed();
         bool isSelectMorePressed();
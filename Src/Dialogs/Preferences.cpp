@@ -187,32 +187,34 @@ namespace AriaMaestosa
         
         void updateValueFromWidget()
         {
+            wxString value = m_parent->m_value;
+            
             switch (m_parent->m_type)
             {
                 case SETTING_ENUM:
-                    m_parent->m_value = to_wxString(m_combo->GetSelection());
+                    value = to_wxString(m_combo->GetSelection());
                     break;
                     
                 case SETTING_STRING_ENUM:
-                    m_parent->m_value = m_combo->GetStringSelection();
+                    value = m_combo->GetStringSelection();
                     break;
                     
                 case SETTING_BOOL:
-                    m_parent->m_value = to_wxString(m_checkbox->GetValue());
+                    value = to_wxString(m_checkbox->GetValue());
                     break;
                     
                 case SETTING_INT:
-                    m_parent->m_value = to_wxString(m_number->GetValue());
+                    value = to_wxString(m_number->GetValue());
                     break;
                 
                 case SETTING_STRING:
                     if (dynamic_cast<wxTextCtrl*>(m_textbox) != NULL)
                     {
-                        m_parent->m_value = dynamic_cast<wxTextCtrl*>(m_textbox)->GetValue();
+                        value = dynamic_cast<wxTextCtrl*>(m_textbox)->GetValue();
                     }
                     else if (dynamic_cast<wxComboBox*>(m_textbox) != NULL)
                     {
-                        m_parent->m_value = dynamic_cast<wxComboBox*>(m_textbox)->GetValue();
+                        value = dynamic_cast<wxComboBox*>(m_textbox)->GetValue();
                     }
                     break;
                     
@@ -221,6 +223,9 @@ namespace AriaMaestosa
                     fprintf(stderr, "Unknown preferences data type : %i\n", m_parent->m_type);
                     return;
             }
+            
+            // only notifies the components that use this setting if it was actually changed
+            PreferencesData::getInstance()->setValue(*m_parent, value);
         }
     };
 }
@@ -21,6 +21,7 @@
 #include "Utils.h"
 
 #include <wx/timer.h>
+#include <wx/button.h>
 #include <wx/dialog.h>
 #include <wx/stattext.h>
 #include <wx/gauge.h>
@@ -59,18 +60,24 @@ namespace AriaMaestosa
         wxBoxSizer* boxSizer;
         wxStaticText* label;
         wxGauge* progress;
+        wxButton* m_cancel_button;
         
         bool m_progress_known;
         
+        IWaitWindowCancelListener* m_cancel_listener;
+        
     public:
         LEAK_CHECK();
         
-        WaitWindowClass(wxWindow* parent, wxString message, bool progressKnown) :
+        WaitWindowClass(wxWindow* parent, wxString message, bool progressKnown,
+                        IWaitWindowCancelListener* cancelListener) :
             wxDialog( parent, wxID_ANY,  _("Please wait..."), wxDefaultPosition, wxSize(250,200),
                       wxCAPTION | wxSTAY_ON_TOP )
         {
             boxSizer = new wxBoxSizer(wxVERTICAL);
             m_progress_known = progressKnown;
+            m_cancel_listener = cancelListener;
+            m_cancel_button = NULL;
             
             // gauge
             progress = new wxGauge( this, wxID_ANY, 100, wxDefaultPosition, wxSize(200, 20) );
@@ -88,6 +95,14 @@ namespace AriaMaestosa
             label = new wxStaticText( this, wxID_ANY, message, wxPoint(25,30));
             boxSizer->Add( label, 0, wxALL, 10 );
             
+            if (cancelListener != NULL)
+            {
+                m_cancel_button = new wxButton(this, wxID_CANCEL, _("Cancel"));
+                m_cancel_button->Connect(wxEVT_COMMAND_BUTTON_CLICKED,
+                                         wxCommandEventHandler(WaitWindowClass::onCancel), NULL, this);
+                boxSizer->Add( m_cancel_button, 0, wxALIGN_RIGHT | wxALL, 10 );
+            }
+            
             SetSizer( boxSizer );
             boxSizer->Layout();
             boxSizer->SetSizeHints( this );
@@ -98,6 +113,13 @@ namespace AriaMaestosa
             progress->SetSize(gaugeSize);
         }
         
+        void onCancel(wxCommandEvent& evt)
+        {
+            // clicking again would not stop it any sooner
+            m_cancel_button->Disable();
+            m_cancel_listener->onWaitWindowCancel();
+        }
+        
         void pulse()
         {
             progress->Pulse();
@@ -139,19 +161,22 @@ namespace AriaMaestosa
     namespace WaitWindow
     {
         
-        void show(wxWindow* parent, wxString message, bool progress_known)
+        void show(wxWindow* parent, wxString message, bool progress_known,
+                  IWaitWindowCancelListener* cancelListener)
         {
             if (waitWindow != NULL)
             {
                 hide();
             }
             wxBeginBusyCursor();
-            waitWindow = new WaitWindowClass(parent, message, progress_known);
+            waitWindow = new WaitWindowClass(parent, message, progress_known, cancelListener);
             waitWindow->show();
         }
         
         void setProgress(int progress)
         {
+            // layout code also runs without any window, e.g. when exporting from the command line
+            if (waitWindow == NULL) return;
             waitWindow->setProgress( progress );
         }
         
@@ -24,13 +24,29 @@ class wxWindow;
 
 namespace AriaMaestosa
 {
+    /**
+      * @ingroup dialogs
+      * @brief to be notified when the user asks to stop the task a wait window is shown for
+      */
+    class IWaitWindowCancelListener
+    {
+    public:
+        virtual ~IWaitWindowCancelListener() {}
+        virtual void onWaitWindowCancel() = 0;
+    };
+    
     /**
       * @ingroup dialogs
       * @brief progress bar frame, to tell the user to wait
       */
     namespace WaitWindow
     {
-        void show(wxWindow* parent, wxString message, bool progress_known = false);
+        /**
+          * @param cancelListener  if not NULL, a 'Cancel' button is shown, that calls it. The window is
+          *                        left open; the listener is expected to hide it once the task stopped.
+          */
+        void show(wxWindow* parent, wxString message, bool progress_known = false,
+                  IWaitWindowCancelListener* cancelListener = NULL);
         void setProgress(int progress); // in percent
         void hide();
         bool isShown();
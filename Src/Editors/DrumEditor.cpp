@@ -905,8 +905,13 @@ void DrumEditor::render(RelativeXCoord mousex_current, int mousey_current,
     const int mouse_y2 = std::max(mousey_current, mousey_initial);
     
     const int noteAmount = m_track->getNoteAmount();
-    for (int n=0; n<noteAmount; n++)
+    std::vector<int> visibleNotes;
+    getVisibleNotes(m_track, -Editor::getEditorXStart(), m_width - Editor::getEditorXStart(), visibleNotes);
+    
+    const int visibleAmount = visibleNotes.size();
+    for (int i=0; i<visibleAmount; i++)
     {
+        const int n = visibleNotes[i];
         const int drumx = m_graphical_track->getNoteStartInPixels(n) - m_gsequence->getXScrollInPixels() +
                           Editor::getEditorXStart();
 
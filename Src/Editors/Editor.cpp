@@ -38,6 +38,9 @@
 
 #include <wx/tokenzr.h>
 
+#include <algorithm>
+#include <cmath>
+
 
 namespace AriaMaestosa
 {
@@ -198,6 +201,31 @@ void Editor::drawVerticalMeasureLines(const int from_y, const int to_y)
 
 // ------------------------------------------------------------------------------------------------------------
 
+bool Editor::getVisibleNotes(const Track* track, const int from_x, const int to_x, std::vector<int>& notes) const
+{
+    ASSERT( MAGIC_NUMBER_OK() );
+    
+    const float zoom    = m_gsequence->getZoom();
+    const int   pscroll = m_gsequence->getXScrollInPixels();
+    
+    // be a little generous on both sides, pixel <-> tick conversions are rounded
+    const int fromTick = std::max(0, (int)floor((from_x + pscroll) / zoom) - 1);
+    const int toTick   = (int)ceil((to_x + pscroll) / zoom) + 1;
+    
+    // long notes that started earlier come first, they start before all notes of the range
+    int firstNote, lastNote;
+    if (not track->findNotesOverlappingRange(fromTick, toTick, firstNote, lastNote, notes))
+    {
+        notes.clear();
+        return false;
+    }
+    
+    for (int n=firstNote; n<=lastNote; n++) notes.push_back(n);
+    return true;
+}
+
+// ------------------------------------------------------------------------------------------------------------
+
 void Editor::renderScrollbar()
 {
     ASSERT( MAGIC_NUMBER_OK() );
@@ -148,6 +148,26 @@ namespace AriaMaestosa
         /** @brief if you use a scrollbar, call this method somewhere near the end of your render method. */
         void renderScrollbar();
         
+        /**
+          * @brief Find which notes of a track overlap the given horizontal pixel span of this editor,
+          *        so that render methods need only iterate on notes that can actually be seen.
+          *
+          * @param track          the track to cull (the edited track or a background track)
+          * @param from_x         first pixel to consider, relative to the editor start (see getEditorXStart)
+          * @param to_x           last pixel to consider, relative to the editor start
+          * @param[out] notes     IDs of the notes to draw, in increasing order (thus in time order)
+          * @return               false if no note is visible
+          * @note Some of these notes may still fall outside the span (e.g. short notes that ended just
+          *       before it), so keep per-note checks.
+          */
+        bool getVisibleNotes(const Track* track, const int from_x, const int to_x, std::vector<int>& notes) const;
+        
+        /** @brief Variant of getVisibleNotes that considers the whole visible width of the editor */
+        bool getVisibleNotes(const Track* track, std::vector<int>& notes) const
+        {
+            return getVisibleNotes(track, 0, m_width, notes);
+        }
+        
         /** 
          * @brief in Aria, most editors (but ControlEditor) are organised as a vertical grid.
          * this method tells Editor what is the height of each "level" or "step".
@@ -73,16 +73,6 @@ GuitarEditor::GuitarEditor(GraphicalTrack* track) : Editor(track)
     
     GuitarNoteNamesSingleton::getInstance()->setFont( getStringNameFont() );
 
-    // set standard tuning by default (FIXME: don't duplicate the tuning from the tuning picker)
-    std::vector<int> newTuning;
-    newTuning.push_back( Note::findNotePitch(NOTE_7_E, PITCH_SIGN_NONE, 4) );
-    newTuning.push_back( Note::findNotePitch(NOTE_7_B, PITCH_SIGN_NONE, 3) );
-    newTuning.push_back( Note::findNotePitch(NOTE_7_G, PITCH_SIGN_NONE, 3) );
-    newTuning.push_back( Note::findNotePitch(NOTE_7_D, PITCH_SIGN_NONE, 3) );
-    newTuning.push_back( Note::findNotePitch(NOTE_7_A, PITCH_SIGN_NONE, 2) );
-    newTuning.push_back( Note::findNotePitch(NOTE_7_E, PITCH_SIGN_NONE, 2) );
-    m_track->getGuitarTuning()->setTuning(newTuning, false);
-    
     Editor::useVerticalScrollbar(false);
 }
 
@@ -128,7 +118,8 @@ void GuitarEditor::render(RelativeXCoord mousex_current, int mousey_current,
     }
 
     // ---------------------- draw notes ----------------------------
-    const int noteAmount = m_track->getNoteAmount();
+    std::vector<int> visibleNotes;
+    getVisibleNotes(m_track, visibleNotes);
     
     const bool mouseValid = (mousex_current.isValid() and mousex_initial.isValid());
     
@@ -137,8 +128,10 @@ void GuitarEditor::render(RelativeXCoord mousex_current, int mousey_current,
     const int mouse_y1 = std::min(mousey_current, mousey_initial);
     const int mouse_y2 = std::max(mousey_current, mousey_initial);
     
-    for (int n=0; n<noteAmount; n++)
+    const int visibleAmount = visibleNotes.size();
+    for (int i=0; i<visibleAmount; i++)
     {
+        const int n = visibleNotes[i];
         const int pscroll = m_gsequence->getXScrollInPixels();
         int x1 = m_graphical_track->getNoteStartInPixels(n) - pscroll;
         int x2 = m_graphical_track->getNoteEndInPixels(n)   - pscroll;
@@ -111,13 +111,30 @@ KeyboardEditor::KeyboardEditor(GraphicalTrack* track) : Editor(track)
     
     m_sharp_notes_names.setFont(drumFont);
     m_flat_notes_names.setFont(drumFont);
+    
+    PreferencesData* prefs = PreferencesData::getInstance();
+    m_show_note_names = prefs->getBool(SETTING_KEY_SHOW_NOTE_NAMES);
+    prefs->addListener(this);
 }
 
 // -----------------------------------------------------------------------------------------------------------
 
 KeyboardEditor::~KeyboardEditor()
 {
+    PreferencesData::getInstance()->removeListener(this);
+}
+
+// -----------------------------------------------------------------------------------------------------------
 
+void KeyboardEditor::onSettingChanged(const Setting& setting)
+{
+    if (setting.m_key == SETTING_KEY_SHOW_NOTE_NAMES)
+    {
+        m_show_note_names = setting.m_bool_value;
+        
+        // note names are part of the cached track renderings
+        m_gsequence->invalidateTrackLayers();
+    }
 }
 
 // **********************************************************************************************************
@@ -407,12 +424,9 @@ void KeyboardEditor::render(RelativeXCoord mousex_current, int mousey_current,
                             RelativeXCoord mousex_initial, int mousey_initial, bool focus)
 {
     AriaColor ariaColor;
-    bool showNoteNames;
+    const bool showNoteNames = m_show_note_names;
     
     if (not ImageProvider::imagesLoaded()) return;
-    
-    // Get preferences here
-    showNoteNames = PreferencesData::getInstance()->getBoolValue(SETTING_ID_SHOW_NOTE_NAMES, true);
 
     AriaRender::beginScissors(LEFT_EDGE_X, getEditorYStart(), m_width - RIGHT_SCISSOR, m_height);
 
@@ -487,13 +501,17 @@ void KeyboardEditor::render(RelativeXCoord mousex_current, int mousey_current,
             Track* otherTrack = m_background_tracks.get(bgtrack);
             GraphicalTrack* otherGTrack = m_gsequence->getGraphicsFor(otherTrack);
             ASSERT(otherGTrack != NULL);
-            const int noteAmount = otherTrack->getNoteAmount();
             
             ariaColor = pickColor(colorIndex);
+            
+            std::vector<int> visibleNotes;
+            if (not getVisibleNotes(otherTrack, visibleNotes)) continue;
         
             // render the notes
-            for (int n=0; n<noteAmount; n++)
+            const int visibleAmount = visibleNotes.size();
+            for (int i=0; i<visibleAmount; i++)
             {
+                const int n = visibleNotes[i];
                 int x,y;
                 int x1 = otherGTrack->getNoteStartInPixels(n) - m_gsequence->getXScrollInPixels();
                 int x2 = otherGTrack->getNoteEndInPixels(n)   - m_gsequence->getXScrollInPixels();
@@ -533,9 +551,13 @@ void KeyboardEditor::render(RelativeXCoord mousex_current, int mousey_current,
     const int mouse_y_min = std::min(mousey_current, mousey_initial);
     const int mouse_y_max = std::max(mousey_current, mousey_initial);
 
-    const int noteAmount = m_track->getNoteAmount();
-    for (int n=0; n<noteAmount; n++)
+    std::vector<int> visibleNotes;
+    getVisibleNotes(m_track, visibleNotes);
+    
+    const int visibleAmount = visibleNotes.size();
+    for (int i=0; i<visibleAmount; i++)
     {
+        const int n = visibleNotes[i];
         int x;
         const int x1 = m_graphical_track->getNoteStartInPixels(n) - pscroll;
         const int x2 = m_graphical_track->getNoteEndInPixels(n)   - pscroll;
@@ -22,6 +22,7 @@
 
 #include "Editors/Editor.h"
 #include "Editors/RelativeXCoord.h"
+#include "PreferencesData.h"
 #include "Utils.h"
 
 namespace AriaMaestosa
@@ -31,11 +32,14 @@ namespace AriaMaestosa
     class Sequence;
     class GraphicalTrack;
     
-    class KeyboardEditor : public Editor
+    class KeyboardEditor : public Editor, public IPreferencesListener
     {
         AriaRenderArray m_sharp_notes_names;
         AriaRenderArray m_flat_notes_names;
         
+        /** value of the 'show note names' setting, kept up to date by onSettingChanged */
+        bool m_show_note_names;
+        
     public:
         KeyboardEditor(GraphicalTrack* data);
         virtual ~KeyboardEditor();
@@ -103,6 +107,9 @@ namespace AriaMaestosa
         
         void scrollNotesIntoView();
         
+        /** implemented from IPreferencesListener */
+        virtual void onSettingChanged(const Setting& setting);
+        
     private:
         
 
@@ -1246,10 +1246,16 @@ void ScoreEditor::renderTrack(Track* track, const TrackRenderContext& ctx, bool
     m_g_clef_analyser->clearAndPrepare();
     m_f_clef_analyser->clearAndPrepare();
     
+    std::vector<int> visibleNotes;
+    getVisibleNotes(track, ctx.first_x_to_consider - Editor::getEditorXStart(),
+                    ctx.last_x_to_consider - Editor::getEditorXStart(), visibleNotes);
+    
     // render pass 1. draw linear notation if relevant, gather information and do initial rendering for
     // musical notation
-    for (int n=0; n<noteAmount; n++)
+    const int visibleAmount = visibleNotes.size();
+    for (int i=0; i<visibleAmount; i++)
     {
+        const int n = visibleNotes[i];
         PitchSign note_sign;
         const int noteLevel = m_converter->noteToLevel(track->getNote(n), &note_sign);
 
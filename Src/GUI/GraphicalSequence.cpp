@@ -18,6 +18,7 @@
 #include "GUI/GraphicalSequence.h"
 #include "GUI/MainFrame.h"
 #include "GUI/MainPane.h"
+#include "IO/RecordedXMLReader.h"
 #include "Midi/MeasureData.h"
 #include "Midi/Sequence.h"
 #include "PreferencesData.h"
@@ -41,6 +42,7 @@ GraphicalSequence::GraphicalSequence(Sequence* s) : m_name_renderer(s->getNameMo
     m_x_scroll_in_pixels    = 0;
     y_scroll                = 0;
     reorderYScroll          = 0;
+    m_layer_generation      = 0;
     
     m_name_renderer.setMaxWidth(155); // FIXME - won't work if lots of sequences are open (tabs will begin to get smaller)
     m_name_renderer.setFont( getSequenceFilenameFont() );
@@ -55,7 +57,6 @@ void GraphicalSequence::createViewForTrack(Track* t)
     ASSERT( getGraphicsFor(t) == NULL );
     GraphicalTrack* gt = new GraphicalTrack(t, this, t->getMagneticGrid());
     m_gtracks.push_back(gt);
-    gt->createEditors();
 }
 
 void GraphicalSequence::createViewForTracks(int id)
@@ -376,6 +377,9 @@ void GraphicalSequence::mouseHeldDown(RelativeXCoord mousex_current, int mousey_
     const int trackAmount = m_gtracks.size();
     for (int n=0; n<trackAmount; n++)
     {
+        // tracks that don't show their editors don't need them to be made
+        if (m_gtracks[n].isCollapsed() or m_gtracks[n].isDocked()) continue;
+        
         m_gtracks[n].getFocusedEditor()->mouseHeldDown(mousex_current, mousey_current,
                                                        mousex_initial, mousey_initial);
     }//next
@@ -467,7 +471,7 @@ void GraphicalSequence::selectNone()
 #pragma mark I/O
 #endif
 
-void GraphicalSequence::saveToFile(wxFileOutputStream& fileout)
+void GraphicalSequence::saveToFile(wxOutputStream& fileout)
 {
     writeData("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n", fileout);
     writeData(wxT("<seqview xscroll=\"") + to_wxString(m_x_scroll_in_pixels) +
@@ -475,13 +479,75 @@ void GraphicalSequence::saveToFile(wxFileOutputStream& fileout)
               wxT("\" zoom=\"")          + to_wxString(m_zoom_percent) +
               wxT("\">\n"), fileout);
     
-    m_sequence->saveToFile(fileout);
+    m_sequence->saveToFile(fileout, this);
     
     writeData(wxT("</seqview>\n"), fileout);
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
+bool GraphicalSequence::readSeqViewAttributes(irr::io::IrrXMLReader* xml, int* zoom)
+{
+    const char* xscroll_c = xml->getAttributeValue("xscroll");
+    if (xscroll_c != NULL)
+    {
+        m_x_scroll_in_pixels = atoi( xscroll_c );
+        ASSERT_E(m_x_scroll_in_pixels, >=, 0);
+    }
+    else
+    {
+        m_x_scroll_in_pixels = 0;
+        std::cerr << "Missing info from file: x scroll" << std::endl;
+    }
+    
+    if (m_x_scroll_in_pixels < 0)
+    {
+        std::cerr << "Wrong x_scroll_in_pixels: " << m_x_scroll_in_pixels << std::endl;
+        m_x_scroll_in_pixels = 0;
+    }
+    
+    const char* yscroll_c = xml->getAttributeValue("yscroll");
+    if ( yscroll_c != NULL )
+    {
+        y_scroll = atoi( yscroll_c );
+    }
+    else
+    {
+        y_scroll = 0;
+        std::cerr << "Missing info from file: y scroll" << std::endl;
+    }
+    
+    if (y_scroll < 0)
+    {
+        std::cerr << "Wrong y_scroll: " << y_scroll << std::endl;
+        y_scroll = 0;
+    }
+    
+    const char* zoom_c = xml->getAttributeValue("zoom");
+    if (zoom_c != NULL)
+    {
+        int zoom_i = atoi(zoom_c);
+        if (zoom_i > 0 and zoom_i < 501) *zoom = zoom_i;
+        else return false;
+    }
+    else
+    {
+        setZoom( 100 );
+        std::cerr << "Missing info from file: zoom" << std::endl;
+    }
+    
+    if (m_zoom <= 0)
+    {
+        std::cerr << "Fatal Error: Wrong Zoom: " << m_zoom 
+        << "(char* = " << zoom_c << ") " << std::endl;
+        setZoom( 100 );
+    }
+    
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 bool GraphicalSequence::readFromFile(irr::io::IrrXMLReader* xml)
 {
     bool inSeqView = false;
@@ -525,62 +591,7 @@ bool GraphicalSequence::readFromFile(irr::io::IrrXMLReader* xml)
                 else if (strcmp("seqview", xml->getNodeName()) == 0)
                 {
                     inSeqView = true;
-                    
-                    const char* xscroll_c = xml->getAttributeValue("xscroll");
-                    if (xscroll_c != NULL)
-                    {
-                        m_x_scroll_in_pixels = atoi( xscroll_c );
-                        ASSERT_E(m_x_scroll_in_pixels, >=, 0);
-                    }
-                    else
-                    {
-                        m_x_scroll_in_pixels = 0;
-                        std::cerr << "Missing info from file: x scroll" << std::endl;
-                    }
-                    
-                    if (m_x_scroll_in_pixels < 0)
-                    {
-                        std::cerr << "Wrong x_scroll_in_pixels: " << m_x_scroll_in_pixels << std::endl;
-                        m_x_scroll_in_pixels = 0;
-                    }
-                    
-                    const char* yscroll_c = xml->getAttributeValue("yscroll");
-                    if ( yscroll_c != NULL )
-                    {
-                        y_scroll = atoi( yscroll_c );
-                    }
-                    else
-                    {
-                        y_scroll = 0;
-                        std::cerr << "Missing info from file: y scroll" << std::endl;
-                    }
-                    
-                    if (y_scroll < 0)
-                    {
-                        std::cerr << "Wrong y_scroll: " << y_scroll << std::endl;
-                        y_scroll = 0;
-                    }
-                    
-                    const char* zoom_c = xml->getAttributeValue("zoom");
-                    if (zoom_c != NULL)
-                    {
-                        int zoom_i = atoi(zoom_c);
-                        if (zoom_i > 0 and zoom_i < 501) zoom = zoom_i;
-                        else return false;
-                    }
-                    else
-                    {
-                        setZoom( 100 );
-                        std::cerr << "Missing info from file: zoom" << std::endl;
-                    }
-                    
-                    if (m_zoom <= 0)
-                    {
-                        std::cerr << "Fatal Error: Wrong Zoom: " << m_zoom 
-                        << "(char* = " << zoom_c << ") " << std::endl;
-                        setZoom( 100 );
-                    }
-                    
+                    if (not readSeqViewAttributes(xml, &zoom)) return false;
                 }
                 break;
             }
@@ -624,3 +635,31 @@ bool GraphicalSequence::readFromFile(irr::io::IrrXMLReader* xml)
 
 // ----------------------------------------------------------------------------------------------------------
 
+void GraphicalSequence::applyPendingView()
+{
+    int zoom = -1;
+    
+    RecordedXMLReader* seqview = m_sequence->m_pending_view;
+    if (seqview != NULL)
+    {
+        seqview->rewind();
+        if (not readSeqViewAttributes(seqview, &zoom)) zoom = -1;
+        m_sequence->m_pending_view = NULL;
+    }
+    
+    const int trackAmount = m_sequence->getTrackAmount();
+    for (int n=0; n<trackAmount; n++)
+    {
+        m_sequence->getTrack(n)->applyPendingView();
+    }
+    
+    m_sequence->parseBackgroundTracks();
+    
+    // as in readFromFile, zoom is set last, once the beat resolution is known
+    setZoom(zoom != -1 ? zoom : 100);
+    
+    DisplayFrame::updateHorizontalScrollbar( m_x_scroll_in_pixels );
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
@@ -51,10 +51,19 @@ namespace AriaMaestosa
         /** while reordering tracks, contains the vertical scrolling amount */
         int reorderYScroll;
         
+        /** incremented to make all tracks render again instead of drawing their cached layer */
+        int m_layer_generation;
+        
         void createViewForTrack(Track* t);
 
         AriaRenderString m_name_renderer;
         
+        /** the file this tab will show once first opened, for tabs restored lazily from the last session */
+        wxString m_deferred_file_path;
+        
+        /** @brief read the attributes of \<seqview\> ; the zoom is returned, to be set once tracks are read */
+        bool readSeqViewAttributes(irr::io::IrrXMLReader* xml, int* zoom);
+        
     public:
         
         /** 
@@ -107,6 +116,14 @@ namespace AriaMaestosa
         
         void renderTracks(int currentTick, RelativeXCoord mousex, int mousey, int mousey_initial, int from_y);
         
+        /**
+         * @brief the next frame will render all tracks again, instead of drawing their cached layer
+         * @note  to be called when something changed that the layers don't know of (the layers are already
+         *        invalidated by changes to scrolling, zoom, and to the tracks and sequence data)
+         */
+        void invalidateTrackLayers() { m_layer_generation++; }
+        int  getLayerGeneration() const { return m_layer_generation; }
+        
         /** @brief called repeatedly when mouse is held down */
         void mouseHeldDown(RelativeXCoord mousex_current, int mousey_current,
                            RelativeXCoord mousex_initial, int mousey_initial);
@@ -151,8 +168,23 @@ namespace AriaMaestosa
         
         void copy();
         
-        void saveToFile(wxFileOutputStream& fileout);
+        void saveToFile(wxOutputStream& fileout);
         bool readFromFile(irr::io::IrrXMLReader* xml);
+        
+        /**
+         * @brief apply the view settings kept by a sequence that was read without a view
+         *        (see loadAriaFile(Sequence*, wxString, ILoadMonitor*))
+         * @pre   this sequence is the current one, and views were created for its tracks
+         */
+        void applyPendingView();
+        
+        /**
+         * @brief set when this tab is a placeholder for a file that is not loaded yet
+         *        (see MainFrame::setCurrentSequence)
+         */
+        void setDeferredFilePath(const wxString& path) { m_deferred_file_path = path;       }
+        const wxString& getDeferredFilePath() const    { return m_deferred_file_path;       }
+        bool isDeferred() const                        { return not m_deferred_file_path.IsEmpty(); }
     };
     
 }
@@ -384,6 +384,19 @@ GraphicalTrack::GraphicalTrack(Track* track, GraphicalSequence* seq, MagneticGri
     m_controller_editor   = NULL;
     m_score_editor        = NULL;
     m_resizing_subeditor  = NULL;
+    m_next_to_resizing_subeditor = NULL;
+    
+    // same defaults as the score editor
+    const int scoreView = PreferencesData::getInstance()->getIntValue("scoreview");
+    m_g_clef           = true;
+    m_f_clef           = true;
+    m_musical_notation = (scoreView == 0 or scoreView == 1);
+    m_linear_notation  = (scoreView == 0 or scoreView == 2);
+    m_octave_shift     = 0;
+    
+    m_controller               = -1;
+    m_show_only_used_drums     = false;
+    m_keyboard_notes_into_view = false;
     
     m_gsequence = seq;
     m_track = track;
@@ -507,29 +520,226 @@ GraphicalTrack::~GraphicalTrack()
 
 // ----------------------------------------------------------------------------------------------------------
     
-void GraphicalTrack::createEditors()
+GraphicalTrack::EditorSettings::EditorSettings()
+{
+    m_relative_height = 1.0f;
+    m_scroll          = -1.0f;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GraphicalTrack::createEditor(const NotationType type)
 {
-    ASSERT(m_all_editors.size() == 0); // function to be called once per object only
+    switch (type)
+    {
+        case KEYBOARD:   m_keyboard_editor   = new KeyboardEditor(this);   break;
+        case GUITAR:     m_guitar_editor     = new GuitarEditor(this);     break;
+        case DRUM:       m_drum_editor       = new DrumEditor(this);       break;
+        case CONTROLLER: m_controller_editor = new ControllerEditor(this); break;
+        case SCORE:      m_score_editor      = new ScoreEditor(this);      break;
+        default:
+            ASSERT(false);
+            return;
+    }
+    
+    Editor* editor = getExistingEditor(type);
+    m_all_editors.push_back(editor);
+    
+    applyEditorSettings(type);
+    editor->addBackgroundTracks();
+    
+    // editors made after the key was set need to be told about it
+    const KeyType key = m_track->getKeyType();
+    if (key == KEY_TYPE_SHARPS)     editor->onKeyChange(m_track->getKeySharpsAmount(), key);
+    else if (key == KEY_TYPE_FLATS) editor->onKeyChange(m_track->getKeyFlatsAmount(), key);
     
-    m_keyboard_editor = new KeyboardEditor(this);
-    m_keyboard_editor->setRelativeHeight(1.0f);
-    m_all_editors.push_back(m_keyboard_editor);
+    if (type == DRUM and m_show_only_used_drums) m_drum_editor->useCustomDrumSet();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GraphicalTrack::releaseEditors()
+{
+    for (int n=0; n<NOTATION_TYPE_COUNT; n++)
+    {
+        storeEditorSettings( (NotationType)n );
+    }
     
-    m_guitar_editor = new GuitarEditor(this);
-    m_guitar_editor->setRelativeHeight(1.0f);
-    m_all_editors.push_back(m_guitar_editor);
+    m_resizing_subeditor         = NULL;
+    m_next_to_resizing_subeditor = NULL;
     
-    m_drum_editor = new DrumEditor(this);
-    m_drum_editor->setRelativeHeight(1.0f);
-    m_all_editors.push_back(m_drum_editor);
+    m_all_editors.clearWithoutDeleting();
+    m_keyboard_editor   = NULL;
+    m_guitar_editor     = NULL;
+    m_drum_editor       = NULL;
+    m_controller_editor = NULL;
+    m_score_editor      = NULL;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GraphicalTrack::storeEditorSettings(const NotationType type)
+{
+    Editor* editor = getExistingEditor(type);
+    if (editor == NULL) return;
     
-    m_controller_editor = new ControllerEditor(this);
-    m_controller_editor->setRelativeHeight(1.0f);
-    m_all_editors.push_back(m_controller_editor);
+    EditorSettings& settings = m_editor_settings[type];
+    settings.m_relative_height   = editor->getRelativeHeight();
+    settings.m_scroll            = editor->getScrollbarPosition();
+    settings.m_background_tracks = editor->getBackgroundTracks();
     
-    m_score_editor = new ScoreEditor(this);
-    m_score_editor->setRelativeHeight(1.0f);
-    m_all_editors.push_back(m_score_editor);
+    if (type == SCORE)
+    {
+        m_g_clef           = m_score_editor->isGClefEnabled();
+        m_f_clef           = m_score_editor->isFClefEnabled();
+        m_musical_notation = m_score_editor->isMusicalNotationEnabled();
+        m_linear_notation  = m_score_editor->isLinearNotationEnabled();
+        m_octave_shift     = m_score_editor->getScoreMidiConverter()->getOctaveShift();
+    }
+    else if (type == CONTROLLER)
+    {
+        m_controller = m_controller_editor->getCurrentControllerType();
+    }
+    else if (type == DRUM)
+    {
+        m_show_only_used_drums = m_drum_editor->showOnlyUsedDrums();
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GraphicalTrack::applyEditorSettings(const NotationType type)
+{
+    Editor* editor = getExistingEditor(type);
+    if (editor == NULL) return;
+    
+    const EditorSettings& settings = m_editor_settings[type];
+    editor->setRelativeHeight(settings.m_relative_height);
+    if (settings.m_scroll >= 0.0f) editor->setScrollbarPosition(settings.m_scroll);
+    
+    // resolved by Editor::addBackgroundTracks, once all tracks are known
+    editor->clearBackgroundTracks();
+    editor->setBackgroundTracks(settings.m_background_tracks);
+    
+    if (type == SCORE)
+    {
+        m_score_editor->enableGClef(m_g_clef);
+        m_score_editor->enableFClef(m_f_clef);
+        m_score_editor->enableMusicalNotation(m_musical_notation);
+        m_score_editor->enableLinearNotation(m_linear_notation);
+        m_score_editor->getScoreMidiConverter()->setOctaveShift(m_octave_shift);
+    }
+    else if (type == CONTROLLER)
+    {
+        if (m_controller != -1) m_controller_editor->setController(m_controller);
+    }
+    else if (type == DRUM)
+    {
+        m_drum_editor->setShowOnlyUsedDrums(m_show_only_used_drums);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+float GraphicalTrack::getEditorRelativeHeight(const NotationType type)
+{
+    Editor* editor = getExistingEditor(type);
+    if (editor != NULL) return editor->getRelativeHeight();
+    return m_editor_settings[type].m_relative_height;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GraphicalTrack::setEditorRelativeHeight(const NotationType type, const float relativeHeight)
+{
+    m_editor_settings[type].m_relative_height = relativeHeight;
+    
+    Editor* editor = getExistingEditor(type);
+    if (editor != NULL) editor->setRelativeHeight(relativeHeight);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+Editor* GraphicalTrack::getEditorFor(NotationType type)
+{
+    if (getExistingEditor(type) == NULL) createEditor(type);
+    return getExistingEditor(type);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+KeyboardEditor* GraphicalTrack::getKeyboardEditor()
+{
+    if (m_keyboard_editor.raw_ptr == NULL) createEditor(KEYBOARD);
+    return m_keyboard_editor;
+}
+
+const KeyboardEditor* GraphicalTrack::getKeyboardEditor() const
+{
+    return const_cast<GraphicalTrack*>(this)->getKeyboardEditor();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+GuitarEditor* GraphicalTrack::getGuitarEditor()
+{
+    if (m_guitar_editor.raw_ptr == NULL) createEditor(GUITAR);
+    return m_guitar_editor;
+}
+
+const GuitarEditor* GraphicalTrack::getGuitarEditor() const
+{
+    return const_cast<GraphicalTrack*>(this)->getGuitarEditor();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+DrumEditor* GraphicalTrack::getDrumEditor()
+{
+    if (m_drum_editor.raw_ptr == NULL) createEditor(DRUM);
+    return m_drum_editor;
+}
+
+const DrumEditor* GraphicalTrack::getDrumEditor() const
+{
+    return const_cast<GraphicalTrack*>(this)->getDrumEditor();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+ScoreEditor* GraphicalTrack::getScoreEditor()
+{
+    if (m_score_editor.raw_ptr == NULL) createEditor(SCORE);
+    return m_score_editor;
+}
+
+const ScoreEditor* GraphicalTrack::getScoreEditor() const
+{
+    return const_cast<GraphicalTrack*>(this)->getScoreEditor();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+ControllerEditor* GraphicalTrack::getControllerEditor()
+{
+    if (m_controller_editor.raw_ptr == NULL) createEditor(CONTROLLER);
+    return m_controller_editor;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GraphicalTrack::setShowOnlyUsedDrums(const bool showOnlyUsedDrums)
+{
+    m_show_only_used_drums = showOnlyUsedDrums;
+    if (m_drum_editor.raw_ptr != NULL) m_drum_editor->setShowOnlyUsedDrums(showOnlyUsedDrums);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GraphicalTrack::setController(const int controller)
+{
+    m_controller = controller;
+    if (m_controller_editor.raw_ptr != NULL) m_controller_editor->setController(controller);
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -559,7 +769,7 @@ bool GraphicalTrack::mouseWheelMoved(int mx, int my, int value)
 
 // ----------------------------------------------------------------------------------------------------------
 
-bool GraphicalTrack::handleEditorChanges(int x, BitmapButton* button, Editor* editor, NotationType type)
+bool GraphicalTrack::handleEditorChanges(int x, BitmapButton* button, NotationType type)
 {
     if (x > button->getX() and x < button->getX() + EDITOR_ICON_SIZE)
     {
@@ -589,13 +799,12 @@ bool GraphicalTrack::handleEditorChanges(int x, BitmapButton* button, Editor* ed
                 {
                     if (n == type)
                     {
-                        getEditorFor( (NotationType)n )->setRelativeHeight( relativeHeight );
+                        setEditorRelativeHeight( (NotationType)n, relativeHeight );
                     }
                     else if (m_track->isNotationTypeEnabled( (NotationType)n ))
                     {
-                        Editor* otherEditor = getEditorFor( (NotationType)n );
-                        float curr = otherEditor->getRelativeHeight();
-                        otherEditor->setRelativeHeight( curr - curr*relativeHeight );
+                        float curr = getEditorRelativeHeight( (NotationType)n );
+                        setEditorRelativeHeight( (NotationType)n, curr - curr*relativeHeight );
                     }
                     
                 }
@@ -605,16 +814,15 @@ bool GraphicalTrack::handleEditorChanges(int x, BitmapButton* button, Editor* ed
                 // can't disable the last shown ditor
                 if (m_track->getEnabledEditorCount() <= 1) return true;
                 
-                if (not m_gsequence->isTrackMaximized()) m_height -= m_height*editor->getRelativeHeight();
-                float toRemove = getEditorFor( type )->getRelativeHeight();
+                float toRemove = getEditorRelativeHeight( type );
+                if (not m_gsequence->isTrackMaximized()) m_height -= m_height*toRemove;
                 
                 for (int n=0; n<NOTATION_TYPE_COUNT; n++)
                 {
                     if (n != type and m_track->isNotationTypeEnabled( (NotationType)n ))
                     {
-                        Editor* otherEditor = getEditorFor( (NotationType)n );
-                        float curr = otherEditor->getRelativeHeight();
-                        otherEditor->setRelativeHeight( curr/(1.0f - toRemove) );
+                        float curr = getEditorRelativeHeight( (NotationType)n );
+                        setEditorRelativeHeight( (NotationType)n, curr/(1.0f - toRemove) );
                     }
                 }
             }
@@ -683,7 +891,7 @@ bool GraphicalTrack::processMouseDown(RelativeXCoord mousex, int mousey)
         // collapse
         if (m_collapse_button->clickIsOnThisWidget(winX, mousey))
         {
-            m_collapsed = not m_collapsed;
+            setCollapsed(not m_collapsed);
             DisplayFrame::updateVerticalScrollbar();
         }
 
@@ -853,16 +1061,16 @@ bool GraphicalTrack::processMouseDown(RelativeXCoord mousex, int mousey)
             // FIXME: setting drums to channel 9 will probably fail if you're trying to enable multiple editors
             
             // modes
-            if (handleEditorChanges(winX, m_score_button, m_score_editor, SCORE))
+            if (handleEditorChanges(winX, m_score_button, SCORE))
             {
             }
-            else if (handleEditorChanges(winX, m_piano_button, m_keyboard_editor, KEYBOARD))
+            else if (handleEditorChanges(winX, m_piano_button, KEYBOARD))
             {
             }
-            else if (handleEditorChanges(winX, m_tab_button, m_guitar_editor, GUITAR))
+            else if (handleEditorChanges(winX, m_tab_button, GUITAR))
             {
             }
-            else if (handleEditorChanges(winX, m_drum_button, m_drum_editor, DRUM))
+            else if (handleEditorChanges(winX, m_drum_button, DRUM))
             {
                 // in midi, drums go to channel 9 (10 if you start counting from one)
                 if (m_track->isNotationTypeEnabled(DRUM) and
@@ -882,7 +1090,7 @@ bool GraphicalTrack::processMouseDown(RelativeXCoord mousex, int mousey)
                 {
                     if (not m_gsequence->isTrackMaximized())
                     {
-                        m_height -= m_height*m_controller_editor->getRelativeHeight();
+                        m_height -= m_height*getEditorRelativeHeight(CONTROLLER);
                     }
                     m_track->setNotationType(CONTROLLER, false);
                 }
@@ -1153,7 +1361,7 @@ void GraphicalTrack::processMouseOutsideOfMe()
 
 void GraphicalTrack::onTrackRemoved(Track* track)
 {
-    m_keyboard_editor->trackDeleted(track);
+    if (m_keyboard_editor.raw_ptr != NULL) m_keyboard_editor->trackDeleted(track);
     
     // uncomment if these editors get background support too
     // m_guitar_editor->trackDelete(track);
@@ -1196,6 +1404,7 @@ void GraphicalTrack::onInstrumentChanged(const int newInstrument)
 void GraphicalTrack::setCollapsed(const bool collapsed)
 {
     m_collapsed = collapsed;
+    if (collapsed) releaseEditors();
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -1232,6 +1441,7 @@ void GraphicalTrack::dock(const bool setDocked)
     {
         m_docked = true;
         m_gsequence->addToDock( this );
+        releaseEditors();
     }
     else
     {
@@ -1329,7 +1539,7 @@ void GraphicalTrack::selectNote(const int id, const bool selected, bool ignoreMo
         if (ed != NULL and ed->getNotationType() == CONTROLLER)
         {
             // FIXME(DESIGN): controller editor must be handled differently (special case)
-            m_controller_editor->selectAll( selected );
+            getControllerEditor()->selectAll( selected );
             done_for_controller = true;
         }
     }
@@ -1346,62 +1556,65 @@ Editor* GraphicalTrack::getEditorAt(const int y, Editor** next)
 {
     if (next != NULL) *next = NULL;
     
-    if (m_track->isNotationTypeEnabled(SCORE) and y >= m_score_editor->getTrackYStart() and
-        y <= m_score_editor->getYEnd())
+    // editors are not shown
+    if (m_collapsed or m_docked) return NULL;
+    
+    if (m_track->isNotationTypeEnabled(SCORE) and y >= getScoreEditor()->getTrackYStart() and
+        y <= getScoreEditor()->getYEnd())
     {
         m_focused_editor = SCORE;
         if (next != NULL)
         {
-            if      (m_track->isNotationTypeEnabled(KEYBOARD))   *next = m_keyboard_editor;
-            else if (m_track->isNotationTypeEnabled(GUITAR))     *next = m_guitar_editor;
-            else if (m_track->isNotationTypeEnabled(DRUM))       *next = m_drum_editor;
-            else if (m_track->isNotationTypeEnabled(CONTROLLER)) *next = m_controller_editor;
+            if      (m_track->isNotationTypeEnabled(KEYBOARD))   *next = getKeyboardEditor();
+            else if (m_track->isNotationTypeEnabled(GUITAR))     *next = getGuitarEditor();
+            else if (m_track->isNotationTypeEnabled(DRUM))       *next = getDrumEditor();
+            else if (m_track->isNotationTypeEnabled(CONTROLLER)) *next = getControllerEditor();
         }
-        return m_score_editor;
+        return getScoreEditor();
     }
     
-    if (m_track->isNotationTypeEnabled(GUITAR) and y >= m_guitar_editor->getTrackYStart() and
-        y <= m_guitar_editor->getYEnd())
+    if (m_track->isNotationTypeEnabled(GUITAR) and y >= getGuitarEditor()->getTrackYStart() and
+        y <= getGuitarEditor()->getYEnd())
     {
         m_focused_editor = GUITAR;
         if (next != NULL)
         {
-            if      (m_track->isNotationTypeEnabled(KEYBOARD))   *next = m_keyboard_editor;
-            else if (m_track->isNotationTypeEnabled(DRUM))       *next = m_drum_editor;
-            else if (m_track->isNotationTypeEnabled(CONTROLLER)) *next = m_controller_editor;
+            if      (m_track->isNotationTypeEnabled(KEYBOARD))   *next = getKeyboardEditor();
+            else if (m_track->isNotationTypeEnabled(DRUM))       *next = getDrumEditor();
+            else if (m_track->isNotationTypeEnabled(CONTROLLER)) *next = getControllerEditor();
         }
-        return m_guitar_editor;
+        return getGuitarEditor();
     }
 
-    if (m_track->isNotationTypeEnabled(KEYBOARD) and y >= m_keyboard_editor->getTrackYStart()and
-        y <= m_keyboard_editor->getYEnd())
+    if (m_track->isNotationTypeEnabled(KEYBOARD) and y >= getKeyboardEditor()->getTrackYStart()and
+        y <= getKeyboardEditor()->getYEnd())
     {
         m_focused_editor = KEYBOARD;
         if (next != NULL)
         {
-            if      (m_track->isNotationTypeEnabled(DRUM))       *next = m_drum_editor;
-            else if (m_track->isNotationTypeEnabled(CONTROLLER)) *next = m_controller_editor;
+            if      (m_track->isNotationTypeEnabled(DRUM))       *next = getDrumEditor();
+            else if (m_track->isNotationTypeEnabled(CONTROLLER)) *next = getControllerEditor();
         }
-        return m_keyboard_editor;
+        return getKeyboardEditor();
     }
     
-    if (m_track->isNotationTypeEnabled(DRUM) and y >= m_drum_editor->getTrackYStart() and
-        y <= m_drum_editor->getYEnd())
+    if (m_track->isNotationTypeEnabled(DRUM) and y >= getDrumEditor()->getTrackYStart() and
+        y <= getDrumEditor()->getYEnd())
     {
         m_focused_editor = DRUM;
         if (next != NULL)
         {
-            if (m_track->isNotationTypeEnabled(CONTROLLER)) *next = m_controller_editor;
+            if (m_track->isNotationTypeEnabled(CONTROLLER)) *next = getControllerEditor();
         }
-        return m_drum_editor;
+        return getDrumEditor();
     }
     
-    if (m_track->isNotationTypeEnabled(CONTROLLER) and y >= m_controller_editor->getTrackYStart() and
-        y <= m_controller_editor->getYEnd())
+    if (m_track->isNotationTypeEnabled(CONTROLLER) and y >= getControllerEditor()->getTrackYStart() and
+        y <= getControllerEditor()->getYEnd())
     {
         m_focused_editor = CONTROLLER;
         if (next != NULL) *next = NULL;
-        return m_controller_editor;
+        return getControllerEditor();
     }
     
     return NULL;
@@ -1413,50 +1626,50 @@ Editor* GraphicalTrack::getFocusedEditor()
 {
     if (m_focused_editor == KEYBOARD and m_track->isNotationTypeEnabled(KEYBOARD))
     {
-        return m_keyboard_editor;
+        return getKeyboardEditor();
     }
     if (m_focused_editor == GUITAR and m_track->isNotationTypeEnabled(GUITAR))
     {
-        return m_guitar_editor;
+        return getGuitarEditor();
     }
     if (m_focused_editor == DRUM and m_track->isNotationTypeEnabled(DRUM))
     {
-        return m_drum_editor;
+        return getDrumEditor();
     }
     if (m_focused_editor == SCORE and m_track->isNotationTypeEnabled(SCORE))
     {
-        return m_score_editor;
+        return getScoreEditor();
     }
     if (m_focused_editor == CONTROLLER and m_track->isNotationTypeEnabled(CONTROLLER))
     {
-        return m_controller_editor;
+        return getControllerEditor();
     }
     
     // Focused editor not found!! Pick the firsdt we find
     if (m_track->isNotationTypeEnabled(KEYBOARD))
     {
         m_focused_editor = KEYBOARD;
-        return m_keyboard_editor;
+        return getKeyboardEditor();
     }
     if (m_track->isNotationTypeEnabled(GUITAR))
     {
         m_focused_editor = GUITAR;
-        return m_guitar_editor;
+        return getGuitarEditor();
     }
     if (m_track->isNotationTypeEnabled(DRUM))
     {
         m_focused_editor = DRUM;
-        return m_drum_editor;
+        return getDrumEditor();
     }
     if (m_track->isNotationTypeEnabled(SCORE))
     {
         m_focused_editor = SCORE;
-        return m_score_editor;
+        return getScoreEditor();
     }
     if (m_track->isNotationTypeEnabled(CONTROLLER))
     {
         m_focused_editor = CONTROLLER;
-        return m_controller_editor;
+        return getControllerEditor();
     }
     
     // WTF??
@@ -1489,11 +1702,11 @@ void GraphicalTrack::evenlyDistributeSpace()
     if (m_track->isNotationTypeEnabled(DRUM))       count++;
     if (m_track->isNotationTypeEnabled(CONTROLLER)) count++;
     
-    if (m_track->isNotationTypeEnabled(SCORE))      m_score_editor->setRelativeHeight(1.0f / count);
-    if (m_track->isNotationTypeEnabled(KEYBOARD))   m_keyboard_editor->setRelativeHeight(1.0f / count);
-    if (m_track->isNotationTypeEnabled(GUITAR))     m_guitar_editor->setRelativeHeight(1.0f / count);
-    if (m_track->isNotationTypeEnabled(DRUM))       m_drum_editor->setRelativeHeight(1.0f / count);
-    if (m_track->isNotationTypeEnabled(CONTROLLER)) m_controller_editor->setRelativeHeight(1.0f / count);
+    if (m_track->isNotationTypeEnabled(SCORE))      setEditorRelativeHeight(SCORE,      1.0f / count);
+    if (m_track->isNotationTypeEnabled(KEYBOARD))   setEditorRelativeHeight(KEYBOARD,   1.0f / count);
+    if (m_track->isNotationTypeEnabled(GUITAR))     setEditorRelativeHeight(GUITAR,     1.0f / count);
+    if (m_track->isNotationTypeEnabled(DRUM))       setEditorRelativeHeight(DRUM,       1.0f / count);
+    if (m_track->isNotationTypeEnabled(CONTROLLER)) setEditorRelativeHeight(CONTROLLER, 1.0f / count);
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -1752,6 +1965,128 @@ void GraphicalTrack::renderHeader(const int x, const int y, const bool closed, c
 
 // ----------------------------------------------------------------------------------------------------------
 
+GraphicalTrack::LayerKey::LayerKey()
+{
+    m_from_y            = -1;
+    m_to_y              = -1;
+    m_width             = -1;
+    m_height            = -1;
+    m_x_scroll          = -1;
+    m_zoom              = -1.0f;
+    m_focus             = false;
+    m_collapsed         = false;
+    m_track_revision    = -1;
+    m_sequence_revision = -1;
+    m_generation        = -1;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool GraphicalTrack::LayerKey::operator==(const LayerKey& other) const
+{
+    return m_from_y            == other.m_from_y            and
+           m_to_y              == other.m_to_y              and
+           m_width             == other.m_width             and
+           m_height            == other.m_height            and
+           m_x_scroll          == other.m_x_scroll          and
+           m_zoom              == other.m_zoom              and
+           m_focus             == other.m_focus             and
+           m_collapsed         == other.m_collapsed         and
+           m_track_revision    == other.m_track_revision    and
+           m_sequence_revision == other.m_sequence_revision and
+           m_generation        == other.m_generation;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+GraphicalTrack::LayerKey GraphicalTrack::getLayerKey(const bool focus) const
+{
+    LayerKey key;
+    key.m_from_y            = m_from_y;
+    key.m_to_y              = m_to_y;
+    key.m_width             = Display::getWidth();
+    key.m_height            = Display::getHeight();
+    key.m_x_scroll          = m_gsequence->getXScrollInPixels();
+    key.m_zoom              = m_gsequence->getZoom();
+    key.m_focus             = focus;
+    key.m_collapsed         = m_collapsed;
+    key.m_track_revision    = m_track->getRevision();
+    key.m_sequence_revision = m_gsequence->getModel()->getRevision();
+    key.m_generation        = m_gsequence->getLayerGeneration();
+    return key;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GraphicalTrack::renderEditors(const int count, const bool focus)
+{
+    const RelativeXCoord x1 = Display::getMouseX_current();
+    const int y1 = Display::getMouseY_current();
+    const RelativeXCoord x2 = Display::getMouseX_initial();
+    const int y2 = Display::getMouseY_initial();
+    
+    int rcount = 0;
+
+    if (m_track->isNotationTypeEnabled(SCORE))
+    {
+        rcount++;
+        getScoreEditor()->render(x1, y1, x2, y2, focus);
+        
+        if (rcount < count)
+        {
+            AriaRender::primitives();
+            AriaRender::color( 0.5f, 0.5f, 0.5f );
+            AriaRender::rect(10, getScoreEditor()->getYEnd() - THUMB_SIZE_ABOVE,
+                             getScoreEditor()->getXEnd(), getScoreEditor()->getYEnd() + THUMB_SIZE_BELOW );
+        }
+    }
+    if (m_track->isNotationTypeEnabled(GUITAR))
+    {
+        rcount++;
+        getGuitarEditor()->render(x1, y1, x2, y2, focus);
+        
+        if (rcount < count)
+        {
+            AriaRender::primitives();
+            AriaRender::color( 0.5f, 0.5f, 0.5f );
+            AriaRender::rect(10, getGuitarEditor()->getYEnd() - THUMB_SIZE_ABOVE,
+                             getGuitarEditor()->getXEnd(), getGuitarEditor()->getYEnd() + THUMB_SIZE_BELOW );
+        }
+    }
+    if (m_track->isNotationTypeEnabled(KEYBOARD))
+    {
+        rcount++;
+        getKeyboardEditor()->render(x1, y1, x2, y2, focus);
+        
+        if (rcount < count)
+        {
+            AriaRender::primitives();
+            AriaRender::color( 0.5f, 0.5f, 0.5f );
+            AriaRender::rect(10, getKeyboardEditor()->getYEnd() - THUMB_SIZE_ABOVE,
+                             getKeyboardEditor()->getXEnd(), getKeyboardEditor()->getYEnd() + THUMB_SIZE_BELOW );
+        }
+    }
+    if (m_track->isNotationTypeEnabled(DRUM))
+    {
+        rcount++;
+        getDrumEditor()->render(x1, y1, x2, y2, focus);
+        
+        if (rcount < count)
+        {
+            AriaRender::primitives();
+            AriaRender::color( 0.5f, 0.5f, 0.5f );
+            AriaRender::rect(10, getDrumEditor()->getYEnd() - THUMB_SIZE_ABOVE,
+                             getDrumEditor()->getXEnd(), getDrumEditor()->getYEnd() + THUMB_SIZE_BELOW );
+        }
+    }
+    if (m_track->isNotationTypeEnabled(CONTROLLER))
+    {
+        getControllerEditor()->render(x1, y1, x2, y2, focus);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 int GraphicalTrack::render(const int y, const int currentTick, const bool focus)
 {
     
@@ -1778,6 +2113,11 @@ int GraphicalTrack::render(const int y, const int currentTick, const bool focus)
         m_to_y = editor_from_y + m_height + BORDER_SIZE + MARGIN_Y;
     }
     
+    // don't waste time laying it out or drawing it if out of bounds ; this way editors are only made once
+    // their track is shown
+    if (m_to_y < 0) return m_to_y;
+    if (m_from_y > Display::getHeight()) return m_to_y;
+    
     // tell the editor(s) about its/their new location
     int count = 0;
     if (m_track->isNotationTypeEnabled(SCORE))      count++;
@@ -1791,118 +2131,85 @@ int GraphicalTrack::render(const int y, const int currentTick, const bool focus)
 
     const int original_editor_from_y = editor_from_y;
     
-    if (m_track->isNotationTypeEnabled(SCORE))
-    {
-        int h = m_score_editor->getRelativeHeight()*editor_height;
-        editor_to_y += h;
-        m_score_editor->updatePosition(editor_from_y, editor_to_y, Display::getWidth(), h);
-        editor_from_y = editor_to_y + 1;
-    }
-    if (m_track->isNotationTypeEnabled(GUITAR))
-    {
-        int h = m_guitar_editor->getRelativeHeight()*editor_height;
-        editor_to_y += h;
-        m_guitar_editor->updatePosition(editor_from_y, editor_to_y, Display::getWidth(), h);
-        editor_from_y = editor_to_y + 1;
-    }
-    if (m_track->isNotationTypeEnabled(KEYBOARD))
-    {
-        int h = m_keyboard_editor->getRelativeHeight()*editor_height;
-        editor_to_y += h;
-        m_keyboard_editor->updatePosition(editor_from_y, editor_to_y, Display::getWidth(), h);
-        editor_from_y = editor_to_y + 1;
-    }
-    if (m_track->isNotationTypeEnabled(DRUM))
-    {
-        int h = m_drum_editor->getRelativeHeight()*editor_height;
-        editor_to_y += h;
-        m_drum_editor->updatePosition(editor_from_y, editor_to_y, Display::getWidth(), h);
-        editor_from_y = editor_to_y + 1;
-    }
-    if (m_track->isNotationTypeEnabled(CONTROLLER))
-    {
-        int h = m_controller_editor->getRelativeHeight()*editor_height;
-        editor_to_y += h;
-        m_controller_editor->updatePosition(editor_from_y, editor_to_y, Display::getWidth(), h);
-        editor_from_y = editor_to_y + 1;
-    }
-    
-    // don't waste time drawing it if out of bounds
-    if (m_to_y < 0) return m_to_y;
-    if (m_from_y > Display::getHeight()) return m_to_y;
-    
-    renderHeader(0, y, m_collapsed, focus);
-    
     if (not m_collapsed)
     {
-        // --------------------------------------------------
-        // render editor(s)
-        
-        const RelativeXCoord x1 = Display::getMouseX_current();
-        const int y1 = Display::getMouseY_current();
-        const RelativeXCoord x2 = Display::getMouseX_initial();
-        const int y2 = Display::getMouseY_initial();
-        
-        int rcount = 0;
-
         if (m_track->isNotationTypeEnabled(SCORE))
         {
-            rcount++;
-            m_score_editor->render(x1, y1, x2, y2, focus);
-            
-            if (rcount < count)
-            {
-                AriaRender::primitives();
-                AriaRender::color( 0.5f, 0.5f, 0.5f );
-                AriaRender::rect(10, m_score_editor->getYEnd() - THUMB_SIZE_ABOVE,
-                                 m_score_editor->getXEnd(), m_score_editor->getYEnd() + THUMB_SIZE_BELOW );
-            }
+            int h = getScoreEditor()->getRelativeHeight()*editor_height;
+            editor_to_y += h;
+            getScoreEditor()->updatePosition(editor_from_y, editor_to_y, Display::getWidth(), h);
+            editor_from_y = editor_to_y + 1;
         }
         if (m_track->isNotationTypeEnabled(GUITAR))
         {
-            rcount++;
-            m_guitar_editor->render(x1, y1, x2, y2, focus);
-            
-            if (rcount < count)
-            {
-                AriaRender::primitives();
-                AriaRender::color( 0.5f, 0.5f, 0.5f );
-                AriaRender::rect(10, m_guitar_editor->getYEnd() - THUMB_SIZE_ABOVE,
-                                 m_guitar_editor->getXEnd(), m_guitar_editor->getYEnd() + THUMB_SIZE_BELOW );
-            }
+            int h = getGuitarEditor()->getRelativeHeight()*editor_height;
+            editor_to_y += h;
+            getGuitarEditor()->updatePosition(editor_from_y, editor_to_y, Display::getWidth(), h);
+            editor_from_y = editor_to_y + 1;
         }
         if (m_track->isNotationTypeEnabled(KEYBOARD))
         {
-            rcount++;
-            m_keyboard_editor->render(x1, y1, x2, y2, focus);
-            
-            if (rcount < count)
-            {
-                AriaRender::primitives();
-                AriaRender::color( 0.5f, 0.5f, 0.5f );
-                AriaRender::rect(10, m_keyboard_editor->getYEnd() - THUMB_SIZE_ABOVE,
-                                 m_keyboard_editor->getXEnd(), m_keyboard_editor->getYEnd() + THUMB_SIZE_BELOW );
-            }
+            int h = getKeyboardEditor()->getRelativeHeight()*editor_height;
+            editor_to_y += h;
+            getKeyboardEditor()->updatePosition(editor_from_y, editor_to_y, Display::getWidth(), h);
+            editor_from_y = editor_to_y + 1;
         }
         if (m_track->isNotationTypeEnabled(DRUM))
         {
-            rcount++;
-            m_drum_editor->render(x1, y1, x2, y2, focus);
-            
-            if (rcount < count)
-            {
-                AriaRender::primitives();
-                AriaRender::color( 0.5f, 0.5f, 0.5f );
-                AriaRender::rect(10, m_drum_editor->getYEnd() - THUMB_SIZE_ABOVE,
-                                 m_drum_editor->getXEnd(), m_drum_editor->getYEnd() + THUMB_SIZE_BELOW );
-            }
+            int h = getDrumEditor()->getRelativeHeight()*editor_height;
+            editor_to_y += h;
+            getDrumEditor()->updatePosition(editor_from_y, editor_to_y, Display::getWidth(), h);
+            editor_from_y = editor_to_y + 1;
         }
         if (m_track->isNotationTypeEnabled(CONTROLLER))
         {
-            m_controller_editor->render(x1, y1, x2, y2, focus);
+            int h = getControllerEditor()->getRelativeHeight()*editor_height;
+            editor_to_y += h;
+            getControllerEditor()->updatePosition(editor_from_y, editor_to_y, Display::getWidth(), h);
+            editor_from_y = editor_to_y + 1;
         }
         
+        if (m_keyboard_notes_into_view and m_track->isNotationTypeEnabled(KEYBOARD))
+        {
+            m_keyboard_notes_into_view = false;
+            m_keyboard_editor->scrollNotesIntoView();
+        }
+    }
+    
+    // the header and editors are drawn from the cached layer when nothing changed since it was rendered;
+    // tracks under the mouse are always rendered since editors show what's hovered or dragged
+    const int mouse_y = Display::getMouseY_current();
+    const int mouse_y_initial = Display::getMouseY_initial();
+    const bool mouse_in_track = (mouse_y >= m_from_y and mouse_y <= m_to_y) or
+                                (Display::isMouseDown() and mouse_y_initial >= m_from_y and
+                                 mouse_y_initial <= m_to_y);
+    
+    const LayerKey key = getLayerKey(focus);
+    if (mouse_in_track)
+    {
+        m_layer.invalidate();
+    }
+    
+    if (mouse_in_track or not (key == m_layer_key) or not AriaRender::drawLayer(m_layer))
+    {
+        const int layer_from_y = std::max(m_from_y, 0);
+        const int layer_to_y   = std::min(m_to_y, Display::getHeight());
+        const bool layered = not mouse_in_track and
+                             AriaRender::beginLayer(m_layer, 0, layer_from_y, Display::getWidth(),
+                                                    layer_to_y - layer_from_y);
         
+        renderHeader(0, y, m_collapsed, focus);
+        if (not m_collapsed) renderEditors(count, focus);
+        
+        if (layered)
+        {
+            AriaRender::endLayer(m_layer);
+            m_layer_key = key;
+        }
+    }
+    
+    if (not m_collapsed)
+    {
         // --------------------------------------------------
         // render playback progress line
         
@@ -2034,6 +2341,13 @@ void GraphicalTrack::setDivider(int divider)
 
 void GraphicalTrack::scrollKeyboardEditorNotesIntoView()
 {
+    // an editor that isn't shown does it once it's made and laid out (see render)
+    if (m_keyboard_editor.raw_ptr == NULL or m_collapsed or m_docked)
+    {
+        m_keyboard_notes_into_view = true;
+        return;
+    }
+    
     m_keyboard_editor->scrollNotesIntoView();
 }
 
@@ -2045,62 +2359,60 @@ void GraphicalTrack::scrollKeyboardEditorNotesIntoView()
 #pragma mark Serialization
 #endif
 
-void GraphicalTrack::saveToFile(wxFileOutputStream& fileout)
+wxString GraphicalTrack::getEditorAttributes(const NotationType type, const bool withScroll) const
+{
+    const EditorSettings& settings = m_editor_settings[type];
+    wxString out;
+    
+    if (withScroll and settings.m_scroll >= 0.0f)
+    {
+        out += wxT("\" scroll=\"") + to_wxString(settings.m_scroll);
+    }
+    if (m_track->isNotationTypeEnabled(type))
+    {
+        out += wxT("\" proportion=\"") + to_wxString(settings.m_relative_height);
+    }
+    if (not settings.m_background_tracks.IsEmpty())
+    {
+        out += wxT("\" background_tracks=\"") + settings.m_background_tracks;
+    }
+    return out;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GraphicalTrack::saveToFile(wxOutputStream& fileout)
 {
-    const int octave_shift = m_score_editor->getScoreMidiConverter()->getOctaveShift();
+    // editors that were not made (or were released) are saved from the settings kept for them
+    for (int n=0; n<NOTATION_TYPE_COUNT; n++)
+    {
+        storeEditorSettings( (NotationType)n );
+    }
 
     // TODO: move notation type to "Track"
     writeData(wxString(wxT("  <editors ")) + (m_collapsed ? wxT("collapsed=\"true\" ") : wxT("")) + 
               wxT("height=\"") + to_wxString(m_height) + wxT("\">\n"),
               fileout);
     writeData(wxT("    <score enabled=\"") + wxString(m_track->isNotationTypeEnabled(SCORE) ? wxT("true") : wxT("false")) +
-              wxT("\" musical_notation=\"") + (m_score_editor->isMusicalNotationEnabled()?wxT("true"):wxT("false")) +
-              wxT("\" linear_notation=\"") + (m_score_editor->isLinearNotationEnabled()?wxT("true"):wxT("false")) +
-              wxT("\" g_clef=\"") + (m_score_editor->isGClefEnabled()?wxT("true"):wxT("false")) +
-              wxT("\" f_clef=\"") + (m_score_editor->isFClefEnabled()?wxT("true"):wxT("false")) +
-              ( octave_shift != 0 ? wxT("\" octave_shift=\"") + to_wxString(octave_shift) : wxT("")) +
-              wxT("\" scroll=\"") + to_wxString(m_score_editor->getScrollbarPosition()) +
-              (m_track->isNotationTypeEnabled(SCORE) ? 
-               wxT("\" proportion=\"") + to_wxString(m_score_editor->getRelativeHeight()) :
-               wxT("")) +
-              (m_score_editor->isBackgroundTrack() ? 
-               wxT("\" background_tracks=\"") + m_score_editor->getBackgroundTracks() :
-               wxT(""))+
+              wxT("\" musical_notation=\"") + (m_musical_notation?wxT("true"):wxT("false")) +
+              wxT("\" linear_notation=\"") + (m_linear_notation?wxT("true"):wxT("false")) +
+              wxT("\" g_clef=\"") + (m_g_clef?wxT("true"):wxT("false")) +
+              wxT("\" f_clef=\"") + (m_f_clef?wxT("true"):wxT("false")) +
+              ( m_octave_shift != 0 ? wxT("\" octave_shift=\"") + to_wxString(m_octave_shift) : wxT("")) +
+              getEditorAttributes(SCORE, true) +
               wxT("\"/>\n"), fileout);
     writeData(wxT("    <keyboard enabled=\"") + wxString(m_track->isNotationTypeEnabled(KEYBOARD) ? wxT("true") : wxT("false")) +
-              wxT("\" scroll=\"") + to_wxString(m_keyboard_editor->getScrollbarPosition()) +
-              (m_track->isNotationTypeEnabled(KEYBOARD) ? 
-               wxT("\" proportion=\"") + to_wxString(m_keyboard_editor->getRelativeHeight()) :
-               wxT("")) +
-              (m_keyboard_editor->isBackgroundTrack() ? 
-               wxT("\" background_tracks=\"") + m_keyboard_editor->getBackgroundTracks() :
-               wxT(""))+
+              getEditorAttributes(KEYBOARD, true) +
               wxT("\"/>\n"), fileout);
     writeData(wxT("    <guitar enabled=\"") + wxString(m_track->isNotationTypeEnabled(GUITAR) ? wxT("true") : wxT("false")) +
-              (m_track->isNotationTypeEnabled(GUITAR) ? 
-               wxT("\" proportion=\"") + to_wxString(m_guitar_editor->getRelativeHeight()) :
-               wxT("")) +
-              (m_guitar_editor->isBackgroundTrack() ? 
-               wxT("\" background_tracks=\"") + m_guitar_editor->getBackgroundTracks() :
-               wxT(""))+
+              getEditorAttributes(GUITAR, false) +
               wxT("\"/>\n"), fileout);
     writeData(wxT("    <drum enabled=\"") + wxString(m_track->isNotationTypeEnabled(DRUM) ? wxT("true") : wxT("false")) +
-              wxT("\" scroll=\"") + to_wxString(m_drum_editor->getScrollbarPosition()) +
-              (m_track->isNotationTypeEnabled(DRUM) ? 
-               wxT("\" proportion=\"") + to_wxString(m_drum_editor->getRelativeHeight()) :
-               wxT("")) +
-              (m_drum_editor->isBackgroundTrack() ? 
-               wxT("\" background_tracks=\"") + m_drum_editor->getBackgroundTracks() :
-               wxT(""))+
+              getEditorAttributes(DRUM, true) +
               wxT("\"/>\n"), fileout);
     writeData(wxT("    <controller enabled=\"") + wxString(m_track->isNotationTypeEnabled(CONTROLLER) ? wxT("true") : wxT("false")) +
-              wxT("\" controller=\"") + to_wxString(m_controller_editor->getCurrentControllerType()) +
-              (m_track->isNotationTypeEnabled(CONTROLLER) ? 
-               wxT("\" proportion=\"") + to_wxString(m_controller_editor->getRelativeHeight()) :
-               wxT("")) +
-              (m_controller_editor->isBackgroundTrack() ? 
-               wxT("\" background_tracks=\"") + m_controller_editor->getBackgroundTracks() :
-               wxT(""))+
+              ( m_controller != -1 ? wxT("\" controller=\"") + to_wxString(m_controller) : wxT("")) +
+              getEditorAttributes(CONTROLLER, false) +
               wxT("\"/>\n"), fileout);
     writeData(wxT("  </editors>\n"), fileout );
     
@@ -2111,7 +2423,7 @@ void GraphicalTrack::saveToFile(wxFileOutputStream& fileout)
     // TODO: move this to 'Track', has nothing to do here in GraphicalTrack
     writeData( wxT("  <instrument id=\"") + to_wxString( m_track->getInstrument() ) + wxT("\"/>\n"), fileout);
     writeData( wxT("  <drumkit id=\"") + to_wxString( m_track->getDrumKit() ) + wxT("\" collapseView=\"") +
-               to_wxString(m_drum_editor->showOnlyUsedDrums()) + wxT("\"/>\n"), fileout);
+               to_wxString(m_show_only_used_drums) + wxT("\"/>\n"), fileout);
     
     // guitar tuning (FIXME: move this out of here)
     writeData( wxT("  <guitartuning "), fileout);
@@ -2178,11 +2490,11 @@ bool GraphicalTrack::readFromFile(irr::io::IrrXMLReader* xml)
         {
             if (strcmp(f_clef_c, "true") == 0)
             {
-                m_score_editor->enableFClef(true);
+                m_f_clef = true;
             }
             else if (strcmp(f_clef_c, "false") == 0)
             {
-                m_score_editor->enableFClef(false);
+                m_f_clef = false;
             }
             else
             {
@@ -2194,7 +2506,7 @@ bool GraphicalTrack::readFromFile(irr::io::IrrXMLReader* xml)
         if ( octave_shift_c != NULL )
         {
             int new_value = atoi( octave_shift_c );
-            if (new_value != 0) m_score_editor->getScoreMidiConverter()->setOctaveShift(new_value);
+            if (new_value != 0) m_octave_shift = new_value;
         }
         
         // compatibility code for older versions of .Aria file format (TODO: eventually remove)
@@ -2215,6 +2527,7 @@ bool GraphicalTrack::readFromFile(irr::io::IrrXMLReader* xml)
             }
             
         }
+        applyEditorSettings(SCORE);
         evenlyDistributeSpace();
     }
     else if (strcmp("editors", xml->getNodeName()) == 0)
@@ -2282,7 +2595,8 @@ bool GraphicalTrack::readFromFile(irr::io::IrrXMLReader* xml)
                     }
                     
                     
-                    float scroll = 0.5f;
+                    // editors that don't exist yet keep their default scroll when it wasn't saved
+                    float scroll = -1.0f;
                     const char* scroll_c = xml->getAttributeValue("scroll");
                     if (scroll_c != NULL)
                     {
@@ -2303,23 +2617,41 @@ bool GraphicalTrack::readFromFile(irr::io::IrrXMLReader* xml)
     
                     wxString backgroundTracks = wxString::FromUTF8(xml->getAttributeValue("background_tracks"));
                    
-                    if (strcmp("score", xml->getNodeName()) == 0)
+                    NotationType type = NOTATION_TYPE_COUNT;
+                    if      (strcmp("score",      xml->getNodeName()) == 0) type = SCORE;
+                    else if (strcmp("keyboard",   xml->getNodeName()) == 0) type = KEYBOARD;
+                    else if (strcmp("guitar",     xml->getNodeName()) == 0) type = GUITAR;
+                    else if (strcmp("drum",       xml->getNodeName()) == 0) type = DRUM;
+                    else if (strcmp("controller", xml->getNodeName()) == 0) type = CONTROLLER;
+                    
+                    if (type == NOTATION_TYPE_COUNT)
+                    {
+                        fprintf(stderr, "[GraphicalTrack] WARNING: Unknown editor type '%s'\n", xml->getNodeName());
+                        break;
+                    }
+                    
+                    // the file is read into the settings kept for the editor, which are then given to it if it
+                    // exists (the guitar and controller editors don't save their scroll)
+                    storeEditorSettings(type);
+                    
+                    EditorSettings& settings = m_editor_settings[type];
+                    m_track->setNotationType(type, enabled);
+                    settings.m_background_tracks = backgroundTracks;
+                    if (enabled) settings.m_relative_height = proportion;
+                    if (scroll_c != NULL and type != GUITAR and type != CONTROLLER) settings.m_scroll = scroll;
+                    
+                    if (type == SCORE)
                     {
-                        m_track->setNotationType(SCORE, enabled);
-                        m_score_editor->setScrollbarPosition(scroll);
-                        m_score_editor->setBackgroundTracks(backgroundTracks);
-                        if (enabled) m_score_editor->setRelativeHeight(proportion);
-                        
                         const char* musical_notation_c = xml->getAttributeValue("musical_notation");
                         if (musical_notation_c != NULL)
                         {
                             if (strcmp(musical_notation_c, "true") == 0)
                             {
-                                m_score_editor->enableMusicalNotation(true);
+                                m_musical_notation = true;
                             }
                             else if (strcmp(musical_notation_c, "false") == 0)
                             {
-                                m_score_editor->enableMusicalNotation(false);
+                                m_musical_notation = false;
                             }
                             else
                             {
@@ -2332,11 +2664,11 @@ bool GraphicalTrack::readFromFile(irr::io::IrrXMLReader* xml)
                         {
                             if (strcmp(linear_notation_c, "true") == 0)
                             {
-                                m_score_editor->enableLinearNotation(true);
+                                m_linear_notation = true;
                             }
                             else if (strcmp(linear_notation_c, "false") == 0)
                             {
-                                m_score_editor->enableLinearNotation(false);
+                                m_linear_notation = false;
                             }
                             else
                             {
@@ -2349,11 +2681,11 @@ bool GraphicalTrack::readFromFile(irr::io::IrrXMLReader* xml)
                         {
                             if (strcmp(g_clef_c, "true") == 0)
                             {
-                                m_score_editor->enableGClef(true);
+                                m_g_clef = true;
                             }
                             else if (strcmp(g_clef_c, "false") == 0)
                             {
-                                m_score_editor->enableGClef(false);
+                                m_g_clef = false;
                             }
                             else
                             {
@@ -2366,11 +2698,11 @@ bool GraphicalTrack::readFromFile(irr::io::IrrXMLReader* xml)
                         {
                             if (strcmp(f_clef_c, "true") == 0)
                             {
-                                m_score_editor->enableFClef(true);
+                                m_f_clef = true;
                             }
                             else if (strcmp(f_clef_c, "false") == 0)
                             {
-                                m_score_editor->enableFClef(false);
+                                m_f_clef = false;
                             }
                             else
                             {
@@ -2383,45 +2715,19 @@ bool GraphicalTrack::readFromFile(irr::io::IrrXMLReader* xml)
                         if ( octave_shift_c != NULL )
                         {
                             int new_value = atoi( octave_shift_c );
-                            if (new_value != 0) m_score_editor->getScoreMidiConverter()->setOctaveShift(new_value);
+                            if (new_value != 0) m_octave_shift = new_value;
                         }
                     }
-                    else if (strcmp("keyboard", xml->getNodeName()) == 0)
-                    {
-                        m_track->setNotationType(KEYBOARD, enabled);
-                        m_keyboard_editor->setScrollbarPosition(scroll);
-                        m_keyboard_editor->setBackgroundTracks(backgroundTracks);
-                        if (enabled) m_keyboard_editor->setRelativeHeight(proportion);
-                    }
-                    else if (strcmp("guitar", xml->getNodeName()) == 0)
-                    {
-                        m_track->setNotationType(GUITAR, enabled);
-                        m_guitar_editor->setBackgroundTracks(backgroundTracks);
-                        if (enabled) m_guitar_editor->setRelativeHeight(proportion);
-                    }
-                    else if (strcmp("drum", xml->getNodeName()) == 0)
+                    else if (type == CONTROLLER)
                     {
-                        m_track->setNotationType(DRUM, enabled);
-                        m_drum_editor->setBackgroundTracks(backgroundTracks);
-                        m_drum_editor->setScrollbarPosition(scroll);
-                        if (enabled) m_drum_editor->setRelativeHeight(proportion);
-                    }
-                    else if (strcmp("controller", xml->getNodeName()) == 0)
-                    {
-                        m_track->setNotationType(CONTROLLER, enabled);
-                        m_controller_editor->setBackgroundTracks(backgroundTracks);
-                        if (enabled) m_controller_editor->setRelativeHeight(proportion);
-                        
                         const char* id = xml->getAttributeValue("controller");
                         if (id != NULL)
                         {
-                            getControllerEditor()->setController(atoi(id));
+                            m_controller = atoi(id);
                         }
                     }
-                    else
-                    {
-                        fprintf(stderr, "[GraphicalTrack] WARNING: Unknown editor type '%s'\n", xml->getNodeName());
-                    }
+                    
+                    applyEditorSettings(type);
                     break;
                 }
                 case irr::io::EXN_ELEMENT_END:
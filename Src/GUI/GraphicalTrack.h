@@ -23,9 +23,10 @@
 #include "Midi/Track.h"
 #include "Pickers/MagneticGridPicker.h"
 #include "Renderers/RenderAPI.h"
+#include "Renderers/RenderLayer.h"
 
 
-class wxFileOutputStream;
+class wxOutputStream;
 // forward
 namespace irr { namespace io {
     class IXMLBase;
@@ -89,13 +90,44 @@ namespace AriaMaestosa
         GraphicalSequence* m_gsequence;
         Track* m_track;
 
-        // editors
+        // editors ; they are only made when first needed (see getEditorFor), and released again when the
+        // track is collapsed or docked (see releaseEditors)
         OwnerPtr<KeyboardEditor>    m_keyboard_editor  ;
         OwnerPtr<GuitarEditor>      m_guitar_editor    ;
         OwnerPtr<DrumEditor>        m_drum_editor      ;
         OwnerPtr<ControllerEditor>  m_controller_editor;
         OwnerPtr<ScoreEditor>       m_score_editor     ;
         
+        /** What is kept of the view of an editor while it doesn't exist */
+        struct EditorSettings
+        {
+            float    m_relative_height;
+            
+            /** Scrollbar position, or -1 to keep the default of the editor */
+            float    m_scroll;
+            
+            /** IDs of the background tracks (see Editor::getBackgroundTracks) */
+            wxString m_background_tracks;
+            
+            EditorSettings();
+        };
+        
+        EditorSettings m_editor_settings[NOTATION_TYPE_COUNT];
+        
+        // score editor settings
+        bool m_g_clef, m_f_clef;
+        bool m_musical_notation, m_linear_notation;
+        int  m_octave_shift;
+        
+        /** Controller shown by the controller editor, or -1 to keep the default of the editor */
+        int  m_controller;
+        
+        /** See DrumEditor::showOnlyUsedDrums */
+        bool m_show_only_used_drums;
+        
+        /** Whether the keyboard editor is to scroll its notes into view once it's made and laid out */
+        bool m_keyboard_notes_into_view;
+        
         bool m_dragging_resize;
         
         
@@ -111,6 +143,7 @@ namespace AriaMaestosa
         
         OwnerPtr<MagneticGridPicker>  m_grid;
 
+        /** The editors that currently exist */
         ptr_vector<Editor, REF> m_all_editors;
         
         OwnerPtr< Model<wxString> > m_instrument_string;
@@ -124,9 +157,48 @@ namespace AriaMaestosa
         Editor* m_resizing_subeditor;
         Editor* m_next_to_resizing_subeditor;
         
-        void evenlyDistributeSpace();
+        /** Everything the rendering of the track header and editors depends on */
+        struct LayerKey
+        {
+            int   m_from_y, m_to_y;
+            int   m_width, m_height;
+            int   m_x_scroll;
+            float m_zoom;
+            bool  m_focus;
+            bool  m_collapsed;
+            int   m_track_revision;
+            int   m_sequence_revision;
+            int   m_generation;
+            
+            LayerKey();
+            bool operator==(const LayerKey& other) const;
+        };
+        
+        /** The header and editors as rendered in a previous frame, reused as long as the key doesn't change */
+        RenderLayer m_layer;
+        LayerKey    m_layer_key;
+        
+        LayerKey getLayerKey(const bool focus) const;
+        void renderEditors(const int count, const bool focus);
+        
         
-        bool handleEditorChanges(int x, BitmapButton* button, Editor* editor, NotationType type);
+        bool handleEditorChanges(int x, BitmapButton* button, NotationType type);
+        
+        /** @brief make the editor of the given type, giving it the settings kept for it */
+        void createEditor(const NotationType type);
+        
+        /** @brief keep the settings of the given editor, if it exists, so that they survive its release */
+        void storeEditorSettings(const NotationType type);
+        
+        /** @brief give the given editor, if it exists, the settings kept for it */
+        void applyEditorSettings(const NotationType type);
+        
+        /** @brief relative height of an editor, read from the settings kept for it if it doesn't exist */
+        float getEditorRelativeHeight(const NotationType type);
+        void  setEditorRelativeHeight(const NotationType type, const float relativeHeight);
+        
+        /** @brief the scroll, proportion and background tracks attributes of an editor, for saveToFile */
+        wxString getEditorAttributes(const NotationType type, const bool withScroll) const;
         wxString getInstrumentName(int instId);
         
     public:
@@ -144,6 +216,9 @@ namespace AriaMaestosa
         void setCollapsed(const bool collapsed);
         void setHeight(const int height);
         void maximizeHeight(bool maximize=true);
+        
+        /** @brief give all the enabled editors of this track the same height */
+        void evenlyDistributeSpace();
                 
         bool isCollapsed() const { return m_collapsed; }
         bool isDocked   () const { return m_docked;    }
@@ -154,24 +229,30 @@ namespace AriaMaestosa
         const GraphicalSequence* getSequence() const  { return m_gsequence;  }
 
         /**
-          * @pre Track, Sequence and GraphicalTrack must be initialized properly upon calling this
+          * @brief delete the editors of this track, keeping their settings; they are made again when needed
+          * @note  called when the track is collapsed or docked, the editors must not be in use
           */
-        void createEditors();
+        void releaseEditors();
         
         //Editor* getCurrentEditor();
         
-        // editors
-              KeyboardEditor* getKeyboardEditor()       { return m_keyboard_editor;   }
-        const KeyboardEditor* getKeyboardEditor() const { return m_keyboard_editor;   }
-              GuitarEditor*   getGuitarEditor  ()       { return m_guitar_editor;     }
-        const GuitarEditor*   getGuitarEditor  () const { return m_guitar_editor;     }
-              DrumEditor*     getDrumEditor    ()       { return m_drum_editor;       }
-        const DrumEditor*     getDrumEditor    () const { return m_drum_editor;       }
-              ScoreEditor*    getScoreEditor   ()       { return m_score_editor;      }
-        const ScoreEditor*    getScoreEditor   () const { return m_score_editor;      }
+        // editors ; the getters make the editor if it doesn't exist yet
+              KeyboardEditor*   getKeyboardEditor  ();
+        const KeyboardEditor*   getKeyboardEditor  () const;
+              GuitarEditor*     getGuitarEditor    ();
+        const GuitarEditor*     getGuitarEditor    () const;
+              DrumEditor*       getDrumEditor      ();
+        const DrumEditor*       getDrumEditor      () const;
+              ScoreEditor*      getScoreEditor     ();
+        const ScoreEditor*      getScoreEditor     () const;
+              ControllerEditor* getControllerEditor();
 
         Editor* getEditorAt(const int y, Editor** next=NULL);
-        Editor* getEditorFor(NotationType type)
+        Editor* getEditorFor(NotationType type);
+        Editor* getFocusedEditor();
+        
+        /** @return the editor of the given type, or NULL if it wasn't made (unlike getEditorFor, never makes it) */
+        Editor* getExistingEditor(NotationType type)
         {
             if      (type == SCORE)      return (Editor*)m_score_editor.raw_ptr;
             else if (type == GUITAR)     return (Editor*)m_guitar_editor.raw_ptr;
@@ -180,9 +261,12 @@ namespace AriaMaestosa
             else if (type == CONTROLLER) return (Editor*)m_controller_editor.raw_ptr;
             return NULL;
         }
-        Editor* getFocusedEditor();
         
-        ControllerEditor*   getControllerEditor() { return m_controller_editor; }
+        /** @brief set what the drum editor shows, without making it (see DrumEditor::setShowOnlyUsedDrums) */
+        void setShowOnlyUsedDrums(const bool showOnlyUsedDrums);
+        
+        /** @brief set the controller shown by the controller editor, without making it */
+        void setController(const int controller);
 
         void dock(const bool dock=true);
         
@@ -255,7 +339,7 @@ namespace AriaMaestosa
         void scrollKeyboardEditorNotesIntoView();
 
         // serialization
-        void saveToFile(wxFileOutputStream& fileout);
+        void saveToFile(wxOutputStream& fileout);
         bool readFromFile(irr::io::IrrXMLReader* xml);
         
     };
@@ -36,9 +36,11 @@
 #include "GUI/MeasureBar.h"
 
 #include "IO/AriaFileWriter.h"
+#include "IO/AsyncFileLoader.h"
 #include "IO/IOUtils.h"
 #include "IO/MidiFileReader.h"
 
+#include "Midi/GuitarFingering.h"
 #include "Midi/MeasureData.h"
 #include "Midi/Sequence.h"
 #include "Midi/Players/PlatformMidiManager.h"
@@ -90,6 +92,8 @@ namespace AriaMaestosa
     DEFINE_LOCAL_EVENT_TYPE(wxEVT_NEW_VERSION_AVAILABLE)
     DEFINE_LOCAL_EVENT_TYPE(wxEVT_ASYNC_ERROR_MESSAGE)
     DEFINE_LOCAL_EVENT_TYPE(wxEVT_SHOW_TRACK_CONTEXTUAL_MENU)
+    DEFINE_LOCAL_EVENT_TYPE(wxEVT_GUITAR_FINGERING_SOLVED)
+    DEFINE_LOCAL_EVENT_TYPE(wxEVT_FILE_LOADED)
 }
 
 
@@ -184,6 +188,10 @@ EVT_COMMAND(ASYNC_ERR_MESSAGE_EVENT_ID, wxEVT_ASYNC_ERROR_MESSAGE, MainFrame::ev
 
 EVT_COMMAND(wxID_ANY, wxEVT_SHOW_TRACK_CONTEXTUAL_MENU, MainFrame::evt_showTrackContextualMenu)
 
+EVT_COMMAND(wxID_ANY, wxEVT_GUITAR_FINGERING_SOLVED, MainFrame::evt_guitarFingeringSolved)
+
+EVT_COMMAND(wxID_ANY, wxEVT_FILE_LOADED, MainFrame::evt_fileLoaded)
+
 
 EVT_MOUSEWHEEL(MainFrame::onMouseWheel)
 
@@ -344,6 +352,7 @@ MainFrame::MainFrame() : wxFrame(NULL, wxID_ANY, wxT("Aria Maestosa"), wxPoint(1
     m_disabled_for_welcome_screen = false;
     m_paused = false;
     m_reload_mode = false;
+    m_closing_all_sequences = false;
 
     m_root_sizer = new wxBoxSizer(wxVERTICAL);
     m_root_sizer->Add(m_main_panel, 1, wxEXPAND | wxALL, 0);
@@ -376,6 +385,11 @@ MainFrame::~MainFrame()
 {
     wxLogVerbose( wxT("MainFrame::~MainFrame") );
     
+    // the loader and the solver post events to this frame until they are stopped
+    m_file_loader = NULL;
+    m_fingering_solver = NULL;
+    m_autosave = NULL;
+    
     std::map<int, wxTimer*>::iterator it;
     for(it = m_timer_map.begin() ; it != m_timer_map.end(); ++it)
     {
@@ -403,11 +417,12 @@ MainFrame::~MainFrame()
 
 // ----------------------------------------------------------------------------------------------------------
 
-void MainFrame::init(const wxArrayString& filesToOpen, bool fileInCommandLine)
+void MainFrame::init(const wxArrayString& filesToOpen, const wxArrayString& sessionFiles, bool fileInCommandLine)
 {
     wxLogVerbose( wxT("MainFrame::init") );
     changingValues = true;
     m_files_to_open = filesToOpen;
+    m_session_files = sessionFiles;
     m_file_in_command_line = fileInCommandLine;
     m_current_dir = ::wxGetCwd();
 
@@ -853,12 +868,40 @@ void MainFrame::onShow(wxShowEvent& evt)
 #endif
     wxLogVerbose( wxT("MainFrame::init (done)") );
     
+    // files of the last session are only loaded when their tab is first shown
+    for (unsigned int n = 0; n < m_session_files.Count(); n++)
+    {
+        if (wxFileExists(m_session_files[n])) addFileTab(m_session_files[n], false /* load now */);
+    }
     
     for (unsigned int n = 0; n < m_files_to_open.Count(); n++)
     {
         loadFile(m_files_to_open[n]);
     }
     
+    // copies of modified files, left over if the application did not quit properly last time
+    std::vector<AutosaveManager::RecoveryFile> recovered;
+    AutosaveManager::findRecoveryFiles(recovered);
+    if (not recovered.empty())
+    {
+        const int answer = wxMessageBox(_("Aria Maestosa did not quit properly last time. Copies of the files that had unsaved changes were kept. Do you want to open them?"),
+                                        _("Recover unsaved changes"), wxYES_NO, this);
+        if (answer == wxYES)
+        {
+            for (unsigned int n = 0; n < recovered.size(); n++)
+            {
+                GraphicalSequence* placeholder = addFileTab(recovered[n].m_path, true /* load now */);
+                placeholder->getModel()->setSequenceFilename(recovered[n].m_title);
+                m_recovered_files[recovered[n].m_path] = recovered[n];
+            }
+        }
+        else
+        {
+            AutosaveManager::removeRecoveryFiles(recovered);
+        }
+    }
+    m_autosave = new AutosaveManager();
+    
     
     if ( pd->getBoolValue(SETTING_ID_LOAD_LAST_SESSION, false) && !m_file_in_command_line )
     {
@@ -871,6 +914,8 @@ void MainFrame::onShow(wxShowEvent& evt)
         }
     }
     
+    GraphicalSequence* current = getCurrentGraphicalSequence();
+    if (current != NULL and current->isDeferred()) requestFileLoad(current);
 }
 
 
@@ -1267,7 +1312,7 @@ void MainFrame::updateTopBarAndScrollbarsForSequence(const GraphicalSequence* se
     m_toolbar->ToggleTool(LOOP_CLICKED, seq->getModel()->isLoopEnabled());
 
 #if defined(__WXOSX_COCOA__)
-    OSXSetModified(seq->getModel()->somethingToUndo());
+    OSXSetModified(seq->getModel()->hasUnsavedChanges());
 #endif
 
     // scrollbars
@@ -1851,7 +1896,7 @@ bool MainFrame::closeSequence(int id_arg) // -1 means current
     }
 
 
-    if (m_sequences[id].getModel()->somethingToUndo())
+    if (m_sequences[id].getModel()->hasUnsavedChanges())
     {
         wxString message = _("You have unsaved changes in sequence '%s'. Do you want to save them before proceeding?") +
                            wxString(wxT("\n\n")) +
@@ -1878,6 +1923,9 @@ bool MainFrame::closeSequence(int id_arg) // -1 means current
         }
     }
 
+    if (m_sequences[id].isDeferred()) cancelFileLoad( m_sequences.get(id) );
+    if (m_autosave.raw_ptr != NULL) m_autosave->onSequenceClosed( m_sequences.get(id) );
+    
     m_sequences.erase( id );
     m_paused = false;
     m_toolbar->SetToolNormalBitmap(PLAY_CLICKED, m_play_bitmap);
@@ -1974,6 +2022,9 @@ void MainFrame::setCurrentSequence(int n, bool updateView)
         m_paused = false;
         updateTopBarAndScrollbarsForSequence( getCurrentGraphicalSequence() );
         updateMenuBarToSequence();
+        
+        // tabs restored from the last session are loaded when first shown
+        if (m_sequences[n].isDeferred()) requestFileLoad( m_sequences.get(n) );
     }
 }
 
@@ -1999,13 +2050,16 @@ void MainFrame::loadFile(const wxString& filePath)
     
     for (int i=0 ; i<size && !found ; i++)
     {
-        existingFilePath = m_sequences[i].getModel()->getFilepath();
+        // tabs whose file is not loaded yet have no file path, so that saving can't overwrite the file
+        if (m_sequences[i].isDeferred()) existingFilePath = m_sequences[i].getDeferredFilePath();
+        else                             existingFilePath = m_sequences[i].getModel()->getFilepath();
         
         if (areFilesIdentical(existingFilePath, filePath))
         {
+            // a tab still waiting for its file is loaded by this
             setCurrentSequence(i);
             
-            if (m_reload_mode)
+            if (m_reload_mode and not m_sequences[i].isDeferred())
             {
                 reloadFile();
             }
@@ -2045,122 +2099,248 @@ void MainFrame::loadFile(const wxString& filePath)
 void MainFrame::loadAriaFile(const wxString& filePath)
 {
     wxLogVerbose( wxT("MainFrame::loadAriaFile") );
+    if (filePath.IsEmpty()) return;
+    
+    addFileTab(filePath, true /* load now */);
+}
 
+// ----------------------------------------------------------------------------------------------------------
+ /** Opens the .mid file in filepath, reads it and prepares the editor to display and edit it. */
+void MainFrame::loadMidiFile(const wxString& filePath)
+{
+    wxLogVerbose( wxT("MainFrame::loadMidiFile") );
     if (filePath.IsEmpty()) return;
+    
+    addFileTab(filePath, true /* load now */);
+}
 
-    const int old_currentSequence = m_current_sequence;
+// ----------------------------------------------------------------------------------------------------------
 
+GraphicalSequence* MainFrame::addFileTab(const wxString& filePath, const bool loadNow)
+{
+    const int old_currentSequence = m_current_sequence;
+    const bool playing = (PlatformMidiManager::get()->isPlaying() or m_paused);
+    
     addSequence(false);
-    setCurrentSequence( getSequenceAmount()-1 );
-    getCurrentSequence()->setFilepath( filePath );
-
-    //WaitWindow::show(this, _("Please wait while .aria file is loading.") );
-
-    const bool success = AriaMaestosa::loadAriaFile(getCurrentGraphicalSequence(), getCurrentSequence()->getFilepath());
-    if (not success)
-    {
-        std::cout << "Loading .aria file failed." << std::endl;
-        //WaitWindow::hide();
-        wxMessageBox(  _("Sorry, loading .aria file failed.") );
-
-        closeSequence();
+    
+    // the file path is only set once loaded, so that saving the placeholder can't overwrite the file
+    GraphicalSequence* placeholder = getCurrentGraphicalSequence();
+    placeholder->setDeferredFilePath(filePath);
+    placeholder->getModel()->setSequenceFilename( extractTitle(filePath) );
+    
+    // if a song is currently playing, it needs to stay on top
+    if (playing and old_currentSequence < m_sequences.size() - 1) setCurrentSequence(old_currentSequence);
+    
+    if (loadNow) requestFileLoad(placeholder);
+    return placeholder;
+}
 
-        return;
-    }
+// ----------------------------------------------------------------------------------------------------------
 
-    //WaitWindow::hide();
-    updateVerticalScrollbar();
+void MainFrame::requestFileLoad(GraphicalSequence* placeholder)
+{
+    ASSERT(placeholder->isDeferred());
+    
+    if (m_closing_all_sequences) return;
+    if (m_load_queue.contains(placeholder)) return;
+    if (m_file_loader.raw_ptr != NULL and m_file_loader->getTarget() == placeholder) return;
+    
+    m_load_queue.push_back(placeholder);
+    startNextFileLoad();
+}
 
-    // change song name
-    getCurrentSequence()->setSequenceFilename( extractTitle(getCurrentSequence()->getFilepath()) );
+// ----------------------------------------------------------------------------------------------------------
 
-    // if a song is currently playing, it needs to stay on top
-    if (PlatformMidiManager::get()->isPlaying() or m_paused)
+void MainFrame::startNextFileLoad()
+{
+    if (m_file_loader.raw_ptr != NULL or m_load_queue.size() == 0) return;
+    
+    GraphicalSequence* placeholder = m_load_queue.get(0);
+    m_load_queue.remove(0);
+    
+    m_file_loader = new AsyncFileLoader(placeholder->getDeferredFilePath(), placeholder);
+    
+    // the MIDI reader reports progress track by track ; .aria files are parsed in one go by irrXML
+    if (m_file_loader->isMidiFile())
     {
-        setCurrentSequence(old_currentSequence);
+        WaitWindow::show(this, _("Please wait while midi file is loading."), true, this);
     }
     else
     {
-        updateTopBarAndScrollbarsForSequence( getCurrentGraphicalSequence() );
-        updateMenuBarToSequence();
+        WaitWindow::show(this, _("Please wait while .aria file is loading."), false, this);
     }
-
-    Display::render();
-    addRecentFile(filePath);
+    
+    m_file_loader->start();
 }
 
-
 // ----------------------------------------------------------------------------------------------------------
- /** Opens the .mid file in filepath, reads it and prepares the editor to display and edit it. */
-void MainFrame::loadMidiFile(const wxString& filePath)
-{
-    wxLogVerbose( wxT("MainFrame::loadMidiFile") );
-    if (filePath.IsEmpty()) return;
-
-    const int old_currentSequence = m_current_sequence;
 
-    addSequence(false);
+void MainFrame::cancelFileLoad(GraphicalSequence* placeholder)
+{
+    m_load_queue.remove(placeholder);
     
-    setCurrentSequence( getSequenceAmount()-1 );
-    getCurrentSequence()->setFilepath(filePath);
-
-    WaitWindow::show(this, _("Please wait while midi file is loading."));
-
-    std::set<wxString> warnings;
-    if (not AriaMaestosa::loadMidiFile( getCurrentGraphicalSequence(), filePath, warnings ) )
+    if (m_file_loader.raw_ptr != NULL and m_file_loader->getTarget() == placeholder)
     {
-        std::cout << "Loading midi file failed." << std::endl;
-        WaitWindow::hide();
-        wxMessageBox(  _("Sorry, loading midi file failed.") );
-        closeSequence();
-
-        return;
+        // the loader's result is discarded once it stopped (see evt_fileLoaded)
+        m_file_loader->setTarget(NULL);
+        m_file_loader->cancel();
     }
+}
 
-    WaitWindow::hide();
-    updateVerticalScrollbar();
+// ----------------------------------------------------------------------------------------------------------
 
-    // change song name
-    getCurrentSequence()->setSequenceFilename( extractTitle(filePath) );
+void MainFrame::onWaitWindowCancel()
+{
+    if (m_file_loader.raw_ptr != NULL) m_file_loader->cancel();
+}
 
-    ASSERT(getCurrentSequence()->invariant());
+// ----------------------------------------------------------------------------------------------------------
 
-    // if a song is currently playing, it needs to stay on top
-    if (PlatformMidiManager::get()->isPlaying() or m_paused) setCurrentSequence(old_currentSequence);
-   
-    Display::render();
+void MainFrame::evt_fileLoaded(wxCommandEvent& evt)
+{
+    AsyncFileLoader* loader = (AsyncFileLoader*)evt.GetClientData();
     
-    requestForScrollKeyboardEditorNotesIntoView();
- 
-    if (not warnings.empty())
+    // a loader stopped by handleApplicationEnd may still have posted its event
+    if (loader != m_file_loader.raw_ptr) return;
+    
+    loader->join();
+    WaitWindow::hide();
+    
+    int id = -1;
+    const int count = m_sequences.size();
+    for (int n=0; n<count; n++)
     {
-        std::set<wxString>::iterator it;
-        std::ostringstream full;
-
-        full << (const char*)wxString(_("Loading the MIDI file completed successfully, but with the following warnings (the song may not sound as intended) :")).utf8_str();
-
-        for (it=warnings.begin() ; it != warnings.end(); it++)
+        if (m_sequences.get(n) == loader->getTarget()) id = n;
+    }
+    
+    if (id != -1)
+    {
+        if (loader->succeeded())
         {
-            std::cerr << (*it).utf8_str() << std::endl;
-            full << "\n";
-            full << "    " << (*it).utf8_str();
+            onFileLoaded(loader, id);
         }
+        else
+        {
+            if (not loader->isCancelled())
+            {
+                std::cout << "Loading file failed." << std::endl;
+                if (loader->isMidiFile()) wxMessageBox( _("Sorry, loading midi file failed.") );
+                else                      wxMessageBox( _("Sorry, loading .aria file failed.") );
+            }
+            
+            closeSequence(id);
+        }
+    }
+    
+    m_file_loader = NULL;
+    startNextFileLoad();
+}
 
-        setNotificationWarning();
+// ----------------------------------------------------------------------------------------------------------
 
+void MainFrame::onFileLoaded(AsyncFileLoader* loader, const int placeholderId)
+{
+    const wxString filePath = loader->getFilePath();
+    const int shownSequence = m_current_sequence;
+    
+    Sequence* seq = loader->releaseSequence();
+    seq->setSequenceFilename( extractTitle(filePath) );
+    
+    // a recovered file shows as the file it is a copy of, with its changes still to be saved
+    std::map<wxString, AutosaveManager::RecoveryFile>::iterator recovered = m_recovered_files.find(filePath);
+    const bool isRecovered = (recovered != m_recovered_files.end());
+    AutosaveManager::RecoveryFile recoveryFile;
+    if (isRecovered)
+    {
+        seq->setFilepath( recovered->second.m_original_path );
+        seq->setSequenceFilename( recovered->second.m_title );
+        seq->markUnsaved();
+        recoveryFile = recovered->second;
+        m_recovered_files.erase(recovered);
+    }
+    
+    seq->setListeners(this, this, this, this);
+    
+    GraphicalSequence* gs = new GraphicalSequence(seq);
+    
+    // the placeholder is replaced, unless it was edited while the file was loading
+    int id = placeholderId;
+    if (m_sequences[id].getModel()->somethingToUndo())
+    {
+        m_sequences[id].setDeferredFilePath(wxEmptyString);
+        id++;
+    }
+    else
+    {
+        m_sequences.erase(id);
+    }
+    m_sequences.add(gs, id);
+    
+    // the views read their settings from the current sequence
+    setCurrentSequence(id, false /* update */);
+    gs->createViewForTracks(-1 /* all */);
+    gs->applyPendingView();
+    
+    if (isRecovered and m_autosave.raw_ptr != NULL) m_autosave->adoptRecoveryFile(gs, recoveryFile);
+    
+    ASSERT(seq->invariant());
+    
+    updateVerticalScrollbar();
+    
+    // go back to what was shown meanwhile ; if a song is playing, it stays on top
+    if (shownSequence != placeholderId)
+    {
+        setCurrentSequence(shownSequence < id ? shownSequence : shownSequence + (id - placeholderId));
+    }
+    else
+    {
+        setCurrentSequence(id);
+    }
+    
+    Display::render();
+    
+    const std::set<wxString>& warnings = loader->getWarnings();
+    if (loader->isMidiFile())
+    {
+        requestForScrollKeyboardEditorNotesIntoView();
+        
+        if (not warnings.empty())
+        {
+            std::set<wxString>::const_iterator it;
+            std::ostringstream full;
+            
+            full << (const char*)wxString(_("Loading the MIDI file completed successfully, but with the following warnings (the song may not sound as intended) :")).utf8_str();
+            
+            for (it=warnings.begin() ; it != warnings.end(); it++)
+            {
+                std::cerr << (*it).utf8_str() << std::endl;
+                full << "\n";
+                full << "    " << (*it).utf8_str();
+            }
+            
+            setNotificationWarning();
+            
 #if wxCHECK_VERSION(2,9,1)
-        m_notification_link->Hide();
+            m_notification_link->Hide();
 #endif
-
-        m_notification_text->SetLabel(wxString(full.str().c_str(), wxConvUTF8));
-        m_notification_panel->Layout();
-        m_notification_panel->GetSizer()->SetSizeHints(m_notification_panel);
-        m_notification_panel->Show();
-        Layout();
-
+            
+            m_notification_text->SetLabel(wxString(full.str().c_str(), wxConvUTF8));
+            m_notification_panel->Layout();
+            m_notification_panel->GetSizer()->SetSizeHints(m_notification_panel);
+            m_notification_panel->Show();
+            Layout();
+        }
+    }
+    else
+    {
+        std::set<wxString>::const_iterator it;
+        for (it=warnings.begin() ; it != warnings.end(); it++)
+        {
+            wxMessageBox(*it);
+        }
     }
     
-    addRecentFile(filePath);
+    if (not isRecovered) addRecentFile(filePath);
 }
 
 
@@ -2343,6 +2523,19 @@ void MainFrame::evt_showTrackContextualMenu(wxCommandEvent& evt)
 
 // ----------------------------------------------------------------------------------------------------------
 
+void MainFrame::evt_guitarFingeringSolved(wxCommandEvent& evt)
+{
+    GuitarFingering::BackgroundSolver* solver = (GuitarFingering::BackgroundSolver*)evt.GetClientData();
+    
+    // the event of a solver that was replaced by another one meanwhile
+    if (solver != m_fingering_solver.raw_ptr) return;
+    
+    solver->apply();
+    m_fingering_solver = NULL;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 void MainFrame::onMeasureDataChange(int change)
 {
     GraphicalSequence* gseq = getCurrentGraphicalSequence();
@@ -2380,6 +2573,14 @@ bool MainFrame::handleApplicationEnd()
     
     exitApp = true;
     
+    // placeholder tabs are closed below, and what is being loaded is not needed anymore
+    m_load_queue.clearWithoutDeleting();
+    if (m_file_loader.raw_ptr != NULL)
+    {
+        m_file_loader = NULL;
+        WaitWindow::hide();
+    }
+    
     // the quit menu is greyed out in playback mode, but there are other ways to get this code called
     // (like closing the frame)
     if (m_playback_mode)
@@ -2387,7 +2588,8 @@ bool MainFrame::handleApplicationEnd()
         m_main_pane->exitPlayLoop();
     }
 
-    // close all open sequences
+    // close all open sequences ; tabs shown in turn meanwhile are not loaded
+    m_closing_all_sequences = true;
     while (getSequenceAmount() > 0 && exitApp)
     {
         if (not closeSequence())
@@ -2396,6 +2598,19 @@ bool MainFrame::handleApplicationEnd()
             exitApp = false;
         }
     }
+    m_closing_all_sequences = false;
+    
+    if (not exitApp)
+    {
+        GraphicalSequence* current = getCurrentGraphicalSequence();
+        if (current != NULL and current->isDeferred()) requestFileLoad(current);
+    }
+    else
+    {
+        // quitting normally : recovery files are not needed anymore
+        m_autosave = NULL;
+        m_fingering_solver = NULL;
+    }
     
     return exitApp;
 }
@@ -2430,7 +2645,9 @@ void MainFrame::saveOpenedFiles()
     count = getSequenceAmount();
     for (int i=0 ; i<count ; i++)
     {
-        path = getSequence(i)->getFilepath();
+        // tabs not shown in this session still hold their file
+        if (m_sequences[i].isDeferred()) path = m_sequences[i].getDeferredFilePath();
+        else                             path = getSequence(i)->getFilepath();
         
         if (wxFileExists(path))
         {
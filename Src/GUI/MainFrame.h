@@ -30,7 +30,9 @@
 
 
 #include "AriaCore.h"
+#include "Dialogs/WaitWindow.h"
 #include "GUI/GraphicalSequence.h"
+#include "IO/Autosave.h"
 #include "Midi/MeasureData.h"
 #include "Midi/Sequence.h"
 #include "ptr_vector.h"
@@ -124,6 +126,7 @@ public:
 
 namespace AriaMaestosa
 {
+    class AsyncFileLoader;
     class CustomNoteSelectDialog;
     class Sequence;
     class PreferencesDialog;
@@ -134,6 +137,7 @@ namespace AriaMaestosa
     class VolumeSlider;
     class TuningPicker;
     class KeyPicker;
+    namespace GuitarFingering { class BackgroundSolver; }
 
     enum IDs
     {
@@ -179,6 +183,7 @@ namespace AriaMaestosa
         MENU_EDIT_SNAP_TO_GRID,
         MENU_EDIT_SCALE,
         MENU_EDIT_REMOVE_OVERLAPPING,
+        MENU_EDIT_ARRANGE_FINGERING,
         MENU_EDIT_UNDO,
         MENU_EDIT_SCROLL_NOTES_INTO_VIEW,
 
@@ -216,6 +221,8 @@ namespace AriaMaestosa
     DECLARE_LOCAL_EVENT_TYPE(wxEVT_NEW_VERSION_AVAILABLE, -1)
     DECLARE_LOCAL_EVENT_TYPE(wxEVT_ASYNC_ERROR_MESSAGE, -1)
     DECLARE_LOCAL_EVENT_TYPE(wxEVT_SHOW_TRACK_CONTEXTUAL_MENU, -1)
+    DECLARE_LOCAL_EVENT_TYPE(wxEVT_GUITAR_FINGERING_SOLVED, -1)
+    DECLARE_LOCAL_EVENT_TYPE(wxEVT_FILE_LOADED, -1)
 
     const int SHOW_WAIT_WINDOW_EVENT_ID = 100001;
     const int UPDT_WAIT_WINDOW_EVENT_ID = 100002;
@@ -311,7 +318,8 @@ namespace AriaMaestosa
       * @brief manages the main frame of Aria Maestosa
       */
     class MainFrame : public wxFrame, public IPlaybackModeListener, public IActionStackListener,
-        public ISequenceDataListener, public ICurrentSequenceProvider, public IMeasureDataListener
+        public ISequenceDataListener, public ICurrentSequenceProvider, public IMeasureDataListener,
+        public IWaitWindowCancelListener
     {
         WxOwnerPtr<CustomNoteSelectDialog>  m_custom_note_select_dialog;
 
@@ -415,12 +423,50 @@ namespace AriaMaestosa
         void updateCurrentDir(wxString& path);
 
         wxArrayString m_files_to_open;
+        
+        /** files of the last session, opened as tabs that are only loaded once shown */
+        wxArrayString m_session_files;
+        
         bool m_reload_mode;
         
+        /** the file being loaded, if any. Files are loaded one at a time */
+        OwnerPtr<AsyncFileLoader> m_file_loader;
+        
+        /** tabs waiting for their file to be loaded, once m_file_loader is done */
+        ptr_vector<GraphicalSequence, REF> m_load_queue;
+        
+        /** set while quitting, so that tabs shown as the others are closed do not start loading */
+        bool m_closing_all_sequences;
         
+        /** the guitar fingering being solved, if any. Starting another one cancels it */
+        OwnerPtr<GuitarFingering::BackgroundSolver> m_fingering_solver;
+        
+        /** NULL until the frame is shown, and again once quitting normally */
+        OwnerPtr<AutosaveManager> m_autosave;
+        
+        /** recovery files being opened, by path */
+        std::map<wxString, AutosaveManager::RecoveryFile> m_recovered_files;
         
         void loadAriaFile(const wxString& filePath);
         void loadMidiFile(const wxString& filePath);
+        
+        /**
+         * @brief open a tab for a file that is not loaded yet (see GraphicalSequence::isDeferred)
+         * @param loadNow  whether to start loading it, or to wait until it is shown
+         * @return the placeholder tab
+         */
+        GraphicalSequence* addFileTab(const wxString& filePath, const bool loadNow);
+        
+        /** @brief load the file of a placeholder tab, once the files requested before it are loaded */
+        void requestFileLoad(GraphicalSequence* placeholder);
+        
+        void startNextFileLoad();
+        
+        /** @brief forget about loading the file of a placeholder tab, e.g. because the tab is closed */
+        void cancelFileLoad(GraphicalSequence* placeholder);
+        
+        /** @brief show what was loaded, once a placeholder tab is loaded */
+        void onFileLoaded(AsyncFileLoader* loader, const int id);
         bool handleApplicationEnd();
         void saveWindowPos();
         void saveRecentFileList();
@@ -441,7 +487,10 @@ namespace AriaMaestosa
         bool changingValues; // set this to true when modifying the controls in the top bar, this allows to ignore all events thrown by their modification.
 
         MainFrame();
-        void init(const wxArrayString& filesToOpen, bool fileInCommandLine);
+        /**
+          * @param sessionFiles  files that were open in the last session ; they are only loaded once shown
+          */
+        void init(const wxArrayString& filesToOpen, const wxArrayString& sessionFiles, bool fileInCommandLine);
         void initMenuBar();
         void initToolbar();
         ~MainFrame();
@@ -519,6 +568,7 @@ namespace AriaMaestosa
         void menuEvent_preferences(wxCommandEvent& evt);
         void menuEvent_followPlayback(wxCommandEvent& evt);
         void menuEvent_removeOverlapping(wxCommandEvent& evt);
+        void menuEvent_arrangeFingering(wxCommandEvent& evt);
         void menuEvent_scrollNotesIntoView(wxCommandEvent& evt);
         void menuEvent_playAlways(wxCommandEvent& evt);
         void menuEvent_playOnChange(wxCommandEvent& evt);
@@ -646,6 +696,8 @@ namespace AriaMaestosa
         void evt_newVersionAvailable(wxCommandEvent& evt);
         void evt_asyncErrMessage(wxCommandEvent& evt);
         void evt_showTrackContextualMenu(wxCommandEvent& evt);
+        void evt_guitarFingeringSolved(wxCommandEvent& evt);
+        void evt_fileLoaded(wxCommandEvent& evt);
 
         void addIconItem(wxMenu* menu, int menuID, const wxString& label, const wxString& stockIconId);
 
@@ -664,6 +716,9 @@ namespace AriaMaestosa
         /** @brief Implement callback from IMeasureDataListener */
         virtual void onMeasureDataChange(int change);
         
+        /** @brief Implement callback from IWaitWindowCancelListener */
+        virtual void onWaitWindowCancel();
+        
         void onMouseClicked();
 
         DECLARE_EVENT_TABLE();
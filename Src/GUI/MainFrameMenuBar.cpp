@@ -40,6 +40,7 @@
 #include "IO/AriaFileWriter.h"
 #include "IO/MidiFileReader.h"
 #include "main.h"
+#include "Midi/GuitarFingering.h"
 #include "Midi/MeasureData.h"
 #include "Midi/Sequence.h"
 #include "Midi/Players/PlatformMidiManager.h"
@@ -191,6 +192,9 @@ void MainFrame::initMenuBar()
     //I18N: menu item in the "edit" menu
     m_edit_menu -> QUICK_ADD_MENU ( MENU_EDIT_REMOVE_OVERLAPPING, _("Remove O&verlapping Notes"),
                                     MainFrame::menuEvent_removeOverlapping );
+    //I18N: menu item in the "edit" menu
+    m_edit_menu -> QUICK_ADD_MENU ( MENU_EDIT_ARRANGE_FINGERING, _("Arrange Guitar &Fingering"),
+                                    MainFrame::menuEvent_arrangeFingering );
 
 
     m_edit_menu->AppendSeparator();
@@ -670,6 +674,7 @@ bool MainFrame::doSave()
     else
     {
         saveAriaFile(getCurrentGraphicalSequence(), getCurrentSequence()->getFilepath());
+        if (m_autosave.raw_ptr != NULL) m_autosave->onSequenceSaved(getCurrentGraphicalSequence());
         return true;
     }
     
@@ -715,6 +720,7 @@ bool MainFrame::doSaveAs()
 
         getCurrentSequence()->setFilepath( givenPath );
         saveAriaFile(getCurrentGraphicalSequence(), getCurrentSequence()->getFilepath());
+        if (m_autosave.raw_ptr != NULL) m_autosave->onSequenceSaved(getCurrentGraphicalSequence());
 
         // change song name
         getCurrentSequence()->setSequenceFilename( extractTitle(getCurrentSequence()->getFilepath()) );
@@ -962,6 +968,16 @@ void MainFrame::menuEvent_removeOverlapping(wxCommandEvent& evt)
     getCurrentSequence()->getCurrentTrack()->action( new Action::RemoveOverlapping() );
 }
 
+// -----------------------------------------------------------------------------------------------------------
+
+void MainFrame::menuEvent_arrangeFingering(wxCommandEvent& evt)
+{
+    // the selected notes if there are any, otherwise the whole track
+    Track* track = getCurrentSequence()->getCurrentTrack();
+    m_fingering_solver = new GuitarFingering::BackgroundSolver(track, track->getFirstSelectedNote() != -1);
+    if (not m_fingering_solver->start()) m_fingering_solver = NULL;
+}
+
 
 void MainFrame::menuEvent_scrollNotesIntoView(wxCommandEvent& evt)
 {
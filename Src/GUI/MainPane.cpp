@@ -165,6 +165,9 @@ MainPane::MainPane(wxWindow* parent, int* args) :
     m_is_mouse_down       = false;
     m_mouse_hovering_tabs = false;
     m_click_area          = CLICK_NONE;
+    m_render_pending      = false;
+    m_view_only_render    = false;
+    m_view_only_changes   = false;
 
     m_mouse_x_initial.setValue(0, MIDI);
     m_mouse_y_initial = 0;
@@ -240,8 +243,8 @@ void MainPane::resized(wxSizeEvent& evt)
 
 void MainPane::paintEvent(wxPaintEvent& evt)
 {
-    #ifdef RENDERER_OPENGL
-    wxPaintDC mydc(this); // OpenGL handles double-buffering on its own
+    #if defined(RENDERER_OPENGL) || defined(RENDERER_SOFTWARE)
+    wxPaintDC mydc(this); // OpenGL and the software renderer handle double-buffering on their own
     #else
     wxAutoBufferedPaintDC mydc(this);
     #endif
@@ -256,6 +259,9 @@ void MainPane::paintEvent(wxPaintEvent& evt)
     if (do_render()) endFrame();
     else { printf("***** do_render returned false!!\n"); }
     Display::renderDC = NULL;
+    
+    m_render_pending   = false;
+    m_view_only_render = false;
 }
 
 // -----------------------------------------------------------------------------------------------------------
@@ -271,6 +277,11 @@ void MainPane::renderNow()
     if (do_render()) endFrame();
     Display::renderDC = NULL;
      */
+    
+    // repaints coalesce, so the frame can only reuse track layers if all of them were view-only
+    m_view_only_render = (m_render_pending ? m_view_only_render : true) and m_view_only_changes;
+    m_render_pending   = true;
+    
     Refresh();
 }
         
@@ -542,6 +553,10 @@ bool MainPane::do_render()
     m_mouse_x_initial.setSequence(gseq);
     m_mouse_x_current.setSequence(gseq);
     
+    // repaints that were not asked with renderNow (e.g. when the window is exposed) or that may follow any
+    // change must render tracks again
+    if (not (m_render_pending and m_view_only_render)) gseq->invalidateTrackLayers();
+    
     gseq->renderTracks(m_current_tick,
                        m_mouse_x_current,
                        m_mouse_y_current,
@@ -634,7 +649,7 @@ bool MainPane::do_render()
         else                    AriaRender::color(0.4, 0.4, 0.4);
         
         int additionalShift = 0;
-        if (getMainFrame()->getGraphicalSequence(n)->getModel()->somethingToUndo())
+        if (getMainFrame()->getGraphicalSequence(n)->getModel()->hasUnsavedChanges())
         {
             m_star.bind();
             additionalShift = m_star.getWidth() + 5;
@@ -1173,6 +1188,9 @@ void MainPane::mouseMoved(wxMouseEvent& event)
             GraphicalSequence* gseq = mf->getCurrentGraphicalSequence();
             Sequence* seq = mf->getCurrentSequence();
             
+            // hovering only changes how the track under the mouse looks, which is never drawn from its layer
+            m_view_only_changes = true;
+            
             for (int n=0; n<seq->getTrackAmount(); n++)
             {
                 Track* track = seq->getTrack(n);
@@ -1189,6 +1207,8 @@ void MainPane::mouseMoved(wxMouseEvent& event)
                 }
             }
             
+            m_view_only_changes = false;
+            
             const int measureBarHeight = gseq->getMeasureBar()->getMeasureBarHeight();
 
             if (event.GetY() > MEASURE_BAR_Y and event.GetY() < MEASURE_BAR_Y + measureBarHeight and
@@ -1611,7 +1631,12 @@ void MainPane::playbackRenderLoop()
         setCurrentTick( startTick + currentTick );
         
         RelativeXCoord tick(m_current_tick, MIDI, gseq);
+        
+        // only the playback line moved (scrolling is part of the track layers' key)
+        m_view_only_changes = true;
         Display::render();
+        m_view_only_changes = false;
+        
         m_last_tick = startTick + currentTick;
     }
 
@@ -1641,7 +1666,7 @@ void MainPane::setCurrentTick(int currentTick)
 #pragma mark Serialization
 #endif
 
-void MainPane::saveToFile(wxFileOutputStream& fileout)
+void MainPane::saveToFile(wxOutputStream& fileout)
 {
     getMainFrame()->getCurrentGraphicalSequence()->saveToFile(fileout);
 }
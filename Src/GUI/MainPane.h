@@ -110,6 +110,18 @@ namespace AriaMaestosa
         /** is frame shown */
         bool m_is_visible;
         
+        /** Whether a repaint was asked with renderNow since the last frame */
+        bool m_render_pending;
+        
+        /**
+          * Whether the repaints asked since the last frame only follow playback or the mouse hovering, in
+          * which case tracks can draw their cached layers
+          */
+        bool m_view_only_render;
+        
+        /** Set while handling an event that can't change how tracks look (see m_view_only_render) */
+        bool m_view_only_changes;
+        
         bool m_left_arrow;
         bool m_right_arrow;
         
@@ -225,7 +237,7 @@ namespace AriaMaestosa
         void paintEvent(wxPaintEvent& evt);
 
         // ---- serialization
-        void saveToFile(wxFileOutputStream& fileout);
+        void saveToFile(wxOutputStream& fileout);
 
         void handleTooltipOnTabs(wxMouseEvent& event);
 
@@ -0,0 +1,278 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "GUI/RenderBenchmark.h"
+
+#include "AriaCore.h"
+#include "Headless.h"
+#include "GUI/GraphicalSequence.h"
+#include "GUI/GraphicalTrack.h"
+#include "GUI/ImageProvider.h"
+#include "GUI/MeasureBar.h"
+#include "Midi/Players/CaptureDevice.h"
+#include "Midi/Players/PlaybackBenchmark.h"
+#include "Midi/Sequence.h"
+#include "Midi/Track.h"
+#include "Renderers/RenderAPI.h"
+
+#ifdef RENDERER_SOFTWARE
+#include "Renderers/SoftwareRasterizer.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <wx/dcmemory.h>
+#include <wx/image.h>
+
+using namespace AriaMaestosa;
+
+#ifndef RENDERER_OPENGL
+
+namespace AriaMaestosa
+{
+    namespace RenderBenchmark
+    {
+        /** Size of the offscreen display */
+        const int FRAME_WIDTH  = 1024;
+        const int FRAME_HEIGHT = 768;
+
+        /** Zoom levels, in percent, at which the song is scrolled through */
+        const int ZOOM_LEVELS[]    = { 25, 100, 400 };
+        const int ZOOM_LEVEL_COUNT = sizeof(ZOOM_LEVELS) / sizeof(ZOOM_LEVELS[0]);
+
+        /** Maximum number of frames rendered for each editor at each zoom level */
+        const int MAX_FRAMES_PER_ZOOM = 40;
+
+        struct EditorInfo
+        {
+            NotationType m_type;
+            const char*  m_name;
+        };
+
+        const EditorInfo EDITORS[] =
+        {
+            { KEYBOARD,   "keyboard"   },
+            { SCORE,      "score"      },
+            { GUITAR,     "guitar"     },
+            { DRUM,       "drum"       },
+            { CONTROLLER, "controller" }
+        };
+        const int EDITOR_COUNT = sizeof(EDITORS) / sizeof(EDITORS[0]);
+
+        /** Where frames are rendered */
+        class OffscreenDisplay
+        {
+            wxBitmap   m_bitmap;
+            wxMemoryDC m_dc;
+#ifdef RENDERER_SOFTWARE
+            SoftwareRasterizer m_rasterizer;
+#endif
+
+        public:
+
+            OffscreenDisplay() : m_bitmap(FRAME_WIDTH, FRAME_HEIGHT)
+            {
+                m_dc.SelectObject(m_bitmap);
+            }
+
+            ~OffscreenDisplay()
+            {
+                m_dc.SelectObject(wxNullBitmap);
+            }
+
+            /**
+              * @brief render the tracks of the sequence, the way MainPane does
+              * @param useLayers  if false, tracks are drawn again instead of reusing their cached layer
+              * @return the time the frame took, in nanoseconds
+              */
+            long long renderFrame(GraphicalSequence* gseq, const bool useLayers)
+            {
+                Sequence* seq = gseq->getModel();
+                if (not useLayers) gseq->invalidateTrackLayers();
+
+                const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+                Display::renderDC = &m_dc;
+#ifdef RENDERER_SOFTWARE
+                m_rasterizer.beginFrame(FRAME_WIDTH, FRAME_HEIGHT);
+#else
+                m_dc.SetBackground(*wxBLACK_BRUSH);
+                m_dc.Clear();
+#endif
+                AriaRender::images();
+
+                int y = 25 + gseq->getMeasureBar()->getMeasureBarHeight() - gseq->getYScroll();
+                const int trackAmount  = seq->getTrackAmount();
+                const int currentTrack = seq->getCurrentTrackID();
+                for (int n=0; n<trackAmount; n++)
+                {
+                    Track* track = seq->getTrack(n);
+                    track->setId(n);
+                    y = gseq->getGraphicsFor(track)->render(y, -1, (n == currentTrack));
+                }
+
+#ifdef RENDERER_SOFTWARE
+                m_rasterizer.endFrame(&m_dc);
+#endif
+                Display::renderDC = NULL;
+
+                const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            }
+        };
+
+        // ----------------------------------------------------------------------------------------------------------
+
+        static double percentile(const std::vector<long long>& sorted, const double p)
+        {
+            if (sorted.empty()) return 0.0;
+            const int index = (int)(p * (sorted.size() - 1) + 0.5);
+            return sorted[index] / 1000000.0;
+        }
+
+        // ----------------------------------------------------------------------------------------------------------
+
+        /** @brief make the given editor the only one shown by each track */
+        static void showOnly(GraphicalSequence* gseq, const NotationType type)
+        {
+            Sequence* seq = gseq->getModel();
+            const int trackAmount = seq->getTrackAmount();
+            for (int n=0; n<trackAmount; n++)
+            {
+                Track* track = seq->getTrack(n);
+                for (int t=0; t<NOTATION_TYPE_COUNT; t++)
+                {
+                    const bool enabled = (t == type);
+                    if (track->isNotationTypeEnabled((NotationType)t) != enabled)
+                    {
+                        track->setNotationType((NotationType)t, enabled);
+                    }
+                }
+                gseq->getGraphicsFor(track)->evenlyDistributeSpace();
+            }
+        }
+
+        // ----------------------------------------------------------------------------------------------------------
+
+        static bool benchmarkSong(const char* name, GraphicalSequence* gseq, OffscreenDisplay& display)
+        {
+            if (gseq->getModel()->getTrackAmount() == 0)
+            {
+                fprintf(stderr, "[benchmark] %s : no tracks to render\n", name);
+                return false;
+            }
+
+            printf("[benchmark] %s\n", name);
+
+            for (int e=0; e<EDITOR_COUNT; e++)
+            {
+                showOnly(gseq, EDITORS[e].m_type);
+
+                std::vector<long long> frameTimes;
+                std::vector<long long> layerTimes;
+                long long primitives = 0;
+
+                for (int z=0; z<ZOOM_LEVEL_COUNT; z++)
+                {
+                    gseq->setZoom(ZOOM_LEVELS[z]);
+
+                    const int totalPixels = gseq->getMeasureBar()->getTotalPixelAmount();
+                    const int step = std::max(FRAME_WIDTH / 2, totalPixels / MAX_FRAMES_PER_ZOOM);
+
+                    for (int x=0; x<std::max(totalPixels - FRAME_WIDTH, 1); x+=step)
+                    {
+                        gseq->setXScrollInPixels(x);
+
+                        AriaRender::resetPrimitiveCount();
+                        frameTimes.push_back( display.renderFrame(gseq, false) );
+                        primitives += AriaRender::getPrimitiveCount();
+
+                        // the same frame again, as drawn when only the playback cursor moved
+                        layerTimes.push_back( display.renderFrame(gseq, true) );
+                    }
+                }
+
+                std::sort(frameTimes.begin(), frameTimes.end());
+                std::sort(layerTimes.begin(), layerTimes.end());
+
+                const int count = frameTimes.size();
+                printf("    %-10s : %3i frames, ms p50 %.3f  p90 %.3f  p99 %.3f  max %.3f, %lli primitives per frame\n",
+                       EDITORS[e].m_name, count, percentile(frameTimes, 0.5), percentile(frameTimes, 0.9),
+                       percentile(frameTimes, 0.99), frameTimes[count - 1] / 1000000.0, primitives / count);
+                printf("    %-10s   from track layers, ms p50 %.3f  p90 %.3f  max %.3f\n",
+                       "", percentile(layerTimes, 0.5), percentile(layerTimes, 0.9),
+                       layerTimes[count - 1] / 1000000.0);
+            }
+
+            return true;
+        }
+    }
+}
+
+#endif
+
+// ----------------------------------------------------------------------------------------------------------
+
+int RenderBenchmark::run(const wxArrayString& files)
+{
+#ifdef RENDERER_OPENGL
+    fprintf(stderr, "[benchmark] rendering offscreen needs the wxWidgets or software renderer\n");
+    return 1;
+#else
+    // nothing is played, but editors ask the MIDI manager whether playback is ongoing
+    PlatformMidiManager::installManager(new CaptureMidiManager(0));
+
+    wxInitAllImageHandlers();
+    ImageProvider::loadImages();
+    Display::setOffscreenSize(FRAME_WIDTH, FRAME_HEIGHT);
+
+    bool success = true;
+
+    {
+        OffscreenDisplay display;
+
+        {
+            GraphicalSequence gseq( new Sequence(NULL, NULL, NULL, NULL, false) );
+            HeadlessSequenceProvider provider(&gseq);
+
+            PlaybackBenchmark::makeSyntheticSong(gseq.getModel());
+            success = benchmarkSong("synthetic", &gseq, display) and success;
+        }
+
+        for (unsigned int n=0; n<files.GetCount(); n++)
+        {
+            GraphicalSequence gseq( new Sequence(NULL, NULL, NULL, NULL, false) );
+            HeadlessSequenceProvider provider(&gseq);
+
+            if (Headless::loadFile(&gseq, files[n]))
+            {
+                success = benchmarkSong(files[n].utf8_str(), &gseq, display) and success;
+            }
+            else
+            {
+                fprintf(stderr, "[benchmark] failed to load %s\n", (const char*)files[n].utf8_str());
+                success = false;
+            }
+        }
+    }
+
+    ImageProvider::unloadImages();
+    return (success ? 0 : 1);
+#endif
+}
@@ -0,0 +1,44 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __RENDER_BENCHMARK_H__
+#define __RENDER_BENCHMARK_H__
+
+#include <wx/arrstr.h>
+
+namespace AriaMaestosa
+{
+
+    /**
+      * @brief Headless measurement of editor rendering (run with 'Aria --benchmark-render [files]')
+      *
+      * Tracks are rendered into an offscreen bitmap, without any window. Each editor in turn is made the
+      * only editor of every track, and the song is scrolled through at a few zoom levels; the time taken
+      * by each frame and the number of primitives drawn are reported per editor.
+      * @note  only the wxWidgets and software renderers can render offscreen
+      */
+    namespace RenderBenchmark
+    {
+        /**
+          * @brief renders a synthetic song, then each of the given .aria or .mid files, and prints a report
+          * @return process exit code
+          */
+        int run(const wxArrayString& files);
+    }
+
+}
+
+#endif
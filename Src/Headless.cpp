@@ -0,0 +1,62 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Headless.h"
+
+#include "GUI/GraphicalSequence.h"
+#include "IO/AriaFileWriter.h"
+#include "IO/MidiFileReader.h"
+
+#include <set>
+
+using namespace AriaMaestosa;
+
+// ----------------------------------------------------------------------------------------------------------
+
+HeadlessSequenceProvider::HeadlessSequenceProvider(GraphicalSequence* gseq)
+{
+    m_gseq = gseq;
+    setCurrentSequenceProvider(this);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+HeadlessSequenceProvider::~HeadlessSequenceProvider()
+{
+    setCurrentSequenceProvider(NULL);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+Sequence* HeadlessSequenceProvider::getCurrentSequence()
+{
+    return m_gseq->getModel();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool Headless::loadFile(GraphicalSequence* gseq, const wxString& path)
+{
+    if (path.EndsWith(wxT(".aria")))
+    {
+        return loadAriaFile(gseq, path);
+    }
+    else
+    {
+        std::set<wxString> warnings;
+        return loadMidiFile(gseq, path, warnings);
+    }
+}
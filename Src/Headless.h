@@ -0,0 +1,58 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HEADLESS_H__
+#define __HEADLESS_H__
+
+#include "AriaCore.h"
+
+#include <wx/string.h>
+
+namespace AriaMaestosa
+{
+    class GraphicalSequence;
+    
+    /**
+      * @brief The current sequence of the modes that run without the main frame (benchmarks, notation
+      *        export, batch conversion)
+      *
+      * It is installed with setCurrentSequenceProvider for as long as it exists.
+      */
+    class HeadlessSequenceProvider : public ICurrentSequenceProvider
+    {
+        GraphicalSequence* m_gseq;
+        
+    public:
+        
+        HeadlessSequenceProvider(GraphicalSequence* gseq);
+        virtual ~HeadlessSequenceProvider();
+        
+        virtual Sequence*          getCurrentSequence();
+        virtual GraphicalSequence* getCurrentGraphicalSequence() { return m_gseq; }
+    };
+    
+    namespace Headless
+    {
+        /**
+          * @brief load a .aria or MIDI file into an empty sequence ; warnings of the MIDI reader are dropped
+          * @return whether the file could be loaded
+          */
+        bool loadFile(GraphicalSequence* gseq, const wxString& path);
+    }
+    
+}
+
+#endif
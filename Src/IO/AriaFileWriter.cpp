@@ -17,6 +17,7 @@
 #include "AriaFileWriter.h"
 
 #include "GUI/GraphicalSequence.h"
+#include "IO/IOUtils.h"
 #include "Midi/Sequence.h"
 
 #include <wx/string.h>
@@ -37,6 +38,7 @@ namespace AriaMaestosa
         
         wxFileOutputStream file( filepath );
         sequence->saveToFile(file);
+        sequence->getModel()->clearUndoStack();
         
         if (overriding_file) wxRemoveFile( temp_name );
     }
@@ -71,4 +73,50 @@ namespace AriaMaestosa
         return true;
     }
     
+    bool loadAriaFile(Sequence* sequence, wxString filepath, ILoadMonitor* monitor)
+    {
+        wxFFile file(filepath);
+        if (not file.IsOpened())
+        {
+            std::cerr << "Could not open file '" << (const char*)filepath.utf8_str() << "' for reading" << std::endl;
+            return false;
+        }
+        
+        irr::io::IrrXMLReader* xml = irr::io::createIrrXMLReader(file.fp());
+        if (xml == NULL)
+        {
+            std::cerr << "Could not open file '" << (const char*)filepath.utf8_str() << "' for reading" << std::endl;
+            return false;
+        }
+        
+        bool foundSequenceNode = false;
+        while (xml->read() and not monitor->isCancelled())
+        {
+            if (xml->getNodeType() != irr::io::EXN_ELEMENT) continue;
+            
+            if (strcmp("sequence", xml->getNodeName()) == 0)
+            {
+                foundSequenceNode = true;
+                
+                // like GraphicalSequence::readFromFile, keep what could be read of a damaged file
+                sequence->readFromFile(xml, NULL, monitor);
+            }
+            else if (strcmp("seqview", xml->getNodeName()) == 0)
+            {
+                sequence->recordPendingView(xml);
+            }
+        }
+        
+        delete xml;
+        
+        if (monitor->isCancelled()) return false;
+        
+        if (not foundSequenceNode)
+        {
+            std::cerr << "ERROR: File contains no sequence node\n";
+            return false;
+        }
+        return true;
+    }
+    
 }
@@ -24,10 +24,20 @@ namespace AriaMaestosa
 {
     
     class GraphicalSequence; // forward
+    class ILoadMonitor;
+    class Sequence;
     
     /** @ingroup io */
     bool loadAriaFile(GraphicalSequence* sequence, wxString filepath);
     
+    /**
+      * @ingroup io
+      * @brief read the model only, without touching the GUI, so that it may be called from a worker thread.
+      *        View settings are kept in the sequence until GraphicalSequence::applyPendingView is called.
+      * @param monitor  receives warnings; may ask to give up between tracks (then false is returned)
+      */
+    bool loadAriaFile(Sequence* sequence, wxString filepath, ILoadMonitor* monitor);
+    
     /** @ingroup io */
     void saveAriaFile(GraphicalSequence* sequence, wxString filepath);
     
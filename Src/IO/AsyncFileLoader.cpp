@@ -0,0 +1,111 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "IO/AsyncFileLoader.h"
+
+#include "AriaCore.h"
+#include "GUI/MainFrame.h"
+#include "IO/AriaFileWriter.h"
+#include "IO/MidiFileReader.h"
+#include "Midi/Sequence.h"
+
+#include <iostream>
+
+using namespace AriaMaestosa;
+
+// ----------------------------------------------------------------------------------------------------------
+
+AsyncFileLoader::AsyncFileLoader(const wxString& filePath, GraphicalSequence* target)
+{
+    m_file_path     = filePath;
+    m_target        = target;
+    m_success       = false;
+    m_last_progress = -1;
+    m_cancelled     = false;
+    
+    // the view is created once loading is over ; until then, nothing listens to this sequence
+    m_sequence = new Sequence(NULL, NULL, NULL, NULL, false);
+    m_sequence->setFilepath(filePath);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+AsyncFileLoader::~AsyncFileLoader()
+{
+    cancel();
+    join();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AsyncFileLoader::start()
+{
+    ASSERT(not m_thread.joinable());
+    m_thread = std::thread(&AsyncFileLoader::run, this);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AsyncFileLoader::join()
+{
+    if (m_thread.joinable()) m_thread.join();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AsyncFileLoader::run()
+{
+    if (isMidiFile())
+    {
+        m_success = AriaMaestosa::loadMidiFile(m_sequence, m_file_path, m_warnings, this);
+    }
+    else
+    {
+        m_success = AriaMaestosa::loadAriaFile(m_sequence, m_file_path, this);
+    }
+    
+    if (not m_success and not m_cancelled)
+    {
+        std::cerr << "[AsyncFileLoader] loading " << (const char*)m_file_path.utf8_str() << " failed" << std::endl;
+    }
+    
+    wxCommandEvent evt(wxEVT_FILE_LOADED, wxID_ANY);
+    evt.SetClientData(this);
+    getMainFrame()->GetEventHandler()->AddPendingEvent(evt);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AsyncFileLoader::setProgress(int percent)
+{
+    // avoid flooding the event queue with identical updates
+    if (percent == m_last_progress) return;
+    m_last_progress = percent;
+    
+    MAKE_UPDATE_PROGRESSBAR_EVENT(evt, percent);
+    getMainFrame()->GetEventHandler()->AddPendingEvent(evt);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+Sequence* AsyncFileLoader::releaseSequence()
+{
+    ASSERT(not m_thread.joinable());
+    
+    Sequence* out = m_sequence.raw_ptr;
+    m_sequence.raw_ptr = NULL;
+    return out;
+}
@@ -0,0 +1,112 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __ASYNC_FILE_LOADER_H__
+#define __ASYNC_FILE_LOADER_H__
+
+#include "IO/IOUtils.h"
+#include "Utils.h"
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include <wx/string.h>
+
+namespace AriaMaestosa
+{
+    class GraphicalSequence;
+    class Sequence;
+    
+    /**
+      * @brief Reads a .aria or MIDI file into a new Sequence on a worker thread
+      *
+      * The sequence is built without listeners and without any view (see
+      * loadAriaFile(Sequence*, wxString, ILoadMonitor*)) so that the GUI keeps running meanwhile.
+      * Progress is posted to the main frame as wxEVT_UPDATE_WAIT_WINDOW events, and a wxEVT_FILE_LOADED
+      * event (whose client data is this loader) is posted when done, be it successfully or not.
+      * The main frame then attaches the sequence to a GraphicalSequence.
+      *
+      * @ingroup io
+      */
+    class AsyncFileLoader : public ILoadMonitor
+    {
+        wxString m_file_path;
+        
+        /** the tab that will show the file, or NULL if it was closed meanwhile. Never used by the worker */
+        GraphicalSequence* m_target;
+        
+        OwnerPtr<Sequence> m_sequence;
+        
+        // only accessed by the worker until it is joined
+        std::set<wxString> m_warnings;
+        bool m_success;
+        int  m_last_progress;
+        
+        std::atomic<bool> m_cancelled;
+        std::thread m_thread;
+        
+        void run();
+        
+    public:
+        LEAK_CHECK();
+        
+        /**
+          * @param target  the tab the file is loaded for ; only kept to be returned by getTarget
+          * @note  to be created on the main thread, since creating a Sequence reads the preferences ; the
+          *        worker then never reads them (tracks take their editor from the sequence, see
+          *        Sequence::getDefaultNotationType)
+          */
+        AsyncFileLoader(const wxString& filePath, GraphicalSequence* target);
+        
+        /** @brief cancels loading if it is still going on, and waits for the worker to stop */
+        ~AsyncFileLoader();
+        
+        void start();
+        
+        /** @brief ask the worker to stop ; it will still post wxEVT_FILE_LOADED */
+        void cancel() { m_cancelled = true; }
+        
+        /** @brief wait for the worker to be done, after wxEVT_FILE_LOADED was received */
+        void join();
+        
+        const wxString& getFilePath() const { return m_file_path; }
+        bool isMidiFile() const { return not m_file_path.EndsWith(wxT("aria")); }
+        
+        GraphicalSequence* getTarget() const         { return m_target;   }
+        void setTarget(GraphicalSequence* target)    { m_target = target; }
+        
+        /** @pre join was called */
+        bool succeeded() const { return m_success and not m_cancelled; }
+        
+        /** @pre join was called */
+        const std::set<wxString>& getWarnings() const { return m_warnings; }
+        
+        /**
+          * @brief the loaded sequence, whose ownership is given to the caller
+          * @pre   join was called and succeeded() returns true
+          */
+        Sequence* releaseSequence();
+        
+        // ILoadMonitor
+        virtual void setProgress(int percent);
+        virtual void addWarning(const wxString& message) { m_warnings.insert(message); }
+        virtual bool isCancelled() const { return m_cancelled; }
+    };
+    
+}
+
+#endif
@@ -0,0 +1,419 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "IO/Autosave.h"
+
+#include "AriaCore.h"
+#include "GUI/GraphicalSequence.h"
+#include "GUI/MainFrame.h"
+#include "IO/SequenceSnapshot.h"
+#include "Midi/Sequence.h"
+#include "Midi/Track.h"
+
+#include <iostream>
+#include <set>
+
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/process.h>
+#include <wx/utils.h>
+
+using namespace AriaMaestosa;
+
+namespace AriaMaestosa
+{
+    static const wxChar* const AUTOSAVE_PREFIX = wxT("autosave-");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+AutosaveManager::AutosaveManager()
+{
+    m_directory = getDirectory();
+    if (not wxDirExists(m_directory) and not wxMkdir(m_directory))
+    {
+        std::cerr << "[Autosave] cannot create " << (const char*)m_directory.utf8_str() << std::endl;
+    }
+    
+    m_pid = wxGetProcessId();
+    
+    // files named after this process are left over by an earlier one, and may still be adopted
+    std::vector<RecoveryFile> existing;
+    listRecoveryFiles(m_directory, existing);
+    
+    m_next_id = 1;
+    const int count = existing.size();
+    for (int n=0; n<count; n++)
+    {
+        if (existing[n].m_pid == m_pid and existing[n].m_id >= m_next_id) m_next_id = existing[n].m_id + 1;
+    }
+    
+    m_stopping = false;
+    m_writer = std::thread(&AutosaveManager::writerLoop, this);
+    
+    PreferencesData::getInstance()->addListener(this);
+    updateInterval();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+AutosaveManager::~AutosaveManager()
+{
+    Stop();
+    PreferencesData::getInstance()->removeListener(this);
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_jobs.clear();
+    }
+    m_condition.notify_all();
+    m_writer.join();
+    
+    for (std::set<int>::iterator it = m_own_ids.begin(); it != m_own_ids.end(); it++)
+    {
+        const wxString ariaPath = getFilePath(m_directory, m_pid, *it, wxT("aria"));
+        const wxString infoPath = getFilePath(m_directory, m_pid, *it, wxT("txt"));
+        if (wxFileExists(ariaPath)) wxRemoveFile(ariaPath);
+        if (wxFileExists(infoPath)) wxRemoveFile(infoPath);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+wxString AutosaveManager::getDirectory()
+{
+    return PreferencesData::getInstance()->getDirectory() + wxT("autosave") + wxFileName::GetPathSeparator();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+wxString AutosaveManager::getFilePath(const wxString& directory, const unsigned long pid, const int id,
+                                      const wxString& extension)
+{
+    return directory + AUTOSAVE_PREFIX + wxString::Format(wxT("%lu-%i."), pid, id) + extension;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::updateInterval()
+{
+    const long minutes = PreferencesData::getInstance()->getInt(SETTING_KEY_AUTOSAVE_INTERVAL);
+    if (minutes > 0) Start(minutes*60*1000);
+    else             Stop();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::onSettingChanged(const Setting& setting)
+{
+    if (setting.m_key == SETTING_KEY_AUTOSAVE_INTERVAL) updateInterval();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::getRevisions(GraphicalSequence* gseq, long* sequenceRevision, long* tracksRevision)
+{
+    // revisions only ever grow ; a track removed from the sum is an action, seen in the sequence revision
+    Sequence* seq = gseq->getModel();
+    *sequenceRevision = seq->getRevision();
+    *tracksRevision = 0;
+    
+    const int trackAmount = seq->getTrackAmount();
+    for (int n=0; n<trackAmount; n++)
+    {
+        *tracksRevision += seq->getTrack(n)->getRevision();
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+AutosaveManager::Entry& AutosaveManager::getEntry(GraphicalSequence* gseq)
+{
+    std::map<const GraphicalSequence*, Entry>::iterator it = m_entries.find(gseq);
+    if (it != m_entries.end()) return it->second;
+    
+    Entry& entry = m_entries[gseq];
+    entry.m_id       = m_next_id++;
+    entry.m_has_file = false;
+    
+    if (gseq->getModel()->hasUnsavedChanges())
+    {
+        // modified before it was first seen
+        entry.m_sequence_revision = -1;
+        entry.m_tracks_revision   = -1;
+    }
+    else
+    {
+        getRevisions(gseq, &entry.m_sequence_revision, &entry.m_tracks_revision);
+    }
+    return entry;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::Notify()
+{
+    MainFrame* frame = getMainFrame();
+    std::set<const GraphicalSequence*> open;
+    
+    const int count = frame->getSequenceAmount();
+    for (int n=0; n<count; n++)
+    {
+        GraphicalSequence* gseq = frame->getGraphicalSequence(n);
+        open.insert(gseq);
+        
+        // the file of a tab that is not loaded yet is still intact
+        if (gseq->isDeferred()) continue;
+        
+        Entry& entry = getEntry(gseq);
+        
+        long sequenceRevision, tracksRevision;
+        getRevisions(gseq, &sequenceRevision, &tracksRevision);
+        if (sequenceRevision == entry.m_sequence_revision and tracksRevision == entry.m_tracks_revision) continue;
+        
+        entry.m_sequence_revision = sequenceRevision;
+        entry.m_tracks_revision   = tracksRevision;
+        entry.m_has_file          = true;
+        m_own_ids.insert(entry.m_id);
+        
+        Sequence* seq = gseq->getModel();
+        const wxString info = seq->getFilepath() + wxT("\n") + seq->getSequenceFilename() + wxT("\n");
+        
+        Job job;
+        job.m_id = entry.m_id;
+        job.m_snapshot.reset( new SequenceSnapshot(gseq) );
+        job.m_info = (const char*)info.utf8_str();
+        queue(job);
+    }
+    
+    // forget sequences that were closed without telling
+    std::map<const GraphicalSequence*, Entry>::iterator it = m_entries.begin();
+    while (it != m_entries.end())
+    {
+        if (open.find(it->first) != open.end())
+        {
+            it++;
+            continue;
+        }
+        
+        if (it->second.m_has_file)
+        {
+            Job job;
+            job.m_id = it->second.m_id;
+            queue(job);
+        }
+        m_entries.erase(it++);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::adoptRecoveryFile(GraphicalSequence* gseq, const RecoveryFile& file)
+{
+    // the recovery file already holds what was just loaded from it
+    Entry& entry = m_entries[gseq];
+    entry.m_id       = m_next_id++;
+    entry.m_has_file = true;
+    getRevisions(gseq, &entry.m_sequence_revision, &entry.m_tracks_revision);
+    m_own_ids.insert(entry.m_id);
+    
+    const wxString infoPath = getFilePath(m_directory, file.m_pid, file.m_id, wxT("txt"));
+    if (not wxRenameFile(file.m_path, getFilePath(m_directory, m_pid, entry.m_id, wxT("aria"))))
+    {
+        // it will be written again as soon as the sequence is modified
+        std::cerr << "[Autosave] cannot rename " << (const char*)file.m_path.utf8_str() << std::endl;
+        entry.m_has_file = false;
+        return;
+    }
+    if (wxFileExists(infoPath)) wxRenameFile(infoPath, getFilePath(m_directory, m_pid, entry.m_id, wxT("txt")));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::onSequenceSaved(GraphicalSequence* gseq)
+{
+    Entry& entry = getEntry(gseq);
+    getRevisions(gseq, &entry.m_sequence_revision, &entry.m_tracks_revision);
+    
+    if (entry.m_has_file)
+    {
+        entry.m_has_file = false;
+        
+        Job job;
+        job.m_id = entry.m_id;
+        queue(job);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::onSequenceClosed(GraphicalSequence* gseq)
+{
+    std::map<const GraphicalSequence*, Entry>::iterator it = m_entries.find(gseq);
+    if (it == m_entries.end()) return;
+    
+    if (it->second.m_has_file)
+    {
+        Job job;
+        job.m_id = it->second.m_id;
+        queue(job);
+    }
+    m_entries.erase(it);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::queue(const Job& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        
+        bool replaced = false;
+        const int count = m_jobs.size();
+        for (int n=0; n<count and not replaced; n++)
+        {
+            if (m_jobs[n].m_id == job.m_id)
+            {
+                m_jobs[n] = job;
+                replaced = true;
+            }
+        }
+        if (not replaced) m_jobs.push_back(job);
+    }
+    m_condition.notify_one();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    
+    while (true)
+    {
+        while (m_jobs.empty() and not m_stopping) m_condition.wait(lock);
+        if (m_stopping) return;
+        
+        Job job = m_jobs.front();
+        m_jobs.pop_front();
+        
+        lock.unlock();
+        runJob(job);
+        
+        // the last reference to a snapshot may be dropped here, outside the lock
+        job.m_snapshot.reset();
+        lock.lock();
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::runJob(const Job& job)
+{
+    const wxString ariaPath = getFilePath(m_directory, m_pid, job.m_id, wxT("aria"));
+    const wxString infoPath = getFilePath(m_directory, m_pid, job.m_id, wxT("txt"));
+    
+    if (job.m_snapshot.get() == NULL)
+    {
+        if (wxFileExists(ariaPath)) wxRemoveFile(ariaPath);
+        if (wxFileExists(infoPath)) wxRemoveFile(infoPath);
+        return;
+    }
+    
+    if (not job.m_snapshot->writeToFile(ariaPath)) return;
+    
+    wxFFile info(infoPath, wxT("wb"));
+    if (info.IsOpened()) info.Write(job.m_info.data(), job.m_info.size());
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::listRecoveryFiles(const wxString& directory, std::vector<RecoveryFile>& out)
+{
+    if (not wxDirExists(directory)) return;
+    
+    wxDir dir(directory);
+    if (not dir.IsOpened()) return;
+    
+    const wxString prefix = AUTOSAVE_PREFIX;
+    
+    wxString name;
+    bool found = dir.GetFirst(&name, prefix + wxT("*.aria"), wxDIR_FILES);
+    while (found)
+    {
+        // named <prefix><process id>-<id>.aria
+        unsigned long pid;
+        long id;
+        const wxString ids = name.Mid(prefix.size()).BeforeLast(wxT('.'));
+        if (ids.BeforeFirst(wxT('-')).ToULong(&pid) and ids.AfterFirst(wxT('-')).ToLong(&id))
+        {
+            RecoveryFile file;
+            file.m_pid   = pid;
+            file.m_id    = id;
+            file.m_path  = directory + name;
+            file.m_title = wxString::Format(_("Recovered file %i"), (int)id);
+            
+            wxString info;
+            wxFFile infoFile(directory + name.BeforeLast(wxT('.')) + wxT(".txt"), wxT("rb"));
+            if (infoFile.IsOpened() and infoFile.ReadAll(&info, wxConvUTF8))
+            {
+                file.m_original_path = info.BeforeFirst(wxT('\n'));
+                
+                const wxString title = info.AfterFirst(wxT('\n')).BeforeFirst(wxT('\n'));
+                if (not title.IsEmpty()) file.m_title = title;
+            }
+            
+            out.push_back(file);
+        }
+        
+        found = dir.GetNext(&name);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::findRecoveryFiles(std::vector<RecoveryFile>& out)
+{
+    std::vector<RecoveryFile> all;
+    listRecoveryFiles(getDirectory(), all);
+    
+    // the files of other instances still running are not left over
+    const unsigned long ownPid = wxGetProcessId();
+    const int count = all.size();
+    for (int n=0; n<count; n++)
+    {
+        if (all[n].m_pid == ownPid or not wxProcess::Exists((int)all[n].m_pid)) out.push_back(all[n]);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AutosaveManager::removeRecoveryFiles(const std::vector<RecoveryFile>& files)
+{
+    const wxString directory = getDirectory();
+    
+    const int count = files.size();
+    for (int n=0; n<count; n++)
+    {
+        const wxString infoPath = getFilePath(directory, files[n].m_pid, files[n].m_id, wxT("txt"));
+        if (wxFileExists(files[n].m_path)) wxRemoveFile(files[n].m_path);
+        if (wxFileExists(infoPath))        wxRemoveFile(infoPath);
+    }
+}
@@ -0,0 +1,175 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __AUTOSAVE_H__
+#define __AUTOSAVE_H__
+
+#include "PreferencesData.h"
+#include "Utils.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <wx/string.h>
+#include <wx/timer.h>
+
+namespace AriaMaestosa
+{
+    class GraphicalSequence;
+    class SequenceSnapshot;
+    
+    /**
+      * @brief Periodically keeps a recovery copy of modified sequences, so that little work is lost if the
+      *        application does not quit properly
+      *
+      * Each time the timer fires, sequences that changed since the last copy are snapshotted on the main
+      * thread (see SequenceSnapshot, which only serializes again the tracks that were edited) and the
+      * snapshots are written by a worker thread, as .aria files in the 'autosave' directory of the
+      * preferences, next to a small text file giving the original path and title of the sequence.
+      * Recovery files are named after the process that wrote them, since several instances of the
+      * application may share the directory. They are removed when their sequence is saved or closed,
+      * and all those of an instance when it quits normally ; those still around on startup whose
+      * process is not running anymore come from a session that did not.
+      *
+      * @ingroup io
+      */
+    class AutosaveManager : public wxTimer, public IPreferencesListener
+    {
+        struct Entry
+        {
+            int  m_id;
+            
+            /** what the sequence looked like when last copied (or saved) ; see Sequence::getRevision */
+            long m_sequence_revision;
+            long m_tracks_revision;
+            
+            /** whether a recovery file was written (or is about to be) for this sequence */
+            bool m_has_file;
+        };
+        
+        /** a recovery file to write, or to remove if m_snapshot is empty */
+        struct Job
+        {
+            int m_id;
+            std::shared_ptr<const SequenceSnapshot> m_snapshot;
+            
+            /** contents of the file describing the recovery file, UTF-8 */
+            std::string m_info;
+        };
+        
+        /** only used on the main thread */
+        std::map<const GraphicalSequence*, Entry> m_entries;
+        int m_next_id;
+        
+        /** ids of all the recovery files this manager wrote or adopted ; only used on the main thread */
+        std::set<int> m_own_ids;
+        
+        /** set once by the constructor, then only read */
+        wxString m_directory;
+        unsigned long m_pid;
+        
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<Job> m_jobs;
+        bool m_stopping;
+        std::thread m_writer;
+        
+        void writerLoop();
+        void runJob(const Job& job);
+        
+        /** @brief queue a job ; a job that was queued for the same file and not started yet is replaced */
+        void queue(const Job& job);
+        
+        Entry& getEntry(GraphicalSequence* gseq);
+        
+        /** @brief restart the timer according to the preferences */
+        void updateInterval();
+        
+        static void getRevisions(GraphicalSequence* gseq, long* sequenceRevision, long* tracksRevision);
+        static wxString getDirectory();
+        static wxString getFilePath(const wxString& directory, const unsigned long pid, const int id,
+                                    const wxString& extension);
+        
+    public:
+        LEAK_CHECK();
+        
+        /** @brief a recovery file left by a session that did not quit properly */
+        struct RecoveryFile
+        {
+            /** the process that wrote it, and its id among the files of that process */
+            unsigned long m_pid;
+            int           m_id;
+            
+            wxString m_path;
+            
+            /** where the sequence was saved, or empty if it never was */
+            wxString m_original_path;
+            wxString m_title;
+        };
+        
+    private:
+        /** @brief list all the recovery files of the directory, whatever process they belong to */
+        static void listRecoveryFiles(const wxString& directory, std::vector<RecoveryFile>& out);
+        
+    public:
+        AutosaveManager();
+        
+        /**
+          * @brief stops the writer and removes the recovery files of this manager (the files of other
+          *        instances are left alone) ; to be destroyed when quitting normally
+          */
+        virtual ~AutosaveManager();
+        
+        /** @brief copy what changed ; called by the timer */
+        virtual void Notify();
+        
+        /**
+          * @brief the sequence was opened from a recovery file, which it keeps until it is saved or closed
+          *        (the file is renamed, to belong to this manager from now on)
+          */
+        void adoptRecoveryFile(GraphicalSequence* gseq, const RecoveryFile& file);
+        
+        /** @brief the sequence was saved, its recovery file is not needed anymore */
+        void onSequenceSaved(GraphicalSequence* gseq);
+        
+        /** @brief the sequence is about to be closed, its recovery file is not needed anymore */
+        void onSequenceClosed(GraphicalSequence* gseq);
+        
+        virtual void onSettingChanged(const Setting& setting);
+        
+        /**
+          * @brief list the recovery files of sessions that did not quit properly, i.e. whose process is
+          *        not running anymore
+          * @pre   no AutosaveManager exists yet (files named after this process are then leftovers of an
+          *        earlier process that had the same id)
+          */
+        static void findRecoveryFiles(std::vector<RecoveryFile>& out);
+        
+        /** @brief remove recovery files found with findRecoveryFiles, that will not be opened */
+        static void removeRecoveryFiles(const std::vector<RecoveryFile>& files);
+    };
+    
+}
+
+#endif
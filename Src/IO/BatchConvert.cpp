@@ -0,0 +1,475 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "IO/BatchConvert.h"
+
+#include "AriaCore.h"
+#include "Headless.h"
+#include "GUI/GraphicalSequence.h"
+#include "GUI/ImageProvider.h"
+#include "IO/AriaFileWriter.h"
+#include "IO/IOUtils.h"
+#include "IO/MidiFileReader.h"
+#include "IO/SequenceSnapshot.h"
+#include "Midi/CommonMidiUtils.h"
+#include "Midi/Players/CaptureDevice.h"
+#include "Midi/Players/PlatformMidiManager.h"
+#include "Midi/Sequence.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/image.h>
+
+using namespace AriaMaestosa;
+
+namespace AriaMaestosa
+{
+    namespace BatchConvert
+    {
+        enum OutputFormat
+        {
+            FORMAT_ARIA,
+            FORMAT_MIDI,
+            FORMAT_AUDIO
+        };
+        
+        /** Where a job is : workers load it, the main thread makes the view of .aria outputs, workers write */
+        enum JobStage
+        {
+            STAGE_LOAD,
+            STAGE_MAKE_SNAPSHOT,
+            STAGE_WRITE_SNAPSHOT,
+            STAGE_DONE
+        };
+        
+        typedef std::chrono::steady_clock Clock;
+        
+        static double elapsedMs(const Clock::time_point& from, const Clock::time_point& to)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count() / 1000.0;
+        }
+        
+        // ----------------------------------------------------------------------------------------------------------
+        
+        /** @brief The conversion of one file ; also receives the warnings of its loader */
+        class Job : public ILoadMonitor
+        {
+        public:
+            wxString m_input;
+            wxString m_output;
+            
+            JobStage m_stage;
+            bool     m_success;
+            
+            /**
+              * set while loading ; created on the main thread, like AsyncFileLoader does, since the
+              * constructor reads the preferences that the workers need
+              */
+            OwnerPtr<Sequence> m_sequence;
+            
+            /** set for .aria outputs, once the view was made */
+            OwnerPtr<SequenceSnapshot> m_snapshot;
+            
+            std::vector<wxString> m_warnings;
+            
+            /** when the job was queued ; the total time also counts waiting for a worker */
+            Clock::time_point m_start;
+            double m_load_ms;
+            double m_convert_ms;
+            
+            Job(const wxString& input, const wxString& output)
+            {
+                m_input      = input;
+                m_output     = output;
+                m_stage      = STAGE_LOAD;
+                m_success    = false;
+                m_load_ms    = 0;
+                m_convert_ms = 0;
+                
+                m_sequence = new Sequence(NULL, NULL, NULL, NULL, false);
+                m_sequence->setFilepath(input);
+                m_sequence->setSequenceFilename( extractTitle(input) );
+            }
+            
+            // ILoadMonitor
+            virtual void setProgress(int percent)                { }
+            virtual void addWarning(const wxString& message)     { m_warnings.push_back(message); }
+            virtual bool isCancelled() const                     { return false; }
+        };
+        
+        // ----------------------------------------------------------------------------------------------------------
+        
+        /**
+          * @brief Runs jobs on a pool of worker threads
+          *
+          * Jobs go to the workers through m_queue and come back to the main thread through m_returned,
+          * whether they are done or need the main thread (to make the view of a .aria output). At most
+          * m_window jobs are under way at once, so that songs are not all held in memory together.
+          */
+        class Converter
+        {
+            OutputFormat m_format;
+            
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            std::deque<Job*> m_queue;
+            std::deque<Job*> m_returned;
+            bool m_closing;
+            
+            int m_thread_amount;
+            int m_window;
+            
+            void work()
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while (true)
+                {
+                    while (m_queue.empty() and not m_closing) m_condition.wait(lock);
+                    if (m_queue.empty()) return;
+                    
+                    Job* job = m_queue.front();
+                    m_queue.pop_front();
+                    lock.unlock();
+                    
+                    if (job->m_stage == STAGE_LOAD) load(job);
+                    else                            writeSnapshot(job);
+                    
+                    lock.lock();
+                    m_returned.push_back(job);
+                    m_condition.notify_all();
+                }
+            }
+            
+            /** @brief on a worker thread : read the input, then write the output unless it is a .aria file */
+            void load(Job* job)
+            {
+                const Clock::time_point loadStart = Clock::now();
+                
+                bool loaded;
+                if (job->m_input.EndsWith(wxT(".aria")))
+                {
+                    loaded = loadAriaFile(job->m_sequence, job->m_input, job);
+                }
+                else
+                {
+                    std::set<wxString> warnings;
+                    loaded = loadMidiFile(job->m_sequence, job->m_input, warnings, job);
+                    job->m_warnings.insert(job->m_warnings.end(), warnings.begin(), warnings.end());
+                }
+                
+                const Clock::time_point loadEnd = Clock::now();
+                job->m_load_ms = elapsedMs(loadStart, loadEnd);
+                
+                if (not loaded)
+                {
+                    job->m_warnings.push_back(wxT("the file could not be loaded"));
+                    job->m_stage = STAGE_DONE;
+                    return;
+                }
+                
+                if (m_format == FORMAT_ARIA)
+                {
+                    job->m_stage = STAGE_MAKE_SNAPSHOT;
+                    return;
+                }
+                
+                if (m_format == FORMAT_MIDI)
+                {
+                    // files are already converted side by side, so tracks are encoded on this thread only
+                    job->m_success = exportMidiFile(job->m_sequence, job->m_output, false /* interactive */, 1);
+                }
+                else
+                {
+                    job->m_success = PlatformMidiManager::get()->renderAudioFile(job->m_sequence, job->m_output);
+                }
+                
+                job->m_convert_ms = elapsedMs(loadEnd, Clock::now());
+                job->m_stage = STAGE_DONE;
+            }
+            
+            /** @brief on a worker thread : write the .aria file of a job whose view was made */
+            void writeSnapshot(Job* job)
+            {
+                ASSERT(job->m_stage == STAGE_WRITE_SNAPSHOT);
+                
+                const Clock::time_point start = Clock::now();
+                job->m_success = job->m_snapshot->writeToFile(job->m_output);
+                job->m_snapshot = NULL;
+                
+                job->m_convert_ms += elapsedMs(start, Clock::now());
+                job->m_stage = STAGE_DONE;
+            }
+            
+            /**
+              * @brief on the main thread : make the view of a loaded song and take the snapshot that saving it
+              *        would write (which is what a .aria file holds besides the model)
+              */
+            void makeSnapshot(Job* job)
+            {
+                const Clock::time_point start = Clock::now();
+                
+                {
+                    GraphicalSequence gseq(job->m_sequence.raw_ptr);
+                    job->m_sequence.raw_ptr = NULL;
+                    
+                    HeadlessSequenceProvider provider(&gseq);
+                    
+                    gseq.createViewForTracks(-1 /* all */);
+                    gseq.applyPendingView();
+                    job->m_snapshot = new SequenceSnapshot(&gseq);
+                }
+                
+                job->m_convert_ms = elapsedMs(start, Clock::now());
+                job->m_stage = STAGE_WRITE_SNAPSHOT;
+            }
+            
+            /** @brief on the main thread : print the outcome of a finished job */
+            void report(Job* job, int* failures)
+            {
+                for (unsigned int n=0; n<job->m_warnings.size(); n++)
+                {
+                    fprintf(stderr, "[convert] %s : %s\n", (const char*)job->m_input.utf8_str(),
+                            (const char*)job->m_warnings[n].utf8_str());
+                }
+                
+                if (job->m_success)
+                {
+                    printf("[convert] %s -> %s : load %.1f ms, convert %.1f ms, total %.1f ms\n",
+                           (const char*)job->m_input.utf8_str(), (const char*)job->m_output.utf8_str(),
+                           job->m_load_ms, job->m_convert_ms, elapsedMs(job->m_start, Clock::now()));
+                }
+                else
+                {
+                    fprintf(stderr, "[convert] %s : FAILED after %.1f ms\n", (const char*)job->m_input.utf8_str(),
+                            elapsedMs(job->m_start, Clock::now()));
+                    (*failures)++;
+                }
+            }
+            
+        public:
+            
+            Converter(const OutputFormat format, const int threadAmount)
+            {
+                m_format        = format;
+                m_thread_amount = threadAmount;
+                m_window        = threadAmount * 2;
+                m_closing       = false;
+            }
+            
+            /**
+              * @param inputs   files to convert
+              * @param outputs  the file each input is converted to
+              * @return how many files could not be converted
+              */
+            int run(const wxArrayString& inputs, const wxArrayString& outputs)
+            {
+                // workers never read the preferences, see Job::m_sequence
+                if (m_format == FORMAT_AUDIO) PlatformMidiManager::get()->prepareAudioRendering();
+                
+                std::vector<std::thread> threads;
+                for (int n=0; n<m_thread_amount; n++)
+                {
+                    threads.push_back( std::thread(&Converter::work, this) );
+                }
+                
+                const int count = inputs.GetCount();
+                int next     = 0;
+                int underWay = 0;
+                int failures = 0;
+                
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while (next < count or underWay > 0)
+                {
+                    // sequences are created here, as their constructor reads the preferences (see Job::m_sequence)
+                    while (underWay < m_window and next < count)
+                    {
+                        lock.unlock();
+                        Job* job = new Job(inputs[next], outputs[next]);
+                        job->m_start = Clock::now();
+                        lock.lock();
+                        
+                        m_queue.push_back(job);
+                        m_condition.notify_all();
+                        next++;
+                        underWay++;
+                    }
+                    
+                    while (m_returned.empty()) m_condition.wait(lock);
+                    Job* job = m_returned.front();
+                    m_returned.pop_front();
+                    lock.unlock();
+                    
+                    if (job->m_stage == STAGE_MAKE_SNAPSHOT)
+                    {
+                        makeSnapshot(job);
+                        lock.lock();
+                        m_queue.push_back(job);
+                        m_condition.notify_all();
+                        continue;
+                    }
+                    
+                    report(job, &failures);
+                    delete job;
+                    lock.lock();
+                    underWay--;
+                }
+                
+                m_closing = true;
+                m_condition.notify_all();
+                lock.unlock();
+                
+                for (unsigned int n=0; n<threads.size(); n++) threads[n].join();
+                return failures;
+            }
+        };
+        
+        // ----------------------------------------------------------------------------------------------------------
+        
+        static void printUsage()
+        {
+            fprintf(stderr, "usage : --convert <aria|mid|audio> [--jobs N] [--output-dir DIR] files...\n");
+            fprintf(stderr, "        (with wxGTK, an X server is needed ; use e.g. xvfb-run on a server)\n");
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int BatchConvert::run(const wxArrayString& args)
+{
+    if (args.GetCount() < 2)
+    {
+        printUsage();
+        return 1;
+    }
+    
+    OutputFormat format;
+    if      (args[0] == wxT("aria"))  format = FORMAT_ARIA;
+    else if (args[0] == wxT("mid"))   format = FORMAT_MIDI;
+    else if (args[0] == wxT("audio")) format = FORMAT_AUDIO;
+    else
+    {
+        printUsage();
+        return 1;
+    }
+    
+    int threadAmount = std::max(1, (int)std::thread::hardware_concurrency());
+    wxString outputDir;
+    wxArrayString inputs;
+    
+    for (unsigned int n=1; n<args.GetCount(); n++)
+    {
+        if (args[n] == wxT("--jobs") and n + 1 < args.GetCount())
+        {
+            long value;
+            if (not args[n+1].ToLong(&value) or value < 1)
+            {
+                printUsage();
+                return 1;
+            }
+            threadAmount = value;
+            n++;
+        }
+        else if (args[n] == wxT("--output-dir") and n + 1 < args.GetCount())
+        {
+            outputDir = args[n+1];
+            n++;
+        }
+        else
+        {
+            inputs.Add(args[n]);
+        }
+    }
+    
+    if (inputs.IsEmpty())
+    {
+        printUsage();
+        return 1;
+    }
+    
+    if (not outputDir.IsEmpty() and not wxDirExists(outputDir))
+    {
+        fprintf(stderr, "[convert] output directory %s does not exist\n", (const char*)outputDir.utf8_str());
+        return 1;
+    }
+    
+    wxString extension;
+    if (format == FORMAT_AUDIO)
+    {
+        // the driver is only asked to render files, it is not initialized (nothing is played)
+        extension = PlatformMidiManager::get()->getAudioExtension();
+        if (extension.IsEmpty())
+        {
+            fprintf(stderr, "[convert] the MIDI driver cannot export audio\n");
+            return 1;
+        }
+    }
+    else
+    {
+        // nothing is played, but views ask the MIDI manager whether playback is ongoing
+        PlatformMidiManager::installManager(new CaptureMidiManager(0));
+        extension = (format == FORMAT_ARIA ? wxT(".aria") : wxT(".mid"));
+        
+        if (format == FORMAT_ARIA)
+        {
+            wxInitAllImageHandlers();
+            ImageProvider::loadImages();
+        }
+    }
+    
+    // ---- find where each file goes
+    wxArrayString outputs;
+    int skipped = 0;
+    for (unsigned int n=0; n<inputs.GetCount(); n++)
+    {
+        wxFileName output(inputs[n]);
+        output.SetExt(extension.AfterFirst('.'));
+        if (not outputDir.IsEmpty()) output.SetPath(outputDir);
+        
+        if (output.SameAs(wxFileName(inputs[n])))
+        {
+            fprintf(stderr, "[convert] %s : FAILED, it would be replaced by its own conversion\n",
+                    (const char*)inputs[n].utf8_str());
+            inputs.RemoveAt(n);
+            n--;
+            skipped++;
+            continue;
+        }
+        outputs.Add(output.GetFullPath());
+    }
+    
+    // ---- convert
+    const Clock::time_point start = Clock::now();
+    
+    Converter converter(format, threadAmount);
+    const int failures = converter.run(inputs, outputs) + skipped;
+    
+    printf("[convert] %i file(s) converted, %i failed, in %.1f ms (%i threads)\n",
+           (int)inputs.GetCount() + skipped - failures, failures, elapsedMs(start, Clock::now()), threadAmount);
+    
+    if (format == FORMAT_ARIA) ImageProvider::unloadImages();
+    return (failures == 0 ? 0 : 1);
+}
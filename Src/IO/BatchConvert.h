@@ -0,0 +1,53 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __BATCH_CONVERT_H__
+#define __BATCH_CONVERT_H__
+
+#include <wx/arrstr.h>
+
+namespace AriaMaestosa
+{
+
+    /**
+      * @brief Headless conversion of many songs between .aria, .mid and sampled audio
+      *        (run with 'Aria --convert <aria|mid|audio> [--jobs N] [--output-dir DIR] files...')
+      *
+      * No window is opened and the MIDI driver is not initialized. Files are loaded and converted by a
+      * pool of worker threads, one file per thread at a time. Only the views needed to write .aria files
+      * are made on the main thread; the file itself is then written by a worker (see SequenceSnapshot).
+      * Each output file goes next to its input unless an output directory is given, with the extension
+      * of the new format. Audio files are rendered by PlatformMidiManager::renderAudioFile, which not
+      * every driver supports.
+      *
+      * The mode is started from wxApp::OnInit, once the toolkit is initialized. With wxGTK, a display is
+      * therefore needed even though no window is opened : on a server, run it under a virtual X server
+      * such as Xvfb ('xvfb-run Aria --convert ...').
+      *
+      * @ingroup io
+      */
+    namespace BatchConvert
+    {
+        /**
+          * @param args  the arguments that follow '--convert' on the command line
+          * @return process exit code : 0 if every file was converted
+          */
+        int run(const wxArrayString& args);
+    }
+
+}
+
+#endif
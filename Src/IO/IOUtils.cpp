@@ -71,7 +71,7 @@ void assertFailed(wxString message)
     exit(1);
 }
 
-void writeData(wxString data, wxFileOutputStream& fileout)
+void writeData(wxString data, wxOutputStream& fileout)
 {
     wxCharBuffer buffer = data.ToUTF8();
     fileout.Write((const char*)buffer, buffer.length());
@@ -22,7 +22,7 @@
 
 #include <wx/string.h>
 
-class wxFileOutputStream;
+class wxOutputStream;
 class wxWindow;
 
 namespace AriaMaestosa
@@ -48,7 +48,7 @@ namespace AriaMaestosa
     wxString to_wxString(bool b);
     
     /** @ingroup io */
-    void writeData(wxString data, wxFileOutputStream& fileout);
+    void writeData(wxString data, wxOutputStream& fileout);
     
     wxString extract_filename(wxString filepath);
     
@@ -83,6 +83,26 @@ namespace AriaMaestosa
       */
     wxString extractTitle(const wxString& inputPath);
 
+    /**
+      * @ingroup io
+      * @brief Lets a file loader report its progress and be interrupted; loaders given one may run
+      *        on a worker thread, so implementations must not touch the GUI directly
+      */
+    class ILoadMonitor
+    {
+    public:
+        virtual ~ILoadMonitor() {}
+        
+        /** @param percent  how much of the file was read, between 0 and 100 */
+        virtual void setProgress(int percent) = 0;
+        
+        /** @brief a problem that does not prevent loading, to be shown to the user afterwards */
+        virtual void addWarning(const wxString& message) = 0;
+        
+        /** @return whether loading should stop as soon as possible (the loader then fails) */
+        virtual bool isCancelled() const = 0;
+    };
+
 }
 
 #endif
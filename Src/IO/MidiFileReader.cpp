@@ -52,8 +52,17 @@ public:
 
 bool AriaMaestosa::loadMidiFile(GraphicalSequence* gseq, wxString filepath, std::set<wxString>& warnings)
 {
-    Sequence* sequence = gseq->getModel();
+    if (not loadMidiFile(gseq->getModel(), filepath, warnings)) return false;
     
+    gseq->setZoom(100);
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool AriaMaestosa::loadMidiFile(Sequence* sequence, wxString filepath, std::set<wxString>& warnings,
+                                ILoadMonitor* monitor)
+{
     OwnerPtr<Sequence::Import> import(sequence->startImport());
 
     // the stream used to read the input file
@@ -119,19 +128,11 @@ bool AriaMaestosa::loadMidiFile(GraphicalSequence* gseq, wxString filepath, std:
         {
             track = jdksequence.GetTrack( trackID );
 
-            // FIXME: to get reasonable performance, I have no choice but to kill the progress indicator,
-            // wxYield pauses for way too long??
-            // if there is a huge amount of tracks, only call wxYield once in a while because calling
-            // it everytime could be very slow
-            //if ((trackAmount < 10) or (trackID % (trackAmount/10) == 0))
-            //{
-            //    WaitWindow::setProgress(
-            //                            (int)(
-            //                                  log(trackID)*100/log(trackAmount)
-            //                                  )
-            //                            );
-            //    wxYield(); // FIXME - use a thread instead
-            //}
+            if (monitor != NULL)
+            {
+                if (monitor->isCancelled()) return false;
+                monitor->setProgress( trackID*100/trackAmount );
+            }
             
             // ----------------------------------- for each event -------------------------------------
 
@@ -554,19 +555,7 @@ bool AriaMaestosa::loadMidiFile(GraphicalSequence* gseq, wxString filepath, std:
             else
             {
                 // set default editor
-                switch (PreferencesData::getInstance()->getIntValue(SETTING_ID_DEFAULT_EDITOR))
-                {
-                    case 2:
-                        ariaTrack->setNotationType(GUITAR, true);
-                        break;
-                    case 1:
-                        ariaTrack->setNotationType(SCORE, true);
-                        break;
-                    case 0:
-                    default:
-                        ariaTrack->setNotationType(KEYBOARD, true);
-                        break;
-                }
+                ariaTrack->setNotationType(sequence->getDefaultNotationType(), true);
             
             }
 
@@ -672,16 +661,12 @@ bool AriaMaestosa::loadMidiFile(GraphicalSequence* gseq, wxString filepath, std:
     std::cout << "[loadMidiFile] song length = " << measureAmount_i << " measures, last_event_tick="
               << lastEventTick << ", beat length = " << sequence->ticksPerQuarterNote() << std::endl;
 
-    gseq->setZoom(100);
-
     if (measureAmount_i < 1) measureAmount_i = 1;
 
     {
         ScopedMeasureTransaction tr(md->startTransaction());
         tr->setMeasureAmount( measureAmount_i );
     }
-    
-    gseq->setZoom(100);
 
     sequence->clearUndoStack();
 
@@ -24,10 +24,21 @@ namespace AriaMaestosa
 {
     
     class GraphicalSequence;
+    class ILoadMonitor;
+    class Sequence;
     
     /** @ingroup io */
     bool loadMidiFile(GraphicalSequence* sequence, wxString filepath, std::set<wxString>& warnings);
     
+    /**
+      * @ingroup io
+      * @brief read a midi file into a sequence that has no view yet; does not touch the GUI, so it may
+      *        be called from a worker thread
+      * @param monitor  receives progress and is polled for cancellation between tracks; may be NULL
+      */
+    bool loadMidiFile(Sequence* sequence, wxString filepath, std::set<wxString>& warnings,
+                      ILoadMonitor* monitor = NULL);
+    
 }
 
 #endif
@@ -51,6 +51,9 @@ namespace AriaMaestosa
         long Seek( const long pos, const int whence );
         int  WriteChar( const int c );
         int  getDataLength();
+        
+        /** @return the bytes written so far, getDataLength() of them */
+        const char* getData() const { return (data.empty() ? NULL : &data[0]); }
         void storeMidiData(char* midiData);
     };
     
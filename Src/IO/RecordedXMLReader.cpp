@@ -0,0 +1,212 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "IO/RecordedXMLReader.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace AriaMaestosa;
+
+// ----------------------------------------------------------------------------------------------------------
+
+RecordedXMLReader::RecordedXMLReader()
+{
+    m_current = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void RecordedXMLReader::recordNode(irr::io::IrrXMLReader* source)
+{
+    Node node;
+    node.m_type  = source->getNodeType();
+    node.m_empty = source->isEmptyElement();
+    
+    const char* name = source->getNodeName();
+    if (name != NULL) node.m_name = name;
+    
+    const char* data = source->getNodeData();
+    if (data != NULL) node.m_data = data;
+    
+    const int count = source->getAttributeCount();
+    for (int n=0; n<count; n++)
+    {
+        node.m_attribute_names.push_back( source->getAttributeName(n) );
+        node.m_attribute_values.push_back( source->getAttributeValue(n) );
+    }
+    
+    m_nodes.push_back(node);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void RecordedXMLReader::record(irr::io::IrrXMLReader* source, const bool withChildren)
+{
+    recordNode(source);
+    
+    if (not withChildren or source->getNodeType() != irr::io::EXN_ELEMENT or source->isEmptyElement()) return;
+    
+    int depth = 1;
+    while (depth > 0 and source->read())
+    {
+        recordNode(source);
+        
+        if (source->getNodeType() == irr::io::EXN_ELEMENT and not source->isEmptyElement()) depth++;
+        else if (source->getNodeType() == irr::io::EXN_ELEMENT_END)                          depth--;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const RecordedXMLReader::Node* RecordedXMLReader::getCurrentNode() const
+{
+    if (m_current < 0 or m_current >= (int)m_nodes.size()) return NULL;
+    return &m_nodes[m_current];
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool RecordedXMLReader::read()
+{
+    if (m_current >= (int)m_nodes.size()) return false;
+    
+    m_current++;
+    return m_current < (int)m_nodes.size();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+irr::io::EXML_NODE RecordedXMLReader::getNodeType() const
+{
+    const Node* node = getCurrentNode();
+    return (node == NULL ? irr::io::EXN_NONE : node->m_type);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int RecordedXMLReader::getAttributeCount() const
+{
+    const Node* node = getCurrentNode();
+    return (node == NULL ? 0 : (int)node->m_attribute_names.size());
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const char* RecordedXMLReader::getAttributeName(int idx) const
+{
+    if (idx < 0 or idx >= getAttributeCount()) return NULL;
+    return getCurrentNode()->m_attribute_names[idx].c_str();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const char* RecordedXMLReader::getAttributeValue(int idx) const
+{
+    if (idx < 0 or idx >= getAttributeCount()) return NULL;
+    return getCurrentNode()->m_attribute_values[idx].c_str();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const char* RecordedXMLReader::getAttributeValue(const char* name) const
+{
+    const Node* node = getCurrentNode();
+    if (node == NULL or name == NULL) return NULL;
+    
+    const int count = node->m_attribute_names.size();
+    for (int n=0; n<count; n++)
+    {
+        if (node->m_attribute_names[n] == name) return node->m_attribute_values[n].c_str();
+    }
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const char* RecordedXMLReader::getAttributeValueSafe(const char* name) const
+{
+    const char* value = getAttributeValue(name);
+    return (value == NULL ? "" : value);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int RecordedXMLReader::getAttributeValueAsInt(const char* name) const
+{
+    return atoi( getAttributeValueSafe(name) );
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int RecordedXMLReader::getAttributeValueAsInt(int idx) const
+{
+    const char* value = getAttributeValue(idx);
+    return (value == NULL ? 0 : atoi(value));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+float RecordedXMLReader::getAttributeValueAsFloat(const char* name) const
+{
+    return (float)atof( getAttributeValueSafe(name) );
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+float RecordedXMLReader::getAttributeValueAsFloat(int idx) const
+{
+    const char* value = getAttributeValue(idx);
+    return (value == NULL ? 0.0f : (float)atof(value));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const char* RecordedXMLReader::getNodeName() const
+{
+    const Node* node = getCurrentNode();
+    return (node == NULL ? "" : node->m_name.c_str());
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const char* RecordedXMLReader::getNodeData() const
+{
+    const Node* node = getCurrentNode();
+    return (node == NULL ? "" : node->m_data.c_str());
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool RecordedXMLReader::isEmptyElement() const
+{
+    const Node* node = getCurrentNode();
+    return (node != NULL and node->m_empty);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+irr::io::ETEXT_FORMAT RecordedXMLReader::getSourceFormat() const
+{
+    return irr::io::ETF_UTF8;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+irr::io::ETEXT_FORMAT RecordedXMLReader::getParserFormat() const
+{
+    return irr::io::ETF_UTF8;
+}
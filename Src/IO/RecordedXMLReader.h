@@ -0,0 +1,97 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __RECORDED_XML_READER_H__
+#define __RECORDED_XML_READER_H__
+
+#include "irrXML/irrXML.h"
+
+#include <string>
+#include <vector>
+
+namespace AriaMaestosa
+{
+    
+    /**
+      * @brief An irrXML reader that plays back nodes copied from another reader
+      *
+      * Used to keep the parts of a .aria file that describe the view (editors, scrolling, zoom) while
+      * the model is read off-screen, so that they can be read by the graphical classes later, exactly
+      * as if they came from the file.
+      *
+      * After 'rewind', the reader is positioned on the first recorded node (unlike readers obtained from
+      * irr::io::createIrrXMLReader, that need a first call to 'read').
+      *
+      * @ingroup io
+      */
+    class RecordedXMLReader : public irr::io::IrrXMLReader
+    {
+        struct Node
+        {
+            irr::io::EXML_NODE m_type;
+            std::string m_name;
+            std::string m_data;
+            bool m_empty;
+            std::vector<std::string> m_attribute_names;
+            std::vector<std::string> m_attribute_values;
+        };
+        
+        std::vector<Node> m_nodes;
+        int m_current;
+        
+        void recordNode(irr::io::IrrXMLReader* source);
+        
+        const Node* getCurrentNode() const;
+        
+    public:
+        
+        RecordedXMLReader();
+        
+        /**
+          * @brief copy the node 'source' is positioned on
+          * @param withChildren  if the node is an element that is not empty, also read 'source' up to the
+          *                      matching end tag and copy everything in between
+          */
+        void record(irr::io::IrrXMLReader* source, const bool withChildren);
+        
+        /** @return whether nothing was recorded */
+        bool isEmpty() const { return m_nodes.empty(); }
+        
+        /** @brief go back to the first recorded node */
+        void rewind() { m_current = 0; }
+        
+        // irr::io::IrrXMLReader
+        virtual bool read();
+        virtual irr::io::EXML_NODE getNodeType() const;
+        virtual int getAttributeCount() const;
+        virtual const char* getAttributeName(int idx) const;
+        virtual const char* getAttributeValue(int idx) const;
+        virtual const char* getAttributeValue(const char* name) const;
+        virtual const char* getAttributeValueSafe(const char* name) const;
+        virtual int getAttributeValueAsInt(const char* name) const;
+        virtual int getAttributeValueAsInt(int idx) const;
+        virtual float getAttributeValueAsFloat(const char* name) const;
+        virtual float getAttributeValueAsFloat(int idx) const;
+        virtual const char* getNodeName() const;
+        virtual const char* getNodeData() const;
+        virtual bool isEmptyElement() const;
+        virtual irr::io::ETEXT_FORMAT getSourceFormat() const;
+        virtual irr::io::ETEXT_FORMAT getParserFormat() const;
+    };
+    
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "IO/SequenceSnapshot.h"
+
+#include "GUI/GraphicalSequence.h"
+
+#include <iostream>
+
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+
+using namespace AriaMaestosa;
+
+// ----------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------------------------
+
+#if 0
+#pragma mark -
+#pragma mark SnapshotOutputStream
+#endif
+
+size_t SnapshotOutputStream::OnSysWrite(const void* buffer, size_t size)
+{
+    m_current.append((const char*)buffer, size);
+    return size;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SnapshotOutputStream::endChunk()
+{
+    if (m_current.empty()) return;
+    
+    m_chunks.push_back( std::shared_ptr<const std::string>(new std::string(m_current)) );
+    m_current.clear();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SnapshotOutputStream::write(const std::shared_ptr<const std::string>& chunk, wxOutputStream& out)
+{
+    SnapshotOutputStream* snapshot = dynamic_cast<SnapshotOutputStream*>(&out);
+    if (snapshot != NULL)
+    {
+        snapshot->endChunk();
+        snapshot->m_chunks.push_back(chunk);
+    }
+    else
+    {
+        out.Write(chunk->data(), chunk->size());
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SnapshotOutputStream::takeChunks(std::vector< std::shared_ptr<const std::string> >& out)
+{
+    endChunk();
+    out.swap(m_chunks);
+    m_chunks.clear();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------------------------
+
+#if 0
+#pragma mark -
+#pragma mark SequenceSnapshot
+#endif
+
+SequenceSnapshot::SequenceSnapshot(GraphicalSequence* gseq)
+{
+    SnapshotOutputStream out;
+    gseq->saveToFile(out);
+    out.takeChunks(m_chunks);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+size_t SequenceSnapshot::getSize() const
+{
+    size_t size = 0;
+    const int count = m_chunks.size();
+    for (int n=0; n<count; n++) size += m_chunks[n]->size();
+    return size;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool SequenceSnapshot::writeToFile(const wxString& filepath) const
+{
+    const wxString tempPath = filepath + wxT(".tmp");
+    
+    {
+        wxFFile file(tempPath, wxT("wb"));
+        if (not file.IsOpened())
+        {
+            std::cerr << "[SequenceSnapshot] cannot write " << (const char*)tempPath.utf8_str() << std::endl;
+            return false;
+        }
+        
+        const int count = m_chunks.size();
+        for (int n=0; n<count; n++)
+        {
+            if (file.Write(m_chunks[n]->data(), m_chunks[n]->size()) != m_chunks[n]->size())
+            {
+                std::cerr << "[SequenceSnapshot] failed writing " << (const char*)tempPath.utf8_str() << std::endl;
+                file.Close();
+                wxRemoveFile(tempPath);
+                return false;
+            }
+        }
+        
+        if (not file.Close()) return false;
+    }
+    
+    return wxRenameFile(tempPath, filepath, true /* overwrite */);
+}
@@ -0,0 +1,92 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __SEQUENCE_SNAPSHOT_H__
+#define __SEQUENCE_SNAPSHOT_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wx/stream.h>
+#include <wx/string.h>
+
+namespace AriaMaestosa
+{
+    class GraphicalSequence;
+    
+    /**
+      * @brief An output stream that collects what is written into immutable chunks, kept in memory
+      *
+      * Text written to it goes into chunks of its own; serialization code that already holds some text
+      * in a shared string (see Track::getSavedEvents) hands it over with 'write', so that it is
+      * referenced rather than copied.
+      *
+      * @ingroup io
+      */
+    class SnapshotOutputStream : public wxOutputStream
+    {
+        std::vector< std::shared_ptr<const std::string> > m_chunks;
+        std::string m_current;
+        
+        void endChunk();
+        
+    protected:
+        virtual size_t OnSysWrite(const void* buffer, size_t size);
+        
+    public:
+        
+        /** @brief write a shared chunk to a stream ; if it is a snapshot stream, the chunk is only referenced */
+        static void write(const std::shared_ptr<const std::string>& chunk, wxOutputStream& out);
+        
+        /** @brief move the chunks written so far to 'out' */
+        void takeChunks(std::vector< std::shared_ptr<const std::string> >& out);
+    };
+    
+    /**
+      * @brief A copy of what saving a sequence to a .aria file would write, taken at one point in time
+      *
+      * Taking a snapshot must be done on the main thread, but it only serializes again what changed since
+      * the last one: the notes and controller events of tracks that were not edited are shared with the
+      * previous snapshots (and with the track itself). The remaining data (sequence and track properties,
+      * measures, tempo, view settings) is small. A snapshot never changes once taken, so it can then be
+      * written from any thread.
+      *
+      * @ingroup io
+      */
+    class SequenceSnapshot
+    {
+        std::vector< std::shared_ptr<const std::string> > m_chunks;
+        
+    public:
+        
+        /** @pre called on the main thread */
+        SequenceSnapshot(GraphicalSequence* gseq);
+        
+        /** @return the size, in bytes, of the .aria file this snapshot makes */
+        size_t getSize() const;
+        
+        /**
+          * @brief write the snapshot as a .aria file ; the file is first written under a temporary name,
+          *        so that an existing file is only replaced by a complete one
+          * @note  may be called from any thread
+          */
+        bool writeToFile(const wxString& filepath) const;
+    };
+    
+}
+
+#endif
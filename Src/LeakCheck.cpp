@@ -26,6 +26,7 @@
 #include <execinfo.h>
 #endif
 
+#include <mutex>
 #include <set>
 
 #include "LeakCheck.h"
@@ -38,10 +39,14 @@ namespace AriaMaestosa
         
         std::set<MyObject*> g_all_objs;
         
+        /** watched objects are also created by worker threads (file loading, MIDI export) */
+        std::mutex g_all_objs_mutex;
+        
         void addObj(MyObject* myObj)
         {
             //std::cout << "addObj " << myObj->file << " (" << myObj->line << ")" << std::endl;
             //g_all_objs.push_back(myObj);
+            std::lock_guard<std::mutex> lock(g_all_objs_mutex);
             g_all_objs.insert(myObj);
         }
         
@@ -49,7 +54,10 @@ namespace AriaMaestosa
         {
             //std::cout << "removeObj " << myObj->file << " (" << myObj->line << ")" << std::endl;
             //g_all_objs.remove(myObj);
-            g_all_objs.erase(myObj);
+            {
+                std::lock_guard<std::mutex> lock(g_all_objs_mutex);
+                g_all_objs.erase(myObj);
+            }
             delete myObj;
             //std::cout << "removeObj done" << std::endl;
         }
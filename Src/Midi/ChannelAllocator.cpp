@@ -0,0 +1,219 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Midi/ChannelAllocator.h"
+
+#include "AriaCore.h"
+#include "Midi/ControllerEvent.h"
+#include "Midi/Sequence.h"
+#include "Midi/Track.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+
+using namespace AriaMaestosa;
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool ChannelAllocator::haveSameChannelState(Track* a, Track* b)
+{
+    const bool drum = a->isNotationTypeEnabled(DRUM);
+    if (drum != b->isNotationTypeEnabled(DRUM)) return false;
+
+    if (drum) { if (a->getDrumKit()   != b->getDrumKit())   return false; }
+    else      { if (a->getInstrument() != b->getInstrument()) return false; }
+
+    const int count = a->getControllerEventAmount();
+    if (count != b->getControllerEventAmount()) return false;
+
+    for (int n=0; n<count; n++)
+    {
+        ControllerEvent* eventA = a->getControllerEvent(n, 0);
+        ControllerEvent* eventB = b->getControllerEvent(n, 0);
+        if (eventA->getTick()       != eventB->getTick()       or
+            eventA->getController() != eventB->getController() or
+            eventA->getValue()      != eventB->getValue())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void ChannelAllocator::groupTracks(Sequence* seq, const std::vector<int>& tracks, std::vector<int>& groupOfTrack)
+{
+    // first track of each group, which the other tracks are compared with
+    std::vector<int> representatives;
+
+    const int count = tracks.size();
+    groupOfTrack.resize(count);
+    for (int n=0; n<count; n++)
+    {
+        Track* track = seq->getTrack(tracks[n]);
+
+        int group = -1;
+        const int groups = representatives.size();
+        for (int g=0; g<groups and group == -1; g++)
+        {
+            if (haveSameChannelState(track, seq->getTrack(representatives[g]))) group = g;
+        }
+
+        if (group == -1)
+        {
+            group = representatives.size();
+            representatives.push_back(tracks[n]);
+        }
+        groupOfTrack[n] = group;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+ChannelAllocator::ChannelAllocator(Sequence* seq, const int portAmount)
+{
+    ASSERT_E(portAmount, >=, 1);
+    const int ports = std::min(portAmount, (int)MAX_PORTS);
+
+    m_overflowing      = false;
+    m_used_port_amount = 1;
+
+    const int trackAmount = seq->getTrackAmount();
+    m_assignments.resize(trackAmount);
+
+    // drum tracks always send their setup, even when muted (see Track::addMidiEvents)
+    std::vector<int> melodic;
+    std::vector<int> drums;
+    for (int n=0; n<trackAmount; n++)
+    {
+        Track* track = seq->getTrack(n);
+        m_assignments[n].m_port    = 0;
+        m_assignments[n].m_channel = -1;
+
+        if      (track->isNotationTypeEnabled(DRUM)) drums.push_back(n);
+        else if (track->isPlayed())                  melodic.push_back(n);
+    }
+
+    // ---- melodic tracks
+    std::vector<int> slots;
+    const int melodicAmount = melodic.size();
+    if (melodicAmount <= MELODIC_CHANNELS_PER_PORT)
+    {
+        for (int n=0; n<melodicAmount; n++) slots.push_back(n);
+    }
+    else
+    {
+        groupTracks(seq, melodic, slots);
+    }
+
+    const int capacity = MELODIC_CHANNELS_PER_PORT * ports;
+    for (int n=0; n<melodicAmount; n++)
+    {
+        int slot = slots[n];
+        if (slot >= capacity)
+        {
+            m_overflowing = true;
+            slot = slot % capacity;
+        }
+
+        Assignment& assignment = m_assignments[melodic[n]];
+        assignment.m_port    = slot / MELODIC_CHANNELS_PER_PORT;
+        assignment.m_channel = slot % MELODIC_CHANNELS_PER_PORT;
+        if (assignment.m_channel >= DRUM_CHANNEL) assignment.m_channel++;
+
+        if (assignment.m_port >= m_used_port_amount) m_used_port_amount = assignment.m_port + 1;
+    }
+
+    // ---- drum tracks : each kit gets the drum channel of a port of its own, when there are enough of them.
+    //      Several kits sharing a channel is not reported as overflow, drum tracks always shared channel 10
+    std::vector<int> drumGroups;
+    groupTracks(seq, drums, drumGroups);
+
+    const int drumAmount = drums.size();
+    for (int n=0; n<drumAmount; n++)
+    {
+        Assignment& assignment = m_assignments[drums[n]];
+        assignment.m_port    = drumGroups[n] % ports;
+        assignment.m_channel = DRUM_CHANNEL;
+
+        if (assignment.m_port >= m_used_port_amount) m_used_port_amount = assignment.m_port + 1;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------------------------
+
+namespace TestChannelAllocator
+{
+    using namespace AriaMaestosa;
+
+    /** @brief make a sequence whose tracks use the given instruments */
+    static Sequence* makeSequence(const int trackAmount, const int instrumentAmount)
+    {
+        Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+        for (int n=0; n<trackAmount; n++)
+        {
+            Track* t = new Track(seq);
+            t->setInstrument(n % instrumentAmount);
+            seq->addTrack(t);
+        }
+        return seq;
+    }
+
+    UNIT_TEST(TestChannelAllocatorFewTracks)
+    {
+        OwnerPtr<Sequence> seq( makeSequence(12, 12) );
+        ChannelAllocator channels(seq, 4);
+
+        require( not channels.isOverflowing(),     "Twelve tracks fit on one port" );
+        require( channels.getUsedPortAmount() == 1, "Twelve tracks fit on one port" );
+
+        for (int n=0; n<12; n++)
+        {
+            require( channels.getPort(n) == 0, "Tracks stay on the first port" );
+            require( channels.getChannel(n) == (n < 9 ? n : n + 1), "Each track has a channel of its own, "
+                     "in order, skipping the drum channel" );
+        }
+    }
+
+    UNIT_TEST(TestChannelAllocatorManyTracks)
+    {
+        // 60 tracks, but only 20 different instruments
+        OwnerPtr<Sequence> seq( makeSequence(60, 20) );
+
+        ChannelAllocator onePort(seq, 1);
+        require( onePort.isOverflowing(), "Twenty instruments do not fit on one port" );
+        require( onePort.getUsedPortAmount() == 1, "A single port is used when only one is available" );
+
+        ChannelAllocator channels(seq, 4);
+        require( not channels.isOverflowing(),     "Tracks with the same instrument were packed together" );
+        require( channels.getUsedPortAmount() == 2, "The packed channels were spread over two ports" );
+
+        for (int a=0; a<60; a++)
+        {
+            require( channels.getChannel(a) != ChannelAllocator::DRUM_CHANNEL, "The drum channel is left alone" );
+
+            for (int b=a+1; b<60; b++)
+            {
+                const bool shared = (channels.getPort(a)    == channels.getPort(b) and
+                                     channels.getChannel(a) == channels.getChannel(b));
+                require( shared == (a % 20 == b % 20), "Only tracks with the same instrument share a channel" );
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CHANNEL_ALLOCATOR_H__
+#define __CHANNEL_ALLOCATOR_H__
+
+#include <vector>
+
+namespace AriaMaestosa
+{
+    class Sequence;
+    class Track;
+
+    /**
+      * @brief Chooses on which MIDI port and channel each track plays, in automatic channel mode
+      *
+      * When the played tracks fit on the channels of a single port, each gets a channel of its own,
+      * in track order. Otherwise, tracks that would send the same channel state (same instrument or
+      * drum kit and same controller events) are packed together on one channel, and the resulting
+      * groups are spread over as many ports as the output allows. Drum groups use channel 10 of
+      * successive ports.
+      *
+      * If there still are not enough channels, unrelated groups have to share channels (as was always
+      * the case with more than 16 tracks); see isOverflowing.
+      *
+      * @ingroup midi
+      */
+    class ChannelAllocator
+    {
+        struct Assignment
+        {
+            int m_port;
+            int m_channel;
+        };
+
+        std::vector<Assignment> m_assignments;
+        int  m_used_port_amount;
+        bool m_overflowing;
+
+        /** @return whether both tracks set their channel to the same state */
+        static bool haveSameChannelState(Track* a, Track* b);
+
+        /** @brief place tracks into groups of tracks that can share a channel, in order of first appearance */
+        static void groupTracks(Sequence* seq, const std::vector<int>& tracks, std::vector<int>& groupOfTrack);
+
+    public:
+
+        /** Most ports used for output; each adds 15 melodic channels and one drum channel */
+        static const int MAX_PORTS = 4;
+
+        static const int DRUM_CHANNEL = 9;
+
+        /** Channels of a port that are not reserved for drums */
+        static const int MELODIC_CHANNELS_PER_PORT = 15;
+
+        /**
+          * @param seq         the sequence whose tracks are to be placed
+          * @param portAmount  how many output ports may be used (at most MAX_PORTS)
+          */
+        ChannelAllocator(Sequence* seq, const int portAmount);
+
+        /** @return the output port of the given track (0 if it is not played) */
+        int getPort(const int trackID) const { return m_assignments[trackID].m_port; }
+
+        /** @return the channel of the given track, or -1 if it is muted (and thus sends nothing) */
+        int getChannel(const int trackID) const { return m_assignments[trackID].m_channel; }
+
+        /** @return how many ports are needed for this sequence, 1 if only the first port is used */
+        int getUsedPortAmount() const { return m_used_port_amount; }
+
+        /** @return whether some tracks that need different channel state had to share a channel anyway */
+        bool isOverflowing() const { return m_overflowing; }
+    };
+
+}
+
+#endif
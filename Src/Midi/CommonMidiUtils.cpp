@@ -19,6 +19,7 @@
 #include "IO/MidiToMemoryStream.h"
 #include "GUI/GraphicalTrack.h"
 #include "Dialogs/WaitWindow.h"
+#include "Midi/ChannelAllocator.h"
 #include "Midi/CommonMidiUtils.h"
 #include "Midi/MeasureData.h"
 #include "Midi/Players/PlatformMidiManager.h"
@@ -36,12 +37,20 @@
 #include "jdksmidi/filewritemultitrack.h"
 #include "jdksmidi/msg.h"
 #include "jdksmidi/sysex.h"
+#include "jdksmidi/sequencer.h"
 
+#include <wx/ffile.h>
+#include <wx/filefn.h>
 #include <wx/intl.h>
 #include <wx/timer.h>
 #include <wx/msgdlg.h>
 
+#include <algorithm>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
 
 
 /*
@@ -94,54 +103,17 @@
 namespace AriaMaestosa
 {
     void addTimeSigFromVector(int n, int amount, MeasureData* measureData,
-                              jdksmidi::MIDIMultiTrack& tracks, int substract_ticks);
+                              jdksmidi::MIDITrack* conductor, int substract_ticks);
     void addTempoEventFromSequenceVector(int n, int amount, Sequence* sequence,
-                                        jdksmidi::MIDIMultiTrack& tracks, int substract_ticks);
+                                        jdksmidi::MIDITrack* conductor, int substract_ticks);
     void addTextEventFromSequenceVector(int n, Sequence* sequence,
-                                        jdksmidi::MIDIMultiTrack& tracks, int substract_ticks);
-}
-
-// ----------------------------------------------------------------------------------------------------------
-
-bool AriaMaestosa::exportMidiFile(Sequence* sequence, wxString filepath)
-{
-    // when we're saving, we always want song to start at first measure, so temporarly switch
-    // firstMeasure to 0, and set it back in the end
-    const int firstMeasureValue = sequence->getMeasureData()->getFirstMeasure();
-    sequence->getMeasureData()->setFirstMeasure(0);
-    
-    jdksmidi::MIDIMultiTrack tracks;
-    int length = -1, start = -1, numTracks = -1;
-    makeJDKMidiSequence(sequence, tracks, false, &length, &start, &numTracks, false);
-    
-#ifdef __WXMSW__
-    jdksmidi::MIDIFileWriteStreamFileName file_stream( (const wchar_t*)filepath.wc_str() );
-#else
-    jdksmidi::MIDIFileWriteStreamFileName file_stream( (const char*)filepath.mb_str(wxConvUTF8) );
-#endif
-
-    jdksmidi::MIDIFileWriteMultiTrack writer2(
-                                             &tracks,
-                                             &file_stream
-                                             );
-    
-    // write the output file
-    if (not writer2.Write(numTracks, sequence->ticksPerQuarterNote()))
-    {
-        fprintf(stderr, "[exportMidiFile] Error writing midi file\n");
-        return false;
-    }
-    
-    sequence->getMeasureData()->setFirstMeasure(firstMeasureValue);
-    
-    return true;
-    
+                                        jdksmidi::MIDITrack* conductor, int substract_ticks);
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
 void AriaMaestosa::addTimeSigFromVector(int n, int amount, MeasureData* measureData,
-                                        jdksmidi::MIDIMultiTrack& tracks, int substract_ticks)
+                                        jdksmidi::MIDITrack* conductor, int substract_ticks)
 {
     jdksmidi::MIDITimedBigMessage m;
     int measure = measureData->getTimeSig(n).getMeasure();
@@ -169,7 +141,7 @@ void AriaMaestosa::addTimeSigFromVector(int n, int amount, MeasureData* measureD
     float denom = (float)log(measureData->getTimeSig(n).getDenom())/(float)log(2);
     m.SetTimeSig( measureData->getTimeSig(n).getNum(), (int)denom );
     
-    if (not tracks.GetTrack(0)->PutEvent(m))
+    if (not conductor->PutEvent(m))
     {
         std::cerr << "Error adding time sig event" << std::endl;
         return;
@@ -179,7 +151,7 @@ void AriaMaestosa::addTimeSigFromVector(int n, int amount, MeasureData* measureD
 // ----------------------------------------------------------------------------------------------------------
 
 void AriaMaestosa::addTempoEventFromSequenceVector(int n, int amount, Sequence* sequence,
-                                                   jdksmidi::MIDIMultiTrack& tracks, int substract_ticks)
+                                                   jdksmidi::MIDITrack* conductor, int substract_ticks)
 {
     jdksmidi::MIDITimedBigMessage m;
     
@@ -203,7 +175,7 @@ void AriaMaestosa::addTempoEventFromSequenceVector(int n, int amount, Sequence*
     double tempo = convertTempoBendToBPM(sequence->getTempoEvent(n)->getValue()) * 32.0;
     m.SetTempo32(tempo);
     
-    if (not tracks.GetTrack(0)->PutEvent( m ))
+    if (not conductor->PutEvent( m ))
     {
         std::cerr << "Error adding tempo event" << std::endl;
         return;
@@ -213,7 +185,7 @@ void AriaMaestosa::addTempoEventFromSequenceVector(int n, int amount, Sequence*
 // ----------------------------------------------------------------------------------------------------------
 
 void AriaMaestosa::addTextEventFromSequenceVector(int n, Sequence* sequence,
-                                                  jdksmidi::MIDIMultiTrack& tracks, int substract_ticks)
+                                                  jdksmidi::MIDITrack* conductor, int substract_ticks)
 {
     jdksmidi::MIDITimedBigMessage m;
     
@@ -246,7 +218,7 @@ void AriaMaestosa::addTextEventFromSequenceVector(int n, Sequence* sequence,
     m.CopySysEx(sysex);
     delete sysex;
     
-    if (not tracks.GetTrack(0)->PutEvent( m ))
+    if (not conductor->PutEvent( m ))
     {
         std::cerr << "Error adding text event" << std::endl;
         return;
@@ -374,119 +346,64 @@ UNIT_TEST( MergeTest )
 
 // ----------------------------------------------------------------------------------------------------------
 
-bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTrack& tracks, bool selectionOnly,
-                                       /*out*/int* songLengthInTicks, /*out*/int* startTick,
-                                       /*out*/ int* numTracks, bool playing)
+int AriaMaestosa::getJDKMidiTrackCapacity(Sequence* sequence)
 {
-    int trackLength = -1;
-    int channel     = 0;
-    
-    int substract_ticks;
-    const bool addMetronome = (sequence->playWithMetronome() and playing);
-    
-    tracks.SetClksPerBeat( sequence->ticksPerQuarterNote() );
-    
-    MeasureData* md = sequence->getMeasureData();
-    
-    bool tooManyChannelsMessageShown = false;
-    
-    const int past_end_time = (playing and not sequence->isLoopEnabled() ? sequence->ticksPerQuarterNote()*4 : 0);
+    // track 0 holds tempo and other global events. Tracks past what the sequencer can play end up in track 1
+    return std::min(std::max(64, sequence->getTrackAmount() + 1), (int)jdksmidi::MIDISequencerState::MAX_TRACKS);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void AriaMaestosa::setJDKMidiTrackPort(jdksmidi::MIDITrack* track, const int port)
+{
+    jdksmidi::MIDITimedBigMessage m;
+    m.SetTime( 0 );
+    m.SetMetaEvent( jdksmidi::META_OUTPUT_CABLE, port, 0 );
+    m.SetDataLength( 1 );
     
-    if (selectionOnly)
+    if (not track->PutEvent( m ))
     {
-        //  ---- add events to tracks
-        trackLength = sequence->getCurrentTrack()->addMidiEvents(tracks.GetTrack(sequence->getCurrentTrackID() + 1),
-                                                                 channel,
-                                                                 md->getFirstMeasure(),
-                                                                 true,
-                                                                 *startTick );
-        
-        substract_ticks = *startTick;
-        
-        if (trackLength == -1) return -1; // nothing to play in track (empty track - play nothing)
-        
-        if (sequence->isLoopEnabled())
-        {
-            // when looping, stop at the measure marked as loop end
-            *songLengthInTicks = md->lastTickInMeasure(md->getLoopEndMeasure()) - substract_ticks;
-        }
-        else
-        {
-            // Add some time at the end for notes to fade out
-            *songLengthInTicks = trackLength + sequence->ticksPerQuarterNote()*2;
-        }
+        std::cerr << "Error adding port event" << std::endl;
     }
-    else
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int AriaMaestosa::getJDKMidiTrackPorts(const jdksmidi::MIDIMultiTrack& tracks, std::vector<int>& ports)
+{
+    int portAmount = 1;
+    
+    const int trackCount = tracks.GetNumTracks();
+    ports.assign(trackCount, 0);
+    for (int t=0; t<trackCount; t++)
     {
-        // play from beginning
-        (*startTick) = -1;
-        
-        const int trackAmount = sequence->getTrackAmount();
-        for (int n=0; n<trackAmount; n++)
+        const jdksmidi::MIDITrack* track = tracks.GetTrack(t);
+        const int eventCount = track->GetNumEvents();
+        for (int n=0; n<eventCount; n++)
         {
-            bool drum_track = (sequence->getTrack(n)->isNotationTypeEnabled(DRUM));
-            
-            int trackFirstNote = -1;
-            
-            if (n+1 < tracks.GetNumTracks())
-            {
-                trackLength = sequence->getTrack(n)->addMidiEvents(tracks.GetTrack(n+1), (drum_track ? 9 : channel),
-                                                                   md->getFirstMeasure(), false,
-                                                                   trackFirstNote );
-            }
-            else
-            {
-                if (not tooManyChannelsMessageShown)
-                {
-                    if (WaitWindow::isShown()) WaitWindow::hide();
-                    wxMessageBox(_("WARNING: this song has too many\nchannels, expect unpredictable output"));
-                    std::cout << "WARNING: this song has too many channels, expect unpredictable output" << std::endl;
-                    tooManyChannelsMessageShown = true;
-                }
-                trackLength = sequence->getTrack(n)->addMidiEvents(tracks.GetTrack(1), (drum_track ? 9 : channel),
-                                                                   md->getFirstMeasure(), false,
-                                                                   trackFirstNote );
-            }
-            
-            if ((trackFirstNote<(*startTick) and trackFirstNote != -1) or (*startTick) == -1)
-            {
-                (*startTick) = trackFirstNote;
-            }
-            
-            
-            if (trackLength == -1) continue; // nothing to play in track (empty track - skip it)
-            if (trackLength > *songLengthInTicks) *songLengthInTicks = trackLength;
-            
-            if (not drum_track)
+            const jdksmidi::MIDITimedBigMessage* msg = track->GetEventAddress(n);
+            if (msg->IsMetaEvent() and msg->GetMetaType() == jdksmidi::META_OUTPUT_CABLE)
             {
-                if (channel > 15 and sequence->getChannelManagementType() == CHANNEL_AUTO)
-                {
-                    if (not tooManyChannelsMessageShown)
-                    {
-                        if (WaitWindow::isShown()) WaitWindow::hide();
-                        wxMessageBox(_("WARNING: this song has too many\nchannels, expect unpredictable output"));
-                        std::cout << "WARNING: this song has too many channels, expect unpredictable output" << std::endl;
-                        tooManyChannelsMessageShown = true;
-                    }
-                    channel = 0;
-                }
-                channel++; if (channel==9) channel++;
+                ports[t] = msg->GetByte2();
+                portAmount = std::max(portAmount, ports[t] + 1);
+                break;
             }
         }
-        
-        if (sequence->isLoopEnabled())
-        {
-            // when looping, stop at the measure marked as loop end
-            *songLengthInTicks = md->lastTickInMeasure(md->getLoopEndMeasure()) - *startTick;
-        }
-        
-        substract_ticks = *startTick;
-        
     }
     
-    
-    if (*songLengthInTicks < 1) return -1; // nothing to play at all (empty song - play nothing)
-    *numTracks = sequence->getTrackAmount()+1;
+    return portAmount;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+/**
+  * @brief add the global events (tempo, key and time signatures, song info, lyrics) to the track that holds
+  *        them, track 0
+  */
+static bool addConductorEvents(Sequence* sequence, jdksmidi::MIDITrack* conductor, const bool playing,
+                               const int substract_ticks)
+{
+    MeasureData* md = sequence->getMeasureData();
     
     // ---- default tempo
     
@@ -495,7 +412,7 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
         m.SetTime( 0 );
         m.SetTempo32( sequence->getTempo() * 32 ); // tempo stored as bpm * 32, giving 1/32 bpm resolution
         
-        if (not tracks.GetTrack(0)->PutEvent( m ))
+        if (not conductor->PutEvent( m ))
         {
             std::cerr << "Error adding tempo event" << std::endl;
             return false;
@@ -525,7 +442,7 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
         // TODO : handle mode (major or minor)
         m.SetKeySig(amount,0);
    
-        if (not tracks.GetTrack(0)->PutEvent( m ))
+        if (not conductor->PutEvent( m ))
         {
             std::cerr << "Error adding key signature event" << std::endl;
             return false;
@@ -551,7 +468,7 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
             m.CopySysEx( &sysex );
             m.SetTime( 0 );
             
-            if (not tracks.GetTrack(0)->PutEvent( m ))
+            if (not conductor->PutEvent( m ))
             {
                 std::cerr << "Error adding copyright sysex event" << std::endl;
                 return false;
@@ -573,7 +490,7 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
             m.CopySysEx( &sysex );
             m.SetTime( 0 );
             
-            if (not tracks.GetTrack(0)->PutEvent( m ))
+            if (not conductor->PutEvent( m ))
             {
                 std::cerr << "Error adding songname sysex event" << std::endl;
                 return false;
@@ -595,14 +512,15 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
             int i;
             int m_count;
             MeasureData* m_md;
-            jdksmidi::MIDIMultiTrack& m_tracks;
+            jdksmidi::MIDITrack* m_conductor;
             int m_substract_ticks;
             
         public:
             
-            TimeSigSource(MeasureData* pmd, jdksmidi::MIDIMultiTrack& ptracks, int psubstract_ticks) : m_tracks(ptracks)
+            TimeSigSource(MeasureData* pmd, jdksmidi::MIDITrack* pconductor, int psubstract_ticks)
             {
                 i = 0;
+                m_conductor = pconductor;
                 m_count = pmd->getTimeSigAmount();
                 m_md = pmd;
                 m_substract_ticks = psubstract_ticks;
@@ -620,7 +538,7 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
             }
             virtual void pop()
             {
-                addTimeSigFromVector(i, m_count, m_md, m_tracks, m_substract_ticks);
+                addTimeSigFromVector(i, m_count, m_md, m_conductor, m_substract_ticks);
                 i++;
             }
         };
@@ -629,14 +547,15 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
             int i;
             int m_count;
             Sequence* m_seq;
-            jdksmidi::MIDIMultiTrack& m_tracks;
+            jdksmidi::MIDITrack* m_conductor;
             int m_substract_ticks;
             
         public:
             
-            TempoEvtSource(Sequence* seq, jdksmidi::MIDIMultiTrack& ptracks, int psubstract_ticks) : m_tracks(ptracks)
+            TempoEvtSource(Sequence* seq, jdksmidi::MIDITrack* pconductor, int psubstract_ticks)
             {
                 i = 0;
+                m_conductor = pconductor;
                 m_count = seq->getTempoEventAmount();
                 m_seq = seq;
                 m_substract_ticks = psubstract_ticks;
@@ -654,7 +573,7 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
             }
             virtual void pop()
             {
-                addTempoEventFromSequenceVector(i, m_count, m_seq, m_tracks, m_substract_ticks);
+                addTempoEventFromSequenceVector(i, m_count, m_seq, m_conductor, m_substract_ticks);
                 i++;
             }
         };
@@ -663,14 +582,15 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
             int i;
             int m_count;
             Sequence* m_seq;
-            jdksmidi::MIDIMultiTrack& m_tracks;
+            jdksmidi::MIDITrack* m_conductor;
             int m_substract_ticks;
             
         public:
             
-            TextEvtSource(Sequence* seq, jdksmidi::MIDIMultiTrack& ptracks, int psubstract_ticks) : m_tracks(ptracks)
+            TextEvtSource(Sequence* seq, jdksmidi::MIDITrack* pconductor, int psubstract_ticks)
             {
                 i = 0;
+                m_conductor = pconductor;
                 m_count = seq->getTextEvents().size();
                 m_seq = seq;
                 m_substract_ticks = psubstract_ticks;
@@ -688,16 +608,16 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
             }
             virtual void pop()
             {
-                addTextEventFromSequenceVector(i, m_seq, m_tracks, m_substract_ticks);
+                addTextEventFromSequenceVector(i, m_seq, m_conductor, m_substract_ticks);
                 i++;
             }
         };
         
         {
             ptr_vector<IMergeSource> sources;
-            sources.push_back( new TimeSigSource(md, tracks, substract_ticks) );
-            sources.push_back( new TempoEvtSource(sequence, tracks, substract_ticks) );
-            sources.push_back( new TextEvtSource(sequence, tracks, substract_ticks) );
+            sources.push_back( new TimeSigSource(md, conductor, substract_ticks) );
+            sources.push_back( new TempoEvtSource(sequence, conductor, substract_ticks) );
+            sources.push_back( new TextEvtSource(sequence, conductor, substract_ticks) );
             merge( sources );
         }
     }
@@ -707,10 +627,451 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
         const int amount = sequence->getTempoEventAmount();
         for (int n=0; n<amount; n++)
         {
-            addTempoEventFromSequenceVector(n, amount, sequence, tracks, substract_ticks);
+            addTempoEventFromSequenceVector(n, amount, sequence, conductor, substract_ticks);
+        }
+    }
+    
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+namespace AriaMaestosa
+{
+    /** @brief encode a libjdkmidi track as a MIDI file track chunk, like MIDIFileWriteMultiTrack does */
+    static bool encodeTrackChunk(const jdksmidi::MIDITrack& track, MidiToMemoryStream* out)
+    {
+        if (not track.EventsOrderOK())
+        {
+            fprintf(stderr, "[exportMidiFile] events out of order\n");
+            return false;
         }
+        
+        jdksmidi::MIDIFileWrite writer(out);
+        writer.WriteTrackHeader( 0 ); // the length is written once known, see RewriteTrackLength
+        
+        jdksmidi::MIDIClockTime ev_time = 0;
+        const int eventAmount = track.GetNumEvents();
+        for (int n=0; n<eventAmount; n++)
+        {
+            const jdksmidi::MIDITimedBigMessage* ev = track.GetEventAddress(n);
+            if (ev->IsNoOp()) continue;
+            
+            ev_time = ev->GetTime();
+            if (ev->IsDataEnd()) break;
+            
+            writer.WriteEvent( *ev );
+            if (writer.ErrorOccurred()) return false;
+        }
+        
+        writer.WriteEndOfTrack( ev_time );
+        writer.RewriteTrackLength();
+        return not writer.ErrorOccurred();
     }
     
+    // ----------------------------------------------------------------------------------------------------------
+    
+    static bool writeToFile(wxFFile& file, MidiToMemoryStream& data)
+    {
+        const size_t length = data.getDataLength();
+        return file.Write(data.getData(), length) == length;
+    }
+    
+    // ----------------------------------------------------------------------------------------------------------
+    
+    /**
+      * @brief Writes a sequence as a MIDI file one track chunk at a time
+      *
+      * Each track is converted to a libjdkmidi track of its own and encoded, then written out and freed,
+      * so the whole song is never held as a jdksmidi::MIDIMultiTrack. Worker threads convert and encode
+      * tracks a little ahead of the one being written ; the calling thread writes them in order.
+      */
+    class StreamingMidiExport
+    {
+        Sequence* m_sequence;
+        const ChannelAllocator& m_channels;
+        
+        /** tick of the event added to each track to mark the declared end of the song, or -1 */
+        int m_end_tick;
+        
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        
+        /** encoded track chunks, NULL until encoded and again once written */
+        std::vector<MidiToMemoryStream*> m_chunks;
+        std::vector<bool> m_encoded;
+        
+        int  m_next_track;
+        int  m_written_amount;
+        
+        /** how many tracks may be encoded ahead of the one being written */
+        int  m_window;
+        
+        /** how many worker threads are started, -1 for one per core */
+        int  m_thread_amount;
+        bool m_failed;
+        
+        void encodeTracks()
+        {
+            const int trackAmount = m_chunks.size();
+            std::unique_lock<std::mutex> lock(m_mutex);
+            
+            while (true)
+            {
+                while (not m_failed and m_next_track < trackAmount and
+                       m_next_track >= m_written_amount + m_window)
+                {
+                    m_condition.wait(lock);
+                }
+                if (m_failed or m_next_track >= trackAmount) return;
+                
+                const int n = m_next_track++;
+                lock.unlock();
+                
+                MidiToMemoryStream* chunk = new MidiToMemoryStream();
+                bool success;
+                {
+                    jdksmidi::MIDITrack midiTrack;
+                    if (m_channels.getUsedPortAmount() > 1) setJDKMidiTrackPort(&midiTrack, m_channels.getPort(n));
+                    
+                    // muted tracks send no events, whatever channel they are given
+                    int trackFirstNote = -1;
+                    m_sequence->getTrack(n)->addMidiEvents(&midiTrack, std::max(0, m_channels.getChannel(n)),
+                                                           0 /* first measure */, false, trackFirstNote);
+                    
+                    if (m_end_tick != -1)
+                    {
+                        jdksmidi::MIDITimedBigMessage m;
+                        m.SetTime( m_end_tick - 1 ); // -1 to not open a new measure when importing back
+                        m.SetControlChange(0, 127, 0);
+                        
+                        if (not midiTrack.PutEvent( m ))
+                        {
+                            std::cerr << "Error adding dummy end midi event!" << std::endl;
+                        }
+                    }
+                    
+                    success = encodeTrackChunk(midiTrack, chunk);
+                }
+                
+                lock.lock();
+                m_chunks[n]  = chunk;
+                m_encoded[n] = true;
+                if (not success) m_failed = true;
+                m_condition.notify_all();
+            }
+        }
+        
+    public:
+        
+        /** @param threadAmount  how many worker threads encode tracks, or -1 for one per core */
+        StreamingMidiExport(Sequence* sequence, const ChannelAllocator& channels, const int endTick,
+                            const int threadAmount) :
+            m_channels(channels)
+        {
+            m_sequence       = sequence;
+            m_end_tick       = endTick;
+            m_thread_amount  = threadAmount;
+            m_next_track     = 0;
+            m_written_amount = 0;
+            m_window         = 1;
+            m_failed         = false;
+        }
+        
+        ~StreamingMidiExport()
+        {
+            for (unsigned int n=0; n<m_chunks.size(); n++) delete m_chunks[n];
+        }
+        
+        bool write(wxFFile& file)
+        {
+            const int trackAmount = m_sequence->getTrackAmount();
+            
+            // ---- header and track 0
+            {
+                MidiToMemoryStream header;
+                jdksmidi::MIDIFileWrite writer(&header);
+                writer.WriteFileHeader( (trackAmount + 1 > 1 ? 1 : 0), trackAmount + 1,
+                                        m_sequence->ticksPerQuarterNote() );
+                
+                jdksmidi::MIDITrack conductor;
+                MidiToMemoryStream conductorChunk;
+                if (not addConductorEvents(m_sequence, &conductor, false /* playing */, 0)) return false;
+                if (not encodeTrackChunk(conductor, &conductorChunk)) return false;
+                
+                if (not writeToFile(file, header) or not writeToFile(file, conductorChunk)) return false;
+            }
+            
+            if (trackAmount == 0) return true;
+            
+            // ---- tracks
+            m_chunks.assign(trackAmount, NULL);
+            m_encoded.assign(trackAmount, false);
+            
+            const int maxThreads   = (m_thread_amount == -1 ? (int)std::thread::hardware_concurrency() : m_thread_amount);
+            const int threadAmount = std::max(1, std::min(maxThreads, trackAmount));
+            m_window = threadAmount * 2;
+            
+            std::vector<std::thread> threads;
+            for (int n=0; n<threadAmount; n++)
+            {
+                threads.push_back( std::thread(&StreamingMidiExport::encodeTracks, this) );
+            }
+            
+            bool success = true;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                for (int n=0; n<trackAmount and success; n++)
+                {
+                    while (not m_encoded[n] and not m_failed) m_condition.wait(lock);
+                    if (m_failed)
+                    {
+                        success = false;
+                        break;
+                    }
+                    
+                    MidiToMemoryStream* chunk = m_chunks[n];
+                    m_chunks[n] = NULL;
+                    
+                    lock.unlock();
+                    success = writeToFile(file, *chunk);
+                    delete chunk;
+                    lock.lock();
+                    
+                    m_written_amount++;
+                    if (not success) m_failed = true;
+                    m_condition.notify_all();
+                }
+            }
+            
+            for (unsigned int n=0; n<threads.size(); n++) threads[n].join();
+            return success;
+        }
+    };
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool AriaMaestosa::exportMidiFile(Sequence* sequence, wxString filepath, const bool interactive,
+                                  const int threadAmount)
+{
+    // when we're saving, we always want song to start at first measure, so temporarly switch
+    // firstMeasure to 0, and set it back in the end
+    MeasureData* md = sequence->getMeasureData();
+    const int firstMeasureValue = md->getFirstMeasure();
+    md->setFirstMeasure(0);
+    
+    // in manual mode, tracks use the channel chosen by the user (see Track::addMidiEvents), on the first port
+    const bool auto_channels = (sequence->getChannelManagementType() == CHANNEL_AUTO);
+    ChannelAllocator channels(sequence, (auto_channels ? (int)ChannelAllocator::MAX_PORTS : 1));
+    
+    if (auto_channels and channels.isOverflowing())
+    {
+        if (interactive)
+        {
+            if (WaitWindow::isShown()) WaitWindow::hide();
+            wxMessageBox(_("WARNING: this song has too many\nchannels, expect unpredictable output"));
+        }
+        std::cout << "WARNING: this song has too many channels, expect unpredictable output" << std::endl;
+    }
+    
+    // an event is added at the declared end of the song, to account for empty measures at the end. Since
+    // tracks are written one at a time, the song length is found beforehand
+    int songLength = 0;
+    const int trackAmount = sequence->getTrackAmount();
+    for (int n=0; n<trackAmount; n++)
+    {
+        songLength = std::max(songLength, sequence->getTrack(n)->getMidiEventsLength());
+    }
+    
+    const int endTick = md->lastTickInMeasure(md->getMeasureAmount() - 1);
+    
+    bool success = false;
+    {
+        wxFFile file(filepath, wxT("wb"));
+        if (file.IsOpened())
+        {
+            StreamingMidiExport exporter(sequence, channels, (endTick > songLength + 1 ? endTick : -1),
+                                         threadAmount);
+            success = exporter.write(file);
+            if (not file.Close()) success = false;
+        }
+    }
+    
+    if (not success)
+    {
+        fprintf(stderr, "[exportMidiFile] Error writing midi file\n");
+        if (wxFileExists(filepath)) wxRemoveFile(filepath);
+    }
+    
+    md->setFirstMeasure(firstMeasureValue);
+    return success;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+UNIT_TEST( StreamedTrackChunksTest )
+{
+    jdksmidi::MIDIMultiTrack tracks( 3 );
+    
+    jdksmidi::MIDITimedBigMessage m;
+    m.SetTime( 0 );
+    m.SetTempo32( 120 * 32 );
+    tracks.GetTrack(0)->PutEvent( m );
+    
+    for (int t=1; t<3; t++)
+    {
+        for (int n=0; n<100; n++)
+        {
+            m.SetTime( n*10 );
+            m.SetNoteOn( t, 60 + n % 12, 100 );
+            tracks.GetTrack(t)->PutEvent( m );
+            
+            m.SetTime( n*10 + 5 );
+            m.SetNoteOff( t, 60 + n % 12, 0 );
+            tracks.GetTrack(t)->PutEvent( m );
+        }
+    }
+    
+    MidiToMemoryStream whole;
+    jdksmidi::MIDIFileWriteMultiTrack writer( &tracks, &whole );
+    require( writer.Write(3, 960), "The reference file was written" );
+    
+    std::string streamed;
+    {
+        MidiToMemoryStream header;
+        jdksmidi::MIDIFileWrite headerWriter( &header );
+        headerWriter.WriteFileHeader( 1, 3, 960 );
+        streamed.append( header.getData(), header.getDataLength() );
+    }
+    for (int t=0; t<3; t++)
+    {
+        MidiToMemoryStream chunk;
+        require( encodeTrackChunk(*tracks.GetTrack(t), &chunk), "The track was encoded" );
+        streamed.append( chunk.getData(), chunk.getDataLength() );
+    }
+    
+    require( streamed == std::string(whole.getData(), whole.getDataLength()),
+             "Tracks encoded one by one give the same file as the whole sequence at once" );
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTrack& tracks, bool selectionOnly,
+                                       /*out*/int* songLengthInTicks, /*out*/int* startTick,
+                                       /*out*/ int* numTracks, bool playing, const int portAmount)
+{
+    int trackLength = -1;
+    const int channel = 0;
+    
+    int substract_ticks;
+    const bool addMetronome = (sequence->playWithMetronome() and playing);
+    
+    tracks.SetClksPerBeat( sequence->ticksPerQuarterNote() );
+    
+    MeasureData* md = sequence->getMeasureData();
+    
+    bool tooManyChannelsMessageShown = false;
+    
+    const int past_end_time = (playing and not sequence->isLoopEnabled() ? sequence->ticksPerQuarterNote()*4 : 0);
+    
+    if (selectionOnly)
+    {
+        //  ---- add events to tracks
+        trackLength = sequence->getCurrentTrack()->addMidiEvents(tracks.GetTrack(sequence->getCurrentTrackID() + 1),
+                                                                 channel,
+                                                                 md->getFirstMeasure(),
+                                                                 true,
+                                                                 *startTick );
+        
+        substract_ticks = *startTick;
+        
+        if (trackLength == -1) return -1; // nothing to play in track (empty track - play nothing)
+        
+        if (sequence->isLoopEnabled())
+        {
+            // when looping, stop at the measure marked as loop end
+            *songLengthInTicks = md->lastTickInMeasure(md->getLoopEndMeasure()) - substract_ticks;
+        }
+        else
+        {
+            // Add some time at the end for notes to fade out
+            *songLengthInTicks = trackLength + sequence->ticksPerQuarterNote()*2;
+        }
+    }
+    else
+    {
+        // play from beginning
+        (*startTick) = -1;
+        
+        // in manual mode, tracks use the channel chosen by the user (see Track::addMidiEvents), on the first port
+        const bool auto_channels = (sequence->getChannelManagementType() == CHANNEL_AUTO);
+        ChannelAllocator channels(sequence, (auto_channels ? portAmount : 1));
+        
+        if (auto_channels and channels.isOverflowing())
+        {
+            if (WaitWindow::isShown()) WaitWindow::hide();
+            wxMessageBox(_("WARNING: this song has too many\nchannels, expect unpredictable output"));
+            std::cout << "WARNING: this song has too many channels, expect unpredictable output" << std::endl;
+            tooManyChannelsMessageShown = true;
+        }
+        
+        const int trackAmount = sequence->getTrackAmount();
+        for (int n=0; n<trackAmount; n++)
+        {
+            int trackFirstNote = -1;
+            
+            // muted tracks send no events, whatever channel they are given
+            const int trackChannel = std::max(0, channels.getChannel(n));
+            
+            if (n+1 < tracks.GetNumTracks())
+            {
+                if (channels.getUsedPortAmount() > 1) setJDKMidiTrackPort(tracks.GetTrack(n+1), channels.getPort(n));
+                
+                trackLength = sequence->getTrack(n)->addMidiEvents(tracks.GetTrack(n+1), trackChannel,
+                                                                   md->getFirstMeasure(), false,
+                                                                   trackFirstNote );
+            }
+            else
+            {
+                if (not tooManyChannelsMessageShown)
+                {
+                    if (WaitWindow::isShown()) WaitWindow::hide();
+                    wxMessageBox(_("WARNING: this song has too many\nchannels, expect unpredictable output"));
+                    std::cout << "WARNING: this song has too many channels, expect unpredictable output" << std::endl;
+                    tooManyChannelsMessageShown = true;
+                }
+                trackLength = sequence->getTrack(n)->addMidiEvents(tracks.GetTrack(1), trackChannel,
+                                                                   md->getFirstMeasure(), false,
+                                                                   trackFirstNote );
+            }
+            
+            if ((trackFirstNote<(*startTick) and trackFirstNote != -1) or (*startTick) == -1)
+            {
+                (*startTick) = trackFirstNote;
+            }
+            
+            
+            if (trackLength == -1) continue; // nothing to play in track (empty track - skip it)
+            if (trackLength > *songLengthInTicks) *songLengthInTicks = trackLength;
+        }
+        
+        if (sequence->isLoopEnabled())
+        {
+            // when looping, stop at the measure marked as loop end
+            *songLengthInTicks = md->lastTickInMeasure(md->getLoopEndMeasure()) - *startTick;
+        }
+        
+        substract_ticks = *startTick;
+        
+    }
+    
+    
+    if (*songLengthInTicks < 1) return -1; // nothing to play at all (empty song - play nothing)
+    *numTracks = sequence->getTrackAmount()+1;
+    
+    if (not addConductorEvents(sequence, tracks.GetTrack(0), playing, substract_ticks)) return false;
+    
     
     
     // ---- add dummy event after the actual end to ensure it doesn't stop playing too quickly
@@ -920,7 +1281,7 @@ void AriaMaestosa::allocAsMidiBytes(Sequence* sequence, bool selectionOnly, /*ou
 {
     int numTracks = -1;
     
-    jdksmidi::MIDIMultiTrack tracks;
+    jdksmidi::MIDIMultiTrack tracks( getJDKMidiTrackCapacity(sequence) );
     
     makeJDKMidiSequence(sequence, tracks, selectionOnly, songlength, startTick, &numTracks, playing);
     
@@ -963,78 +1324,47 @@ float AriaMaestosa::convertBPMToTempoBend(float tempo)
 
 int AriaMaestosa::getTimeAtTick(int tick, const Sequence* seq)
 {
-    std::vector<float> tempos;
-    std::vector<int> duration;
-    
-    const int tempo_events_amount = seq->getTempoEventAmount();
-    //std::cout << "tempo_events_amount = " << tempo_events_amount << std::endl;
-    if (tempo_events_amount < 1 or (tempo_events_amount == 1 and seq->getTempoEvent(0)->getTick() == 0) )
-    {
-        tempos.push_back(seq->getTempo());
-        duration.push_back(tick);
-    }
-    else
-    {
-        // multiple tempo changes
-        
-        if (tick > seq->getTempoEvent(0)->getTick())
-        {
-            // from beginning to first event
-            tempos.push_back(seq->getTempo());
-            duration.push_back(seq->getTempoEvent(0)->getTick());
-            
-            //std::cout << "Firstly, " << (seq->tempoEvents[0].getTick()) << " ticks at " << seq->getTempo() << std::endl;
-            
-            // other events
-            int n;
-            for (n = 1; n<tempo_events_amount; n++)
-            {
-                if (seq->getTempoEvent(n)->getTick() > tick)
-                {
-                    // this tempo event is only partially used, remove what we had calculated and just to the next part
-                    tempos.pop_back();
-                    duration.pop_back();
-                    break;
-                }
-                else
-                {
-                    tempos.push_back( convertTempoBendToBPM(seq->getTempoEvent(n-1)->getValue()) );
-                    duration.push_back(seq->getTempoEvent(n)->getTick() - seq->getTempoEvent(n-1)->getTick());
-                }
-                //std::cout << (duration[duration.size()-1]) << " ticks at " << (tempos[tempos.size()-1]) << std::endl;
-            }
-            
-            if (seq->getTempoEvent(n-1)->getTick() <= tick)
-            {
-                // after last event
-                tempos.push_back( convertTempoBendToBPM(seq->getTempoEvent(n-1)->getValue()) );
-                duration.push_back( tick - seq->getTempoEvent(n-1)->getTick() );
-            }
-        }
-        else
-        {
-            // tick is before the first event!
-            tempos.push_back(seq->getTempo());
-            duration.push_back(tick);
-        }
-        
-        //std::cout << "Finally, " << (duration[duration.size()-1]) << " ticks at " << (tempos[tempos.size()-1]) << std::endl;
-    }
+    return (int)round(seq->getTimeInSecondsAtTick(tick));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+double AriaMaestosa::getTimeInSecondsAtTick(int tick, const Sequence* seq)
+{
+    return seq->getTimeInSecondsAtTick(tick);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int AriaMaestosa::getTickAtTimeInSeconds(double seconds, const Sequence* seq)
+{
+    return seq->getTickAtTimeInSeconds(seconds);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+UNIT_TEST( TempoMapTest )
+{
+    OwnerPtr<Sequence> seq( new Sequence(NULL, NULL, NULL, NULL, false) );
+    seq->addTrack( new Track(seq) );
+    seq->setTicksPerQuarterNote(960);
+    seq->setTempo(120);
     
+    const int   bend = 100;
+    const float bpm  = convertTempoBendToBPM(bend);
+    seq->addTempoEvent( new ControllerEvent(PSEUDO_CONTROLLER_TEMPO, 1920, bend), NULL );
     
-    float song_duration = 0;
-    const int amount = tempos.size();
-    for (int n=0; n<amount; n++)
-    {
-        //printf("%i for %i\n", tempos[n], duration[n]);
-        
-        // std::cout << " -- adding " << (int)round( ((float)duration[n] * 60.0f ) / ((float)seq->ticksPerQuarterNote() * (float)tempos[n])) << std::endl;
-        song_duration += ((float)duration[n] * 60.0f ) / ((float)seq->ticksPerQuarterNote() * (float)tempos[n]);
-    }
+    require( fabs(seq->getTimeInSecondsAtTick(1920) - 1.0) < 0.0001, "Two beats at 120 BPM last one second" );
+    require( fabs(seq->getTimeInSecondsAtTick(2880) - (1.0 + 60.0/bpm)) < 0.0001,
+             "The tempo event applies from its tick on" );
+    require( seq->getTickAtTimeInSeconds(1.0 + 60.0/bpm) == 2880, "Seconds are converted back to ticks" );
+    require( seq->getTempoAtTick(1919) == 120, "The main tempo applies before the first event" );
+    require( seq->getTempoAtTick(1920) == bpm, "The tempo event applies from its tick on" );
     
-    //wxString duration_label = wxString::Format(wxString(_("Song duration :")) + wxT("  %i:%.2i"), (int)(song_duration/60), song_duration%60);
-    //songLength->SetLabel(duration_label);
+    seq->setTempo(60);
+    require( fabs(seq->getTimeInSecondsAtTick(1920) - 2.0) < 0.0001, "The tempo map follows main tempo changes" );
     
-    return (int)round(song_duration);
+    seq->addTempoEvent( new ControllerEvent(PSEUDO_CONTROLLER_TEMPO, 960, bend), NULL );
+    require( fabs(seq->getTimeInSecondsAtTick(1920) - (1.0 + 60.0/bpm)) < 0.0001,
+             "The tempo map follows new tempo events" );
 }
-
@@ -20,9 +20,10 @@
 /** @defgroup midi */
 
 #include <wx/string.h>
+#include <vector>
 
 // forward
-namespace jdksmidi{ class MIDIMultiTrack; }
+namespace jdksmidi{ class MIDIMultiTrack; class MIDITrack; }
 
 namespace AriaMaestosa
 {
@@ -37,16 +38,50 @@ namespace AriaMaestosa
     
     /**
       * @brief write a midi file
+      *
+      * Unlike makeJDKMidiSequence, the song is never held in memory as a whole : tracks are converted and
+      * encoded one by one (on several threads), and each is written as soon as it is ready.
+      * @param interactive   whether problems with the song are reported in a dialog ; otherwise they are only
+      *                      printed, so that the export may run without a GUI or on a worker thread
+      * @param threadAmount  how many threads encode tracks, or -1 for one per core
       * @ingroup midi
       */
-    bool exportMidiFile(Sequence* sequence, wxString filepath);
+    bool exportMidiFile(Sequence* sequence, wxString filepath, const bool interactive = true,
+                        const int threadAmount = -1);
     
     /**
       * @brief converts an Aria sequence into a libjdkmidi sequence
+      *
+      * In automatic channel mode, channels are chosen by ChannelAllocator. When the tracks need more
+      * than one port, each track of the libjdkmidi sequence starts with a 'MIDI port' meta event
+      * (see getJDKMidiTrackPorts).
+      * @param portAmount  how many MIDI ports the output has
       * @ingroup midi
       */
     bool makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTrack& tracks, bool selectionOnly,
-                             /*out*/int* songLengthInTicks, /*out*/int* startTick, /*out*/ int* numTracks, bool playing);
+                             /*out*/int* songLengthInTicks, /*out*/int* startTick, /*out*/ int* numTracks, bool playing,
+                             const int portAmount = 1);
+    
+    /**
+      * @return how many tracks a libjdkmidi sequence needs to hold the given sequence, to be given to the
+      *         MIDIMultiTrack constructor
+      * @ingroup midi
+      */
+    int getJDKMidiTrackCapacity(Sequence* sequence);
+    
+    /**
+      * @brief add a 'MIDI port' meta event at the start of the given track
+      * @ingroup midi
+      */
+    void setJDKMidiTrackPort(jdksmidi::MIDITrack* track, const int port);
+    
+    /**
+      * @brief           find on which port each track of a libjdkmidi sequence plays
+      * @param[out] ports receives the port of each track, 0 for tracks that have no 'MIDI port' meta event
+      * @return          how many ports are used
+      * @ingroup midi
+      */
+    int getJDKMidiTrackPorts(const jdksmidi::MIDIMultiTrack& tracks, std::vector<int>& ports);
     
     /**
       * @brief For use with the controller editor, when entering tempo bends
@@ -62,6 +97,19 @@ namespace AriaMaestosa
       */
     int getTimeAtTick(int tick, const Sequence* seq);
     
+    /**
+      * @ingroup midi
+      * @return Time elapsed from start of song to given tick, in seconds, without rounding
+      */
+    double getTimeInSecondsAtTick(int tick, const Sequence* seq);
+    
+    /**
+      * @ingroup midi
+      * @brief  Inverse of getTimeInSecondsAtTick, considering all tempo changes
+      * @return The tick reached after the given amount of seconds have elapsed from the start of the song
+      */
+    int getTickAtTimeInSeconds(double seconds, const Sequence* seq);
+    
 }
 
 #endif
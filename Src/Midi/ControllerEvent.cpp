@@ -53,7 +53,7 @@ void ControllerEvent::setValue(wxFloat64 value)
 #pragma mark Serialization
 #endif
 
-void ControllerEvent::saveToFile(wxFileOutputStream& fileout)
+void ControllerEvent::saveToFile(wxOutputStream& fileout)
 {
 
     writeData( wxT("  <controlevent type=\"") + to_wxString(m_controller)           , fileout );
@@ -110,7 +110,7 @@ bool ControllerEvent::readFromFile(irr::io::IrrXMLReader* xml)
 
 // ----------------------------------------------------------------------------------------------------------
 
-void TextEvent::saveToFile(wxFileOutputStream& fileout)
+void TextEvent::saveToFile(wxOutputStream& fileout)
 {
     writeData( wxT("  <controlevent type=\"") + to_wxString(m_controller) , fileout );
     writeData( wxT("\" tick=\"")              + to_wxString(m_tick)       , fileout );
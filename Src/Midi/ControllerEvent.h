@@ -21,7 +21,7 @@
 #include "Renderers/RenderAPI.h"
 #include <math.h>
 
-class wxFileOutputStream;
+class wxOutputStream;
 // forward
 namespace irr { namespace io {
     class IXMLBase;
@@ -142,7 +142,7 @@ namespace AriaMaestosa
         }
         
         // ---- serialization
-        virtual void saveToFile(wxFileOutputStream& fileout);
+        virtual void saveToFile(wxOutputStream& fileout);
         virtual bool readFromFile(irr::io::IrrXMLReader* xml);
     };
     
@@ -171,7 +171,7 @@ namespace AriaMaestosa
         void setText(const wxString& t)         { m_text.getModel()->setValue( t ); }
         
         // ---- serialization
-        virtual void saveToFile(wxFileOutputStream& fileout);
+        virtual void saveToFile(wxOutputStream& fileout);
         virtual bool readFromFile(irr::io::IrrXMLReader* xml);
     };
     
@@ -0,0 +1,553 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Midi/GuitarFingering.h"
+
+#include "AriaCore.h"
+#include "Actions/ArrangeGuitarFingering.h"
+#include "GUI/MainFrame.h"
+#include "Midi/GuitarTuning.h"
+#include "Midi/Sequence.h"
+#include "Midi/Track.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+using namespace AriaMaestosa;
+
+namespace AriaMaestosa
+{
+    namespace GuitarFingering
+    {
+        /** Highest fret the solver places notes on */
+        const int MAX_FRET = 24;
+
+        /** Widest distance, in frets, that the fingers cover without moving the hand */
+        const int MAX_STRETCH = 4;
+
+        /** Most ways of playing a chord slice that are listed, and most that are kept for the Viterbi pass */
+        const int MAX_ENUMERATED = 512;
+        const int MAX_CHOICES    = 24;
+
+        /** Cost of the distance between the lowest and highest fret of a chord, per fret */
+        const float STRETCH_COST     = 1.0f;
+
+        /** Extra cost per fret beyond MAX_STRETCH */
+        const float OVERSTRETCH_COST = 10.0f;
+
+        /** Cost of playing further up the neck, per fret and per note (breaks ties towards low positions) */
+        const float HIGH_FRET_COST   = 0.05f;
+
+        /** Cost of moving the hand between two slices, per fret the fingers could not reach from where they were */
+        const float HAND_MOVE_COST   = 1.0f;
+
+        /** Cost of any change of frets between two slices, per fret (favours staying in the same place) */
+        const float FINGER_MOVE_COST = 0.1f;
+
+        /** One way of playing a chord slice */
+        struct Choice
+        {
+            /** index of the position of the first note of the slice, in the pool of positions */
+            int m_first_position;
+
+            /** cost of the choice taken alone */
+            float m_cost;
+
+            /** lowest and highest fret pressed, or -1 when only open strings are played */
+            int m_lowest, m_highest;
+        };
+
+        struct ChoiceCostOrder
+        {
+            bool operator()(const Choice& a, const Choice& b) const { return a.m_cost < b.m_cost; }
+        };
+
+        /** Notes that start on the same tick */
+        struct Slice
+        {
+            int m_first_note, m_note_count;
+            int m_first_choice, m_choice_count;
+        };
+
+        /** Where the choices of the slice being examined are listed */
+        struct EnumerationContext
+        {
+            const std::vector<int>* m_tuning;
+
+            /** pitch IDs of the notes of the slice */
+            const int* m_pitch_IDs;
+            int m_note_count;
+
+            std::vector<Position> m_current;
+            std::vector<bool>     m_string_used;
+
+            /** choices found; their positions are stored one after the other in 'm_positions' */
+            std::vector<Choice>   m_choices;
+            std::vector<Position> m_positions;
+        };
+    }
+}
+
+#if 0
+#pragma mark -
+#pragma mark Solver
+#endif
+
+// ----------------------------------------------------------------------------------------------------------
+
+GuitarFingering::Position GuitarFingering::findNearestPosition(const std::vector<int>& tuning, const int pitchID)
+{
+    ASSERT(not tuning.empty());
+
+    const int lowestString = tuning.size() - 1;
+    if (pitchID > tuning[lowestString])
+    {
+        // note is too low to appear on this tab, will have a negative fret number
+        return Position(lowestString, tuning[lowestString] - pitchID);
+    }
+
+    // find string that can hold the value with the smallest fret number possible
+    int nearest  = -1;
+    int distance = 1000;
+
+    for (int n=0; n<(int)tuning.size(); n++)
+    {
+        // exact match (note can be played on a string at fret 0)
+        if (tuning[n] == pitchID) return Position(n, 0);
+
+        if (tuning[n] > pitchID and tuning[n] - pitchID < distance)
+        {
+            nearest  = n;
+            distance = tuning[n] - pitchID;
+        }
+    }
+
+    return Position(nearest, distance);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+namespace AriaMaestosa
+{
+    namespace GuitarFingering
+    {
+        /** @brief add the positions in 'context.m_current' to the choices of the slice */
+        static void addChoice(EnumerationContext& context)
+        {
+            int lowest  = -1;
+            int highest = -1;
+            int fretSum = 0;
+
+            for (int n=0; n<context.m_note_count; n++)
+            {
+                const int fret = context.m_current[n].m_fret;
+
+                // open strings don't need a finger
+                if (fret == 0) continue;
+
+                if (lowest  == -1 or fret < lowest)  lowest  = fret;
+                if (highest == -1 or fret > highest) highest = fret;
+                fretSum += fret;
+            }
+
+            Choice choice;
+            choice.m_first_position = context.m_positions.size();
+            choice.m_cost           = HIGH_FRET_COST * fretSum;
+
+            choice.m_lowest         = lowest;
+            choice.m_highest        = highest;
+
+            if (lowest != -1)
+            {
+                const int span = highest - lowest;
+                choice.m_cost += STRETCH_COST * span;
+                if (span > MAX_STRETCH) choice.m_cost += OVERSTRETCH_COST * (span - MAX_STRETCH);
+            }
+
+            context.m_positions.insert(context.m_positions.end(), context.m_current.begin(),
+                                       context.m_current.begin() + context.m_note_count);
+            context.m_choices.push_back(choice);
+        }
+
+        // ----------------------------------------------------------------------------------------------------------
+
+        /** @brief list the ways to play notes 'note' to the end of the slice, each on a string of its own */
+        static void enumerateChoices(EnumerationContext& context, const int note)
+        {
+            if ((int)context.m_choices.size() >= MAX_ENUMERATED) return;
+
+            if (note == context.m_note_count)
+            {
+                addChoice(context);
+                return;
+            }
+
+            const std::vector<int>& tuning = *context.m_tuning;
+            const int pitchID = context.m_pitch_IDs[note];
+            const int stringCount = tuning.size();
+
+            for (int s=0; s<stringCount; s++)
+            {
+                const int fret = tuning[s] - pitchID;
+                if (fret < 0 or fret > MAX_FRET or context.m_string_used[s]) continue;
+
+                context.m_string_used[s] = true;
+                context.m_current[note]  = Position(s, fret);
+                enumerateChoices(context, note + 1);
+                context.m_string_used[s] = false;
+            }
+        }
+
+        // ----------------------------------------------------------------------------------------------------------
+
+        static inline float getMoveCost(const Choice& from, const Choice& to)
+        {
+            // with open strings only, the hand is free to go wherever the next slice needs it
+            if (from.m_lowest == -1 or to.m_lowest == -1) return 0.0f;
+
+            // the hand only moves if the frets of both slices can't be reached from the same place
+            const int reach = std::max(from.m_highest, to.m_highest) - std::min(from.m_lowest, to.m_lowest);
+            const int shift = std::abs(to.m_lowest + to.m_highest - from.m_lowest - from.m_highest) / 2;
+            return HAND_MOVE_COST * std::max(0, reach - MAX_STRETCH) + FINGER_MOVE_COST * shift;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GuitarFingering::solve(const std::vector<int>& tuning, const std::vector<int>& pitchIDs,
+                            const std::vector<int>& ticks, std::vector<Position>& out,
+                            const std::atomic<bool>* cancelled)
+{
+    ASSERT_E(pitchIDs.size(), ==, ticks.size());
+    ASSERT(not tuning.empty());
+
+    const int noteCount   = pitchIDs.size();
+    const int stringCount = tuning.size();
+    out.resize(noteCount);
+
+    std::vector<Slice>    slices;
+    std::vector<Choice>   choices;
+    std::vector<Position> positions;
+
+    EnumerationContext context;
+    context.m_tuning = &tuning;
+    context.m_string_used.assign(stringCount, false);
+
+    // ---- list the best ways to play each slice
+    int first = 0;
+    while (first < noteCount)
+    {
+        if (cancelled != NULL and *cancelled) return;
+
+        int end = first + 1;
+        while (end < noteCount and ticks[end] == ticks[first]) end++;
+        const int count = end - first;
+
+        context.m_choices.clear();
+        context.m_positions.clear();
+
+        if (count <= stringCount)
+        {
+            context.m_pitch_IDs  = &pitchIDs[first];
+            context.m_note_count = count;
+            context.m_current.resize(count);
+            enumerateChoices(context, 0);
+        }
+
+        if (context.m_choices.empty())
+        {
+            // the slice cannot be played as a whole; its notes are left out of the optimization
+            for (int n=first; n<end; n++) out[n] = findNearestPosition(tuning, pitchIDs[n]);
+        }
+        else
+        {
+            const int kept = std::min((int)context.m_choices.size(), MAX_CHOICES);
+            std::partial_sort(context.m_choices.begin(), context.m_choices.begin() + kept,
+                              context.m_choices.end(), ChoiceCostOrder());
+
+            Slice slice;
+            slice.m_first_note   = first;
+            slice.m_note_count   = count;
+            slice.m_first_choice = choices.size();
+            slice.m_choice_count = kept;
+            slices.push_back(slice);
+
+            for (int c=0; c<kept; c++)
+            {
+                Choice choice = context.m_choices[c];
+                const int from = choice.m_first_position;
+
+                choice.m_first_position = positions.size();
+                positions.insert(positions.end(), context.m_positions.begin() + from,
+                                 context.m_positions.begin() + from + count);
+                choices.push_back(choice);
+            }
+        }
+
+        first = end;
+    }
+
+    if (slices.empty()) return;
+
+    // ---- Viterbi pass : cheapest way to reach each choice, and which choice of the previous slice it comes from
+    std::vector<float> total(choices.size());
+    std::vector<int>   previous(choices.size(), -1);
+
+    const int sliceCount = slices.size();
+    for (int s=0; s<sliceCount; s++)
+    {
+        if (cancelled != NULL and *cancelled) return;
+
+        const Slice& slice = slices[s];
+        for (int c=slice.m_first_choice; c<slice.m_first_choice + slice.m_choice_count; c++)
+        {
+            if (s == 0)
+            {
+                total[c] = choices[c].m_cost;
+                continue;
+            }
+
+            const Slice& before = slices[s - 1];
+            float best     = std::numeric_limits<float>::max();
+            int   bestFrom = -1;
+            for (int p=before.m_first_choice; p<before.m_first_choice + before.m_choice_count; p++)
+            {
+                const float cost = total[p] + getMoveCost(choices[p], choices[c]);
+                if (cost < best)
+                {
+                    best     = cost;
+                    bestFrom = p;
+                }
+            }
+
+            total[c]    = best + choices[c].m_cost;
+            previous[c] = bestFrom;
+        }
+    }
+
+    // ---- walk back from the cheapest choice of the last slice
+    const Slice& last = slices[sliceCount - 1];
+    int choice = last.m_first_choice;
+    for (int c=last.m_first_choice + 1; c<last.m_first_choice + last.m_choice_count; c++)
+    {
+        if (total[c] < total[choice]) choice = c;
+    }
+
+    for (int s=sliceCount-1; s>=0; s--)
+    {
+        ASSERT(choice != -1);
+        const Slice& slice = slices[s];
+        for (int n=0; n<slice.m_note_count; n++)
+        {
+            out[slice.m_first_note + n] = positions[choices[choice].m_first_position + n];
+        }
+        choice = previous[choice];
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+#if 0
+#pragma mark -
+#pragma mark Background solving
+#endif
+
+namespace AriaMaestosa
+{
+    namespace GuitarFingering
+    {
+        static void collectNotes(Track* track, const bool selectionOnly, std::vector<int>& pitchIDs,
+                                 std::vector<int>& ticks)
+        {
+            const int noteAmount = track->getNoteAmount();
+            for (int n=0; n<noteAmount; n++)
+            {
+                if (selectionOnly and not track->isNoteSelected(n)) continue;
+
+                pitchIDs.push_back( track->getNotePitchID(n) );
+                ticks.push_back( track->getNoteStartInMidiTicks(n) );
+            }
+        }
+
+        // ----------------------------------------------------------------------------------------------------------
+
+        /** @return whether the track belongs to one of the open sequences */
+        static bool isTrackOpen(const Track* track)
+        {
+            MainFrame* mainFrame = getMainFrame();
+            const int sequenceAmount = mainFrame->getSequenceAmount();
+            for (int s=0; s<sequenceAmount; s++)
+            {
+                Sequence* seq = mainFrame->getSequence(s);
+                const int trackAmount = seq->getTrackAmount();
+                for (int t=0; t<trackAmount; t++)
+                {
+                    if (seq->getTrack(t) == track) return true;
+                }
+            }
+            return false;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+GuitarFingering::BackgroundSolver::BackgroundSolver(Track* track, const bool selectionOnly)
+{
+    ASSERT(track != NULL);
+
+    m_track          = track;
+    m_selection_only = selectionOnly;
+    m_tuning         = track->getGuitarTuning()->tuning;
+    m_cancelled      = false;
+    collectNotes(track, selectionOnly, m_pitch_IDs, m_ticks);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+GuitarFingering::BackgroundSolver::~BackgroundSolver()
+{
+    cancel();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool GuitarFingering::BackgroundSolver::start()
+{
+    ASSERT(not m_thread.joinable());
+    if (m_pitch_IDs.empty() or m_tuning.empty()) return false;
+
+    m_thread = std::thread(&BackgroundSolver::run, this);
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GuitarFingering::BackgroundSolver::run()
+{
+    // worker thread : only touches the data copied when the solver was created
+    solve(m_tuning, m_pitch_IDs, m_ticks, m_positions, &m_cancelled);
+
+    // when cancelled, the owner is about to delete this solver and expects no event
+    if (m_cancelled) return;
+
+    wxCommandEvent evt(wxEVT_GUITAR_FINGERING_SOLVED, wxID_ANY);
+    evt.SetClientData(this);
+    getMainFrame()->GetEventHandler()->AddPendingEvent(evt);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GuitarFingering::BackgroundSolver::apply()
+{
+    if (m_thread.joinable()) m_thread.join();
+
+    // the track may have been closed or edited while the worker was busy
+    if (not isTrackOpen(m_track)) return;
+
+    std::vector<int> pitchIDs;
+    std::vector<int> ticks;
+    collectNotes(m_track, m_selection_only, pitchIDs, ticks);
+
+    if (pitchIDs != m_pitch_IDs or ticks != m_ticks or m_track->getGuitarTuning()->tuning != m_tuning) return;
+
+    m_track->action( new Action::ArrangeGuitarFingering(m_positions, m_selection_only) );
+    Display::render();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+#if 0
+#pragma mark -
+#pragma mark Unit tests
+#endif
+
+namespace TestGuitarFingering
+{
+    using namespace AriaMaestosa;
+
+    /** standard tuning, pitch IDs as in Aria (higher pitch, smaller ID) */
+    static std::vector<int> standardTuning()
+    {
+        const int strings[] = { 131-64, 131-59, 131-55, 131-50, 131-45, 131-40 };
+        return std::vector<int>(strings, strings + 6);
+    }
+
+    UNIT_TEST(TestFingeringPlayable)
+    {
+        const std::vector<int> tuning = standardTuning();
+
+        // an ascending line with a chord in the middle
+        std::vector<int> pitchIDs;
+        std::vector<int> ticks;
+        const int line[] = { 131-55, 131-57, 131-59, 131-60, 131-62 };
+        for (int n=0; n<5; n++)
+        {
+            pitchIDs.push_back(line[n]);
+            ticks.push_back(n*100);
+        }
+        const int chord[] = { 131-48, 131-52, 131-55 };
+        for (int n=0; n<3; n++)
+        {
+            pitchIDs.push_back(chord[n]);
+            ticks.push_back(500);
+        }
+
+        std::vector<GuitarFingering::Position> positions;
+        GuitarFingering::solve(tuning, pitchIDs, ticks, positions);
+
+        require( positions.size() == pitchIDs.size(), "There is one position per note" );
+
+        for (unsigned int n=0; n<positions.size(); n++)
+        {
+            require( positions[n].m_fret >= 0, "Notes in range have a positive fret" );
+            require( tuning[positions[n].m_string] - positions[n].m_fret == pitchIDs[n],
+                     "The position plays the right pitch" );
+        }
+
+        require( positions[5].m_string != positions[6].m_string and
+                 positions[5].m_string != positions[7].m_string and
+                 positions[6].m_string != positions[7].m_string, "Notes of a chord are on distinct strings" );
+    }
+
+    UNIT_TEST(TestFingeringLargeTrack)
+    {
+        const std::vector<int> tuning = standardTuning();
+
+        std::vector<int> pitchIDs;
+        std::vector<int> ticks;
+        for (int n=0; n<20000; n++)
+        {
+            pitchIDs.push_back( 131 - (45 + (n*7) % 30) );
+            ticks.push_back( (n / 3) * 100 );
+        }
+
+        std::vector<GuitarFingering::Position> positions;
+        GuitarFingering::solve(tuning, pitchIDs, ticks, positions);
+
+        require( positions.size() == pitchIDs.size(), "There is one position per note" );
+        for (unsigned int n=0; n<positions.size(); n++)
+        {
+            require( tuning[positions[n].m_string] - positions[n].m_fret == pitchIDs[n],
+                     "The position plays the right pitch" );
+        }
+    }
+}
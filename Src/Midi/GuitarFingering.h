@@ -0,0 +1,129 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __GUITAR_FINGERING_H__
+#define __GUITAR_FINGERING_H__
+
+#include "Utils.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace AriaMaestosa
+{
+    class Track;
+
+    /**
+      * @brief Chooses on which string and fret guitar notes are played
+      *
+      * Notes starting on the same tick form a chord slice. For each slice, the possible ways of
+      * playing it (one distinct string per note) are listed and given a cost for the stretch of the
+      * hand and how high up the neck it is; a Viterbi pass then picks, over the whole track, the
+      * sequence of choices that also moves the hand the least from one slice to the next.
+      *
+      * @ingroup midi
+      */
+    namespace GuitarFingering
+    {
+        struct Position
+        {
+            int m_string;
+            int m_fret;
+
+            Position() { m_string = -1; m_fret = -1; }
+            Position(const int string, const int fret) { m_string = string; m_fret = fret; }
+        };
+
+        /**
+          * @brief the position Note::findStringAndFretFromNote has always picked : the string where the
+          *        fret number is the smallest. Notes too low for the tuning get a negative fret.
+          * @param tuning  pitch ID of each open string
+          */
+        Position findNearestPosition(const std::vector<int>& tuning, const int pitchID);
+
+        /**
+          * @brief find the positions of a sequence of notes
+          *
+          * @param tuning    pitch ID of each open string
+          * @param pitchIDs  pitch ID of each note, notes ordered by start tick
+          * @param ticks     start tick of each note
+          * @param[out] out  receives one position per note. Notes that cannot be placed within the first
+          *                  frets (or chords that have more notes than there are strings) fall back to
+          *                  findNearestPosition.
+          * @param cancelled if not NULL, solving stops as soon as it becomes true, leaving 'out' incomplete
+          */
+        void solve(const std::vector<int>& tuning, const std::vector<int>& pitchIDs,
+                   const std::vector<int>& ticks, std::vector<Position>& out,
+                   const std::atomic<bool>* cancelled = NULL);
+
+        /**
+          * @brief solves the notes of a track (all of them or the selected ones) on a worker thread
+          *
+          * Like AsyncFileLoader, the solver is owned on the main thread, and the worker is joined before
+          * the solver is deleted. When done, a wxEVT_GUITAR_FINGERING_SOLVED event (whose client data is
+          * this solver) is posted to the main frame, which then calls apply.
+          */
+        class BackgroundSolver
+        {
+            /** never dereferenced by the worker */
+            Track* m_track;
+            bool   m_selection_only;
+
+            /** what the track looked like when the solve started */
+            std::vector<int> m_tuning;
+            std::vector<int> m_pitch_IDs;
+            std::vector<int> m_ticks;
+
+            /** only accessed by the worker until it is joined */
+            std::vector<Position> m_positions;
+
+            std::atomic<bool> m_cancelled;
+            std::thread m_thread;
+
+            void run();
+
+        public:
+            LEAK_CHECK();
+
+            BackgroundSolver(Track* track, const bool selectionOnly);
+
+            /** @brief cancels solving if it is still going on, and waits for the worker to stop */
+            ~BackgroundSolver();
+
+            /**
+              * @brief starts the worker
+              * @return false if there is nothing to solve, in which case no worker is started
+              *         and no event will be posted
+              */
+            bool start();
+
+            /** @brief ask the worker to stop ; no wxEVT_GUITAR_FINGERING_SOLVED will be posted */
+            void cancel() { m_cancelled = true; }
+
+            /**
+              * @brief waits for the worker, then applies the positions as a single undoable action
+              *        (see Action::ArrangeGuitarFingering), unless the track was closed or edited
+              *        in the meantime
+              * @pre   wxEVT_GUITAR_FINGERING_SOLVED was received for this solver
+              */
+            void apply();
+        };
+    }
+
+}
+
+#endif
@@ -26,6 +26,14 @@ using namespace AriaMaestosa;
 GuitarTuning::GuitarTuning(IGuitarTuningListener* listener)
 {
     m_listener = listener;
+
+    // standard tuning by default (FIXME: don't duplicate the tuning from the tuning picker)
+    tuning.push_back( Note::findNotePitch(NOTE_7_E, PITCH_SIGN_NONE, 4) );
+    tuning.push_back( Note::findNotePitch(NOTE_7_B, PITCH_SIGN_NONE, 3) );
+    tuning.push_back( Note::findNotePitch(NOTE_7_G, PITCH_SIGN_NONE, 3) );
+    tuning.push_back( Note::findNotePitch(NOTE_7_D, PITCH_SIGN_NONE, 3) );
+    tuning.push_back( Note::findNotePitch(NOTE_7_A, PITCH_SIGN_NONE, 2) );
+    tuning.push_back( Note::findNotePitch(NOTE_7_E, PITCH_SIGN_NONE, 2) );
 }
 
 // ----------------------------------------------------------------------------------------------------------
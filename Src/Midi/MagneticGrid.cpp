@@ -85,7 +85,7 @@ void MagneticGrid::setDivider(const int newVal)
 
 // ----------------------------------------------------------------------------------------------------------
 
-void MagneticGrid::saveToFile(wxFileOutputStream& fileout)
+void MagneticGrid::saveToFile(wxOutputStream& fileout)
 {
     
     writeData( wxT("  <magneticgrid ") +
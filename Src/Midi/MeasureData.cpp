@@ -799,7 +799,7 @@ bool MeasureData::readFromFile(irr::io::IrrXMLReader* xml)
 
 // ----------------------------------------------------------------------------------------------------------
 
-void MeasureData::saveToFile(wxFileOutputStream& fileout)
+void MeasureData::saveToFile(wxOutputStream& fileout)
 {
     writeData(wxT("<measure ") +
               wxString( wxT(" firstMeasure=\"") ) + to_wxString(getFirstMeasure()),
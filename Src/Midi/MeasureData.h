@@ -22,7 +22,7 @@
 #include "Midi/TimeSigChange.h"
 #include "Utils.h"
 
-class wxFileOutputStream;
+class wxOutputStream;
 // forward
 namespace irr { namespace io {
     class IXMLBase;
@@ -386,7 +386,7 @@ namespace AriaMaestosa
         bool  readFromFile(irr::io::IrrXMLReader* xml);
         
         /** @brief serializatiuon */
-        void  saveToFile(wxFileOutputStream& fileout);
+        void  saveToFile(wxOutputStream& fileout);
         
         float getBeatSize(int measure) const;
         int getBeatCount(int measure) const;
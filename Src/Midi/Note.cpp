@@ -17,6 +17,7 @@
 #include "AriaCore.h"
 
 #include "IO/IOUtils.h"
+#include "Midi/GuitarFingering.h"
 #include "Midi/Note.h"
 #include "Midi/Players/PlatformMidiManager.h"
 #include "Midi/Sequence.h"
@@ -113,6 +114,16 @@ void Note::checkIfStringAndFretMatchNote(const bool fixStringAndFret)
 
 // ----------------------------------------------------------------------------------------------------------
 
+bool Note::isStringAndFretInSync() const
+{
+    const GuitarTuning* tuning = m_track->getGuitarTuning();
+    
+    if (string < 0 or string > (int)tuning->tuning.size()-1 or fret == -1) return false;
+    return (m_pitch_ID == tuning->tuning[string] - fret);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 void Note::setParent(Track* parent)
 {
     m_track = parent;
@@ -165,45 +176,11 @@ void Note::shiftString(const int amount)
 
 void Note::findStringAndFretFromNote()
 {
-
-    // find string that can hold the value with the smallest fret number possible
-    int nearest  = -1;
-    int distance = 1000;
-
-    GuitarTuning* tuning = m_track->getGuitarTuning();
+    const GuitarFingering::Position position =
+        GuitarFingering::findNearestPosition(m_track->getGuitarTuning()->tuning, m_pitch_ID);
     
-    if (m_pitch_ID > (tuning->tuning)[ tuning->tuning.size()-1] )
-    {
-        // note is too low to appear on this tab, will have a negative fret number
-        string = tuning->tuning.size()-1;
-        fret = (tuning->tuning)[ tuning->tuning.size() - 1] - m_pitch_ID;
-        return;
-    }
-
-    for (int n=0; n<(int)tuning->tuning.size(); n++)
-    {
-
-        // exact match (note can be played on a string at fret 0)
-        if ((tuning->tuning)[n] == m_pitch_ID)
-        {
-            string = n;
-            fret   = 0;
-            return;
-        }
-
-        if ((tuning->tuning)[n] > m_pitch_ID)
-        {
-            if ((tuning->tuning)[n] - m_pitch_ID < distance)
-            {
-                nearest  = n;
-                distance = (tuning->tuning)[n] - m_pitch_ID;
-            }//end if
-        }//end if
-    }//next
-
-    string = nearest;
-    fret = distance;
-
+    string = position.m_string;
+    fret   = position.m_fret;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -218,7 +195,10 @@ void Note::findNoteFromStringAndFret()
 
 void Note::setSelected(const bool selected)
 {
+    if (m_selected == selected) return;
+    
     m_selected = selected;
+    if (m_track != NULL) m_track->onNoteSelectionChanged();
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -254,7 +234,7 @@ void Note::setEndTick(const int ticks)
 #pragma mark Serialization
 #endif
 
-void Note::saveToFile(wxFileOutputStream& fileout)
+void Note::saveToFile(wxOutputStream& fileout)
 {
     writeData( wxT("  <note pitch=\"") + to_wxString(m_pitch_ID)  , fileout );
     writeData( wxT("\" start=\"")      + to_wxString(m_start_tick), fileout );
@@ -20,7 +20,7 @@
 #include "Utils.h"
 #include <wx/intl.h>
 
-class wxFileOutputStream;
+class wxOutputStream;
 
 // forward
 namespace irr { namespace io {
@@ -132,6 +132,8 @@ namespace AriaMaestosa
       */
     class Note
     {
+        friend class Track;
+        
         Track* m_track;
         
         bool   m_selected;
@@ -161,6 +163,7 @@ namespace AriaMaestosa
         LEAK_CHECK();
         
 
+        /** @note to select notes of a track, prefer the selection methods of Track, they keep its index up to date */
         void setSelected(const bool selected);
         bool isSelected() const { return m_selected; }
         
@@ -206,6 +209,12 @@ namespace AriaMaestosa
           */
         void checkIfStringAndFretMatchNote(const bool fixStringAndFret);
         
+        /**
+          * @return whether the string and fret of the note are set and play its pitch with the current tuning
+          * @note for guitar mode only
+          */
+        bool isStringAndFretInSync() const;
+        
         int  getString();
         int  getFret();
         
@@ -274,7 +283,7 @@ namespace AriaMaestosa
         }
         
         // serialization
-        void saveToFile(wxFileOutputStream& fileout);
+        void saveToFile(wxOutputStream& fileout);
         bool readFromFile(irr::io::IrrXMLReader* xml);
     };
     
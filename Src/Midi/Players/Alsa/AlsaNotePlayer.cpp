@@ -9,6 +9,7 @@
 #include "Midi/Players/Alsa/AlsaPort.h"
 
 #include <alsa/asoundlib.h>
+#include <pthread.h>
 
 namespace AriaMaestosa
 {
@@ -58,13 +59,19 @@ void resetAllControllers()
 {
     if (not sound_available) return;
 
-    for (int channel=0; channel<16; channel++)
+    const int portAmount = context_ref->getOutputPortAmount();
+    for (int port=0; port<portAmount; port++)
     {
-        seq_controlchange(0x78 /*120*/ /* all sound off */, 0, channel);
-        seq_controlchange(0x79 /*121*/ /* reset controllers */, 0, channel);
-        seq_controlchange(7 /* reset volume */, 127, channel);
-        seq_controlchange( 10 /* reset pan */, 64, channel);
+        seq_set_port(port);
+        for (int channel=0; channel<16; channel++)
+        {
+            seq_controlchange(0x78 /*120*/ /* all sound off */, 0, channel);
+            seq_controlchange(0x79 /*121*/ /* reset controllers */, 0, channel);
+            seq_controlchange(7 /* reset volume */, 127, channel);
+            seq_controlchange( 10 /* reset pan */, 64, channel);
+        }
     }
+    seq_set_port(0);
     // FIXME - reset pitch bend!!
 }
 
@@ -128,6 +135,138 @@ void stopNote()
 }
 
 
+// ----------------------------------------------------------
+// scheduled output on the context's ALSA queue
+
+#if 0
+#pragma mark -
+#endif
+
+/** whether events sent from the sequencer thread currently go through the queue */
+bool scheduling = false;
+pthread_t scheduling_thread;
+
+/** queue time at which the generic sequencer started counting, in nanoseconds */
+long long scheduling_origin = 0;
+
+/** time at which the next scheduled events must sound, in nanoseconds since 'scheduling_origin' */
+long long scheduled_event_time = 0;
+
+bool scheduling_available()
+{
+    return sound_available and context_ref->queue >= 0;
+}
+
+void scheduling_start()
+{
+    if (not scheduling_available()) return;
+
+    if (not scheduling)
+    {
+        // starting the queue resets its time; make sure this is done before reading it back
+        snd_seq_start_queue(context_ref->sequencer, context_ref->queue, NULL);
+        snd_seq_drain_output(context_ref->sequencer);
+        snd_seq_sync_output_queue(context_ref->sequencer);
+    }
+
+    snd_seq_queue_status_t* status;
+    snd_seq_queue_status_alloca(&status);
+    snd_seq_get_queue_status(context_ref->sequencer, context_ref->queue, status);
+    const snd_seq_real_time_t* now = snd_seq_queue_status_get_real_time(status);
+
+    scheduling_origin    = (long long)now->tv_sec * 1000000000LL + now->tv_nsec;
+    scheduled_event_time = 0;
+    scheduling_thread    = pthread_self();
+    scheduling           = true;
+}
+
+void scheduling_set_event_time(const long long nanos)
+{
+    scheduled_event_time = nanos;
+}
+
+void scheduling_flush()
+{
+    if (not scheduling) return;
+
+    snd_seq_drain_output(context_ref->sequencer);
+}
+
+void scheduling_stop()
+{
+    if (not scheduling) return;
+    scheduling = false;
+
+    // forget events still in our output buffer, then those already waiting on the queue
+    snd_seq_drop_output(context_ref->sequencer);
+
+    snd_seq_remove_events_t* remove;
+    snd_seq_remove_events_alloca(&remove);
+    snd_seq_remove_events_set_queue(remove, context_ref->queue);
+    snd_seq_remove_events_set_condition(remove, SND_SEQ_REMOVE_OUTPUT);
+    snd_seq_remove_events(context_ref->sequencer, remove);
+
+    snd_seq_stop_queue(context_ref->sequencer, context_ref->queue, NULL);
+    snd_seq_drain_output(context_ref->sequencer);
+}
+
+/**
+  * Sends an event either immediately, or, when it comes from the sequencer thread while scheduling,
+  * timestamped on the queue and buffered until the end of the batch (see scheduling_flush)
+  */
+static void outputEvent(snd_seq_event_t* event)
+{
+    if (scheduling and pthread_equal(pthread_self(), scheduling_thread))
+    {
+        const long long time_ns = scheduling_origin + scheduled_event_time;
+
+        snd_seq_real_time_t time;
+        time.tv_sec  = time_ns / 1000000000LL;
+        time.tv_nsec = time_ns % 1000000000LL;
+        snd_seq_ev_schedule_real(event, context_ref->queue, 0 /* absolute */, &time);
+
+        snd_seq_event_output(context_ref->sequencer, event);
+    }
+    else
+    {
+        snd_seq_ev_set_direct(event);
+
+        if (snd_seq_event_output_direct(context_ref->sequencer, event) < 0)
+        {
+            return;
+        }
+        snd_seq_drain_output(context_ref->sequencer);
+    }
+}
+
+// ----------------------------------------------------------
+// output ports
+
+#if 0
+#pragma mark -
+#endif
+
+/** port chosen with seq_set_port, only applies to events sent from 'output_port_thread' */
+int output_port = 0;
+pthread_t output_port_thread;
+
+void seq_set_port(const int port)
+{
+    ASSERT_E(port, >=, 0);
+    output_port        = port;
+    output_port_thread = pthread_self();
+}
+
+/** @return the address events sent from the calling thread come from */
+static const snd_seq_addr_t& getSource()
+{
+    if (output_port != 0 and pthread_equal(pthread_self(), output_port_thread))
+    {
+        return context_ref->getOutputPort(output_port);
+    }
+    return context_ref->address;
+}
+
 // ----------------------------------------------------------
 // PlatformMidiManager generic timer functions
 
@@ -141,15 +280,12 @@ void seq_note_on(const int note, const int volume, const int channel)
 
     snd_seq_ev_clear(&event);
 
-    event.queue  = SND_SEQ_QUEUE_DIRECT;
-    event.source = context_ref->address;
+    event.source = getSource();
 
     snd_seq_ev_set_subs(&event);
-    snd_seq_ev_set_direct(&event);
     snd_seq_ev_set_noteon(&event, channel, note, volume);
 
-    snd_seq_event_output_direct(context_ref->sequencer, &event);
-    snd_seq_drain_output(context_ref->sequencer);
+    outputEvent(&event);
 }
 
 
@@ -159,15 +295,12 @@ void seq_note_off(const int note, const int channel)
 
     snd_seq_ev_clear(&event);
 
-    event.queue  = SND_SEQ_QUEUE_DIRECT;
-    event.source = context_ref->address;
+    event.source = getSource();
 
     snd_seq_ev_set_subs(&event);
-    snd_seq_ev_set_direct(&event);
     snd_seq_ev_set_noteoff(&event, channel, note, 0 /*velocity*/);
 
-    snd_seq_event_output_direct(context_ref->sequencer, &event);
-    snd_seq_drain_output(context_ref->sequencer);
+    outputEvent(&event);
 }
 
 void seq_prog_change(const int instrumentID, const int channel)
@@ -176,18 +309,12 @@ void seq_prog_change(const int instrumentID, const int channel)
 
     snd_seq_ev_clear(&event);
 
-    event.queue  = SND_SEQ_QUEUE_DIRECT;
-    event.source = context_ref->address;
+    event.source = getSource();
 
     snd_seq_ev_set_subs(&event);
-    snd_seq_ev_set_direct(&event);
     snd_seq_ev_set_pgmchange(&event, channel, instrumentID);
 
-    if (snd_seq_event_output_direct(context_ref->sequencer, &event) < 0)
-    {
-        return;
-    }
-    snd_seq_drain_output(context_ref->sequencer);
+    outputEvent(&event);
 }
 
 void seq_controlchange(const int controller, const int value, const int channel)
@@ -196,18 +323,12 @@ void seq_controlchange(const int controller, const int value, const int channel)
 
     snd_seq_ev_clear(&event);
 
-    event.queue  = SND_SEQ_QUEUE_DIRECT;
-    event.source = context_ref->address;
+    event.source = getSource();
 
     snd_seq_ev_set_subs(&event);
-    snd_seq_ev_set_direct(&event);
     snd_seq_ev_set_controller(&event, channel, controller, value);
 
-    if (snd_seq_event_output_direct(context_ref->sequencer, &event) < 0)
-    {
-        return;
-    }
-    snd_seq_drain_output(context_ref->sequencer);
+    outputEvent(&event);
 }
 
 void seq_pitch_bend(const int value, const int channel)
@@ -216,18 +337,14 @@ void seq_pitch_bend(const int value, const int channel)
 
     snd_seq_ev_clear(&event);
 
-    event.queue  = SND_SEQ_QUEUE_DIRECT;
-    event.source = context_ref->address;
+    event.source = getSource();
 
     snd_seq_ev_set_subs(&event);
-    snd_seq_ev_set_direct(&event);
     snd_seq_ev_set_pitchbend(&event, channel, value);
 
-    snd_seq_event_output_direct(context_ref->sequencer, &event);
-    snd_seq_drain_output(context_ref->sequencer);
+    outputEvent(&event);
 }
 
-
 }
 }
 
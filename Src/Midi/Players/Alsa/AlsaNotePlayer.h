@@ -35,6 +35,28 @@ class MidiContext;
         void seq_prog_change(const int instrumentID, const int channel);
         void seq_controlchange(const int controller, const int value, const int channel);
         void seq_pitch_bend(const int value, const int channel);
+
+        /** @return whether events can be scheduled ahead on the context's ALSA queue */
+        bool scheduling_available();
+
+        /**
+          * @brief start timestamping the seq_* events sent from the calling thread on the ALSA queue,
+          *        relative to the current queue time. Other threads still send immediately.
+          */
+        void scheduling_start();
+        void scheduling_set_event_time(const long long nanos);
+
+        /** @brief write the scheduled events buffered so far, in a single call */
+        void scheduling_flush();
+
+        /** @brief drop the scheduled events that did not sound yet, stop the queue */
+        void scheduling_stop();
+
+        /**
+          * @brief send the seq_* events of the calling thread from the given port of the context
+          *        (see MidiContext::getOutputPortAmount)
+          */
+        void seq_set_port(const int port);
     }
 }
 
@@ -105,23 +105,28 @@ wxString g_export_audio_filepath;
 AudioExportEngine g_export_engine;
 wxString g_fluisynth_soundfont;
 
-void* export_audio_func( void *ptr )
+/**
+  * @brief export the sequence to midi, then have the chosen synthesizer render it to an audio file
+  * @param tempMidiFile  where the intermediate midi file is written (it is removed afterwards)
+  * @param interactive   see exportMidiFile
+  * @return whether the audio file was written
+  */
+bool render_audio(Sequence* sequence, const wxString& filepath, const wxString& tempMidiFile,
+                  AudioExportEngine engine, const wxString& soundfont, const bool interactive)
 {
-    // the file is exported to midi, and then we tell timidity to make it into wav
-    wxString tempMidiFile = g_export_audio_filepath.BeforeLast('/') + wxT("/aria_temp_file.mid");
+    if (not AriaMaestosa::exportMidiFile(sequence, tempMidiFile, interactive)) return false;
     
-    AriaMaestosa::exportMidiFile(g_sequence, tempMidiFile);
     wxString cmd;
     
-    if (g_export_engine == FLUIDSYNTH)
+    if (engine == FLUIDSYNTH)
     {
         // fluidsynth -O s32 -T wav -a file --fast-render=test.wav /usr/share/sounds/sf2/FluidR3_GM.sf2 '/home/mmg/Desktop/angelinblack/Angel in black piano.mid'
-        cmd = wxT("fluidsynth -O s32 -T wav -a file --fast-render=\"") + g_export_audio_filepath +
-              wxT("\" \"") + g_fluisynth_soundfont + wxT("\" \"") + tempMidiFile + wxT("\"");
+        cmd = wxT("fluidsynth -O s32 -T wav -a file --fast-render=\"") + filepath +
+              wxT("\" \"") + soundfont + wxT("\" \"") + tempMidiFile + wxT("\"");
     }
-    else if (g_export_engine == TIMIDITY)
+    else if (engine == TIMIDITY)
     {
-        cmd = wxT("timidity -Ow -o \"") + g_export_audio_filepath + wxT("\" \"") + tempMidiFile + wxT("\" -idt");
+        cmd = wxT("timidity -Ow -o \"") + filepath + wxT("\" \"") + tempMidiFile + wxT("\" -idt");
     }
     else
     {
@@ -154,18 +159,30 @@ void* export_audio_func( void *ptr )
     catch(...)
     {
         std::cout << "An error occured while exporting audio file." << std::endl;
-        return (void*)NULL;
+        wxRemoveFile(tempMidiFile);
+        return false;
     }
     
     std::cout << "\n-----------------" << std::endl;
-    pclose(command_output);
+    const int status = pclose(command_output);
+    
+    wxRemoveFile(tempMidiFile);
+    
+    return (status == 0 and wxFileExists(filepath));
+}
+
+void* export_audio_func( void *ptr )
+{
+    // the file is exported to midi, and then we tell timidity to make it into wav
+    wxString tempMidiFile = g_export_audio_filepath.BeforeLast('/') + wxT("/aria_temp_file.mid");
+    
+    render_audio(g_sequence, g_export_audio_filepath, tempMidiFile, g_export_engine, g_fluisynth_soundfont,
+                 true /* interactive */);
     
     // send hide progress window event
     MAKE_HIDE_PROGRESSBAR_EVENT(event);
     getMainFrame()->GetEventHandler()->AddPendingEvent(event);
     
-    wxRemoveFile(tempMidiFile);
-    
     return (void*)NULL;
 }
 
@@ -195,12 +212,13 @@ public:
 
     void prepareSequencer()
     {
-        jdkmidiseq = new jdksmidi::MIDIMultiTrack();
+        jdkmidiseq = new jdksmidi::MIDIMultiTrack( getJDKMidiTrackCapacity(g_sequence) );
         songLengthInTicks = -1;
         int trackAmount = -1;
         m_start_tick = 0;
         makeJDKMidiSequence(g_sequence, *jdkmidiseq, selectionOnly, &songLengthInTicks,
-                            &m_start_tick, &trackAmount, true /* for playback */);
+                            &m_start_tick, &trackAmount, true /* for playback */,
+                            PlatformMidiManager::get()->seq_get_port_amount());
 
         //std::cout << "trackAmount=" << trackAmount << " start_tick=" << m_start_tick<<
         //        " songLengthInTicks=" << songLengthInTicks << std::endl;
@@ -405,6 +423,47 @@ public:
     {
         g_current_accurate_tick = tick;
     }
+
+    virtual long long seq_get_lookahead()
+    {
+        // recording needs the metronome and playthrough to sound right away
+        if (isRecording() or not AlsaPlayerStuff::scheduling_available()) return 0;
+        
+        const long millis = PreferencesData::getInstance()->getInt(SETTING_KEY_ALSA_LOOKAHEAD);
+        return (millis > 0 ? millis * 1000000LL : 0);
+    }
+    
+    virtual void seq_start_scheduling()
+    {
+        AlsaPlayerStuff::scheduling_start();
+    }
+    
+    virtual void seq_set_event_time(const long long nanos)
+    {
+        AlsaPlayerStuff::scheduling_set_event_time(nanos);
+    }
+    
+    virtual void seq_flush()
+    {
+        AlsaPlayerStuff::scheduling_flush();
+    }
+    
+    virtual void seq_stop_scheduling()
+    {
+        AlsaPlayerStuff::scheduling_stop();
+    }
+    
+    virtual int seq_get_port_amount()
+    {
+        if (not sound_available) return 1;
+        return context->getOutputPortAmount();
+    }
+    
+    virtual void seq_set_port(const int port)
+    {
+        if (not sound_available) return;
+        AlsaPlayerStuff::seq_set_port(port);
+    }
     
     virtual bool isPlaying()
     {
@@ -608,6 +667,24 @@ public:
         threads::export_audio.runFunction( &export_audio_func );
     }
     
+    // what renderAudioFile uses, read by prepareAudioRendering
+    AudioExportEngine m_render_engine;
+    wxString m_render_soundfont;
+    
+    virtual void prepareAudioRendering()
+    {
+        PreferencesData* prefs = PreferencesData::getInstance();
+        m_render_engine    = (AudioExportEngine)prefs->getIntValue(SETTING_ID_AUDIO_EXPORT_ENGINE);
+        m_render_soundfont = prefs->getValue(SETTING_ID_FLUIDSYNTH_SOUNDFONT_PATH);
+    }
+    
+    virtual bool renderAudioFile(Sequence* sequence, wxString filepath)
+    {
+        // renders may run side by side, so each gets an intermediate file of its own
+        return render_audio(sequence, filepath, filepath + wxT(".tmp.mid"), m_render_engine, m_render_soundfont,
+                            false /* interactive */);
+    }
+    
     virtual void playNote(int noteNum, int volume, int duration, int channel, int instrument)
     {
         if (not sound_available) return;
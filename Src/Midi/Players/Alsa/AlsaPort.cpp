@@ -2,6 +2,7 @@
 
 #include <glib.h>
 #include "AriaCore.h"
+#include "Midi/ChannelAllocator.h"
 #include "Midi/Players/Alsa/AlsaPort.h"
 #include <iostream>
 #include <wx/wx.h>
@@ -61,7 +62,11 @@ void MidiDevice::close()
     {
         snd_seq_unsubscribe_port(midiContext->sequencer, midiContext->subs);
         snd_seq_drop_output(midiContext->sequencer);
-        snd_seq_free_queue(midiContext->sequencer, midiContext->queue);
+        if (midiContext->queue >= 0)
+        {
+            snd_seq_free_queue(midiContext->sequencer, midiContext->queue);
+            midiContext->queue = -1;
+        }
         snd_seq_close(midiContext->sequencer);
     }
 }
@@ -87,6 +92,7 @@ void MidiContext::closeDevice()
 {
     if (device != NULL)
     {
+        closeExtraPorts();
         device->close();
         device = NULL;
     }
@@ -364,6 +370,9 @@ void MidiContext::findDevices()
     address.client = snd_seq_client_id (sequencer);
     snd_seq_set_client_pool_output (sequencer, 1024);
 
+    // used to schedule playback ahead of time; if it can't be had, events are sent directly
+    queue = snd_seq_alloc_named_queue(sequencer, "Aria");
+
     destlist = g_array_new(0, 0, sizeof(snd_seq_addr_t));
 }
 
@@ -390,7 +399,71 @@ bool MidiContext::openDevice(MidiDevice* device)
 {
     MidiContext::device = device;
     if (device == NULL) return false;
-    return device->open();
+    if (not device->open()) return false;
+    
+    openExtraPorts();
+    return true;
+}
+
+
+/** @return the name of a port without the part in parentheses, e.g. "Synth input port (1234:0)" */
+static wxString getPortFamily(const wxString& name)
+{
+    return name.BeforeFirst(wxT('(')).Trim();
+}
+
+
+void MidiContext::openExtraPorts()
+{
+    closeExtraPorts();
+    
+    // only consecutive ports of the same synthesizer are used; the ports of a multi-port interface
+    // usually go to different instruments and have distinct names
+    const wxString family = getPortFamily(device->name);
+    
+    for (int n=1; n<ChannelAllocator::MAX_PORTS; n++)
+    {
+        int index;
+        MidiDevice* next = getDevice(device->client, device->port + n, index);
+        if (next == NULL or getPortFamily(next->name) != family) break;
+        
+        const wxString name = wxString::Format(wxT("Aria Port %i"), n);
+        const int port = snd_seq_create_simple_port(sequencer, name.mb_str(),
+                                                    SND_SEQ_PORT_CAP_READ | SND_SEQ_PORT_CAP_SUBS_READ,
+                                                    SND_SEQ_PORT_TYPE_APPLICATION);
+        if (port < 0) break;
+        
+        if (snd_seq_connect_to(sequencer, port, next->client, next->port) < 0)
+        {
+            snd_seq_delete_simple_port(sequencer, port);
+            break;
+        }
+        
+        snd_seq_addr_t addr;
+        addr.client = address.client;
+        addr.port   = port;
+        extraPorts.push_back(addr);
+    }
+}
+
+
+void MidiContext::closeExtraPorts()
+{
+    const int count = extraPorts.size();
+    for (int n=0; n<count; n++)
+    {
+        snd_seq_disconnect_to(sequencer, extraPorts[n].port, device->client, device->port + n + 1);
+        snd_seq_delete_simple_port(sequencer, extraPorts[n].port);
+    }
+    extraPorts.clear();
+}
+
+
+const snd_seq_addr_t& MidiContext::getOutputPort(const int id) const
+{
+    ASSERT_E(id, >=, 0);
+    if (id == 0 or id > (int)extraPorts.size()) return address;
+    return extraPorts[id - 1];
 }
 
 
@@ -478,7 +551,8 @@ void MidiContext::runTimidity()
 void MidiContext::runSoftSynth(const wxString& soundfontPath)
 {
     wxString cmd(FLUIDSYNTH_COMMAND 
-        + wxT(" -a pulseaudio -l --server -i '") + soundfontPath + wxT("'"));
+        + wxString::Format(wxT(" -a pulseaudio -l --server -K %i -i '"), ChannelAllocator::MAX_PORTS * 16)
+        + soundfontPath + wxT("'"));
     
     wxExecute(cmd, wxEXEC_ASYNC);
 }
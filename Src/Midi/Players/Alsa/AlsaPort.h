@@ -6,6 +6,7 @@
 #include "glib.h"
 #include <wx/string.h>
 #include "ptr_vector.h"
+#include <vector>
 
 #include "jdksmidi/world.h"
 #include "jdksmidi/track.h"
@@ -36,6 +37,12 @@ namespace AriaMaestosa
         void launchFluidSynth(const wxString& soundFontPath);
         void runSoftSynth(const wxString& soundfontPath);
         void setDevice(MidiDevice** d, int index);
+        
+        /** ports of our client beyond 'address', each connected to the next port of the device */
+        std::vector<snd_seq_addr_t> extraPorts;
+        
+        void openExtraPorts();
+        void closeExtraPorts();
 
     public:
         LEAK_CHECK();
@@ -65,6 +72,15 @@ namespace AriaMaestosa
         MidiDevice* getDevice(int index);
         MidiDevice* getDevice(int client, int port, int& index);
         MidiDevice* getDevice(const wxString& marker, int& index);
+        
+        /**
+          * @return how many ports output may be spread over. Synthesizers with more than 16 channels
+          *         (like FluidSynth, as launched by Aria) have one port per group of 16 channels.
+          */
+        int getOutputPortAmount() const { return extraPorts.size() + 1; }
+        
+        /** @return the address of our client's port that sends to the given port of the device */
+        const snd_seq_addr_t& getOutputPort(const int id) const;
 
     };
 
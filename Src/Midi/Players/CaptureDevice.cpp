@@ -0,0 +1,96 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Midi/Players/CaptureDevice.h"
+
+#include <chrono>
+
+using namespace AriaMaestosa;
+
+// ----------------------------------------------------------------------------------------------------------
+
+CaptureMidiManager::CaptureMidiManager(const int capacity)
+{
+    m_events.reserve(capacity);
+    m_must_stop = false;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+long long CaptureMidiManager::getMonotonicTime()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void CaptureMidiManager::clear()
+{
+    m_events.clear();
+    m_must_stop = false;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void CaptureMidiManager::capture(const int byte0, const int byte1, const int byte2)
+{
+    CapturedMidiEvent event;
+    event.m_time     = getMonotonicTime();
+    event.m_bytes[0] = byte0;
+    event.m_bytes[1] = byte1;
+    event.m_bytes[2] = byte2;
+    m_events.push_back(event);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void CaptureMidiManager::seq_note_on(const int note, const int volume, const int channel)
+{
+    capture(0x90 | channel, note, volume);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void CaptureMidiManager::seq_note_off(const int note, const int channel)
+{
+    capture(0x80 | channel, note, 0);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void CaptureMidiManager::seq_prog_change(const int instrument, const int channel)
+{
+    capture(0xC0 | channel, instrument, 0);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void CaptureMidiManager::seq_controlchange(const int controller, const int value, const int channel)
+{
+    capture(0xB0 | channel, controller, value);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void CaptureMidiManager::seq_pitch_bend(const int value, const int channel)
+{
+    // pitch bend values are centered on 0 in the seq_* interface
+    const int raw = value + 8192;
+    capture(0xE0 | channel, raw & 0x7F, (raw >> 7) & 0x7F);
+}
+
+// ----------------------------------------------------------------------------------------------------------
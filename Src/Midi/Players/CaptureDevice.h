@@ -0,0 +1,95 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CAPTURE_DEVICE_H__
+#define __CAPTURE_DEVICE_H__
+
+#include "Midi/Players/PlatformMidiManager.h"
+
+#include <vector>
+
+namespace AriaMaestosa
+{
+
+    /**
+      * @brief A MIDI message sent by the generic sequencer to a CaptureMidiManager
+      * @ingroup midi.players
+      */
+    struct CapturedMidiEvent
+    {
+        /** Monotonic host time at which the seq_* function was called, in nanoseconds */
+        long long m_time;
+
+        unsigned char m_bytes[3];
+    };
+
+    /**
+      * @brief Silent MIDI manager that records every event it receives from the generic sequencer,
+      *        with a timestamp, so that playback timing can be measured without a sound device.
+      *
+      * It is not registered as a MIDI driver; it is meant to be installed by headless tools
+      * (see PlatformMidiManager::installManager).
+      * @ingroup midi.players
+      */
+    class CaptureMidiManager : public PlatformMidiManager
+    {
+        std::vector<CapturedMidiEvent> m_events;
+        bool m_must_stop;
+
+        void capture(const int byte0, const int byte1, const int byte2);
+
+    public:
+
+        /** @param capacity  number of events for which memory is reserved up-front, so that
+          *                  capturing does not allocate during playback */
+        CaptureMidiManager(const int capacity);
+        virtual ~CaptureMidiManager() { }
+
+        /** @return monotonic host time, in nanoseconds */
+        static long long getMonotonicTime();
+
+        /** @brief forget all captured events, and allow the sequencer to run again */
+        void clear();
+
+        const std::vector<CapturedMidiEvent>& getEvents() const { return m_events; }
+
+        virtual bool playSequence(Sequence* sequence, /*out*/int* startTick) { return false; }
+        virtual bool playSelected(Sequence* sequence, /*out*/int* startTick) { return false; }
+        virtual bool isPlaying() { return false; }
+        virtual void stop() { m_must_stop = true; }
+        virtual void exportAudioFile(Sequence* sequence, wxString filepath) { }
+        virtual int  trackPlaybackProgression() { return 0; }
+        virtual int  getAccurateTick() { return 0; }
+        virtual void initMidiPlayer() { }
+        virtual void freeMidiPlayer() { }
+        virtual void playNote(int noteNum, int volume, int duration, int channel, int instrument) { }
+        virtual void stopNote() { }
+        virtual const wxString getAudioExtension() { return wxEmptyString; }
+        virtual const wxString getAudioWildcard() { return wxEmptyString; }
+        virtual wxArrayString getOutputChoices() { return wxArrayString(); }
+
+        virtual void seq_note_on      (const int note, const int volume, const int channel);
+        virtual void seq_note_off     (const int note, const int channel);
+        virtual void seq_prog_change  (const int instrument, const int channel);
+        virtual void seq_controlchange(const int controller, const int value, const int channel);
+        virtual void seq_pitch_bend   (const int value, const int channel);
+
+        virtual bool seq_must_continue() { return not m_must_stop; }
+    };
+
+}
+
+#endif
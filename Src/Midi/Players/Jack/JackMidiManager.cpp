@@ -4,8 +4,10 @@
 
 #include <algorithm>
 #include <memory>
+#include <vector>
 #include <exception>
 #include <cassert>
+#include <cstdio>
 #include <stdint.h>
 #include <pthread.h>
 #include <jack/jack.h>
@@ -14,6 +16,7 @@
 #include <jdksmidi/utils.h>
 #include <jdksmidi/multitrack.h>
 #include <jdksmidi/sequencer.h>
+#include "Midi/ChannelAllocator.h"
 #include "Midi/CommonMidiUtils.h"
 #include "Midi/Sequence.h"
 #include "Midi/Players/PlatformMidiManager.h"
@@ -50,10 +53,10 @@ public:
 		jack_client_close(m_jack);
 		pthread_cond_destroy(&m_finish);
 		pthread_mutex_destroy(&m_mutex);
-		delete m_sequencer;
+		delete m_cursor;
 	}
 
-	PrivateJackMidiPlayer(): m_playing(false), m_frame(0), m_sequencer(0)
+	PrivateJackMidiPlayer(): m_playing(false), m_frame(0), m_cursor(0)
 	{
 		pthread_mutexattr_t mattr;
 		pthread_mutexattr_init(&mattr);
@@ -73,11 +76,20 @@ public:
 				try
 				{
 					jack_set_process_callback(m_jack, &handleJack, this);
-					m_port = jack_port_register(
-						m_jack, "midi_out", JACK_DEFAULT_MIDI_TYPE, JackPortIsOutput, 0
-					);
-					if(m_port == 0)
-						throw std::exception();
+					// one port per group of 16 channels (see ChannelAllocator)
+					for(int n = 0; n < PORT_AMOUNT; ++n)
+					{
+						char name[32];
+						if(n == 0)
+							snprintf(name, sizeof(name), "midi_out");
+						else
+							snprintf(name, sizeof(name), "midi_out_%d", n + 1);
+						m_ports[n] = jack_port_register(
+							m_jack, name, JACK_DEFAULT_MIDI_TYPE, JackPortIsOutput, 0
+						);
+						if(m_ports[n] == 0)
+							throw std::exception();
+					}
 					if(jack_activate(m_jack) != 0)
 						throw std::exception();
 				}
@@ -102,10 +114,16 @@ public:
 
 	void play(jdksmidi::MIDIMultiTrack* tracks, uint64_t frame = 0)
 	{
-		jdksmidi::MIDISequencer* tmp = new jdksmidi::MIDISequencer(tracks);
+		// events are then read in place by handleJack(), without copies nor tempo computations
+		jdksmidi::MIDISequencerCursor* tmp = new jdksmidi::MIDISequencerCursor(tracks);
+		tmp->GoToTimeMs(frame * (1000.0 / jack_get_sample_rate(m_jack)));
+		// computed here, since handleJack() must not allocate
+		std::vector<int> trackPorts;
+		AriaMaestosa::getJDKMidiTrackPorts(*tracks, trackPorts);
 		{
 			ScopedLocker lock(&m_mutex);
-			std::swap(tmp, m_sequencer);
+			std::swap(tmp, m_cursor);
+			m_track_ports.swap(trackPorts);
 			m_frame = frame;
 			m_playing = true;
 		}
@@ -137,55 +155,63 @@ public:
 	int getTick()
 	{
 		ScopedLocker lock(&m_mutex);
-		assert(m_sequencer != 0);
-		return m_sequencer->GetCurrentMIDIClockTime();
+		assert(m_cursor != 0);
+		return m_cursor->GetCurrentMIDIClockTime();
 	}
 	
+	static const int PORT_AMOUNT = AriaMaestosa::ChannelAllocator::MAX_PORTS;
+
 	private:
 		static int handleJack(jack_nframes_t nFrame, void* selfv)
 		{
 			PrivateJackMidiPlayer* self = reinterpret_cast<PrivateJackMidiPlayer*>(selfv);
 			unsigned srate = jack_get_sample_rate(self->m_jack);
-			void* buf = jack_port_get_buffer(self->m_port, nFrame);
-			jack_midi_clear_buffer(buf);
+			void* bufs[PORT_AMOUNT];
+			for(int n = 0; n < PORT_AMOUNT; ++n)
+			{
+				bufs[n] = jack_port_get_buffer(self->m_ports[n], nFrame);
+				jack_midi_clear_buffer(bufs[n]);
+			}
 
 			ScopedLocker lock(&self->m_mutex);
 			if (self->m_playing)
 			{
-				// [bgn, end)
-				double bgn = self->m_frame * (1000.0 / srate);
+				// [m_frame, end); the events before m_frame were sent by the previous calls
 				double end = (self->m_frame + nFrame) * (1000.0 / srate);
 
-				self->m_sequencer->GoToTimeMs(bgn);
-
-				float t;
-				while (self->m_sequencer->GetNextEventTimeMs(&t) && t < end)
+				double t;
+				while (self->m_cursor->GetNextEventTimeMs(&t) && t < end)
 				{
 					int trackId;
-					jdksmidi::MIDITimedBigMessage msg;
-					self->m_sequencer->GetNextEvent(&trackId, &msg);
+					const jdksmidi::MIDITimedBigMessage* msg;
+					if (!self->m_cursor->GetNextEvent(&trackId, &msg))
+						break;
 
-					if (not msg.IsMetaEvent())
+					if (not msg->IsMetaEvent())
 					{
-						unsigned l = msg.GetLength();
+						int port = 0;
+						if(trackId < int(self->m_track_ports.size()))
+							port = std::min(self->m_track_ports[trackId], PORT_AMOUNT - 1);
+
+						unsigned l = msg->GetLength();
 						assert(l < 4);
 						uint8_t* ev = jack_midi_event_reserve(
-							buf, int(t * (srate / 1000.0)) - self->m_frame, l
+							bufs[port], int(t * (srate / 1000.0)) - self->m_frame, l
 						);
-						ev[0] = msg.GetStatus();
+						ev[0] = msg->GetStatus();
 						if(l >= 2)
 						{
-							ev[1] = msg.GetByte1();
+							ev[1] = msg->GetByte1();
 						}
 						if(l >= 3)
 						{
-							ev[2] = msg.GetByte2();
+							ev[2] = msg->GetByte2();
 						}
 					}
 				}
 				self->m_frame += nFrame;
 
-				if(!self->m_sequencer->GetNextEventTimeMs(&t))
+				if(!self->m_cursor->GetNextEventTimeMs(&t))
 				{
 					self->m_playing = false;
 					pthread_cond_signal(&self->m_finish);
@@ -196,10 +222,11 @@ public:
 		}
 
 		jack_client_t* m_jack;
-		jack_port_t* m_port;
+		jack_port_t* m_ports[PORT_AMOUNT];
+		std::vector<int> m_track_ports;
 		bool m_playing;
 		uint64_t m_frame;
-		jdksmidi::MIDISequencer* m_sequencer;
+		jdksmidi::MIDISequencerCursor* m_cursor;
 		pthread_mutex_t m_mutex;
 		pthread_cond_t m_finish;
 };
@@ -235,14 +262,19 @@ public:
     
 	void resetSync()
 	{
-		jdksmidi::MIDIMultiTrack tracks(1);
+		const int portAmount = PrivateJackMidiPlayer::PORT_AMOUNT;
+		jdksmidi::MIDIMultiTrack tracks(portAmount);
 		tracks.SetClksPerBeat(960);
-		for (int ch = 0; ch < 16; ++ch)
+		for (int port = 0; port < portAmount; ++port)
 		{
-			jdksmidi::MIDITimedBigMessage msg;
-			msg.SetTime(0);
-			msg.SetAllNotesOff(ch);
-			tracks.GetTrack(0)->PutEvent(msg);
+			AriaMaestosa::setJDKMidiTrackPort(tracks.GetTrack(port), port);
+			for (int ch = 0; ch < 16; ++ch)
+			{
+				jdksmidi::MIDITimedBigMessage msg;
+				msg.SetTime(0);
+				msg.SetAllNotesOff(ch);
+				tracks.GetTrack(port)->PutEvent(msg);
+			}
 		}
 
 		player->play(&tracks);
@@ -281,8 +313,9 @@ public:
 
 		int len = -1;
 		int nTrack = -1;
-		tracks.reset(new jdksmidi::MIDIMultiTrack());
-		makeJDKMidiSequence(seq, *tracks, false, &len, startTick, &nTrack, true);
+		tracks.reset(new jdksmidi::MIDIMultiTrack(getJDKMidiTrackCapacity(seq)));
+		makeJDKMidiSequence(seq, *tracks, false, &len, startTick, &nTrack, true,
+		                    PrivateJackMidiPlayer::PORT_AMOUNT);
 		player->play(tracks.get());
 
         m_start_tick = *startTick;
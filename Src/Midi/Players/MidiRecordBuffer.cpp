@@ -0,0 +1,110 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Midi/Players/MidiRecordBuffer.h"
+#include "UnitTest.h"
+
+#include <chrono>
+
+using namespace AriaMaestosa;
+
+// ----------------------------------------------------------------------------------------------------------
+
+MidiRecordBuffer::MidiRecordBuffer(unsigned int capacity) : m_read_index(0), m_write_index(0), m_dropped(0)
+{
+    unsigned int size = 1;
+    while (size < capacity) size <<= 1;
+    
+    m_messages.resize(size);
+    m_mask = size - 1;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void MidiRecordBuffer::reset()
+{
+    m_read_index.store(0);
+    m_write_index.store(0);
+    m_dropped.store(0);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool MidiRecordBuffer::push(const RecordedMidiMessage& message)
+{
+    const unsigned int write = m_write_index.load(std::memory_order_relaxed);
+    const unsigned int read  = m_read_index.load(std::memory_order_acquire);
+    
+    if (write - read > m_mask)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    m_messages[write & m_mask] = message;
+    m_write_index.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool MidiRecordBuffer::pop(RecordedMidiMessage& message)
+{
+    const unsigned int read  = m_read_index.load(std::memory_order_relaxed);
+    const unsigned int write = m_write_index.load(std::memory_order_acquire);
+    
+    if (read == write) return false;
+    
+    message = m_messages[read & m_mask];
+    m_read_index.store(read + 1, std::memory_order_release);
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+long long MidiRecordBuffer::getMonotonicTime()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+UNIT_TEST( TestRecordBufferWrapAround )
+{
+    MidiRecordBuffer queue(3);
+    RecordedMidiMessage message;
+    
+    for (int n=0; n<10; n++)
+    {
+        message.m_anchor_tick = n;
+        require(queue.push(message), "there is room for this message");
+        require(queue.pop(message), "the message can be read back");
+        require_e(message.m_anchor_tick, ==, n, "messages come out in order");
+    }
+    require(not queue.pop(message), "the queue is empty");
+    
+    for (int n=0; n<4; n++)
+    {
+        message.m_anchor_tick = n;
+        require(queue.push(message), "capacity was rounded up to 4");
+    }
+    require(not queue.push(message), "the queue is full");
+    require_e(queue.getDroppedCount(), ==, 1u, "the dropped message was counted");
+    
+    require(queue.pop(message), "the queue is not empty");
+    require_e(message.m_anchor_tick, ==, 0, "messages come out in order");
+}
@@ -0,0 +1,99 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __MIDI_RECORD_BUFFER_H__
+#define __MIDI_RECORD_BUFFER_H__
+
+#include <atomic>
+#include <vector>
+
+namespace AriaMaestosa
+{
+    
+    /**
+      * @brief A raw MIDI message, as captured by the MIDI input thread while recording
+      * @ingroup midi.players
+      */
+    struct RecordedMidiMessage
+    {
+        /** Time elapsed since the previous captured message, in seconds, as reported by the input device */
+        double m_delta_time;
+        
+        /** Monotonic host time at which the message was captured, in microseconds (see getMonotonicTime) */
+        long long m_capture_time;
+        
+        /** For the first message of a recording session only : the sequence tick at which it was
+          * received, used as origin for all following device timestamps. -1 for other messages. */
+        int m_anchor_tick;
+        
+        unsigned char m_bytes[3];
+    };
+    
+    /**
+      * @brief Fixed-size single-producer/single-consumer queue of recorded MIDI messages.
+      *
+      * The MIDI input thread pushes messages, the main thread pops them. Neither side allocates
+      * memory nor takes a lock; when the queue is full, messages are dropped and counted.
+      * @ingroup midi.players
+      */
+    class MidiRecordBuffer
+    {
+        std::vector<RecordedMidiMessage> m_messages;
+        
+        /** m_messages.size() - 1; the size is always a power of two */
+        unsigned int m_mask;
+        
+        /** Only written by the consumer */
+        std::atomic<unsigned int> m_read_index;
+        
+        /** Only written by the producer */
+        std::atomic<unsigned int> m_write_index;
+        
+        std::atomic<unsigned int> m_dropped;
+        
+    public:
+        
+        /** @param capacity maximal number of pending messages; rounded up to a power of two */
+        MidiRecordBuffer(unsigned int capacity);
+        
+        /**
+          * @brief Forget all pending messages and reset statistics
+          * @pre   Neither the producer nor the consumer may be active during this call
+          */
+        void reset();
+        
+        /**
+          * @brief  Called from the producer thread only
+          * @return false if the queue was full and the message was dropped
+          */
+        bool push(const RecordedMidiMessage& message);
+        
+        /**
+          * @brief  Called from the consumer thread only
+          * @return false if there was no pending message (then 'message' is left untouched)
+          */
+        bool pop(RecordedMidiMessage& message);
+        
+        /** @return the number of messages dropped because the queue was full since the last reset */
+        unsigned int getDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+        
+        /** @return a monotonic timestamp in microseconds, usable from any thread */
+        static long long getMonotonicTime();
+    };
+    
+}
+
+#endif
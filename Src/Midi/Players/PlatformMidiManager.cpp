@@ -19,7 +19,9 @@
 #include "Actions/AddNote.h"
 #include "Actions/AddControlEvent.h"
 #include "Actions/Record.h"
+#include "Midi/CommonMidiUtils.h"
 #include "Midi/Players/PlatformMidiManager.h"
+#include "Midi/Sequence.h"
 #include "PreferencesData.h"
 #include "ptr_vector.h"
 #include "Utils.h"
@@ -33,12 +35,23 @@ using namespace AriaMaestosa;
 ptr_vector<PlatformMidiManagerFactory, REF>* g_all_midi_managers = NULL;
 PlatformMidiManager* g_manager = NULL;
 
+/** Maximal number of recorded messages waiting to be processed by the main thread */
+const unsigned int RECORD_BUFFER_CAPACITY = 4096;
+
 // ----------------------------------------------------------------------------------------------------------
 
-PlatformMidiManager::PlatformMidiManager()
+PlatformMidiManager::PlatformMidiManager() : m_record_buffer(RECORD_BUFFER_CAPACITY)
 {
     m_recording = false;
     m_record_action = NULL;
+    m_record_anchored = false;
+    m_record_skipped_time = 0.0;
+    m_record_origin_time = 0.0;
+    m_record_elapsed_time = 0.0;
+    m_record_stats.m_message_count = 0;
+    m_record_stats.m_dropped_count = 0;
+    m_record_stats.m_total_latency = 0;
+    m_record_stats.m_max_latency   = 0;
     m_playthrough = PreferencesData::getInstance()->getBoolValue(SETTING_ID_PLAYTHROUGH, true);
 }
 
@@ -107,6 +120,14 @@ void PlatformMidiManager::registerManager(PlatformMidiManagerFactory* newManager
 
 // ----------------------------------------------------------------------------------------------------------
 
+void PlatformMidiManager::installManager(PlatformMidiManager* manager)
+{
+    ASSERT(g_manager == NULL);
+    g_manager = manager;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 wxArrayString PlatformMidiManager::getInputChoices()
 {
     wxArrayString out;
@@ -145,120 +166,133 @@ void PlatformMidiManager::recordCallback(double deltatime, std::vector<unsigned
                                          void *userData)
 {
     // ---- this function is invoked from a thread!!
+    // Do not allocate or lock here; only capture the raw message and let the main thread do the rest
+    // from 'processRecordQueue'.
 
     PlatformMidiManager* self = (PlatformMidiManager*)userData;
 
     ASSERT( MAGIC_NUMBER_OK_FOR(*self) );
 
-    // self->m_open_notes
-    unsigned int nBytes = message->size();
-
-    if (nBytes >= 3)
+    const unsigned int nBytes = message->size();
+    
+    if (nBytes < 3)
     {
-        int messageType = message->at(0) & 0xF0;
-        int channel = message->at(0) & 0x0F;
-        int value = message->at(1);
-        int value2 = message->at(2);
-
-        //printf("message %x on channel %i = %i %i\n", messageType, channel, value, value2);
-
-        int now_tick = self->m_start_tick + self->getAccurateTick();
-
+        // ignored (e.g. clock, active sensing), but its delta time must be accounted for
+        self->m_record_skipped_time += deltatime;
+        return;
+    }
+    
+    RecordedMidiMessage recorded;
+    recorded.m_delta_time   = self->m_record_skipped_time + deltatime;
+    recorded.m_capture_time = MidiRecordBuffer::getMonotonicTime();
+    recorded.m_anchor_tick  = -1;
+    recorded.m_bytes[0]     = message->at(0);
+    recorded.m_bytes[1]     = message->at(1);
+    recorded.m_bytes[2]     = message->at(2);
+    
+    if (not self->m_record_anchored)
+    {
+        // device timestamps are relative; the first message gives them an origin in the song
+        recorded.m_anchor_tick = self->m_start_tick + self->getAccurateTick();
+    }
+    
+    if (self->m_record_buffer.push(recorded))
+    {
+        self->m_record_anchored     = true;
+        self->m_record_skipped_time = 0.0;
+    }
+    else
+    {
+        self->m_record_skipped_time = recorded.m_delta_time;
+    }
+    
+    if (self->m_playthrough)
+    {
+        const int messageType = recorded.m_bytes[0] & 0xF0;
+        const int value       = recorded.m_bytes[1];
+        const int value2      = recorded.m_bytes[2];
+        
+        // FIXME: we are in a thread, not all players may be thread-safe!!
         switch (messageType)
         {
             case 0x90: // NOTE ON
             case 0x80: // NOTE OFF
                 if (messageType == 0x90 and value2 > 0)
                 {
-                    // Note On
-
-                    //printf("NOTE ON on channel %i; note : %i velocity : %i\n", channel, value, value2);
-
-                    // FIXME: we are in a thread, not all players may be thread-safe!!
-                    if (self->m_playthrough) self->seq_note_on(value, value2, self->m_record_target->getChannel());
-
-                    NoteInfo n = {now_tick, value2};
-                    self->m_open_notes[value] = n;
+                    self->seq_note_on(value, value2, self->m_record_target->getChannel());
                 }
                 else
                 {
-                    // Note off
-
-                    //printf("NOTE OFF on channel %i; note : %i velocity : %i\n", channel, value, value2);
-
-                    // FIXME: we are in a thread, not all players may be thread-safe!!
-                    if (self->m_playthrough) self->seq_note_off(value, self->m_record_target->getChannel());
-
-                    if (self->m_open_notes.find(value) != self->m_open_notes.end())
-                    {
-                        NoteInfo n = self->m_open_notes[value];
-                        self->m_open_notes.erase(value);
-
-                        if (self->m_record_action != NULL)
-                        {
-                            wxMutexLocker lock(self->m_record_action_queue_lock);
-                            int channel = self->m_record_target->getChannel();
-                            // TODO: remove 131 - value old crap
-                            self->m_record_action_queue.push_back(new Action::AddNote((channel == 9 ? value : 131 - value),
-                                                                                      n.m_note_on_tick,
-                                                                                      now_tick,
-                                                                                      n.m_velocity,
-                                                                                      false));
-                        }
-                    }
+                    self->seq_note_off(value, self->m_record_target->getChannel());
                 }
                 break;
-
-            case 0xC0:
-                //printf("PROGRAM CHANGE on channel %i; instrument : %i\n", channel, value);
-                break;
-
+                
             case 0xE0:
-            {
-                float val = ControllerEvent::fromPitchBendValue((value | (value2 << 7)) - 8192);
-
-                // FIXME: when is m_record_action null?
-                if (self->m_record_action != NULL)
-                {
-                    wxMutexLocker lock(self->m_record_action_queue_lock);
-                    self->m_record_action_queue.push_back(new Action::AddControlEvent(now_tick, val,
-                                                                                      PSEUDO_CONTROLLER_PITCH_BEND));
-                }
-
-                // FIXME: we are in a thread, not all players may be thread-safe!!
-                if (self->m_playthrough) self->seq_pitch_bend((value | (value2 << 7)) - 8192,
-                                                              self->m_record_target->getChannel());
-
+                self->seq_pitch_bend((value | (value2 << 7)) - 8192, self->m_record_target->getChannel());
                 break;
-            }
+                
             case 0xB0:
-                if (self->m_record_action != NULL)
-                {
-                    wxMutexLocker lock(self->m_record_action_queue_lock);
-                    self->m_record_action_queue.push_back(new Action::AddControlEvent(now_tick,
-                                                                                      127 - value2 /* value */,
-                                                                                      value /* controller ID */));
-                }
+                self->seq_controlchange(value, value2, self->m_record_target->getChannel());
+                break;
+        }
+    }
+}
 
-                // FIXME: we are in a thread, not all players may be thread-safe!!
-                if (self->m_playthrough) self->seq_controlchange(value, value2,
-                                                                 self->m_record_target->getChannel());
+// ----------------------------------------------------------------------------------------------------------
 
+void PlatformMidiManager::processRecordedMessage(const RecordedMidiMessage& message, const int now_tick)
+{
+    const int messageType = message.m_bytes[0] & 0xF0;
+    const int channel     = message.m_bytes[0] & 0x0F;
+    const int value       = message.m_bytes[1];
+    const int value2      = message.m_bytes[2];
 
-                break;
+    //printf("message %x on channel %i = %i %i\n", messageType, channel, value, value2);
 
-            default:
-                printf("UNKNOWN EVENT %x on channel %i; value : %i %i\n", messageType, channel, value, value2);
+    switch (messageType)
+    {
+        case 0x90: // NOTE ON
+        case 0x80: // NOTE OFF
+            if (messageType == 0x90 and value2 > 0)
+            {
+                // Note On
+                m_open_notes[value].m_note_on_tick = now_tick;
+                m_open_notes[value].m_velocity     = value2;
+            }
+            else if (m_open_notes[value].m_note_on_tick != -1)
+            {
+                // Note off
+                const int trackChannel = m_record_target->getChannel();
+                
+                // TODO: remove 131 - value old crap
+                m_record_action->action(new Action::AddNote((trackChannel == 9 ? value : 131 - value),
+                                                            m_open_notes[value].m_note_on_tick,
+                                                            now_tick,
+                                                            m_open_notes[value].m_velocity,
+                                                            false));
+                m_open_notes[value].m_note_on_tick = -1;
+            }
+            break;
+
+        case 0xC0:
+            //printf("PROGRAM CHANGE on channel %i; instrument : %i\n", channel, value);
+            break;
 
+        case 0xE0:
+        {
+            float val = ControllerEvent::fromPitchBendValue((value | (value2 << 7)) - 8192);
+            m_record_action->action(new Action::AddControlEvent(now_tick, val, PSEUDO_CONTROLLER_PITCH_BEND));
+            break;
         }
-    }
+        case 0xB0:
+            m_record_action->action(new Action::AddControlEvent(now_tick,
+                                                                127 - value2 /* value */,
+                                                                value /* controller ID */));
+            break;
 
-    /*
-    for ( unsigned int i=0; i<nBytes; i++ )
-        std::cout << "Byte " << i << " = " << (int)message->at(i) << ", ";
-    if ( nBytes > 0 )
-        std::cout << "stamp = " << deltatime << std::endl;
-     */
+        default:
+            printf("UNKNOWN EVENT %x on channel %i; value : %i %i\n", messageType, channel, value, value2);
+    }
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -267,14 +301,31 @@ void PlatformMidiManager::processRecordQueue()
 {
     if (m_record_action == NULL) return;
 
-    // FIXME: this is a thread, and Sequence/Track are NOT thread-safe!!
-    wxMutexLocker lock(m_record_action_queue_lock);
-    const int count = m_record_action_queue.size();
-    for (int n=0; n<count; n++)
+    const Sequence* sequence = m_record_target->getSequence();
+    
+    RecordedMidiMessage message;
+    while (m_record_buffer.pop(message))
     {
-        m_record_action->action(m_record_action_queue.get(n));
+        if (message.m_anchor_tick != -1)
+        {
+            m_record_origin_time  = getTimeInSecondsAtTick(message.m_anchor_tick, sequence);
+            m_record_elapsed_time = 0.0;
+        }
+        else
+        {
+            m_record_elapsed_time += message.m_delta_time;
+        }
+        
+        const int tick = getTickAtTimeInSeconds(m_record_origin_time + m_record_elapsed_time, sequence);
+        processRecordedMessage(message, tick);
+        
+        const long long latency = MidiRecordBuffer::getMonotonicTime() - message.m_capture_time;
+        m_record_stats.m_message_count++;
+        m_record_stats.m_total_latency += latency;
+        if (latency > m_record_stats.m_max_latency) m_record_stats.m_max_latency = latency;
     }
-    m_record_action_queue.clearWithoutDeleting();
+    
+    m_record_stats.m_dropped_count = m_record_buffer.getDroppedCount();
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -322,6 +373,19 @@ bool PlatformMidiManager::startRecording(wxString outputPort, Track* target)
 
     m_recording = true;
     m_record_action = new Action::Record();
+    
+    m_record_buffer.reset();
+    m_record_anchored     = false;
+    m_record_skipped_time = 0.0;
+    m_record_origin_time  = 0.0;
+    m_record_elapsed_time = 0.0;
+    
+    m_record_stats.m_message_count = 0;
+    m_record_stats.m_dropped_count = 0;
+    m_record_stats.m_total_latency = 0;
+    m_record_stats.m_max_latency   = 0;
+    
+    for (int n=0; n<128; n++) m_open_notes[n].m_note_on_tick = -1;
 
     // add the action to the action stack so it can be undone
     m_record_target->action(m_record_action);
@@ -367,10 +431,6 @@ void PlatformMidiManager::stopRecording()
 
     processRecordQueue();
 
-    // it's supposed to have been emptied already but who knows...
-    if (m_record_action_queue.size() > 0) fprintf(stderr, "Why is m_record_action_queue not empty??\n");
-    m_record_action_queue.clearWithoutDeleting();
-
     delete m_midi_input;
     m_midi_input = NULL;
     m_record_action = NULL;
@@ -21,9 +21,9 @@
 #include <wx/string.h>
 #include <wx/arrstr.h>
 #include <wx/thread.h>
-#include <map>
 
 #include "Actions/EditAction.h"
+#include "Midi/Players/MidiRecordBuffer.h"
 #include "ptr_vector.h"
 #include "Utils.h"
 
@@ -62,6 +62,25 @@ namespace AriaMaestosa
      */
     class PlatformMidiManager
     {
+    public:
+        
+        /** @brief Statistics gathered during the last recording session */
+        struct RecordStatistics
+        {
+            /** Number of messages converted into edit actions */
+            int m_message_count;
+            
+            /** Number of messages lost because the record queue was full */
+            int m_dropped_count;
+            
+            /** Sum of the delays between capture on the MIDI thread and processing on the main thread,
+              * in microseconds */
+            long long m_total_latency;
+            
+            /** Longest delay between capture and processing, in microseconds */
+            long long m_max_latency;
+        };
+        
     protected:
         bool m_recording;
         RtMidiIn* m_midi_input;
@@ -72,8 +91,8 @@ namespace AriaMaestosa
             int m_velocity;
         };
         
-        /** Used when recording. Key is the midi note ID. */
-        std::map<int, NoteInfo> m_open_notes;
+        /** Used when recording. Indexed by midi note ID; m_note_on_tick is -1 for notes that are not held */
+        NoteInfo m_open_notes[128];
         
         PlatformMidiManager();
 
@@ -91,9 +110,26 @@ namespace AriaMaestosa
         /** Used while recording */
         Action::Record* m_record_action;
         
-        ptr_vector<Action::SingleTrackAction> m_record_action_queue;
+        /** Raw messages captured by the rtmidi thread, waiting to be processed by the main thread */
+        MidiRecordBuffer m_record_buffer;
+        
+        /** Only accessed from the rtmidi thread : whether the first message of the session was captured */
+        bool m_record_anchored;
+        
+        /** Only accessed from the rtmidi thread : device time of messages that were not queued, in seconds,
+          * to be added to the delta time of the next queued message */
+        double m_record_skipped_time;
+        
+        /** Song time of the first recorded message, in seconds */
+        double m_record_origin_time;
+        
+        /** Device time elapsed since the first recorded message, in seconds */
+        double m_record_elapsed_time;
         
-        wxMutex m_record_action_queue_lock;
+        RecordStatistics m_record_stats;
+        
+        /** @brief Converts a message popped from the record queue into an edit action (main thread only) */
+        void processRecordedMessage(const RecordedMidiMessage& message, const int tick);
         
     public:
         
@@ -105,6 +141,12 @@ namespace AriaMaestosa
         static PlatformMidiManager* get();
         static void registerManager(PlatformMidiManagerFactory* newManager);
         
+        /**
+         * @brief Use the given manager instead of the driver chosen in the preferences. Meant for
+         *        headless tools, must be called before anything else uses the MIDI manager.
+         */
+        static void installManager(PlatformMidiManager* manager);
+        
         /**
          * @brief                  starts playing the entire sequence, from the measure being marked as
          *                         the first one
@@ -138,7 +180,23 @@ namespace AriaMaestosa
         virtual void stop() = 0;
         
         virtual void exportAudioFile(Sequence* sequence, wxString filepath) = 0;
+
+        /**
+         * @brief  read, on the main thread, the preferences that renderAudioFile uses, since that one
+         *         runs on worker threads
+         */
+        virtual void prepareAudioRendering() { }
         
+        /**
+         * @brief  export to sampled audio without any user interface, and only return once done
+         *
+         * Used by batch conversion (see BatchConvert) : it may be called from several threads at once,
+         * for different sequences, and without initMidiPlayer having been called.
+         * @pre    prepareAudioRendering was called
+         * @return whether the file was written ; false if the manager cannot export audio this way
+         */
+        virtual bool renderAudioFile(Sequence* sequence, wxString filepath) { return false; }
+
         /**
          * @brief  called repeatedly during playback to know progression
          *
@@ -204,6 +262,9 @@ namespace AriaMaestosa
         
         bool isRecording() const { return m_recording; }
         
+        /** @brief Get statistics about the current (or last) recording session */
+        const RecordStatistics& getRecordStatistics() const { return m_record_stats; }
+        
         /** This method should be called very regularly while recording, *from the main thread*,
           * so that the PlatformMidiManager can perform tasks that otherwise could not have been done
           * from the MIDI record thread
@@ -239,7 +300,41 @@ namespace AriaMaestosa
           * @return false to stop it, true to continue
           */
         virtual bool seq_must_continue() { return false; }
-        
+
+        /**
+          * @brief   scheduled output support for the generic sequencer
+          * @return  how long (in nanoseconds) before their deadline events may be passed to the seq_*
+          *          functions, or 0 if the player can only play events at the moment they must sound.
+          * @note    when this returns a non-zero value, the generic sequencer calls @c seq_start_scheduling
+          *          when playback starts (and each time it loops), @c seq_set_event_time before each event,
+          *          @c seq_flush after each batch of events and @c seq_stop_scheduling when it exits.
+          */
+        virtual long long seq_get_lookahead() { return 0; }
+
+        /** @brief scheduled output : the origin of event times is now */
+        virtual void seq_start_scheduling() { }
+
+        /** @brief scheduled output : time (in nanoseconds since the origin) at which the next events must sound */
+        virtual void seq_set_event_time(const long long nanos) { }
+
+        /** @brief scheduled output : send the events of the current batch */
+        virtual void seq_flush() { }
+
+        /** @brief scheduled output : drop events that did not sound yet and return to immediate output */
+        virtual void seq_stop_scheduling() { }
+
+        /**
+          * @return how many output ports the generic sequencer may spread channels over (see ChannelAllocator);
+          *         players that return more than 1 must implement @c seq_set_port
+          */
+        virtual int seq_get_port_amount() { return 1; }
+
+        /**
+          * @brief the seq_* events that the calling thread sends from now on go to the given port
+          *        (events sent from other threads, e.g. preview notes, keep going to the first port)
+          */
+        virtual void seq_set_port(const int port) { }
+
         /** Get whether tp play through when recording */
         bool isPlayThrough() const { return m_playthrough; }
         
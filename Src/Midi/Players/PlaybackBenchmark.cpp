@@ -0,0 +1,228 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Midi/Players/PlaybackBenchmark.h"
+
+#include "AriaCore.h"
+#include "Headless.h"
+#include "GUI/GraphicalSequence.h"
+#include "Midi/CommonMidiUtils.h"
+#include "Midi/ControllerEvent.h"
+#include "Midi/Players/CaptureDevice.h"
+#include "Midi/Players/Sequencer.h"
+#include "Midi/Sequence.h"
+#include "Midi/Track.h"
+
+#include "jdksmidi/world.h"
+#include "jdksmidi/multitrack.h"
+#include "jdksmidi/sequencer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+using namespace AriaMaestosa;
+
+namespace AriaMaestosa
+{
+    namespace PlaybackBenchmark
+    {
+        /** Memory reserved for captured events; capturing more is allowed, but may allocate during playback */
+        const int CAPTURE_CAPACITY = 1 << 20;
+
+        /** Shape of the synthetic song : a few tracks of sixteenth notes over a controller sweep */
+        const int SYNTHETIC_TRACKS   = 8;
+        const int SYNTHETIC_MEASURES = 4;
+
+        void makeSyntheticSong(Sequence* seq)
+        {
+            const int beat = seq->ticksPerQuarterNote();
+            const int sixteenth = beat / 4;
+            const int length = SYNTHETIC_MEASURES * 4 * beat;
+
+            OwnerPtr<Sequence::Import> import(seq->startImport());
+
+            // a tempo change halfway, so that the tempo map is exercised
+            import->addTempoEvent( new ControllerEvent(PSEUDO_CONTROLLER_TEMPO, length / 2,
+                                                       convertBPMToTempoBend(150)) );
+
+            for (int t=0; t<SYNTHETIC_TRACKS; t++)
+            {
+                Track* track = new Track(seq);
+
+                for (int tick=0; tick<length; tick+=sixteenth)
+                {
+                    const int pitch = 40 + t * 5 + (tick / sixteenth) % 12;
+                    track->addNote_import(pitch, tick, tick + sixteenth, 100, -1);
+
+                    if (t == 0) track->addControlEvent_import(tick, (tick / sixteenth) % 128, 7 /* volume */);
+                }
+
+                seq->addTrack(track);
+            }
+        }
+
+        // ----------------------------------------------------------------------------------------------------------
+
+        /** @return the deadline of each event AriaSequenceTimer will send, in the order it will send them */
+        static void getDeadlines(const jdksmidi::MIDIMultiTrack* tracks, const PlaybackTempoMap& tempoMap,
+                                 const int songLengthInTicks, std::vector<long long>& deadlines)
+        {
+            jdksmidi::MIDISequencerCursor cursor(tracks);
+
+            jdksmidi::MIDIClockTime tick;
+            const jdksmidi::MIDITimedBigMessage* ev;
+            int track;
+
+            while (cursor.GetNextEventTime(&tick) and (int)tick <= songLengthInTicks and
+                   cursor.GetNextEvent(&track, &ev))
+            {
+                if (ev->IsNoteOn() or ev->IsNoteOff() or ev->IsControlChange() or ev->IsPitchBend() or
+                    ev->IsProgramChange())
+                {
+                    deadlines.push_back( tempoMap.tickToNanos(tick) );
+                }
+            }
+        }
+
+        // ----------------------------------------------------------------------------------------------------------
+
+        static double percentile(const std::vector<long long>& sorted, const double p)
+        {
+            if (sorted.empty()) return 0.0;
+            const int index = (int)(p * (sorted.size() - 1) + 0.5);
+            return sorted[index] / 1000000.0;
+        }
+
+        // ----------------------------------------------------------------------------------------------------------
+
+        static bool benchmarkSong(const char* name, Sequence* seq, CaptureMidiManager* capture)
+        {
+            capture->clear();
+
+            const long long prepareStart = CaptureMidiManager::getMonotonicTime();
+
+            jdksmidi::MIDIMultiTrack jdkmidiseq;
+            int songLengthInTicks = -1;
+            int startTick = 0;
+            int trackAmount = -1;
+            makeJDKMidiSequence(seq, jdkmidiseq, false, &songLengthInTicks, &startTick, &trackAmount,
+                                true /* for playback */);
+            jdksmidi::MIDISequencer jdksequencer(&jdkmidiseq);
+
+            const long long runStart = CaptureMidiManager::getMonotonicTime();
+            const std::clock_t cpuStart = std::clock();
+
+            AriaSequenceTimer timer(seq);
+            timer.run(&jdksequencer, songLengthInTicks);
+
+            const std::clock_t cpuEnd = std::clock();
+            const long long runEnd = CaptureMidiManager::getMonotonicTime();
+
+            const std::vector<CapturedMidiEvent>& events = capture->getEvents();
+            if (events.empty())
+            {
+                fprintf(stderr, "[benchmark] %s : nothing was played\n", name);
+                return false;
+            }
+
+            const PlaybackTempoMap tempoMap(&jdkmidiseq, seq->getTempo(), seq->ticksPerQuarterNote());
+            std::vector<long long> deadlines;
+            getDeadlines(&jdkmidiseq, tempoMap, songLengthInTicks, deadlines);
+
+            const int count = std::min(events.size(), deadlines.size());
+            if (count == 0)
+            {
+                fprintf(stderr, "[benchmark] %s : no events to compare\n", name);
+                return false;
+            }
+            if ((int)events.size() != (int)deadlines.size())
+            {
+                fprintf(stderr, "[benchmark] %s : %i events expected, %i received; comparing the first %i\n",
+                        name, (int)deadlines.size(), (int)events.size(), count);
+            }
+
+            // the first event is the reference; its own delay is reported as startup latency
+            std::vector<long long> lateness;
+            lateness.reserve(count);
+            for (int n=0; n<count; n++)
+            {
+                lateness.push_back( (events[n].m_time - events[0].m_time) - (deadlines[n] - deadlines[0]) );
+            }
+            std::sort(lateness.begin(), lateness.end());
+
+            const double prepareMs = (runStart - prepareStart) / 1000000.0;
+            const double startupMs = (events[0].m_time - runStart - deadlines[0]) / 1000000.0;
+            const double wallSeconds = (runEnd - runStart) / 1000000000.0;
+            const double cpuSeconds = (double)(cpuEnd - cpuStart) / CLOCKS_PER_SEC;
+
+            printf("[benchmark] %s\n", name);
+            printf("    %i events in %.3f s, %i tracks\n", (int)events.size(), wallSeconds, trackAmount);
+            printf("    prepare (makeJDKMidiSequence) : %.3f ms\n", prepareMs);
+            printf("    startup latency               : %.3f ms\n", startupMs);
+            printf("    lateness (ms) p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  min %.3f  max %.3f\n",
+                   percentile(lateness, 0.5), percentile(lateness, 0.9), percentile(lateness, 0.99),
+                   percentile(lateness, 0.999), lateness[0] / 1000000.0, lateness[count - 1] / 1000000.0);
+            printf("    CPU time                      : %.3f ms (%.2f %% of playback)\n",
+                   cpuSeconds * 1000.0, wallSeconds > 0 ? cpuSeconds * 100.0 / wallSeconds : 0.0);
+            printf("    throughput                    : %.1f events/s, %.0f events per CPU second\n",
+                   wallSeconds > 0 ? events.size() / wallSeconds : 0.0,
+                   cpuSeconds > 0 ? events.size() / cpuSeconds : 0.0);
+
+            // what the timer measured itself : event lateness against its own deadlines, and sleep jitter
+            timer.getTimingStats().print();
+
+            return true;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int PlaybackBenchmark::run(const wxArrayString& files)
+{
+    CaptureMidiManager* capture = new CaptureMidiManager(CAPTURE_CAPACITY);
+    PlatformMidiManager::installManager(capture);
+
+    bool success = true;
+
+    {
+        GraphicalSequence gseq( new Sequence(NULL, NULL, NULL, NULL, false) );
+        HeadlessSequenceProvider provider(&gseq);
+
+        makeSyntheticSong(gseq.getModel());
+        success = benchmarkSong("synthetic", gseq.getModel(), capture) and success;
+    }
+
+    for (unsigned int n=0; n<files.GetCount(); n++)
+    {
+        GraphicalSequence gseq( new Sequence(NULL, NULL, NULL, NULL, false) );
+        HeadlessSequenceProvider provider(&gseq);
+
+        if (Headless::loadFile(&gseq, files[n]))
+        {
+            success = benchmarkSong(files[n].utf8_str(), gseq.getModel(), capture) and success;
+        }
+        else
+        {
+            fprintf(stderr, "[benchmark] failed to load %s\n", (const char*)files[n].utf8_str());
+            success = false;
+        }
+    }
+
+    return (success ? 0 : 1);
+}
@@ -0,0 +1,48 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __PLAYBACK_BENCHMARK_H__
+#define __PLAYBACK_BENCHMARK_H__
+
+#include <wx/arrstr.h>
+
+namespace AriaMaestosa
+{
+    class Sequence;
+
+    /**
+      * @brief Headless measurement of playback timing (run with 'Aria --benchmark-playback [files]')
+      *
+      * Songs are converted with makeJDKMidiSequence and played in real time by AriaSequenceTimer into a
+      * CaptureMidiManager; the time at which each event was received is then compared to its deadline.
+      * @ingroup midi.players
+      */
+    namespace PlaybackBenchmark
+    {
+        /**
+          * @brief plays a synthetic song, then each of the given .aria or .mid files, and prints a report
+          * @note  the real MIDI driver is replaced by a CaptureMidiManager; nothing is heard
+          * @return process exit code
+          */
+        int run(const wxArrayString& files);
+        
+        /** @brief fill an empty sequence with a few tracks of fast notes, a controller sweep and a tempo change */
+        void makeSyntheticSong(Sequence* seq);
+    }
+
+}
+
+#endif
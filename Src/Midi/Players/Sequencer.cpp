@@ -16,6 +16,9 @@
 
 #include <wx/thread.h>
 
+#include <algorithm>
+#include <cstdio>
+
 #include "GUI/MainFrame.h"
 #include "Midi/Players/Sequencer.h"
 #include "Midi/CommonMidiUtils.h"
@@ -37,12 +40,23 @@
 #define HAVE_FTIME 1
 #endif
 
+#ifdef __linux__
+#define HAVE_CLOCK_NANOSLEEP 1
+#else
+#define HAVE_CLOCK_NANOSLEEP 0
+#endif
+
 #if HAVE_GETIMEOFDAY
 #include <sys/time.h>
 #else
 #include <sys/timeb.h>
 #endif
 
+#if HAVE_CLOCK_NANOSLEEP
+#include <errno.h>
+#include <time.h>
+#endif
+
 namespace AriaMaestosa
 {
 
@@ -136,19 +150,290 @@ typedef DummyTimer BasicTimer;
 
 #endif
 
+
+#if HAVE_CLOCK_NANOSLEEP
+
+/** Monotonic clock that can sleep until an absolute deadline, so that sleep errors do not accumulate */
+class DeadlineClock
+{
+    long long m_origin_ns;
+    
+    static long long now()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+    
+public:
+    
+    void reset() { m_origin_ns = now(); }
+    
+    long long getElapsedNanos() { return now() - m_origin_ns; }
+    
+    void sleepUntil(const long long elapsed_ns)
+    {
+        const long long target = m_origin_ns + elapsed_ns;
+        
+        timespec ts;
+        ts.tv_sec  = target / 1000000000LL;
+        ts.tv_nsec = target % 1000000000LL;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+    }
+};
+
+#else
+
+/** Fallback for platforms without clock_nanosleep : relative sleeps with millisecond granularity */
+class DeadlineClock
+{
+    BasicTimer m_timer;
+    
+public:
+    
+    void reset() { m_timer.reset_and_start(); }
+    
+    long long getElapsedNanos() { return (long long)m_timer.get_elapsed_millis() * 1000000LL; }
+    
+    void sleepUntil(const long long elapsed_ns)
+    {
+        const long long delta_ns = elapsed_ns - getElapsedNanos();
+        if (delta_ns > 0) wxThread::Sleep( (delta_ns + 999999) / 1000000 );
+    }
+};
+
+#endif
+
+/** Events due within this window after the current time are sent along with the current batch */
+const long long BATCH_WINDOW_NS = 1000000LL;
+
+/** Longest sleep between two wake-ups; progression feedback and stop requests are handled on wake-up */
+const long long MAX_SLEEP_NS = 10000000LL;
+
+// ------------------------------------------------------------
+//                        tempo map
+// ------------------------------------------------------------
+
+#if 0
+#pragma mark -
+#endif
+
+/** Nanoseconds per minute, times 32 since tempos are expressed in 1/32 bpm */
+const long long NANOS_PER_MINUTE_32 = 60LL * 1000000000LL * 32LL;
+
+PlaybackTempoMap::PlaybackTempoMap(const jdksmidi::MIDIMultiTrack* tracks, const int initialBPM,
+                                   const int ticksPerBeat)
+{
+    m_ticks_per_beat = ticksPerBeat;
+    
+    // gather tempo events from all tracks, in time order
+    std::vector< std::pair<long long, long long> > tempos;
+    const int trackCount = tracks->GetNumTracks();
+    for (int t=0; t<trackCount; t++)
+    {
+        const jdksmidi::MIDITrack* track = tracks->GetTrack(t);
+        const int eventCount = track->GetNumEvents();
+        for (int n=0; n<eventCount; n++)
+        {
+            const jdksmidi::MIDITimedBigMessage* msg = track->GetEventAddress(n);
+            if (msg->IsTempo() and msg->GetTempo32() > 0)
+            {
+                tempos.push_back( std::make_pair((long long)msg->GetTime(), (long long)msg->GetTempo32()) );
+            }
+        }
+    }
+    std::stable_sort(tempos.begin(), tempos.end());
+    
+    Segment first;
+    first.m_tick    = 0;
+    first.m_time_ns = 0;
+    first.m_tempo32 = initialBPM * 32;
+    m_segments.push_back(first);
+    
+    const int count = tempos.size();
+    for (int n=0; n<count; n++)
+    {
+        Segment& last = m_segments[m_segments.size() - 1];
+        if (tempos[n].first == last.m_tick)
+        {
+            // several tempo changes at the same tick, the last one wins
+            last.m_tempo32 = tempos[n].second;
+            continue;
+        }
+        
+        Segment segment;
+        segment.m_tick    = tempos[n].first;
+        segment.m_time_ns = tickToNanos(segment.m_tick);
+        segment.m_tempo32 = tempos[n].second;
+        m_segments.push_back(segment);
+    }
+}
+
+// ------------------------------------------------------------
+
+int PlaybackTempoMap::findSegmentForTick(const long long tick) const
+{
+    int low  = 0;
+    int high = m_segments.size() - 1;
+    while (low < high)
+    {
+        const int mid = (low + high + 1) / 2;
+        if (m_segments[mid].m_tick <= tick) low  = mid;
+        else                                high = mid - 1;
+    }
+    return low;
+}
+
+// ------------------------------------------------------------
+
+long long PlaybackTempoMap::tickToNanos(const long long tick) const
+{
+    const Segment& segment = m_segments[findSegmentForTick(tick)];
+    
+    // ns = delta * NANOS_PER_MINUTE_32 / divisor, split to avoid overflowing on long songs
+    const long long delta   = tick - segment.m_tick;
+    const long long divisor = segment.m_tempo32 * m_ticks_per_beat;
+    return segment.m_time_ns + delta * (NANOS_PER_MINUTE_32 / divisor) +
+           (delta * (NANOS_PER_MINUTE_32 % divisor)) / divisor;
+}
+
+// ------------------------------------------------------------
+
+int PlaybackTempoMap::nanosToTick(const long long nanos) const
+{
+    int low  = 0;
+    int high = m_segments.size() - 1;
+    while (low < high)
+    {
+        const int mid = (low + high + 1) / 2;
+        if (m_segments[mid].m_time_ns <= nanos) low  = mid;
+        else                                    high = mid - 1;
+    }
+    
+    // only used for progression feedback, floating point precision is plenty
+    const Segment& segment = m_segments[low];
+    return segment.m_tick + (int)((double)(nanos - segment.m_time_ns) * segment.m_tempo32 *
+                                  m_ticks_per_beat / NANOS_PER_MINUTE_32);
+}
+
+// ------------------------------------------------------------
+//                    timing statistics
+// ------------------------------------------------------------
+
+#if 0
+#pragma mark -
+#endif
+
+const int PlaybackTimingStats::BUCKET_LIMITS[] = { 1, 250, 500, 1000, 2000, 5000, 10000, -1 };
+
+void PlaybackTimingStats::reset()
+{
+    for (int n=0; n<BUCKET_COUNT; n++)
+    {
+        m_event_lateness[n]  = 0;
+        m_wakeup_lateness[n] = 0;
+    }
+    m_event_count            = 0;
+    m_wakeup_count           = 0;
+    m_max_event_lateness_ns  = 0;
+    m_max_wakeup_lateness_ns = 0;
+}
+
+// ------------------------------------------------------------
+
+static int findBucket(const long long lateness_ns)
+{
+    const long long micros = lateness_ns / 1000;
+    for (int n=0; n<PlaybackTimingStats::BUCKET_COUNT - 1; n++)
+    {
+        if (micros < PlaybackTimingStats::BUCKET_LIMITS[n]) return n;
+    }
+    return PlaybackTimingStats::BUCKET_COUNT - 1;
+}
+
+void PlaybackTimingStats::addEventLateness(const long long lateness_ns)
+{
+    m_event_lateness[findBucket(lateness_ns)]++;
+    m_event_count++;
+    if (lateness_ns > m_max_event_lateness_ns) m_max_event_lateness_ns = lateness_ns;
+}
+
+void PlaybackTimingStats::addWakeupLateness(const long long lateness_ns)
+{
+    m_wakeup_lateness[findBucket(lateness_ns)]++;
+    m_wakeup_count++;
+    if (lateness_ns > m_max_wakeup_lateness_ns) m_max_wakeup_lateness_ns = lateness_ns;
+}
+
+// ------------------------------------------------------------
+
+void PlaybackTimingStats::print() const
+{
+    printf("[AriaSequenceTimer] %i events, %i wake-ups; max lateness %.3f ms (events), %.3f ms (wake-ups)\n",
+           m_event_count, m_wakeup_count, m_max_event_lateness_ns / 1000000.0,
+           m_max_wakeup_lateness_ns / 1000000.0);
+    
+    for (int n=0; n<BUCKET_COUNT; n++)
+    {
+        if (n < BUCKET_COUNT - 1) printf("    < %6i us : ", BUCKET_LIMITS[n]);
+        else                      printf("   >= %6i us : ", BUCKET_LIMITS[n - 1]);
+        printf("%8i events %8i wake-ups\n", m_event_lateness[n], m_wakeup_lateness[n]);
+    }
+}
+
+// ------------------------------------------------------------
+//                        sequencer
+// ------------------------------------------------------------
+
+#if 0
+#pragma mark -
+#endif
+
 AriaSequenceTimer::AriaSequenceTimer(Sequence* seq)
 {
     m_seq = seq;
 }
 
-BasicTimer* timer = NULL;
+DeadlineClock* timer = NULL;
 
 void cleanup_sequencer()
 {
+    PlatformMidiManager::get()->seq_stop_scheduling();
+    
     if (timer != NULL) delete timer;
     timer = NULL;
 }
 
+/** With scheduled output, wait until the events already handed to the player have sounded */
+static void waitForScheduledEvents(const long long lookahead, const long long last_event_time)
+{
+    if (lookahead <= 0) return;
+    
+    PlatformMidiManager::get()->seq_flush();
+    timer->sleepUntil(last_event_time);
+}
+
+/** @brief send the following events to the given port, if they do not already go there */
+static void selectPort(const int port, int* current_port)
+{
+    if (port == *current_port) return;
+    PlatformMidiManager::get()->seq_set_port(port);
+    *current_port = port;
+}
+
+/** @brief all notes off on all channels of all ports */
+static void allNotesOff(const int port_amount, int* current_port)
+{
+    for (int port = 0; port < port_amount; port++)
+    {
+        selectPort(port, current_port);
+        for (int c = 0; c < 16; c++)
+        {
+            PlatformMidiManager::get()->seq_controlchange(0x7B /* all notes off */, 0, c);
+        }
+    }
+}
+
 int count = 0;
 
 class ReentrencyGuard
@@ -184,22 +469,24 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
 
     //std::cout << "trying to play " << seq->suggestFileName().mb_str() << std::endl;
 
-    jdksequencer->GoToTimeMs( 0 );
-
-    int bpm = m_seq->getTempo();
-    const int beatlen = m_seq->ticksPerQuarterNote();
+    const jdksmidi::MIDIMultiTrack* multitrack = jdksequencer->GetState()->multitrack;
 
-    double ticks_per_millis = (double)bpm * (double)beatlen / (double)60000.0;
+    // events are read in place, and beat markers are not needed here
+    jdksmidi::MIDISequencerCursor cursor(multitrack);
 
-    //std::cout << "bpm = " << bpm << " beatlen=" << beatlen << " ticks_per_millis=" << ticks_per_millis << std::endl;
+    const PlaybackTempoMap tempo_map(multitrack, m_seq->getTempo(), m_seq->ticksPerQuarterNote());
 
-    float next_event_time = 0;
+    // tracks may be spread over several output ports (see ChannelAllocator)
+    std::vector<int> track_ports;
+    const int port_amount = getJDKMidiTrackPorts(*multitrack, track_ports);
+    int current_port = 0;
+    PlatformMidiManager::get()->seq_set_port(0);
 
-    jdksmidi::MIDITimedBigMessage ev;
+    const jdksmidi::MIDITimedBigMessage* ev;
     int ev_track;
 
     jdksmidi::MIDIClockTime tick;
-    if (not jdksequencer->GetNextEventTime(&tick))
+    if (not cursor.GetNextEventTime(&tick))
     {
         std::cerr << "[AriaSequenceTimer] failed to get first event time, returning (did you try to play en empty sequence?)" << std::endl;
         cleanup_sequencer();
@@ -210,13 +497,20 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
     
     long previous_tick = tick;
     
-    next_event_time = tick / ticks_per_millis;
+    // absolute deadline of the next event, in nanoseconds since 'timer' was reset
+    long long next_event_time = tempo_map.tickToNanos(tick);
     
-    timer = new BasicTimer();
-    timer->reset_and_start();
+    m_timing_stats.reset();
     
-    long total_millis = 0;
-    long last_millis = 0;
+    // with scheduled output, events are handed to the player ahead of time, and the player
+    // takes care of sounding them at the right moment
+    PlatformMidiManager* manager = PlatformMidiManager::get();
+    const long long lookahead = manager->seq_get_lookahead();
+    const long long batch_window = std::max(BATCH_WINDOW_NS, lookahead);
+    
+    timer = new DeadlineClock();
+    timer->reset();
+    if (lookahead > 0) manager->seq_start_scheduling();
     
     int next_metronome_beat = -1;
     int played_metronome_tick = -1;
@@ -225,11 +519,18 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
     
     while (PlatformMidiManager::get()->seq_must_continue() or PlatformMidiManager::get()->isRecording())
     {
-        // process all events that need to be done by the current tick
-        while (next_event_time <= total_millis)
+        const long long now = timer->getElapsedNanos();
+        
+        // process, as one batch, all events that are due by the end of the current slot
+        while (next_event_time <= now + batch_window)
         {
-            if (not jdksequencer->GetNextEvent( &ev_track, &ev ))
+            if (lookahead > 0) manager->seq_set_event_time(next_event_time);
+            
+            bool got_event = true;
+            if (not cursor.GetNextEvent( &ev_track, &ev ))
             {
+                got_event = false;
+                
                 if (not PlatformMidiManager::get()->isRecording() and not m_seq->isLoopEnabled())
                 {
                     std::cerr << "error, failed to retrieve next event, returning" << std::endl;
@@ -255,71 +556,54 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
                         
                         if ((int)tick >= next_metronome_beat and next_metronome_beat != played_metronome_tick)
                         {
+                            selectPort(0, &current_port);
                             PlatformMidiManager::get()->seq_note_on(metronomeInstrument, metronomeVolume, 9);
                             played_metronome_tick = next_metronome_beat;
                         }
                     }
                 }
             }
-            const int channel = ev.GetChannel();
-
-            if (ev.IsNoteOn())
-            {
-                const int note = ev.GetNote();
-                const int volume = ev.GetVelocity();
-                PlatformMidiManager::get()->seq_note_on(note, volume, channel);
-            }
-            else if (ev.IsNoteOff())
-            {
-                const int note = ev.GetNote();
-                PlatformMidiManager::get()->seq_note_off(note, channel);
-            }
-            else if (ev.IsControlChange())
-            {
-                const int controllerID = ev.GetController();
-                const int value = ev.GetControllerValue();
-                PlatformMidiManager::get()->seq_controlchange(controllerID, value, channel);
-            }
-            else if (ev.IsPitchBend())
-            {
-                const int pitchBendVal = ev.GetBenderValue();
-                PlatformMidiManager::get()->seq_pitch_bend(pitchBendVal, channel);
-            }
-            else if (ev.IsProgramChange())
-            {
-                const int instrument = ev.GetPGValue();
-                PlatformMidiManager::get()->seq_prog_change(instrument, channel);
-            }
-            else if (ev.IsTempo())
+            
+            if (got_event)
             {
-                //std::cout << "tempo event" << std::endl;
-                const int event_bpm = ev.GetTempo32()/32;
-                ticks_per_millis = (double)event_bpm * (double)beatlen / (double)60000.0;
+                m_timing_stats.addEventLateness(now - next_event_time);
+                
+                selectPort(ev_track < (int)track_ports.size() ? track_ports[ev_track] : 0, &current_port);
+                const int channel = ev->GetChannel();
+
+                if (ev->IsNoteOn())
+                {
+                    const int note = ev->GetNote();
+                    const int volume = ev->GetVelocity();
+                    PlatformMidiManager::get()->seq_note_on(note, volume, channel);
+                }
+                else if (ev->IsNoteOff())
+                {
+                    const int note = ev->GetNote();
+                    PlatformMidiManager::get()->seq_note_off(note, channel);
+                }
+                else if (ev->IsControlChange())
+                {
+                    const int controllerID = ev->GetController();
+                    const int value = ev->GetControllerValue();
+                    PlatformMidiManager::get()->seq_controlchange(controllerID, value, channel);
+                }
+                else if (ev->IsPitchBend())
+                {
+                    const int pitchBendVal = ev->GetBenderValue();
+                    PlatformMidiManager::get()->seq_pitch_bend(pitchBendVal, channel);
+                }
+                else if (ev->IsProgramChange())
+                {
+                    const int instrument = ev->GetPGValue();
+                    PlatformMidiManager::get()->seq_prog_change(instrument, channel);
+                }
+                // tempo events need no handling here, they are part of the precomputed tempo map
             }
-            /*
-            else if ( ev.IsPolyPressure() )
-                std::cout << "poly pressure" << std::endl;
-            else if ( ev.IsChannelPressure() )
-                std::cout << "channel pressure" << std::endl;
-            else if ( ev.IsSystemMessage() )
-                std::cout << "system message " << std::hex << ev.GetType() << std::endl;
-
-            if ( ev.IsSysEx() )
-                std::cout << "sys ex " << ev.GetSysExNum() << std::endl;
-            else if ( ev.IsSongPosition() )
-                std::cout << "song position" << std::endl;
-            else if ( ev.IsNoOp() )
-                std::cout << "no op" << std::endl;
-            else if ( ev.IsBeatMarker() )
-                std::cout << "beat marker" << std::endl;
-            else
-            {
-                std::cout << "unknown event : " << ev.GetType() << std::endl;
-            }*/
 
             previous_tick = tick;
 
-            if (not jdksequencer->GetNextEventTime(&tick))
+            if (not cursor.GetNextEventTime(&tick))
             {
                 // if recording, continue as long as user doesn't press stop.
                 // if looping, continue until the loop point, wherever it may be
@@ -330,11 +614,14 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
                 }
                 else
                 {
+                    waitForScheduledEvents(lookahead, next_event_time);
                     cleanup_sequencer();
                     return;
                 }
             }
             
+            next_event_time = tempo_map.tickToNanos(tick);
+            
             if ((long)tick < (long) previous_tick) continue; // something wrong about time order...
             
             if (previous_tick >= (long)songLengthInTicks)
@@ -342,11 +629,14 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
                 // looping when recording makes no sense
                 if (m_seq->isLoopEnabled() and not PlatformMidiManager::get()->isRecording())
                 {
+                    // the end of the loop must have sounded before the origin is moved
+                    waitForScheduledEvents(lookahead, tempo_map.tickToNanos(previous_tick));
+                    
                     tick = 0;
                     previous_tick = 0;
                     
-                    jdksequencer->GoToTimeMs( 0 );
-                    if (not jdksequencer->GetNextEventTime(&tick))
+                    cursor.GoToZero();
+                    if (not cursor.GetNextEventTime(&tick))
                     {
                         std::cerr << "[AriaSequenceTimer] failed to get first event time, returning (did you try to play en empty sequence?)" << std::endl;
                         cleanup_sequencer();
@@ -357,26 +647,28 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
                     
                     previous_tick = tick;
                     
-                    next_event_time = tick / ticks_per_millis;
-                    
+                    // deadlines are relative to the start of the loop
                     timer->reset();
-                    
-                    total_millis = 0;
-                    last_millis = 0;
+                    next_event_time = tempo_map.tickToNanos(tick);
+                    if (lookahead > 0)
+                    {
+                        manager->seq_start_scheduling();
+                        manager->seq_set_event_time(0);
+                    }
                     
                     next_metronome_beat = -1;
                     played_metronome_tick = -1;
                     
                     next_beat = 0;
                     
-                    // all notes off on all channels
-                    for (int n = 0; n < 16; n++)
-                    {
-                        PlatformMidiManager::get()->seq_controlchange(0x7B /* all notes off */, 0, n);
-                    }
+                    allNotesOff(port_amount, &current_port);
+                    
+                    // the batch was started relative to the previous origin
+                    break;
                 }
                 else
                 {
+                    waitForScheduledEvents(lookahead, tempo_map.tickToNanos(previous_tick));
                     PlatformMidiManager::get()->seq_notify_current_tick(-1);
                     if (not PlatformMidiManager::get()->isRecording())
                     {
@@ -387,43 +679,38 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
                 }
             }
 
-            PlatformMidiManager::get()->seq_notify_current_tick(previous_tick);
-
-            //std::cout << "next_event_time was " << next_event_time << " adding " <<
-            //((tick - previous_tick) / ticks_per_millis) << " tick=" << tick <<
-            //" previous_tick=" << previous_tick << "ticks_per_millis=" << ticks_per_millis << std::endl;
-            next_event_time += (tick - previous_tick) / ticks_per_millis;
-
-            /*
-            static int i = 0;
-            i++; if (i>10) i=0;
-            if (i == 1)
-            {
-                std::cout << "next_event_time = " << next_event_time << "  -> tick = " << tick << std::endl;
-            }
-            */
-
+            // with scheduled output, events were sent ahead; progression is reported on wake-up instead
+            if (lookahead == 0) PlatformMidiManager::get()->seq_notify_current_tick(previous_tick);
         }
         
-        wxThread::Sleep(10);
-        
-        
-        last_millis = total_millis;
-        assert(timer != NULL);
-        const int delta = (timer->get_elapsed_millis() - last_millis);
+        long long wake_time;
+        if (lookahead > 0)
+        {
+            // the whole batch goes out at once; wake up when half of the look-ahead window was consumed
+            manager->seq_flush();
+            wake_time = std::min(next_event_time - lookahead / 2,
+                                 timer->getElapsedNanos() + std::max(MAX_SLEEP_NS, lookahead / 2));
+        }
+        else
+        {
+            // sleep until the next deadline, but wake up regularly to give feedback and check for stop requests
+            wake_time = std::min(next_event_time, timer->getElapsedNanos() + MAX_SLEEP_NS);
+        }
+        timer->sleepUntil(wake_time);
         
-        total_millis += delta;
+        const long long elapsed = timer->getElapsedNanos();
+        m_timing_stats.addWakeupLateness(elapsed - wake_time);
         
-        // FIXME; this will not play well with tempo changes
-        PlatformMidiManager::get()->seq_notify_accurate_current_tick(total_millis*ticks_per_millis);
+        const int current_tick = tempo_map.nanosToTick(elapsed);
+        PlatformMidiManager::get()->seq_notify_accurate_current_tick(current_tick);
+        if (lookahead > 0) PlatformMidiManager::get()->seq_notify_current_tick(current_tick);
         
         if (PlatformMidiManager::get()->isRecording())
         {
-            const int extend_tick = total_millis*ticks_per_millis;
-            if (extend_tick >= next_beat)
+            if (current_tick >= next_beat)
             {
                 wxCommandEvent evt(wxEVT_EXTEND_TICK, wxID_ANY);
-                evt.SetInt( extend_tick );
+                evt.SetInt( current_tick );
                 getMainFrame()->GetEventHandler()->AddPendingEvent( evt );
                 
                 Sequence* seq = getMainFrame()->getCurrentSequence();
@@ -432,10 +719,11 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
         }
     }
     
-    for (int c=0; c<16; c++)
-    {
-        PlatformMidiManager::get()->seq_controlchange(123 /* all notes off */, 0, c);
-    }
+    // drop what was scheduled but did not sound yet, so that the notes off below are immediate
+    PlatformMidiManager::get()->seq_stop_scheduling();
+    
+    allNotesOff(port_amount, &current_port);
+    selectPort(0, &current_port);
     
     cleanup_sequencer();
 }
@@ -443,5 +731,3 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
 
 
 }
-
-
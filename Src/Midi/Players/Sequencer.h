@@ -3,12 +3,12 @@
  it under the terms of the GNU General Public License as published by
  the Free Software Foundation; either version 2 of the License, or
  (at your option) any later version.
-
+ 
  This program is distributed in the hope that it will be useful,
  but WITHOUT ANY WARRANTY; without even the implied warranty of
  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  GNU General Public License for more details.
-
+ 
  You should have received a copy of the GNU General Public License along
  with this program; if not, write to the Free Software Foundation, Inc.,
  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
@@ -17,21 +17,114 @@
 #ifndef __ARIA_SEQUENCER_H__
 #define __ARIA_SEQUENCER_H__
 
-namespace jdksmidi{ class MIDISequencer; }
+#include <vector>
+
+namespace jdksmidi{ class MIDISequencer; class MIDIMultiTrack; }
 
 namespace AriaMaestosa
 {
 
     class Sequence;
+    
+    /**
+      * @brief Converts midi ticks to nanoseconds elapsed since the start of playback, considering
+      *        all tempo changes of a jdkmidi sequence.
+      *
+      * The map is computed once before playback; conversions from ticks are done in integer
+      * arithmetic from the start of the tempo segment they fall in, so error does not accumulate.
+      * @ingroup midi.players
+      */
+    class PlaybackTempoMap
+    {
+        struct Segment
+        {
+            long long m_tick;
+            long long m_time_ns;
+            
+            /** tempo in 1/32 bpm (see jdksmidi::MIDIMessage::GetTempo32) */
+            long long m_tempo32;
+        };
+        
+        std::vector<Segment> m_segments;
+        long long m_ticks_per_beat;
+        
+        int findSegmentForTick(const long long tick) const;
+        
+    public:
+        
+        /**
+          * @param tracks        the sequence that will be played
+          * @param initialBPM    tempo before the first tempo event
+          * @param ticksPerBeat  resolution of the sequence
+          */
+        PlaybackTempoMap(const jdksmidi::MIDIMultiTrack* tracks, const int initialBPM, const int ticksPerBeat);
+        
+        /** @return time at which the given tick is reached, in nanoseconds from the start of playback */
+        long long tickToNanos(const long long tick) const;
+        
+        /** @return tick reached after the given time, in nanoseconds from the start of playback */
+        int nanosToTick(const long long nanos) const;
+    };
+    
+    /**
+      * @brief Histograms of timing errors measured while playing with AriaSequenceTimer
+      * @ingroup midi.players
+      */
+    struct PlaybackTimingStats
+    {
+        /** upper bound (exclusive) of each histogram bucket, in microseconds; the last bucket is unbounded */
+        static const int BUCKET_LIMITS[];
+        static const int BUCKET_COUNT = 8;
+        
+        /** how late each event was sent compared to its deadline (events sent early as part of a batch
+          * fall in the first bucket) */
+        int m_event_lateness[BUCKET_COUNT];
+        
+        /** how late the playback thread woke up compared to the time it asked for (i.e. sleep jitter) */
+        int m_wakeup_lateness[BUCKET_COUNT];
+        
+        int       m_event_count;
+        int       m_wakeup_count;
+        long long m_max_event_lateness_ns;
+        long long m_max_wakeup_lateness_ns;
+        
+        PlaybackTimingStats() { reset(); }
+        
+        void reset();
+        void addEventLateness (const long long lateness_ns);
+        void addWakeupLateness(const long long lateness_ns);
+        
+        /** @brief print the histograms to stdout (reported by PlaybackBenchmark; see getTimingStats) */
+        void print() const;
+    };
 
+    /**
+      * @brief Generic sequencer, for platforms whose native API has none. Sends events to the
+      *        current PlatformMidiManager through its seq_* methods.
+      *
+      * Every event gets an absolute deadline computed from a PlaybackTempoMap; the thread sleeps until
+      * the next deadline and then sends, as one batch, all events that are due within a short window.
+      * @ingroup midi.players
+      */
     class AriaSequenceTimer
     {
         Sequence* m_seq;
         
+        PlaybackTimingStats m_timing_stats;
+        
     public:
 
         AriaSequenceTimer(Sequence* seq);
+        
+        /**
+          * @brief play the sequence; returns when playback is over or was stopped
+          * @param jdksequencer  only its multitrack is used, events are read in place through a
+          *                      jdksmidi::MIDISequencerCursor
+          */
         void run(jdksmidi::MIDISequencer* jdksequencer, const int songLengthInTicks);
+        
+        /** @return timing statistics of the last (or current) call to 'run' */
+        const PlaybackTimingStats& getTimingStats() const { return m_timing_stats; }
     };
 
 }
@@ -32,14 +32,18 @@ const int CURRENT_FILE_VERSION = 4;
 #include "Dialogs/WaitWindow.h"
 
 #include "IO/IOUtils.h"
+#include "IO/RecordedXMLReader.h"
 #include "Midi/CommonMidiUtils.h"
 #include "Midi/MeasureData.h"
 #include "Midi/Players/PlatformMidiManager.h"
 #include "Midi/Track.h"
+#include "GUI/GraphicalSequence.h"
 #include "GUI/GraphicalTrack.h"
 #include "PreferencesData.h"
 #include "Utils.h"
 
+#include <algorithm>
+
 #include <wx/intl.h>
 #include <wx/utils.h>
 #include <wx/msgdlg.h>
@@ -63,10 +67,27 @@ Sequence::Sequence(IPlaybackModeListener* playbackListener, IActionStackListener
     m_action_stack_listener     = actionStackListener;
     m_seq_data_listener         = sequenceDataListener;
     m_play_with_metronome       = false;
+    m_revision                  = 0;
+    m_tempo_map_valid           = false;
+    m_unsaved_changes           = false;
     m_playback_start_tick       = 0;
     m_default_key_type          = KEY_TYPE_C;
     m_default_key_symbol_amount = 0;
     
+    switch (PreferencesData::getInstance()->getIntValue(SETTING_ID_DEFAULT_EDITOR))
+    {
+        case 2:
+            m_default_notation_type = GUITAR;
+            break;
+        case 1:
+            m_default_notation_type = SCORE;
+            break;
+        case 0:
+        default:
+            m_default_notation_type = KEYBOARD;
+            break;
+    }
+    
     m_sequence_filename     = new Model<wxString>( _("Untitled") );
     channelManagement = CHANNEL_AUTO;
     m_copyright = wxT("");
@@ -92,6 +113,21 @@ Sequence::~Sequence()
 }
 
 
+// ----------------------------------------------------------------------------------------------------------
+
+void Sequence::setListeners(IPlaybackModeListener* playbackListener, IActionStackListener* actionStackListener,
+                            ISequenceDataListener* sequenceDataListener, IMeasureDataListener* measureListener)
+{
+    m_playback_listener     = playbackListener;
+    m_action_stack_listener = actionStackListener;
+    m_seq_data_listener     = sequenceDataListener;
+    
+    if (measureListener != NULL)
+    {
+        m_measure_data->addListener( measureListener );
+    }
+}
+
 // ----------------------------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------------------------
 
@@ -182,6 +218,7 @@ void Sequence::setChannelManagementType(ChannelManagementType type)
 void Sequence::setTicksPerQuarterNote(int res)
 {
     m_quarterNoteResolution = res;
+    invalidateTempoMap();
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -251,27 +288,101 @@ void Sequence::scale(float factor,
 void Sequence::setTempo(int tmp)
 {
     m_tempo = tmp;
+    invalidateTempoMap();
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
-float Sequence::getTempoAtTick(const int tick) const
+const std::vector<Sequence::TempoSegment>& Sequence::getTempoMap() const
 {
-    float outTempo = getTempo();
+    if (m_tempo_map_valid) return m_tempo_map;
     
+    m_tempo_map.clear();
+    m_tempo_map.reserve(m_tempo_events.size() + 1);
+    
+    TempoSegment segment;
+    segment.m_tick    = 0;
+    segment.m_seconds = 0.0;
+    segment.m_bpm     = m_tempo;
+    m_tempo_map.push_back(segment);
+    
+    const double ticksPerBeat = m_quarterNoteResolution;
     const int amount = m_tempo_events.size();
     for (int n=0; n<amount; n++)
     {
-        if (m_tempo_events[n].getTick() <= tick)
-        {
-            outTempo = convertTempoBendToBPM(m_tempo_events[n].getValue());
-        }
-        else
-        {
-            break;
-        }
+        const TempoSegment& previous = m_tempo_map[m_tempo_map.size() - 1];
+        const int tick = std::max(m_tempo_events[n].getTick(), previous.m_tick);
+        
+        segment.m_seconds = previous.m_seconds + (tick - previous.m_tick)*60.0/(previous.m_bpm*ticksPerBeat);
+        segment.m_tick    = tick;
+        segment.m_bpm     = convertTempoBendToBPM(m_tempo_events[n].getValue());
+        
+        // an event on the same tick as the previous one replaces it
+        if (tick == previous.m_tick) m_tempo_map[m_tempo_map.size() - 1] = segment;
+        else                         m_tempo_map.push_back(segment);
     }
-    return outTempo;
+    
+    m_tempo_map_valid = true;
+    return m_tempo_map;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int Sequence::findTempoSegmentAtTick(const int tick) const
+{
+    const std::vector<TempoSegment>& map = getTempoMap();
+    
+    int from = 0;
+    int to   = map.size() - 1;
+    while (from < to)
+    {
+        const int middle = (from + to + 1)/2;
+        if (map[middle].m_tick <= tick) from = middle;
+        else                            to   = middle - 1;
+    }
+    return from;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int Sequence::findTempoSegmentAtTime(const double seconds) const
+{
+    const std::vector<TempoSegment>& map = getTempoMap();
+    
+    int from = 0;
+    int to   = map.size() - 1;
+    while (from < to)
+    {
+        const int middle = (from + to + 1)/2;
+        if (map[middle].m_seconds <= seconds) from = middle;
+        else                                  to   = middle - 1;
+    }
+    return from;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+float Sequence::getTempoAtTick(const int tick) const
+{
+    return getTempoMap()[findTempoSegmentAtTick(tick)].m_bpm;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+double Sequence::getTimeInSecondsAtTick(const int tick) const
+{
+    const TempoSegment& segment = getTempoMap()[findTempoSegmentAtTick(tick)];
+    
+    return segment.m_seconds + (tick - segment.m_tick)*60.0/(segment.m_bpm*m_quarterNoteResolution);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int Sequence::getTickAtTimeInSeconds(const double seconds) const
+{
+    const TempoSegment& segment = getTempoMap()[findTempoSegmentAtTime(seconds)];
+    
+    return segment.m_tick + (int)round((seconds - segment.m_seconds)*segment.m_bpm*m_quarterNoteResolution/60.0);
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -288,6 +399,7 @@ void Sequence::addTempoEvent(ControllerEvent* evt, wxFloat64* previousValue)
 void Sequence::addTempoEvent_import( ControllerEvent* evt )
 {
     m_tempo_events.push_back(evt);
+    invalidateTempoMap();
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -298,6 +410,7 @@ void Sequence::addTempoEvent_import( ControllerEvent* evt )
 void Sequence::sortTempoEvents()
 {
     m_tempo_events.insertionSort();
+    invalidateTempoMap();
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -468,9 +581,14 @@ void Sequence::updateTrackPlayingStatus()
 
 void Sequence::action( Action::MultiTrackAction* actionObj)
 {
+    // any track may be modified
+    const int trackAmount = tracks.size();
+    for (int n=0; n<trackAmount; n++) tracks[n].markChanged();
+    
     addToUndoStack( actionObj );
     actionObj->setParentSequence(this, new SequenceVisitor(this));
     actionObj->perform();
+    invalidateTempoMap();
     
     if (m_action_stack_listener != NULL) m_action_stack_listener->onActionStackChanged();
     
@@ -481,6 +599,7 @@ void Sequence::action( Action::MultiTrackAction* actionObj)
 
 void Sequence::addToUndoStack( Action::EditAction* actionObj )
 {
+    m_revision++;
     undoStack.push_back(actionObj);
 
     if (PlatformMidiManager::get()->isRecording() and
@@ -516,8 +635,22 @@ void Sequence::undo()
         return;
     }
     
+    // tell the tracks that were modified, so that what was saved of them is not reused
+    Action::SingleTrackAction* trackAction = dynamic_cast<Action::SingleTrackAction*>(lastAction);
+    if (trackAction != NULL)
+    {
+        trackAction->getParentTrack()->markChanged();
+    }
+    else
+    {
+        const int trackAmount = tracks.size();
+        for (int n=0; n<trackAmount; n++) tracks[n].markChanged();
+    }
+    
     lastAction->undo();
     undoStack.erase( undoStack.size() - 1 );
+    m_revision++;
+    invalidateTempoMap();
 
     if (m_seq_data_listener != NULL) m_seq_data_listener->onSequenceDataChanged();
     
@@ -541,6 +674,15 @@ wxString Sequence::getTopActionName() const
 void Sequence::clearUndoStack()
 {
     undoStack.clearAndDeleteAll();
+    m_unsaved_changes = false;
+    if (m_action_stack_listener != NULL) m_action_stack_listener->onActionStackChanged();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Sequence::markUnsaved()
+{
+    m_unsaved_changes = true;
     if (m_action_stack_listener != NULL) m_action_stack_listener->onActionStackChanged();
 }
 
@@ -792,7 +934,7 @@ void Sequence::pasteAtMouse()
 #pragma mark I/O
 #endif
 
-void Sequence::saveToFile(wxFileOutputStream& fileout)
+void Sequence::saveToFile(wxOutputStream& fileout, GraphicalSequence* gseq)
 {
 
     writeData(wxT("<sequence"), fileout );
@@ -852,17 +994,15 @@ void Sequence::saveToFile(wxFileOutputStream& fileout)
     // ---- tracks
     for (int n=0; n<tracks.size(); n++)
     {
-        tracks[n].saveToFile(fileout);
+        tracks[n].saveToFile(fileout, gseq->getGraphicsFor(tracks.get(n)));
     }
     
     writeData(wxT("</sequence>"), fileout );
-    
-    clearUndoStack();
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
-bool Sequence::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
+bool Sequence::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq, ILoadMonitor* monitor)
 {
     m_importing = true;
     
@@ -903,8 +1043,16 @@ bool Sequence::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
             fileversion = atoi( (char*)fileFormatVersion );
             if (fileversion > CURRENT_FILE_VERSION )
             {
-                if (WaitWindow::isShown()) WaitWindow::hide();
-                wxMessageBox( _("Warning : you are opening a file saved with a version of\nAria Maestosa more recent than the version you currently have.\nIt may not open correctly.") );
+                const wxString message = _("Warning : you are opening a file saved with a version of\nAria Maestosa more recent than the version you currently have.\nIt may not open correctly.");
+                if (monitor != NULL)
+                {
+                    monitor->addWarning(message);
+                }
+                else
+                {
+                    if (WaitWindow::isShown()) WaitWindow::hide();
+                    wxMessageBox(message);
+                }
             }
         }
         const char* measureAmount_c = xml->getAttributeValue("measureAmount");
@@ -1043,6 +1191,8 @@ bool Sequence::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
                     // ---------- track ------
                     else if (strcmp("track", xml->getNodeName()) == 0)
                     {
+                        if (monitor != NULL and monitor->isCancelled()) return false;
+                        
                         Track* newTrack = new Track(this);
                         addTrack( newTrack );
                         
@@ -1158,7 +1308,8 @@ bool Sequence::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
     m_importing = false;
     if (m_seq_data_listener != NULL) m_seq_data_listener->onSequenceDataChanged();
 
-    parseBackgroundTracks();
+    // without a view, this is done by GraphicalSequence::applyPendingView
+    if (gseq != NULL) parseBackgroundTracks();
     
     updateTrackPlayingStatus();
 
@@ -1168,18 +1319,27 @@ bool Sequence::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
 
 }
 
+void Sequence::recordPendingView(irr::io::IrrXMLReader* xml)
+{
+    m_pending_view = new RecordedXMLReader();
+    m_pending_view->record(xml, false);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 void Sequence::parseBackgroundTracks()
 {
     GraphicalTrack* graphicalTrack;
  
+    // editors that aren't made yet do this themselves once they are
     for (int n=0; n<tracks.size(); n++)
     {
         graphicalTrack = tracks[n].getGraphics();
-        graphicalTrack->getEditorFor(SCORE)->addBackgroundTracks();
-        graphicalTrack->getEditorFor(GUITAR)->addBackgroundTracks();
-        graphicalTrack->getEditorFor(DRUM)->addBackgroundTracks();
-        graphicalTrack->getEditorFor(KEYBOARD)->addBackgroundTracks();
-        graphicalTrack->getEditorFor(CONTROLLER)->addBackgroundTracks();
+        for (int type=0; type<NOTATION_TYPE_COUNT; type++)
+        {
+            Editor* editor = graphicalTrack->getExistingEditor( (NotationType)type );
+            if (editor != NULL) editor->addBackgroundTracks();
+        }
     }
 }
 
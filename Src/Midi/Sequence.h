@@ -19,7 +19,7 @@
 
 #include <wx/string.h>
 
-class wxFileOutputStream;
+class wxOutputStream;
 // forward
 namespace irr { namespace io {
     class IXMLBase;
@@ -34,6 +34,7 @@ namespace irr { namespace io {
 
 #include <math.h> // for 'round'
 #include <string>
+#include <vector>
 
 
 namespace AriaMaestosa
@@ -42,6 +43,8 @@ namespace AriaMaestosa
     class ControllerEvent;
     class MeasureBar;
     class IMeasureDataListener;
+    class ILoadMonitor;
+    class RecordedXMLReader;
 
     const int DEFAULT_SONG_LENGTH = 12;
     
@@ -123,6 +126,12 @@ namespace AriaMaestosa
         ChannelManagementType channelManagement;
 
         ptr_vector<Action::EditAction> undoStack;
+        
+        /** Incremented each time an action is performed or undone */
+        int m_revision;
+        
+        /** Set when the sequence has unsaved changes that cannot be undone (e.g. a recovered file) */
+        bool m_unsaved_changes;
 
         IPlaybackModeListener* m_playback_listener;
         
@@ -146,8 +155,38 @@ namespace AriaMaestosa
         OwnerPtr< Model<wxString> > m_sequence_filename;
         OwnerPtr<MeasureData>       m_measure_data;
         
+        /** \<seqview\> read while no view existed, kept for GraphicalSequence::applyPendingView */
+        OwnerPtr<RecordedXMLReader> m_pending_view;
+        
         ptr_vector<ControllerEvent> m_tempo_events;
         ptr_vector<TextEvent>       m_text_events;
+        
+        /** A stretch of the song played at a constant tempo */
+        struct TempoSegment
+        {
+            int    m_tick;
+            
+            /** Time at which the segment starts, from the start of the song */
+            double m_seconds;
+            
+            float  m_bpm;
+        };
+        
+        /**
+          * The main tempo followed by one segment per tempo event, in order, so that conversions between
+          * ticks and seconds are a binary search away. Built lazily, see invalidateTempoMap.
+          */
+        mutable std::vector<TempoSegment> m_tempo_map;
+        mutable bool m_tempo_map_valid;
+        
+        /** @brief build m_tempo_map again if it was invalidated */
+        const std::vector<TempoSegment>& getTempoMap() const;
+        
+        /** @return index in the tempo map of the last segment starting at or before the given tick */
+        int findTempoSegmentAtTick(const int tick) const;
+        
+        /** @return index in the tempo map of the last segment starting at or before the given time */
+        int findTempoSegmentAtTime(const double seconds) const;
 
         /** this object is to be modified by MainFrame, to remember where to save this sequence */
         wxString m_filepath;
@@ -171,6 +210,12 @@ namespace AriaMaestosa
         
         int m_default_key_symbol_amount;
         
+        /**
+          * editor that new tracks open with ; read from the preferences when the sequence is created, so
+          * that tracks can then be created on a worker thread (see AsyncFileLoader)
+          */
+        NotationType m_default_notation_type;
+        
         
      public:
         
@@ -216,6 +261,13 @@ namespace AriaMaestosa
         
         void addTrackSetListener(ITrackSetListener* l) { m_listeners.push_back(l); }
         
+        /**
+         * @brief set the listeners of a sequence that was built without them (e.g. loaded on a
+         *        worker thread, see AsyncFileLoader)
+         */
+        void setListeners(IPlaybackModeListener* playbackListener, IActionStackListener* actionStackListener,
+                          ISequenceDataListener* sequenceDataListener, IMeasureDataListener* measureListener);
+        
         /**
          * @brief perform an action that affects multiple tracks
          *
@@ -242,14 +294,32 @@ namespace AriaMaestosa
         /** @return the name of the Action at the top of the undo stack */
         wxString getTopActionName() const;
         
-        /** @brief forbid undo, by dropping all undo information kept in memory. */
+        /**
+          * @brief forbid undo, by dropping all undo information kept in memory.
+          *        This also forgets about changes marked with markUnsaved.
+          */
         void clearUndoStack();
         
+        /** @brief consider the sequence modified, though there is nothing to undo */
+        void markUnsaved();
+        
+        /**
+          * @return a number that changes each time an action is performed or undone, in any track
+          * @see    Track::getRevision
+          */
+        int getRevision() const { return m_revision; }
+        
         /** @return is there something to undo? */
         bool somethingToUndo() const
         {
             return undoStack.size() > 0;
         }
+        
+        /** @return whether closing the sequence would lose changes */
+        bool hasUnsavedChanges() const
+        {
+            return m_unsaved_changes or somethingToUndo();
+        }
 
         wxString suggestFileName() const;
         wxString suggestTitle() const;
@@ -319,6 +389,23 @@ namespace AriaMaestosa
         /** @return the tempo at any tick (not necessarily a tick where there is a tempo change event) */
         float getTempoAtTick(const int tick) const;
         
+        /**
+          * @return Time elapsed from the start of the song to the given tick, in seconds, considering all
+          *         tempo changes. Logarithmic in the amount of tempo events.
+          * @note   the tempo map is built lazily, so like the rest of the sequence this is only to be used
+          *         from the thread that owns it
+          */
+        double getTimeInSecondsAtTick(const int tick) const;
+        
+        /** @return the tick reached after the given amount of seconds from the start of the song */
+        int getTickAtTimeInSeconds(const double seconds) const;
+        
+        /**
+          * @brief Call when the tempo or the tempo events changed, so that the tempo map is built again.
+          *        This is already done by the setters of this class, and after each action and undo.
+          */
+        void invalidateTempoMap() { m_tempo_map_valid = false; }
+        
         void  addTempoEvent(ControllerEvent* evt, wxFloat64* previousValue);
         void sortTempoEvents();
         void sortTextEvents();
@@ -327,9 +414,9 @@ namespace AriaMaestosa
         
         int                    getTempoEventAmount() const { return m_tempo_events.size();  }
         const ControllerEvent* getTempoEvent(int id) const { return m_tempo_events.getConst(id); }
-        void eraseTempoEvent(int id) { m_tempo_events.erase(id); }
-        void setTempoEventValue(int id, int newValue) { m_tempo_events[id].setValue(newValue); }
-        void setTempoEventTick (int id, int newTick)  { m_tempo_events[id].setTick(newTick);  }
+        void eraseTempoEvent(int id) { m_tempo_events.erase(id); invalidateTempoMap(); }
+        void setTempoEventValue(int id, int newValue) { m_tempo_events[id].setValue(newValue); invalidateTempoMap(); }
+        void setTempoEventTick (int id, int newTick)  { m_tempo_events[id].setTick(newTick);   invalidateTempoMap(); }
         ControllerEvent* getTempoEventAt(int tick);
 
         /** @return Returns the old value there was, if any, before this new event replaces it.*/
@@ -350,9 +437,10 @@ namespace AriaMaestosa
         {
             ControllerEvent* evt = m_tempo_events.get(id);
             m_tempo_events.markToBeRemoved(id);
+            invalidateTempoMap();
             return evt;
         }
-        void removeMarkedTempoEvents()        { m_tempo_events.removeMarked();      }
+        void removeMarkedTempoEvents()        { m_tempo_events.removeMarked(); invalidateTempoMap(); }
 
         TextEvent* extractTextEvent(int id)
         {
@@ -443,15 +531,31 @@ namespace AriaMaestosa
         int getDefaultKeySymbolAmount() { return m_default_key_symbol_amount; }
         void setDefaultKeySymbolAmount(int symbolAmount) { m_default_key_symbol_amount = symbolAmount; }
         
+        /** @return the editor that new tracks open with (KEYBOARD, SCORE or GUITAR) */
+        NotationType getDefaultNotationType() const { return m_default_notation_type; }
+        
         bool invariant();
         
         // ---- serialization
         
-        /** Called when saving \<Sequence\> ... \</Sequence\> in .aria file */
-        void saveToFile(wxFileOutputStream& fileout);
+        /**
+         * @brief Called when saving \<Sequence\> ... \</Sequence\> in .aria file
+         * @param gseq  the view of this sequence, whose track editor settings are saved too
+         */
+        void saveToFile(wxOutputStream& fileout, GraphicalSequence* gseq);
+        
+        /**
+         * @brief Called when reading \<sequence\> ... \</sequence\> in .aria file
+         *
+         * @param gseq     the view of this sequence, or NULL to only build the model ; view settings
+         *                 are then kept until GraphicalSequence::applyPendingView is called
+         * @param monitor  if not NULL, receives warnings (instead of showing them) and is asked
+         *                 between tracks whether to give up
+         */
+        bool readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq, ILoadMonitor* monitor = NULL);
         
-        /** Called when reading \<sequence\> ... \</sequence\> in .aria file */
-        bool readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq);
+        /** @brief keep the \<seqview\> node the reader is on, read while no view existed */
+        void recordPendingView(irr::io::IrrXMLReader* xml);
 
     };
     
@@ -28,13 +28,19 @@
 #include "Editors/DrumEditor.h"
 
 #include "IO/IOUtils.h"
+#include "IO/RecordedXMLReader.h"
+#include "IO/SequenceSnapshot.h"
 #include "Midi/Track.h"
 #include "Midi/Sequence.h"
 #include "Midi/ControllerEvent.h"
 #include "Midi/DrumChoice.h"
+#include "Midi/GuitarFingering.h"
 #include "Midi/MeasureData.h"
 #include "PreferencesData.h"
+#include "UnitTest.h"
+#include "UnitTestUtils.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "jdksmidi/world.h"
@@ -43,6 +49,7 @@
 #include <wx/intl.h>
 #include <wx/utils.h>
 #include "irrXML/irrXML.h"
+#include <wx/mstream.h>
 #include <wx/stopwatch.h>
 
 using namespace AriaMaestosa;
@@ -68,22 +75,20 @@ Track::Track(Sequence* sequence)
         m_editor_mode[n] = false;
     }
 
-    // set default editor
-    switch (PreferencesData::getInstance()->getIntValue(SETTING_ID_DEFAULT_EDITOR))
-    {
-        case 2:
-            m_editor_mode[GUITAR] = true;
-            break;
-        case 1:
-            m_editor_mode[SCORE] = true;
-            break;
-        case 0:
-        default:
-            m_editor_mode[KEYBOARD] = true;
-            break;
-    }
+    // set default editor (not read from the preferences, tracks may be created on a loading thread)
+    m_editor_mode[sequence->getDefaultNotationType()] = true;
 
     m_listener = NULL;
+    m_revision = 0;
+    m_saved_events_revision = -1;
+    
+    m_selection_valid     = false;
+    m_selection_structure = 0;
+    
+    m_long_note_length         = 0;
+    m_long_notes_revision      = -1;
+    m_long_notes_structure     = 0;
+    m_long_notes_off_structure = 0;
 
     // init key data
     setKey(sequence->getDefaultKeySymbolAmount(),
@@ -148,9 +153,11 @@ Track::~Track()
 
 void Track::action( Action::SingleTrackAction* actionObj)
 {
+    m_revision++;
     actionObj->setParentTrack(this, new TrackVisitor(this));
     m_sequence->addToUndoStack( actionObj );
     actionObj->perform();
+    m_sequence->invalidateTempoMap();
     
     ASSERT(m_sequence->invariant());
 }
@@ -262,7 +269,11 @@ void Track::addControlEvent( ControllerEvent* evt, wxFloat64* previousValue )
     if (previousValue != NULL) *previousValue = -1;
 
     // tempo events
-    if (evt->getController() == PSEUDO_CONTROLLER_TEMPO) vector = &m_sequence->m_tempo_events;
+    if (evt->getController() == PSEUDO_CONTROLLER_TEMPO)
+    {
+        vector = &m_sequence->m_tempo_events;
+        m_sequence->invalidateTempoMap();
+    }
     // controller and pitch bend events
     else vector = &m_control_events;
 
@@ -416,6 +427,11 @@ int getNoteEndTick(Note* note)
     return note->getEndTick();
 }
 
+static bool endsBefore(const Note* a, const Note* b)
+{
+    return a->getEndTick() < b->getEndTick();
+}
+
 void Track::reorderNoteOffVector()
 {
     m_note_off.insertionSort(getNoteEndTick);
@@ -430,6 +446,103 @@ void Track::reorderControlVector()
 
 // ----------------------------------------------------------------------------------------------------------
 
+static int getControlEventTick(ControllerEvent* evt)
+{
+    return evt->getTick();
+}
+
+void Track::shiftTicksAfter(const int afterTick, const int amountInTicks)
+{
+    // all notes that move are at the end of the note vector, and they keep their order. In the note off
+    // vector, only those ending after 'afterTick' can have changed places.
+    const int firstNoteOff = m_note_off.findFirstAfter(getNoteEndTick, afterTick);
+    
+    const int noteAmount = m_notes.size();
+    for (int n=m_notes.findFirstAfter(getNoteTick, afterTick); n<noteAmount; n++)
+    {
+        Note& note = m_notes[n];
+        note.setTick(note.getTick() + amountInTicks);
+        note.setEndTick(note.getEndTick() + amountInTicks);
+    }
+    m_note_off.insertionSort(getNoteEndTick, firstNoteOff);
+    
+    const int controlAmount = m_control_events.size();
+    for (int n=m_control_events.findFirstAfter(getControlEventTick, afterTick); n<controlAmount; n++)
+    {
+        m_control_events[n].setTick(m_control_events[n].getTick() + amountInTicks);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::extractNotesInRange(const int fromTick, const int toTick, ptr_vector<Note>& removed)
+{
+    const int first = m_notes.findFirstAfter(getNoteTick, fromTick);
+    const int last  = m_notes.findFirstAfter(getNoteTick, toTick - 1);
+    if (first >= last) return;
+    
+    for (int n=first; n<last; n++)
+    {
+        removed.push_back(m_notes.get(n));
+        m_notes.markToBeRemoved(n);
+    }
+    
+    // the removed notes all end after 'fromTick'
+    const int noteOffAmount = m_note_off.size();
+    for (int n=m_note_off.findFirstAfter(getNoteEndTick, fromTick); n<noteOffAmount; n++)
+    {
+        const int tick = m_note_off[n].getTick();
+        if (tick > fromTick and tick < toTick) m_note_off.markToBeRemoved(n);
+    }
+    
+    m_notes.removeMarked();
+    m_note_off.removeMarked();
+    ASSERT_E(m_notes.size(), ==, m_note_off.size());
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::insertNotes(const std::vector<Note*>& notes)
+{
+    if (notes.empty()) return;
+    
+    const int startTick = notes[0]->getTick();
+    const int index     = m_notes.findFirstAfter(getNoteTick, startTick - 1);
+    m_notes.add(notes, index);
+    
+    // if the range was not empty after all, keep the vector in order
+    const int next = index + notes.size();
+    if (next < m_notes.size() and m_notes[next].getTick() < notes[notes.size() - 1]->getTick())
+    {
+        m_notes.insertionSort(getNoteTick, index);
+    }
+    
+    // notes of the block do not necessarily end in order; place them among the notes ending after the
+    // block starts, and sort that part only
+    const int firstNoteOff = m_note_off.findFirstAfter(getNoteEndTick, startTick - 1);
+    m_note_off.add(notes, firstNoteOff);
+    m_note_off.insertionSort(getNoteEndTick, firstNoteOff);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::insertControlEvents(const std::vector<ControllerEvent*>& events)
+{
+    if (events.empty()) return;
+    
+    const int index = m_control_events.findFirstAfter(getControlEventTick, events[0]->getTick() - 1);
+    m_control_events.add(events, index);
+    
+    const int next = index + events.size();
+    if (next < m_control_events.size() and
+        m_control_events[next].getTick() < events[events.size() - 1]->getTick())
+    {
+        m_control_events.insertionSort(getControlEventTick, index);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 void Track::mergeTrackIn(Track* track)
 {
     const int noteAmount = track->m_notes.size();
@@ -606,6 +719,84 @@ int Track::findLastNoteInRange(const int fromTick, const int toTick) const
 
 // ----------------------------------------------------------------------------------------------------------
 
+void Track::updateLongNotes() const
+{
+    if (m_long_notes_revision      == m_revision                        and
+        m_long_notes_structure     == m_notes.getStructureRevision()    and
+        m_long_notes_off_structure == m_note_off.getStructureRevision())
+    {
+        return;
+    }
+    
+    // notes longer than a 4/4 measure are rare enough to be checked one by one
+    m_long_note_length = m_sequence->ticksPerQuarterNote()*4;
+    
+    m_long_notes.clear();
+    const int count = m_notes.size();
+    for (int n=0; n<count; n++)
+    {
+        if (m_notes[n].getEndTick() - m_notes[n].getTick() > m_long_note_length) m_long_notes.push_back(n);
+    }
+    
+    m_long_notes_revision      = m_revision;
+    m_long_notes_structure     = m_notes.getStructureRevision();
+    m_long_notes_off_structure = m_note_off.getStructureRevision();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool Track::findNotesOverlappingRange(const int fromTick, const int toTick, int& firstNote, int& lastNote,
+                                      std::vector<int>& longNotes) const
+{
+    const int noteAmount = m_notes.size();
+    if (noteAmount == 0) return false;
+    
+    ASSERT_E(m_note_off.size(), ==, noteAmount);
+    
+    updateLongNotes();
+    
+    // binary search for the first note starting at or after 'toTick'; the one before it is the last to consider
+    int low  = 0;
+    int high = noteAmount;
+    while (low < high)
+    {
+        const int mid = (low + high) / 2;
+        if (m_notes[mid].getTick() < toTick) low = mid + 1;
+        else                                 high = mid;
+    }
+    const int last = low - 1;
+    if (last < 0) return false;
+    
+    // notes that are not long notes and still sound at 'fromTick' started at most 'm_long_note_length'
+    // ticks earlier; binary search for the first note starting from there
+    const int earliestTick = fromTick - m_long_note_length;
+    low  = 0;
+    high = last + 1;
+    while (low < high)
+    {
+        const int mid = (low + high) / 2;
+        if (m_notes[mid].getTick() < earliestTick) low = mid + 1;
+        else                                       high = mid;
+    }
+    const int first = low;
+    
+    // long notes that started even earlier, and still sound within the range
+    longNotes.clear();
+    const int longNoteAmount = m_long_notes.size();
+    for (int n=0; n<longNoteAmount and m_long_notes[n] < first; n++)
+    {
+        if (m_notes[m_long_notes[n]].getEndTick() > fromTick) longNotes.push_back(m_long_notes[n]);
+    }
+    
+    if (first > last and longNotes.empty()) return false;
+    
+    firstNote = first;
+    lastNote  = last;
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 int Track::getControllerEventAmount(const bool isLyrics, const bool isTempo) const
 {
     if (isTempo)       return m_sequence->getTempoEventAmount();
@@ -666,34 +857,106 @@ int Track::getFirstNoteTick(bool selectionOnly) const
 
     if (not selectionOnly) return m_notes[0].getTick();
 
-    const int noteAmount = m_notes.size();
-    int tick = -1;
+    const int firstSelected = getFirstSelectedNote();
+    if (firstSelected == -1) return -1;
+    return m_notes[firstSelected].getTick();
 
-    for (int n=0; n<noteAmount; n++)
-    {
-        if ( m_notes[n].isSelected() ) return m_notes[n].getTick();
-    }//next
+}
 
-    return tick;
+// ----------------------------------------------------------------------------------------------------------
 
+int Track::getFirstSelectedNote() const
+{
+    updateSelection();
+    if (m_selection.empty()) return -1;
+    return m_selection[0];
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
-int Track::getFirstSelectedNote() const
+int Track::getSelectedNoteCount() const
+{
+    updateSelection();
+    return m_selection.size();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const std::vector<int>& Track::getSelectedNotes() const
 {
+    updateSelection();
+    return m_selection;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::updateSelection() const
+{
+    if (m_selection_valid and m_selection_structure == m_notes.getStructureRevision()) return;
+    
+    m_selection.clear();
     const int count = m_notes.size();
     for (int n=0; n<count; n++)
     {
-        if (m_notes[n].isSelected()) return n;
+        if (m_notes[n].isSelected()) m_selection.push_back(n);
+    }
+    
+    m_selection_valid     = true;
+    m_selection_structure = m_notes.getStructureRevision();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::setNoteSelected(const int id, const bool selected)
+{
+    Note& note = m_notes[id];
+    if (note.m_selected == selected) return;
+    
+    updateSelection();
+    note.m_selected = selected;
+    
+    std::vector<int>::iterator it = std::lower_bound(m_selection.begin(), m_selection.end(), id);
+    if (selected)
+    {
+        m_selection.insert(it, id);
+    }
+    else
+    {
+        ASSERT(it != m_selection.end() and *it == id);
+        m_selection.erase(it);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::selectNotesInRange(const int fromTick, const int toTick, const bool selected,
+                               const int fromPitchID, const int toPitchID)
+{
+    m_revision++;
+    
+    // notes are sorted by start tick, binary search for the first one in range
+    int low  = 0;
+    int high = m_notes.size();
+    while (low < high)
+    {
+        const int mid = (low + high) / 2;
+        if (m_notes[mid].getTick() < fromTick) low = mid + 1;
+        else                                   high = mid;
+    }
+    
+    const int noteAmount = m_notes.size();
+    for (int n=low; n<noteAmount and m_notes[n].getTick() < toTick; n++)
+    {
+        const int pitch = m_notes[n].getPitchID();
+        if (pitch >= fromPitchID and pitch <= toPitchID) setNoteSelected(n, selected);
     }
-    return -1;
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
 void Track::selectNote(const int id, const bool selected, bool ignoreModifiers)
 {
+    m_revision++;
     ASSERT(id != SELECTED_NOTES); // not supported in this function
 
     if (not ignoreModifiers and not Display::isSelectMorePressed() and
@@ -711,13 +974,29 @@ void Track::selectNote(const int id, const bool selected, bool ignoreModifiers)
         {
          */
 
-            if (ignoreModifiers)
+            if (ignoreModifiers and selected)
             {
+                m_selection.clear();
                 const int count = m_notes.size();
                 for (int n=0; n<count; n++)
                 {
-                    m_notes[n].setSelected(selected);
+                    m_notes[n].m_selected = true;
+                    m_selection.push_back(n);
                 }//next
+                
+                m_selection_valid     = true;
+                m_selection_structure = m_notes.getStructureRevision();
+            }
+            else if (ignoreModifiers)
+            {
+                // only the selected notes need to be visited
+                updateSelection();
+                const int count = m_selection.size();
+                for (int n=0; n<count; n++)
+                {
+                    m_notes[m_selection[n]].m_selected = false;
+                }//next
+                m_selection.clear();
             }//end if
 
         /*
@@ -733,15 +1012,15 @@ void Track::selectNote(const int id, const bool selected, bool ignoreModifiers)
         // if we ignore +/- key modifiers, just set the value right away
         if (ignoreModifiers)
         {
-            m_notes[id].setSelected(selected);
+            setNoteSelected(id, selected);
         }
         else
         {
             // otherwise, check key modifiers and set value accordingly
             if (selected)
             {
-                if      (Display::isSelectMorePressed()) m_notes[id].setSelected(true);
-                else if (Display::isSelectLessPressed()) m_notes[id].setSelected(not selected);
+                if      (Display::isSelectMorePressed()) setNoteSelected(id, true);
+                else if (Display::isSelectLessPressed()) setNoteSelected(id, not selected);
             }
         }//end if
 
@@ -762,9 +1041,38 @@ bool Track::isNoteSelected(const int id) const
 void Track::updateNotesForGuitarEditor()
 {
     const int amount = m_notes.size();
+    
+    std::vector<int> outdated;
+    for (int n=0; n<amount; n++)
+    {
+        if (not m_notes[n].isStringAndFretInSync()) outdated.push_back(n);
+    }
+    
+    if (outdated.empty()) return;
+    
+    if (outdated.size() == 1)
+    {
+        m_notes[outdated[0]].findStringAndFretFromNote();
+        return;
+    }
+    
+    // place the notes together, so that they are comfortable to play one after the other
+    std::vector<int> pitchIDs(amount);
+    std::vector<int> ticks(amount);
     for (int n=0; n<amount; n++)
     {
-        m_notes[n].checkIfStringAndFretMatchNote(true);
+        pitchIDs[n] = m_notes[n].getPitchID();
+        ticks[n]    = m_notes[n].getTick();
+    }
+    
+    std::vector<GuitarFingering::Position> positions;
+    GuitarFingering::solve(m_tuning->tuning, pitchIDs, ticks, positions);
+    
+    const int outdatedAmount = outdated.size();
+    for (int n=0; n<outdatedAmount; n++)
+    {
+        const GuitarFingering::Position& position = positions[outdated[n]];
+        m_notes[outdated[n]].setStringAndFret(position.m_string, position.m_fret);
     }
 }
 
@@ -830,9 +1138,11 @@ void Track::copy()
 
     int tickOfFirstSelectedNote=-1;
     // place all selected notes into clipboard
-    for (int n=0; n<m_notes.size(); n++)
+    const std::vector<int>& selection = getSelectedNotes();
+    const int selectedAmount = selection.size();
+    for (int i=0; i<selectedAmount; i++)
     {
-        if (!m_notes[n].isSelected()) continue;
+        const int n = selection[i];
 
         Note* tmp=new Note(m_notes[n]);
         Clipboard::add(tmp);
@@ -889,6 +1199,7 @@ void Track::setId(const int id)
 
 void Track::setName(wxString name)
 {
+    m_revision++;
     if (name.Trim().IsEmpty()) m_track_name->setValue( wxString( _("Untitled") ) );
     else                       m_track_name->setValue(name);
 }
@@ -909,6 +1220,7 @@ int Track::getChannel()
 
 void Track::setChannel(int i)
 {
+    m_revision++;
     m_channel = i;
 
     // check what is the instrument currently used in this channel, if any
@@ -1023,6 +1335,7 @@ int Track::getDuration() const
 
 void Track::setKey(const int symbolAmount, const KeyType type)
 {
+    m_revision++;
     assert(symbolAmount < 8);
 
     // This is to support older file formats. TODO: eventually remove compat.
@@ -1138,6 +1451,7 @@ void Track::setKey(const int symbolAmount, const KeyType type)
 
 void Track::setCustomKey(const KeyInclusionType key_notes[131])
 {
+    m_revision++;
     m_key_type = KEY_TYPE_CUSTOM;
     m_key_sharps_amnt = 0;
     m_key_flats_amnt = 0;
@@ -1173,6 +1487,7 @@ bool Track::isMuted() const
 
 void Track::setMuted(bool muted)
 {
+    m_revision++;
     m_muted = muted;
     m_sequence->updateTrackPlayingStatus();
 }
@@ -1190,6 +1505,7 @@ bool Track::isSoloed() const
     
 void Track::setSoloed(bool soloed)
 {
+    m_revision++;
     m_soloed = m_soloed;
     m_sequence->updateTrackPlayingStatus();
 }
@@ -1203,6 +1519,7 @@ bool Track::isPlayed() const
 
 void Track::setPlayed(bool played)
 {
+    if (played != m_played) m_revision++;
     m_played = played;
 }
 
@@ -1211,6 +1528,7 @@ void Track::setPlayed(bool played)
 
 void Track::onInstrumentChanged(const int newValue)
 {
+    m_revision++;
     if (m_next_instrument_listener != NULL)
     {
         m_next_instrument_listener->onInstrumentChanged(newValue);
@@ -1223,6 +1541,7 @@ void Track::onInstrumentChanged(const int newValue)
 
 void Track::onDrumkitChanged(const int newValue)
 {
+    m_revision++;
     if (m_next_drumkit_listener != NULL)
     {
         m_next_drumkit_listener->onDrumkitChanged(newValue);
@@ -1235,6 +1554,7 @@ void Track::onDrumkitChanged(const int newValue)
 
 void Track::onGuitarTuningUpdated(GuitarTuning* tuning, const bool userTriggered)
 {
+    m_revision++;
     if (userTriggered)
     {
         action( new Action::UpdateGuitarTuning() );
@@ -1251,6 +1571,7 @@ void Track::onGuitarTuningUpdated(GuitarTuning* tuning, const bool userTriggered
 
 void Track::setNotationType(NotationType t, bool enabled)
 {
+    m_revision++;
     m_editor_mode[t] = enabled;
     if (m_listener != NULL) m_listener->onNotationTypeChange();
 
@@ -1402,18 +1723,9 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
 
     if (selectionOnly)
     {
-        const int noteAmount = m_notes.size();
-        for (int n=0; n<noteAmount; n++)
-        {
-            if (m_notes[n].isSelected())
-            {
-                if (m_notes[n].getTick() < firstNoteStartTick or firstNoteStartTick==-1)
-                {
-                    firstNoteStartTick = m_notes[n].getTick();
-                }
-                selectedNoteAmount++;
-            }
-        }
+        // notes are ordered by tick, so the first selected note is the one that plays first
+        selectedNoteAmount = getSelectedNoteCount();
+        if (selectedNoteAmount > 0) firstNoteStartTick = m_notes[getFirstSelectedNote()].getTick();
 
         if (firstNoteStartTick == -1) return -1; // error, no note was found.
         if (selectedNoteAmount == 0)  return -1; // error, no note was found.
@@ -1566,8 +1878,22 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
     int note_off_id    = 0;
     int control_evt_id = 0;
 
+    // copied, since the selection is not expected to change while events are being added
+    const std::vector<int> selection = (selectionOnly ? getSelectedNotes() : std::vector<int>());
+    const int selectedAmount = selection.size();
+    int selected_id = 0;
+    
+    // when only playing the selection, note offs are those of the selected notes, in the order they end
+    std::vector<Note*> selectedNoteOffs;
+    if (selectionOnly)
+    {
+        selectedNoteOffs.reserve(selectedAmount);
+        for (int n=0; n<selectedAmount; n++) selectedNoteOffs.push_back( m_notes.get(selection[n]) );
+        std::stable_sort(selectedNoteOffs.begin(), selectedNoteOffs.end(), endsBefore);
+    }
+
     const int noteOnAmount     = m_notes.size();
-    const int noteOffAmount    = m_note_off.size();
+    const int noteOffAmount    = (selectionOnly ? selectedAmount : m_note_off.size());
     const int controllerAmount = m_control_events.size();
 
     // find track end
@@ -1589,23 +1915,24 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
         // if we only want to play what's selected, skip unselected notes
         if (selectionOnly)
         {
-            while (note_on_id < noteOnAmount   and not m_notes[note_on_id].isSelected())
-            {
-                note_on_id++;
-            }
-            while (note_off_id < noteOffAmount and not m_note_off[note_off_id].isSelected())
+            // jump straight to the next selected note instead of testing every note
+            while (selected_id < selectedAmount and selection[selected_id] < note_on_id)
             {
-                note_off_id++;
+                selected_id++;
             }
+            note_on_id = (selected_id < selectedAmount ? selection[selected_id] : noteOnAmount);
         }
 
         bool have_tick_on = (note_on_id < noteOnAmount);
         bool have_tick_off = (note_off_id < noteOffAmount);
 
+        const Note* noteOff = NULL;
+        if (have_tick_off) noteOff = (selectionOnly ? selectedNoteOffs[note_off_id] : m_note_off.get(note_off_id));
+
         const int tick_on  = have_tick_on   ?
                               m_notes[note_on_id].getTick() - firstNoteStartTick   :  -1;
         const int tick_off = have_tick_off ?
-                              m_note_off[note_off_id].getEndTick() - firstNoteStartTick :  -1;
+                              noteOff->getEndTick() - firstNoteStartTick :  -1;
         
         // ignore control events when only playing selection
         bool have_tick_control = (control_evt_id < controllerAmount and not selectionOnly);
@@ -1661,7 +1988,7 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
         else if (activeMin == 0)
         {
 
-            const int time=m_note_off[note_off_id].getEndTick() - firstNoteStartTick;
+            const int time = noteOff->getEndTick() - firstNoteStartTick;
             if (time >= 0 and (time + firstNoteStartTick) <= lastTickInSong)
             {
                 ASSERT_E(time, >=, debug_curr_time); debug_curr_time = time;
@@ -1670,11 +1997,11 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
                 
                 if (m_editor_mode[DRUM])
                 {
-                    m.SetNoteOff( channel, m_note_off[note_off_id].getPitchID(), 0 );
+                    m.SetNoteOff( channel, noteOff->getPitchID(), 0 );
                 }
                 else
                 {
-                    m.SetNoteOff( channel, 131 - m_note_off[note_off_id].getPitchID(), 0 );
+                    m.SetNoteOff( channel, 131 - noteOff->getPitchID(), 0 );
                 }
 
                 // find track end
@@ -1859,6 +2186,36 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
     return last_event_tick - firstNoteStartTick;
 }
 
+// ----------------------------------------------------------------------------------------------------------
+
+int Track::getMidiEventsLength() const
+{
+    // like addMidiEvents (without selection) : muted tracks, drum tracks included, return -1
+    if (not m_played) return -1;
+    
+    MeasureData* md = m_sequence->getMeasureData();
+    const int lastTickInSong = md->firstTickInMeasure( md->getMeasureAmount() );
+    
+    // same as addMidiEvents : notes starting past the end are left out, notes that start before end with
+    // their note off (which is never past the end of the note), and controller events are all considered
+    int last_event_tick = 0;
+    
+    const int noteAmount = m_notes.size();
+    for (int n=0; n<noteAmount; n++)
+    {
+        if (m_notes[n].getTick() < 0 or m_notes[n].getTick() > lastTickInSong) continue;
+        if (m_notes[n].getEndTick() > last_event_tick) last_event_tick = m_notes[n].getEndTick();
+    }
+    
+    const int controllerAmount = m_control_events.size();
+    for (int n=0; n<controllerAmount; n++)
+    {
+        if (m_control_events[n].getTick() > last_event_tick) last_event_tick = m_control_events[n].getTick();
+    }
+    
+    return last_event_tick;
+}
+
 // =======================================================================================================
 // ================================================ IO ===================================================
 // =======================================================================================================
@@ -1867,12 +2224,8 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
 #pragma mark Serialization
 #endif
 
-void Track::saveToFile(wxFileOutputStream& fileout)
+void Track::saveToFile(wxOutputStream& fileout, GraphicalTrack* gtrack)
 {
-    reorderNoteVector();
-    reorderNoteOffVector();
-    reorderControlVector();
-
     wxString name = m_track_name->getValue();
     name.Replace("\"", "&quot;");
     wxString xml_line = wxString::Format("\n<track name=\"%s\" id=\"%i\" channel=\"%i\" muted=\"%s\" soloed=\"%s\" volume=\"%i\" default_volume=\"%i\">\n",
@@ -1917,25 +2270,47 @@ void Track::saveToFile(wxFileOutputStream& fileout)
             break;
     }
 
-    getGraphics()->saveToFile(fileout);
+    gtrack->saveToFile(fileout);
 
-    // notes
+    // notes and controller changes. Snapshots trust the revision to tell if they changed, actual saves
+    // write them again in any case
+    if (dynamic_cast<SnapshotOutputStream*>(&fileout) == NULL) m_saved_events_revision = -1;
+    SnapshotOutputStream::write(getSavedEvents(), fileout);
+
+    writeData(wxT("</track>\n\n"), fileout );
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+std::shared_ptr<const std::string> Track::getSavedEvents()
+{
+    if (m_saved_events_revision == m_revision) return m_saved_events;
+    
+    reorderNoteVector();
+    reorderNoteOffVector();
+    reorderControlVector();
+    
+    wxMemoryOutputStream out;
+    
     const int noteCount = m_notes.size();
     for (int n=0; n<noteCount; n++)
     {
-        m_notes[n].saveToFile(fileout);
+        m_notes[n].saveToFile(out);
     }
 
-    // controller changes
     const int ctrlCount = m_control_events.size();
     for (int n=0; n<ctrlCount; n++)
     {
-        m_control_events[n].saveToFile(fileout);
+        m_control_events[n].saveToFile(out);
     }
-
-    writeData(wxT("</track>\n\n"), fileout );
-
-
+    
+    // a new string rather than modifying the old one, which snapshots may still be writing
+    std::string* text = new std::string(out.GetSize(), '\0');
+    if (not text->empty()) out.CopyTo(&(*text)[0], text->size());
+    
+    m_saved_events.reset(text);
+    m_saved_events_revision = m_revision;
+    return m_saved_events;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -2108,7 +2483,8 @@ bool Track::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
                         setNotationType(KEYBOARD, true);
                     }
 
-                    getGraphics()->readFromFile(xml);
+                    if (gseq != NULL) readViewFromFile(xml);
+                    else              recordPendingView(xml, false);
                 }
                 else if (strcmp("editors", xml->getNodeName()) == 0)
                 {
@@ -2117,7 +2493,8 @@ bool Track::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
                     setNotationType(DRUM, false);
                     setNotationType(GUITAR, false);
                     setNotationType(CONTROLLER, false);
-                    getGraphics()->readFromFile(xml);
+                    if (gseq != NULL) readViewFromFile(xml);
+                    else              recordPendingView(xml, true);
                 }
                 else if (strcmp("guitartuning", xml->getNodeName()) == 0)
                 {
@@ -2161,21 +2538,14 @@ bool Track::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
                         std::cerr << "Missing info from file: drum ID" << std::endl;
                     }
 
-                    const char* collapse = xml->getAttributeValue("collapseView");
-                    if (collapse != NULL && strcmp(collapse, "true") == 0)
-                    {
-                        getGraphics()->getDrumEditor()->setShowOnlyUsedDrums(true);
-                    }
+                    if (gseq != NULL) readViewFromFile(xml);
+                    else              recordPendingView(xml, false);
                 }
                 // TODO: for backwards compatibility only, eventually remove
                 else if (strcmp("controller", xml->getNodeName()) == 0)
                 {
-                    const char* id = xml->getAttributeValue("id");
-                    if (id != NULL)
-                    {
-                        // FIXME: remove GUI calls from here
-                        getGraphics()->getControllerEditor()->setController(atoi(id));
-                    }
+                    if (gseq != NULL) readViewFromFile(xml);
+                    else              recordPendingView(xml, false);
                 }
                 else if (strcmp("key", xml->getNodeName()) == 0)
                 {
@@ -2334,11 +2704,7 @@ bool Track::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
                     ASSERT(invariant());
 
                     // now that we have the set of notes, we can collapse the view if needed
-                    GraphicalTrack* gtrack = getGraphics();
-                    if (gtrack->getDrumEditor()->showOnlyUsedDrums())
-                    {
-                        gtrack->getDrumEditor()->useCustomDrumSet();
-                    }
+                    if (gseq != NULL) applyDrumViewSettings();
 
                     return true;
                 }
@@ -2358,6 +2724,72 @@ bool Track::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
 
 }
 
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::readViewFromFile(irr::io::IrrXMLReader* xml)
+{
+    if (strcmp("editor", xml->getNodeName()) == 0 or strcmp("editors", xml->getNodeName()) == 0)
+    {
+        getGraphics()->readFromFile(xml);
+    }
+    else if (strcmp("drumkit", xml->getNodeName()) == 0)
+    {
+        const char* collapse = xml->getAttributeValue("collapseView");
+        if (collapse != NULL && strcmp(collapse, "true") == 0)
+        {
+            getGraphics()->setShowOnlyUsedDrums(true);
+        }
+    }
+    else if (strcmp("controller", xml->getNodeName()) == 0)
+    {
+        const char* id = xml->getAttributeValue("id");
+        if (id != NULL)
+        {
+            // FIXME: remove GUI calls from here
+            getGraphics()->setController(atoi(id));
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::recordPendingView(irr::io::IrrXMLReader* xml, const bool withChildren)
+{
+    if (m_pending_view.raw_ptr == NULL) m_pending_view = new RecordedXMLReader();
+    m_pending_view->record(xml, withChildren);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::applyDrumViewSettings()
+{
+    // a drum editor that isn't made yet does this itself once it is
+    DrumEditor* editor = (DrumEditor*)getGraphics()->getExistingEditor(DRUM);
+    if (editor != NULL and editor->showOnlyUsedDrums())
+    {
+        editor->useCustomDrumSet();
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::applyPendingView()
+{
+    if (m_pending_view.raw_ptr != NULL)
+    {
+        // each recorded node is read as readFromFile would have; "editors" nodes consume their children
+        m_pending_view->rewind();
+        do
+        {
+            if (m_pending_view->getNodeType() == irr::io::EXN_ELEMENT) readViewFromFile(m_pending_view);
+        } while (m_pending_view->read());
+        
+        m_pending_view = NULL;
+    }
+    
+    applyDrumViewSettings();
+}
+
 
 // Gets note volume
 // Applies track volume
@@ -2407,3 +2839,48 @@ bool Track::invariant()
     
     return true;
 }
+
+// ----------------------------------------------------------------------------------------------------------
+
+UNIT_TEST( TestFindNotesOverlappingRange )
+{
+    Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+    
+    TestSequenceProvider provider(seq);
+    AriaMaestosa::setCurrentSequenceProvider(&provider);
+    
+    Track* t = new Track(seq);
+    
+    {
+        OwnerPtr<Sequence::Import> import(seq->startImport());
+        t->addNote_import(100 /* pitch */, 0     /* start */, 40000 /* end */, 127 /* volume */, -1);
+        t->addNote_import(101 /* pitch */, 10100 /* start */, 10200 /* end */, 127 /* volume */, -1);
+        t->addNote_import(102 /* pitch */, 10300 /* start */, 10400 /* end */, 127 /* volume */, -1);
+        t->addNote_import(103 /* pitch */, 10500 /* start */, 10600 /* end */, 127 /* volume */, -1);
+        t->addNote_import(104 /* pitch */, 10700 /* start */, 10800 /* end */, 127 /* volume */, -1);
+        t->reorderNoteOffVector();
+    }
+    seq->addTrack(t);
+    
+    int first = -1, last = -1;
+    std::vector<int> longNotes;
+    
+    require(t->findNotesOverlappingRange(10450, 10650, first, last, longNotes), "notes are found");
+    require_e(first, ==, 1, "the range does not go back to the long note");
+    require_e(last,  ==, 3, "last note is the last one starting before the end of the range");
+    require(longNotes.size() == 1 and longNotes[0] == 0, "long note starting before the range is listed");
+    
+    require(t->findNotesOverlappingRange(0, 50, first, last, longNotes), "notes are found");
+    require_e(first, ==, 0, "range at the start of the track");
+    require_e(last,  ==, 0, "range at the start of the track");
+    require(longNotes.empty(), "long note within the range is not listed apart");
+    
+    require(t->findNotesOverlappingRange(50000, 60000, first, last, longNotes) == false,
+            "nothing is found after the end");
+    
+    require(t->findNotesOverlappingRange(20000, 30000, first, last, longNotes), "long note is found");
+    require(first > last, "no ordinary note sounds within the range");
+    require(longNotes.size() == 1 and longNotes[0] == 0, "long note is found");
+    
+    delete seq;
+}
@@ -17,7 +17,7 @@
 #ifndef __TRACK_H__
 #define __TRACK_H__
 
-class wxFileOutputStream;
+class wxOutputStream;
 // forward
 namespace irr { namespace io {
     class IXMLBase;
@@ -35,6 +35,9 @@ namespace jdksmidi { class MIDITrack; }
 
 #include "ptr_vector.h"
 
+#include <memory>
+#include <string>
+
 namespace AriaMaestosa
 {
     
@@ -44,6 +47,7 @@ namespace AriaMaestosa
     class ControllerEvent;
     class FullTrackUndo;
     class NoteRelocator;
+    class RecordedXMLReader;
     class SequenceVisitor;
     
     namespace Action
@@ -177,6 +181,66 @@ namespace AriaMaestosa
 
         unsigned short m_default_volume;
 
+        /** Incremented each time something that is displayed changes; see getRevision */
+        int m_revision;
+        
+        /**
+          * IDs of the selected notes, in increasing order. Kept up to date by the selection methods of
+          * the track; rebuilt from the notes (see 'updateSelection') when notes were added, removed or
+          * reordered since, or selected directly through Note::setSelected.
+          */
+        mutable std::vector<int> m_selection;
+        mutable bool m_selection_valid;
+        
+        /** structure revision of 'm_notes' that 'm_selection' was built for */
+        mutable unsigned int m_selection_structure;
+        
+        /**
+          * The \<note\> and \<controlevent\> elements of this track as last saved, and the revision they
+          * were saved at (-1 if never). Shared with autosave snapshots, see getSavedEvents.
+          */
+        std::shared_ptr<const std::string> m_saved_events;
+        int m_saved_events_revision;
+        
+        /** @brief make sure 'm_selection' matches the notes */
+        void updateSelection() const;
+        
+        /** @brief select or deselect one note, keeping 'm_selection' up to date */
+        void setNoteSelected(const int id, const bool selected);
+        
+        /**
+          * IDs of the notes longer than 'm_long_note_length' ticks, in increasing order. Other notes are
+          * known to be that short, which bounds how far back findNotesOverlappingRange needs to look.
+          * Rebuilt (see 'updateLongNotes') when the track was edited or its notes added, removed or
+          * reordered since.
+          */
+        mutable std::vector<int> m_long_notes;
+        mutable int m_long_note_length;
+        
+        /** revision of the track and structure revisions of 'm_notes' and 'm_note_off' that 'm_long_notes'
+          * was built for (revision -1 if never built) */
+        mutable int m_long_notes_revision;
+        mutable unsigned int m_long_notes_structure;
+        mutable unsigned int m_long_notes_off_structure;
+        
+        /** @brief make sure 'm_long_notes' matches the notes */
+        void updateLongNotes() const;
+        
+        /**
+          * View settings read from a .aria file before this track had a GraphicalTrack
+          * (see readFromFile and applyPendingView)
+          */
+        OwnerPtr<RecordedXMLReader> m_pending_view;
+        
+        /** @brief read a node of a .aria file that holds settings of the GraphicalTrack */
+        void readViewFromFile(irr::io::IrrXMLReader* xml);
+        
+        /** @brief keep a node read by readFromFile for readViewFromFile, when there is no GraphicalTrack yet */
+        void recordPendingView(irr::io::IrrXMLReader* xml, const bool withChildren);
+        
+        /** @brief once notes are read, collapse the drum editor to the used drums if the file asked so */
+        void applyDrumViewSettings();
+
     public:
         
         DECLARE_MAGIC_NUMBER();
@@ -240,6 +304,16 @@ namespace AriaMaestosa
         void setInstrumentListener(IInstrumentChoiceListener* l) { m_next_instrument_listener = l; }
         void setDrumListener      (IDrumChoiceListener* l)       { m_next_drumkit_listener    = l; }
         
+        /**
+          * @return a number that changes each time the track is edited through an action, or its selection,
+          *         key, instrument, name or notation types change. Lets views know if what they drew is
+          *         still up to date.
+          */
+        int getRevision() const { return m_revision; }
+        
+        /** @brief signal a change that is not covered by the cases listed in getRevision */
+        void markChanged() { m_revision++; }
+        
         /** @brief place events in time order */
         void reorderNoteVector();
         
@@ -249,6 +323,31 @@ namespace AriaMaestosa
         /** @brief place events in time order */
         void reorderControlVector();
         
+        /**
+          * @brief Move the notes and controller events that start after 'afterTick' by 'amountInTicks', for
+          *        measures inserted or removed. The first event to move is found by binary search, so the
+          *        part of the track before 'afterTick' is not visited.
+          * @note  When moving back, the range being closed must not hold any note (see extractNotesInRange).
+          */
+        void shiftTicksAfter(const int afterTick, const int amountInTicks);
+        
+        /**
+          * @brief Remove (without deleting) the notes that start within ]fromTick, toTick[
+          * @param[out] removed  receives the removed notes, in time order
+          */
+        void extractNotesInRange(const int fromTick, const int toTick, ptr_vector<Note>& removed);
+        
+        /**
+          * @brief Add a block of notes at once. Notes must be in time order, and are expected to start
+          *        within a range of the track that holds no other note (like those left by shiftTicksAfter
+          *        and extractNotesInRange); otherwise the track is sorted again from the block on.
+          *        The track takes ownership of the notes.
+          */
+        void insertNotes(const std::vector<Note*>& notes);
+        
+        /** @brief Same as insertNotes, for controller events */
+        void insertControlEvents(const std::vector<ControllerEvent*>& events);
+        
         void removeNote(const int id);
         
         void setId(const int id);
@@ -280,6 +379,26 @@ namespace AriaMaestosa
         void setName(wxString name);
         
         void selectNote(const int id, const bool selected, bool ignoreModifiers=false);
+        
+        /**
+          * @brief select or deselect the notes that start in [fromTick, toTick) and whose pitch ID is within
+          *        [fromPitchID, toPitchID]; other notes are left as they are
+          */
+        void selectNotesInRange(const int fromTick, const int toTick, const bool selected,
+                                const int fromPitchID=0, const int toPitchID=131);
+        
+        /** @return the number of selected notes */
+        int getSelectedNoteCount() const;
+        
+        /**
+          * @return the IDs of the selected notes, in increasing order
+          * @note   the IDs are only valid until notes are added, removed or reordered; copy the vector if
+          *         you are going to do that while going through it
+          */
+        const std::vector<int>& getSelectedNotes() const;
+        
+        /** @brief called by notes of this track when they are selected or deselected directly */
+        void onNoteSelectionChanged() { m_selection_valid = false; }
 
         const wxString    getName     () const { return m_track_name->getValue(); }
         Model<wxString>*  getNameModel()       { return m_track_name;             }
@@ -352,6 +471,25 @@ namespace AriaMaestosa
          */
         int findLastNoteInRange(const int fromTick, const int toTick) const;
         
+        /**
+         * @brief Find the notes that are sounding somewhere in [fromTick, toTick)
+         *
+         * Since notes are sorted by start tick, the result is mostly given as a range of note IDs. This
+         * range goes back far enough to include notes of ordinary length that started before 'fromTick'
+         * but still sound inside the range; notes longer than that are listed apart, so that a single
+         * long note does not extend the range back to it. Some notes within the returned range may end
+         * before 'fromTick', so callers still need to check each note.
+         *
+         * @param[out] firstNote ID of the first note to consider
+         * @param[out] lastNote  ID of the last note to consider (inclusive; lower than firstNote if
+         *                       only long notes overlap the range)
+         * @param[out] longNotes IDs of the long notes starting before 'firstNote' that sound within the
+         *                       range, in increasing order
+         * @return               false if no note overlaps the given range (out parameters are then unset)
+         */
+        bool findNotesOverlappingRange(const int fromTick, const int toTick,
+                                       int& firstNote, int& lastNote, std::vector<int>& longNotes) const;
+        
         void playNote(const int id, const bool noteChange=false);
         
         void markNoteToBeRemoved(const int id);
@@ -408,6 +546,10 @@ namespace AriaMaestosa
           */
         int getNoteFretConst(const int id) const; 
 
+        /**
+          * @brief give a string and fret to the notes that don't have one matching their pitch (e.g. after
+          *        a tuning change); when there are several, they are placed together by GuitarFingering
+          */
         void updateNotesForGuitarEditor();
         
         static bool isTempoController(const int controllerTypeID)
@@ -514,6 +656,12 @@ namespace AriaMaestosa
          */
         int addMidiEvents(jdksmidi::MIDITrack* track, int channel, int firstMeasure,
                           bool selectionOnly, int& startTick); // returns length
+        
+        /**
+         * @return what addMidiEvents returns when adding the whole track from the start of the song
+         *         (-1 if the track is muted), found without creating any event
+         */
+        int getMidiEventsLength() const;
 
         /**
           * @brief Get a read-only list of all notes in this track, but ordered by their end tick.
@@ -589,8 +737,25 @@ namespace AriaMaestosa
         bool invariant();
         
         // serialization
-        void saveToFile(wxFileOutputStream& fileout);
+        
+        /** @param gtrack  the view of this track, whose editor settings are saved too */
+        void saveToFile(wxOutputStream& fileout, GraphicalTrack* gtrack);
+        
+        /**
+          * @return the \<note\> and \<controlevent\> elements of this track, UTF-8 encoded as in .aria files.
+          *         The text is kept until the revision of the track changes, so that saving a track that
+          *         was not edited (e.g. in each autosave snapshot) costs nothing, and its snapshots share it.
+          */
+        std::shared_ptr<const std::string> getSavedEvents();
+        
+        /**
+          * @param gseq  NULL when the file is read off-screen (possibly on a worker thread), before there
+          *              is any GraphicalTrack; the view settings are then kept until applyPendingView
+          */
         bool readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq);
+        
+        /** @brief give the view settings kept by readFromFile to the GraphicalTrack, which must now exist */
+        void applyPendingView();
     };
     
 }
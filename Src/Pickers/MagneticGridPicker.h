@@ -20,7 +20,7 @@
 
 #include <wx/menu.h>
 
-class wxFileOutputStream;
+class wxOutputStream;
 // forward
 namespace irr { namespace io {
     class IXMLBase;
@@ -30,6 +30,8 @@
 
 #include "Midi/Players/PlatformMidiManager.h"
 
+#include <algorithm>
+
 
 using namespace AriaMaestosa; 
 
@@ -48,8 +50,13 @@ Setting::Setting(wxString name, wxString user_name, SettingType type,
     m_user_name = user_name;
     m_type      = type;
     m_subtype   = subtype;
-    m_value     = default_value;
     m_category  = category;
+    m_key       = SETTING_KEY_COUNT;
+    
+    m_int_value  = -1;
+    m_bool_value = false;
+    m_is_number  = false;
+    setValue(default_value);
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -66,6 +73,24 @@ void Setting::setChoices(wxArrayString choices)
     m_choices = choices;
 }
 
+// ----------------------------------------------------------------------------------------------------------
+
+bool Setting::setValue(const wxString& value)
+{
+    if (value == m_value) return false;
+    
+    m_value = value;
+    
+    long asLong = -1;
+    if      (value == wxT("true"))  { asLong = 1; m_is_number = true; }
+    else if (value == wxT("false")) { asLong = 0; m_is_number = true; }
+    else                            { m_is_number = value.ToLong(&asLong); }
+    
+    m_int_value  = (m_is_number ? asLong : -1);
+    m_bool_value = (m_is_number and m_int_value != 0);
+    return true;
+}
+
 // ----------------------------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------------------------
 
@@ -104,6 +129,8 @@ PreferencesData::PreferencesData()
     wxConfig::Set(new wxFileConfig(fis));
     
     
+    for (int n=0; n<SETTING_KEY_COUNT; n++) m_settings_by_key[n] = NULL;
+    
     m_inited = false;
 }
 
@@ -130,29 +157,40 @@ void PreferencesData::readValues()
     // --- read values from file
     wxConfig* prefs = (wxConfig*) wxConfig::Get();
     
-    //long value;
-    
     // for each setting
     const int settingAmount = m_settings.size();
     for (int i=0; i<settingAmount; i++)
     {
         // see if this value is defined in file
-        if (prefs->Read( m_settings[i].m_name, &m_settings[i].m_value) )
+        wxString value;
+        if (prefs->Read( m_settings[i].m_name, &value) )
         {
-            //m_settings[i].m_value = value;
+            m_settings[i].setValue(value);
         }
     }    
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
+void PreferencesData::addSetting(SettingKey key, Setting* setting)
+{
+    ASSERT(m_settings_by_key[key] == NULL);
+    
+    setting->m_key = key;
+    m_settings.push_back(setting);
+    m_settings_by_key[key] = setting;
+    m_settings_by_name[setting->m_name] = setting;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 void PreferencesData::prepareLanguageEntry()
 {
     // ---- language
     Setting* languages = new Setting(fromCString(SETTING_ID_LANGUAGE), _("Language"), SETTING_ENUM,
                                      SETTING_CATEGORY_UI, to_wxString(getDefaultLanguageAriaID()) );
     languages->setChoices( getLanguageList() );
-    m_settings.push_back( languages );
+    addSetting(SETTING_KEY_LANGUAGE, languages);
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -183,7 +221,7 @@ void PreferencesData::fillSettingsVector()
     {
         midiDriver->addChoice(midiDrivers[n]);
     }
-    m_settings.push_back( midiDriver );
+    addSetting(SETTING_KEY_MIDI_DRIVER, midiDriver);
 
     // ---- play during edit
     //I18N: In preferences
@@ -192,7 +230,7 @@ void PreferencesData::fillSettingsVector()
     play->addChoice(_("Always"));        // PLAY_ALWAYS = 0,
     play->addChoice(_("On note change"));// PLAY_ON_CHANGE = 1,
     play->addChoice(_("Never"));         // PLAY_NEVER = 2
-    m_settings.push_back( play );
+    addSetting(SETTING_KEY_PLAY_DURING_EDIT, play);
     
     // ---- score view
     //I18N: In preferences
@@ -201,7 +239,7 @@ void PreferencesData::fillSettingsVector()
     scoreview->addChoice(_("Both Musical and Linear"));
     scoreview->addChoice(_("Musical Only"));
     scoreview->addChoice(_("Linear Only"));
-    m_settings.push_back( scoreview );
+    addSetting(SETTING_KEY_SCORE_VIEW, scoreview);
     
     // ---- default editor
     //I18N: In preferences
@@ -210,7 +248,7 @@ void PreferencesData::fillSettingsVector()
     defaultEditor->addChoice(_("Keyboard"));  // 0
     defaultEditor->addChoice(_("Score"));     // 1
     defaultEditor->addChoice(_("Tablature")); // 2
-    m_settings.push_back( defaultEditor );
+    addSetting(SETTING_KEY_DEFAULT_EDITOR, defaultEditor);
 
 
     // ---- instrument classification
@@ -220,7 +258,7 @@ void PreferencesData::fillSettingsVector()
     instrumentClassification->addChoice(_("MIDI Standard"));  // 0
     instrumentClassification->addChoice(wxT("Aria"));     // 1
     instrumentClassification->addChoice(wxT("Buzzwood"));     // 2
-    m_settings.push_back( instrumentClassification );
+    addSetting(SETTING_KEY_INSTRUMENT_CLASSIFICATION, instrumentClassification);
 
 
 
@@ -230,44 +268,50 @@ void PreferencesData::fillSettingsVector()
     Setting* soundbank = new Setting(fromCString(SETTING_ID_SOUNDBANK), _("Soundfont"),
                                      SETTING_STRING, SETTING_CATEGORY_AUDIO, SYSTEM_BANK,
                                      SETTING_SUBTYPE_FILE_OR_DEFAULT);
-    m_settings.push_back( soundbank );
+    addSetting(SETTING_KEY_SOUNDBANK, soundbank);
 #endif
     
     // ---- follow playback
     Setting* followp = new Setting(fromCString(SETTING_ID_FOLLOW_PLAYBACK), _("Follow playback by default"),
                                    SETTING_BOOL, SETTING_CATEGORY_EDITION, wxT("0") );
-    m_settings.push_back( followp );
+    addSetting(SETTING_KEY_FOLLOW_PLAYBACK, followp);
     
     // ---- playthrough
     Setting* playthrough = new Setting(fromCString(SETTING_ID_PLAYTHROUGH), _("Enable playthrough when recording by default"),
                                        SETTING_BOOL, SETTING_CATEGORY_AUDIO, wxT("1") );
-    m_settings.push_back( playthrough );
+    addSetting(SETTING_KEY_PLAYTHROUGH, playthrough);
 
     // ---- check for new version
     Setting* newversion = new Setting(fromCString(SETTING_ID_CHECK_NEW_VERSION), _("Check online for new versions"),
                                        SETTING_BOOL, SETTING_CATEGORY_UI, wxT("1") );
-    m_settings.push_back( newversion );
+    addSetting(SETTING_KEY_CHECK_NEW_VERSION, newversion);
+    
+    // ---- autosave
+    Setting* autosave = new Setting(fromCString(SETTING_ID_AUTOSAVE_INTERVAL),
+                                    _("Keep a recovery copy of modified files every (minutes, 0 to disable)"),
+                                    SETTING_INT, SETTING_CATEGORY_UI, wxT("2") );
+    addSetting(SETTING_KEY_AUTOSAVE_INTERVAL, autosave);
     
     // ---- Remember window location
     Setting* windowloc = new Setting(fromCString(SETTING_ID_REMEMBER_WINDOW_POS), _("Remember window location"),
                                      SETTING_BOOL, SETTING_CATEGORY_UI, wxT("0") );
-    m_settings.push_back( windowloc );
+    addSetting(SETTING_KEY_REMEMBER_WINDOW_POS, windowloc);
     
     Setting* window_x = new Setting(fromCString(SETTING_ID_WINDOW_X), wxT("Window X"),
                                      SETTING_INT, SETTING_CATEGORY_HIDDEN, wxT("0") );
-    m_settings.push_back( window_x );
+    addSetting(SETTING_KEY_WINDOW_X, window_x);
     
     Setting* window_y = new Setting(fromCString(SETTING_ID_WINDOW_Y), wxT("Window Y"),
                                      SETTING_INT, SETTING_CATEGORY_HIDDEN, wxT("0") );
-    m_settings.push_back( window_y );
+    addSetting(SETTING_KEY_WINDOW_Y, window_y);
     
     Setting* window_w = new Setting(fromCString(SETTING_ID_WINDOW_W), wxT("Window W"),
                                      SETTING_INT, SETTING_CATEGORY_HIDDEN, wxT("800") );
-    m_settings.push_back( window_w );
+    addSetting(SETTING_KEY_WINDOW_W, window_w);
     
     Setting* window_h = new Setting(fromCString(SETTING_ID_WINDOW_H), wxT("Window H"),
                                      SETTING_INT, SETTING_CATEGORY_HIDDEN, wxT("600") );
-    m_settings.push_back( window_h );
+    addSetting(SETTING_KEY_WINDOW_H, window_h);
     
 #ifdef __WXGTK__
     /*
@@ -283,78 +327,83 @@ void PreferencesData::fillSettingsVector()
     Setting* launchFluidSynth = new Setting(fromCString(SETTING_ID_LAUNCH_FLUIDSYNTH),
                                      _("Automatically launch FluidSynth if needed"),
                                      SETTING_BOOL, SETTING_CATEGORY_AUDIO, wxT("1") );
-    m_settings.push_back(launchFluidSynth);
+    addSetting(SETTING_KEY_LAUNCH_FLUIDSYNTH, launchFluidSynth);
+    
+    Setting* alsaLookahead = new Setting(fromCString(SETTING_ID_ALSA_LOOKAHEAD),
+                                     _("Schedule playback ahead on the ALSA queue (milliseconds, 0 to disable)"),
+                                     SETTING_INT, SETTING_CATEGORY_AUDIO, wxT("0") );
+    addSetting(SETTING_KEY_ALSA_LOOKAHEAD, alsaLookahead);
 #endif
 
 #ifndef __WXMAC__
     Setting* singleInstance = new Setting(fromCString(SETTING_ID_SINGLE_INSTANCE_APPLICATION),
                                      _("Single-instance application"),
                                      SETTING_BOOL, SETTING_CATEGORY_UI, wxT("1") );
-    m_settings.push_back( singleInstance );
+    addSetting(SETTING_KEY_SINGLE_INSTANCE_APPLICATION, singleInstance);
 #endif
 
     Setting* showNoteNames = new Setting(fromCString(SETTING_ID_SHOW_NOTE_NAMES),
                                      _("Show note names in piano-roll"),
                                      SETTING_BOOL, SETTING_CATEGORY_EDITION, wxT("1") );
-    m_settings.push_back(showNoteNames);
+    addSetting(SETTING_KEY_SHOW_NOTE_NAMES, showNoteNames);
     
     
     Setting* loadLastSession = new Setting(fromCString(SETTING_ID_LOAD_LAST_SESSION),
                                      _("Restore open files from previous session"),
                                      SETTING_BOOL, SETTING_CATEGORY_UI, wxT("0") );
-    m_settings.push_back(loadLastSession); 
+    addSetting(SETTING_KEY_LOAD_LAST_SESSION, loadLastSession); 
     
     
     Setting* lastSessionFiles = new Setting(fromCString(SETTING_ID_LAST_SESSION_FILES),
                                      wxT("Last session files"),
                                      SETTING_STRING, SETTING_CATEGORY_HIDDEN, wxT("") );
-    m_settings.push_back(lastSessionFiles); 
+    addSetting(SETTING_KEY_LAST_SESSION_FILES, lastSessionFiles); 
     
     
     Setting* lastCurrentSequence = new Setting(fromCString(SETTING_ID_LAST_CURRENT_SEQUENCE),
                                      wxT("Last Current Sequence"),
                                      SETTING_INT, SETTING_CATEGORY_HIDDEN, wxT("0"));
-    m_settings.push_back(lastCurrentSequence); 
+    addSetting(SETTING_KEY_LAST_CURRENT_SEQUENCE, lastCurrentSequence); 
     
     
     
     Setting* recentFiles = new Setting(fromCString(SETTING_ID_RECENT_FILES),
                                      wxT("Recent files"),
                                      SETTING_STRING, SETTING_CATEGORY_HIDDEN, wxT("") );
-    m_settings.push_back(recentFiles); 
+    addSetting(SETTING_KEY_RECENT_FILES, recentFiles); 
     
     
 
     Setting* output = new Setting(fromCString(SETTING_ID_MIDI_OUTPUT), wxT(""),
                                   SETTING_STRING, SETTING_CATEGORY_HIDDEN, DEFAULT_PORT );
-    m_settings.push_back( output );
+    addSetting(SETTING_KEY_MIDI_OUTPUT, output);
     
     Setting* input = new Setting(fromCString(SETTING_ID_MIDI_INPUT), wxT(""),
                                  // NOTE: there is an identical string in MainFrameMenuBar that must be changed too if changed here
                                  SETTING_STRING, SETTING_CATEGORY_HIDDEN, _("No MIDI input") );
-    m_settings.push_back( input );
+    addSetting(SETTING_KEY_MIDI_INPUT, input);
     
     // ---- printing
     Setting* marginLeft = new Setting(fromCString(SETTING_ID_MARGIN_LEFT), wxT(""),
                                       SETTING_INT, SETTING_CATEGORY_HIDDEN, wxT("12") );
-    m_settings.push_back( marginLeft );
+    addSetting(SETTING_KEY_MARGIN_LEFT, marginLeft);
     
     Setting* marginRight = new Setting(fromCString(SETTING_ID_MARGIN_RIGHT), wxT(""),
                                       SETTING_INT, SETTING_CATEGORY_HIDDEN, wxT("12") );
-    m_settings.push_back( marginRight );
+    addSetting(SETTING_KEY_MARGIN_RIGHT, marginRight);
     
     Setting* marginTop = new Setting(fromCString(SETTING_ID_MARGIN_TOP), wxT(""),
                                       SETTING_INT, SETTING_CATEGORY_HIDDEN, wxT("12") );
-    m_settings.push_back( marginTop );
+    addSetting(SETTING_KEY_MARGIN_TOP, marginTop);
     
     Setting* marginBottom = new Setting(fromCString(SETTING_ID_MARGIN_BOTTOM), wxT(""),
                                       SETTING_INT, SETTING_CATEGORY_HIDDEN, wxT("16") );
-    m_settings.push_back( marginBottom );
+    addSetting(SETTING_KEY_MARGIN_BOTTOM, marginBottom);
     
     //FIXME: hope wx enum values don't change...
     Setting* paperType = new Setting(fromCString(SETTING_ID_PAPER_TYPE), wxT(""),
                                      SETTING_INT, SETTING_CATEGORY_HIDDEN, to_wxString(wxPAPER_LETTER) );
-    m_settings.push_back( paperType );
+    addSetting(SETTING_KEY_PAPER_TYPE, paperType);
     
     
 #ifdef __WXGTK__
@@ -362,12 +411,12 @@ void PreferencesData::fillSettingsVector()
     Setting* audioExportEngine = new Setting(fromCString(SETTING_ID_AUDIO_EXPORT_ENGINE),
                                      wxT("Audio Export Engine"),
                                      SETTING_INT, SETTING_CATEGORY_HIDDEN, wxT("0"));
-    m_settings.push_back( audioExportEngine );
+    addSetting(SETTING_KEY_AUDIO_EXPORT_ENGINE, audioExportEngine);
                          
     Setting* fluidsynthSoundfontPath = new Setting(fromCString(SETTING_ID_FLUIDSYNTH_SOUNDFONT_PATH),
                                      wxT("Fluidsynth Soundfont Path"),
                                      SETTING_STRING, SETTING_CATEGORY_HIDDEN, DEFAULT_SOUNDFONT_PATH );
-    m_settings.push_back( fluidsynthSoundfontPath );
+    addSetting(SETTING_KEY_FLUIDSYNTH_SOUNDFONT_PATH, fluidsynthSoundfontPath);
 #endif
 }
 
@@ -409,70 +458,98 @@ void PreferencesData::save()
 
 // ----------------------------------------------------------------------------------------------------------
 
+const wxString& PreferencesData::getDirectory() const
+{
+    return prefsDir;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+Setting* PreferencesData::findSetting(const wxString& entryName) const
+{
+    std::map<wxString, Setting*>::const_iterator it = m_settings_by_name.find(entryName);
+    if (it == m_settings_by_name.end()) return NULL;
+    return it->second;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 wxString PreferencesData::getValue(wxString entryName) const
 {
-    
-    const int settingAmount = m_settings.size();
-    for (int i=0; i<settingAmount; i++)
+    const Setting* setting = findSetting(entryName);
+    if (setting == NULL)
     {
-        if ( m_settings[i].m_name == entryName )
-        {
-            //std::cout << m_settings[i].m_value << std::endl;
-            return m_settings[i].m_value;
-        }
+        std::cout << "prefs value not found : " << entryName.mb_str() << std::endl;
+        return wxEmptyString;
     }
-    std::cout << "prefs value not found : " << entryName.mb_str() << std::endl;
-    return wxEmptyString;
+    return setting->m_value;
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
 long PreferencesData::getIntValue(wxString entryName) const
 {
-    wxString asString = getValue(entryName);
-    ASSERT(not asString.IsEmpty());
+    const Setting* setting = findSetting(entryName);
+    ASSERT(setting != NULL);
+    if (setting == NULL) return -1;
     
-    long asInt = -1;
-    if (not asString.ToLong(&asInt))
-    {
-        ASSERT(false);
-    }
-    return asInt;
+    ASSERT(setting->m_is_number);
+    return setting->m_int_value;
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
 bool PreferencesData::getBoolValue(const char* entryName, bool defaultVal) const
 {
-    wxString asString = getValue(entryName);
-    if (asString.IsEmpty()) return defaultVal;
+    const Setting* setting = findSetting(wxString(entryName, wxConvUTF8));
+    if (setting == NULL or setting->m_value.IsEmpty()) return defaultVal;
     
-    if (asString == wxT("true")) return true;
-    else if (asString == wxT("false")) return false;
-    
-    // otherwise try 0/1
-    long asInt = -1;
-    if (not asString.ToLong(&asInt))
-    {
-        ASSERT(false);
-    }
-    return asInt;
+    ASSERT(setting->m_is_number);
+    return setting->m_bool_value;
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
 void PreferencesData::setValue(wxString entryName, wxString newValue)
 {
-    const int settingAmount = m_settings.size();
-    for (int i=0; i<settingAmount; i++)
+    Setting* setting = findSetting(entryName);
+    ASSERT(setting != NULL);
+    if (setting == NULL) return;
+    
+    setValue(*setting, newValue);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void PreferencesData::setValue(Setting& setting, const wxString& newValue)
+{
+    if (not setting.setValue(newValue)) return;
+    
+    // copy, in case a listener unregisters itself
+    std::vector<IPreferencesListener*> listeners = m_listeners;
+    const int count = listeners.size();
+    for (int n=0; n<count; n++)
     {
-        if ( m_settings[i].m_name == entryName )
-        {
-            m_settings[i].m_value = newValue;
-            return;
-        }
+        listeners[n]->onSettingChanged(setting);
     }
-    ASSERT(false);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void PreferencesData::addListener(IPreferencesListener* listener)
+{
+    ASSERT(std::find(m_listeners.begin(), m_listeners.end(), listener) == m_listeners.end());
+    m_listeners.push_back(listener);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void PreferencesData::removeListener(IPreferencesListener* listener)
+{
+    std::vector<IPreferencesListener*>::iterator it = std::find(m_listeners.begin(), m_listeners.end(),
+                                                                listener);
+    ASSERT(it != m_listeners.end());
+    if (it != m_listeners.end()) m_listeners.erase(it);
 }
 
 // ----------------------------------------------------------------------------------------------------------
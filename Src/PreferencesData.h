@@ -20,6 +20,9 @@
 #include "Singleton.h"
 #include "ptr_vector.h"
 
+#include <map>
+#include <vector>
+
 #include <wx/string.h>
 #include <wx/arrstr.h>
 #include <wx/font.h>
@@ -74,6 +77,7 @@ static const wxString SYSTEM_BANK = _("System soundbank");
     EXTERN const char* SETTING_ID_PLAY_DURING_EDIT DEFAULT("playDuringEdit");
     EXTERN const char* SETTING_ID_LANGUAGE         DEFAULT("lang");
     EXTERN const char* SETTING_ID_LAUNCH_FLUIDSYNTH  DEFAULT("launchFluidSynth");
+    EXTERN const char* SETTING_ID_ALSA_LOOKAHEAD   DEFAULT("alsaLookahead");
     
 #ifndef __WXMAC__
     EXTERN const char* SETTING_ID_SINGLE_INSTANCE_APPLICATION  DEFAULT("singleInstanceApplication");
@@ -105,6 +109,8 @@ static const wxString SYSTEM_BANK = _("System soundbank");
     
     EXTERN const char* SETTING_ID_CHECK_NEW_VERSION DEFAULT("checkForNewVersion");
     
+    EXTERN const char* SETTING_ID_AUTOSAVE_INTERVAL DEFAULT("autosaveInterval");
+    
     EXTERN const char* SETTING_ID_REMEMBER_WINDOW_POS DEFAULT("rememberWindowLocation");
     EXTERN const char* SETTING_ID_WINDOW_X DEFAULT("window_x");
     EXTERN const char* SETTING_ID_WINDOW_Y DEFAULT("window_y");
@@ -120,6 +126,49 @@ static const wxString SYSTEM_BANK = _("System soundbank");
 #undef EXTERN
 #undef DEFAULT
     
+    /**
+      * @brief index of each setting, for the typed accessors of PreferencesData (one per SETTING_ID_*
+      *        name above; settings that don't exist on the current platform are simply never registered)
+      */
+    enum SettingKey
+    {
+        SETTING_KEY_FOLLOW_PLAYBACK,
+        SETTING_KEY_SCORE_VIEW,
+        SETTING_KEY_PLAY_DURING_EDIT,
+        SETTING_KEY_LANGUAGE,
+        SETTING_KEY_LAUNCH_FLUIDSYNTH,
+        SETTING_KEY_ALSA_LOOKAHEAD,
+        SETTING_KEY_SINGLE_INSTANCE_APPLICATION,
+        SETTING_KEY_PLAYTHROUGH,
+        SETTING_KEY_MARGIN_LEFT,
+        SETTING_KEY_MARGIN_RIGHT,
+        SETTING_KEY_MARGIN_TOP,
+        SETTING_KEY_MARGIN_BOTTOM,
+        SETTING_KEY_PAPER_TYPE,
+        SETTING_KEY_MIDI_DRIVER,
+        SETTING_KEY_MIDI_OUTPUT,
+        SETTING_KEY_MIDI_INPUT,
+        SETTING_KEY_DEFAULT_EDITOR,
+        SETTING_KEY_INSTRUMENT_CLASSIFICATION,
+        SETTING_KEY_SHOW_NOTE_NAMES,
+        SETTING_KEY_LOAD_LAST_SESSION,
+        SETTING_KEY_LAST_SESSION_FILES,
+        SETTING_KEY_LAST_CURRENT_SEQUENCE,
+        SETTING_KEY_RECENT_FILES,
+        SETTING_KEY_CHECK_NEW_VERSION,
+        SETTING_KEY_AUTOSAVE_INTERVAL,
+        SETTING_KEY_REMEMBER_WINDOW_POS,
+        SETTING_KEY_WINDOW_X,
+        SETTING_KEY_WINDOW_Y,
+        SETTING_KEY_WINDOW_W,
+        SETTING_KEY_WINDOW_H,
+        SETTING_KEY_AUDIO_EXPORT_ENGINE,
+        SETTING_KEY_FLUIDSYNTH_SOUNDFONT_PATH,
+        SETTING_KEY_SOUNDBANK,
+        
+        SETTING_KEY_COUNT
+    };
+    
     class Setting
     {
     public:
@@ -129,13 +178,42 @@ static const wxString SYSTEM_BANK = _("System soundbank");
         wxArrayString   m_choices;
         SettingType     m_type;
         SettingSubType  m_subtype;
-        wxString        m_value;
         SettingCategory m_category;
+        SettingKey      m_key;
+        
+        /** Textual value, as saved in the config file. Use setValue to change it. */
+        wxString        m_value;
+        
+        /** m_value parsed once when it's set ("true"/"false" are read as 1/0) */
+        long            m_int_value;
+        bool            m_bool_value;
+        
+        /** whether m_value could be parsed as a number or a boolean */
+        bool            m_is_number;
         
         Setting(wxString name, wxString user_name, SettingType type, SettingCategory category,
                 wxString default_value = wxEmptyString, SettingSubType subtype = SETTING_SUBTYPE_NONE);
         void addChoice(wxString choice);
         void setChoices(wxArrayString choices);
+        
+        /**
+          * @brief change the value and update the parsed values (listeners are not notified, see
+          *        PreferencesData::setValue for that)
+          * @return whether the value actually changed
+          */
+        bool setValue(const wxString& value);
+    };
+    
+    /**
+      * @brief Implement to be notified when the value of a setting changes
+      */
+    class IPreferencesListener
+    {
+    public:
+        virtual ~IPreferencesListener() {}
+        
+        /** @brief called after the value of 'setting' was changed to something different */
+        virtual void onSettingChanged(const Setting& setting) = 0;
     };
     
     class PreferencesData : public Singleton<PreferencesData>
@@ -144,9 +222,22 @@ static const wxString SYSTEM_BANK = _("System soundbank");
         
         ptr_vector<Setting> m_settings;
         
+        /** The same settings, for constant-time lookup. Entries are NULL for settings that don't
+          * exist on this platform. */
+        Setting* m_settings_by_key[SETTING_KEY_COUNT];
+        std::map<wxString, Setting*> m_settings_by_name;
+        
+        std::vector<IPreferencesListener*> m_listeners;
+        
         /** Add and init preferences values */
         void fillSettingsVector();
         
+        /** @brief take ownership of the setting and make it reachable through its key and its name */
+        void addSetting(SettingKey key, Setting* setting);
+        
+        /** @return the setting with this name, or NULL if there is none */
+        Setting* findSetting(const wxString& entryName) const;
+        
         void prepareLanguageEntry();
         
         /** Private constructor */
@@ -174,9 +265,44 @@ static const wxString SYSTEM_BANK = _("System soundbank");
         }
         void setValue(wxString entryName, wxString newValue);
         
+        /**
+          * @brief change the value of a setting, notifying listeners if it's actually different
+          * @note  use this rather than Setting::setValue so that components caching the value are updated
+          */
+        void setValue(Setting& setting, const wxString& newValue);
+        
+        /**
+          * @name Typed accessors
+          * Cheap enough to be called while rendering : values are parsed when they are set, not when read.
+          * The setting must exist on the current platform.
+          * @{
+          */
+        const Setting& getSetting(const SettingKey key) const
+        {
+            ASSERT(m_settings_by_key[key] != NULL);
+            return *m_settings_by_key[key];
+        }
+        long            getInt   (const SettingKey key) const { return getSetting(key).m_int_value;  }
+        bool            getBool  (const SettingKey key) const { return getSetting(key).m_bool_value; }
+        const wxString& getString(const SettingKey key) const { return getSetting(key).m_value;      }
+        
+        void setValue(const SettingKey key, const wxString& newValue)
+        {
+            ASSERT(m_settings_by_key[key] != NULL);
+            setValue(*m_settings_by_key[key], newValue);
+        }
+        /** @} */
+        
+        /** @brief listeners are called from the thread that changed the setting (normally the main thread) */
+        void addListener(IPreferencesListener* listener);
+        void removeListener(IPreferencesListener* listener);
+        
         /** write config file */
         void save();
 
+        /** @return the directory where preferences are stored, ending with a path separator */
+        const wxString& getDirectory() const;
+
         ptr_vector<Setting>& getSettings() { return m_settings; }
     };
     
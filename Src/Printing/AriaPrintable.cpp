@@ -195,6 +195,22 @@ wxPrinterError AriaPrintable::print()
 
 // -------------------------------------------------------------------------------------------------------------
 
+bool AriaPrintable::exportToFile(const wxString& path, const VectorFormat format)
+{
+    ASSERT( MAGIC_NUMBER_OK() );
+    
+    ASSERT(m_seq->isLayoutCalculated());
+    ASSERT(m_printer_manager != NULL);
+    
+    const wxSize paperSize = m_printer_manager->getPaperSize();
+    VectorExporter exporter(this, format, paperSize.GetWidth(), paperSize.GetHeight(),
+                            m_printer_manager->getLeftMargin(), m_printer_manager->getTopMargin(),
+                            getUnitWidth(), getUnitHeight(), getUnitsPerCm());
+    return exporter.exportPages(path, m_seq->getPageAmount());
+}
+
+// -------------------------------------------------------------------------------------------------------------
+
 AriaPrintable* AriaPrintable::getCurrentPrintable()
 {
     ASSERT(m_current_printable != NULL);
@@ -332,10 +348,6 @@ void AriaPrintable::printPage(const int pageNum, wxDC& dc, wxGraphicsContext* gc
 
     dc.SetFont( m_normal_font );
     m_seq->printLinesInArea(dc, gc, pageNum-1, notation_area_y0, notation_area_h, h, x0, x1);
-    
-#if wxCHECK_VERSION(2,9,1) && wxUSE_GRAPHICS_CONTEXT
-    delete gc;
-#endif
 }
     
 // -------------------------------------------------------------------------------------------------------------
@@ -18,6 +18,7 @@
 #ifndef __ARIA_PRINTABLE_H__
 #define __ARIA_PRINTABLE_H__
 
+#include "Printing/VectorExporter.h"
 #include "Printing/wxEasyPrintWrapper.h"
 #include <wx/print.h>
 
@@ -129,6 +130,14 @@ namespace AriaMaestosa
           */ 
         wxPrinterError print();
         
+        /**
+          * @brief Write all pages to a PDF or SVG file, without going through the printing system
+          *        (no print dialog, usable without any window). Uses the current page setup.
+          * @pre  the 'calculateLayout' method of the printable sequence has been called
+          * @return whether the export succeeded
+          */
+        bool exportToFile(const wxString& path, const VectorFormat format);
+        
         /** 
           * @return the number of units used horizontally in the coordinate system set-up for
           * the kind of paper that is selected.
@@ -182,10 +191,11 @@ namespace AriaMaestosa
         }
         
         /**
-         * Called (by wxEasyPrintWrapper) when it is time to print a page.
+         * Called (by wxEasyPrintWrapper or VectorExporter) when it is time to print a page.
          *
          * @param pageNum      ID of the page we want to print
          * @param dc           The wxDC onto which stuff to print is to be rendered
+         * @param gc           Graphics context drawing on the same page (remains owned by the caller)
          * @param x0           x origin coordinate from which drawing can occur
          * @param y0           y origin coordinate from which drawing can occur
          */
@@ -0,0 +1,152 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Printing/NotationExport.h"
+
+#include "AriaCore.h"
+#include "Headless.h"
+#include "GUI/GraphicalSequence.h"
+#include "GUI/GraphicalTrack.h"
+#include "GUI/ImageProvider.h"
+#include "Midi/Players/CaptureDevice.h"
+#include "Midi/Sequence.h"
+#include "Midi/Track.h"
+#include "Printing/AriaPrintable.h"
+#include "Printing/SymbolPrinter/SymbolPrintableSequence.h"
+#include "Printing/VectorExporter.h"
+
+#include <cstdio>
+
+#include <wx/image.h>
+
+using namespace AriaMaestosa;
+
+namespace AriaMaestosa
+{
+    namespace NotationExport
+    {
+        /** @return how the track is exported, or false if it is left out */
+        static bool getExportedNotation(const Track* track, NotationType* out)
+        {
+            if (track->isNotationTypeEnabled(SCORE))
+            {
+                *out = SCORE;
+            }
+            else if (track->isNotationTypeEnabled(GUITAR))
+            {
+                *out = GUITAR;
+            }
+            else if (track->isNotationTypeEnabled(DRUM))
+            {
+                return false;
+            }
+            else
+            {
+                *out = SCORE;
+            }
+            return true;
+        }
+
+        // ----------------------------------------------------------------------------------------------------------
+
+        static bool exportSequence(GraphicalSequence* gseq, const wxString& output, const VectorFormat format)
+        {
+            Sequence* seq = gseq->getModel();
+
+            bool success = false;
+            AriaPrintable printable( AbstractPrintableSequence::getTitle(seq), &success );
+            if (not success)
+            {
+                fprintf(stderr, "[export] page setup failed\n");
+                return false;
+            }
+
+            SymbolPrintableSequence printableSeq(seq);
+            printable.setSequence(&printableSeq);
+
+            int trackCount = 0;
+            const int trackAmount = seq->getTrackAmount();
+            for (int n=0; n<trackAmount; n++)
+            {
+                Track* track = seq->getTrack(n);
+                NotationType notation;
+                if (not getExportedNotation(track, &notation)) continue;
+
+                if (not printableSeq.addTrack(gseq->getGraphicsFor(track), notation))
+                {
+                    fprintf(stderr, "[export] track '%s' cannot be exported\n",
+                            (const char*)track->getName().utf8_str());
+                    return false;
+                }
+                trackCount++;
+            }
+
+            if (trackCount == 0)
+            {
+                fprintf(stderr, "[export] no track to export\n");
+                return false;
+            }
+
+            printableSeq.calculateLayout();
+            return printable.exportToFile(output, format);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int NotationExport::run(const wxString& input, const wxString& output)
+{
+    VectorFormat format;
+    if (not VectorExporter::formatFromFileName(output, &format))
+    {
+        fprintf(stderr, "[export] unknown output format for %s (expected .pdf or .svg)\n",
+                (const char*)output.utf8_str());
+        return 1;
+    }
+
+    if (not VectorExporter::isAvailable())
+    {
+        fprintf(stderr, "[export] PDF and SVG export are not supported in this build\n");
+        return 1;
+    }
+
+    // nothing is played, but editors ask the MIDI manager whether playback is ongoing
+    PlatformMidiManager::installManager(new CaptureMidiManager(0));
+
+    wxInitAllImageHandlers();
+    ImageProvider::loadImages();
+
+    bool success;
+
+    {
+        GraphicalSequence gseq( new Sequence(NULL, NULL, NULL, NULL, false) );
+        HeadlessSequenceProvider provider(&gseq);
+
+        if (Headless::loadFile(&gseq, input))
+        {
+            success = exportSequence(&gseq, output, format);
+        }
+        else
+        {
+            fprintf(stderr, "[export] failed to load %s\n", (const char*)input.utf8_str());
+            success = false;
+        }
+    }
+
+    ImageProvider::unloadImages();
+    return (success ? 0 : 1);
+}
@@ -0,0 +1,52 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __NOTATION_EXPORT_H__
+#define __NOTATION_EXPORT_H__
+
+#include <wx/string.h>
+
+namespace AriaMaestosa
+{
+
+    /**
+      * @brief Headless export of score and tablature to PDF or SVG
+      *        (run with 'Aria --export-notation song.aria output.pdf')
+      *
+      * The song is laid out the way it would be printed, with the page setup saved in the preferences,
+      * then the pages are written by VectorExporter. Tracks that show the score editor are exported as
+      * score, tracks that show the guitar editor as tablature; other tracks are exported as score,
+      * except drum tracks, which are left out.
+      *
+      * No window is opened, but the mode is started from wxApp::OnInit, once the toolkit is initialized,
+      * and the views load the images of the editors as wxBitmaps. With wxGTK, a display is therefore
+      * needed : on a server, run it under a virtual X server such as Xvfb
+      * ('xvfb-run Aria --export-notation ...').
+      * @ingroup printing
+      */
+    namespace NotationExport
+    {
+        /**
+          * @param input   a .aria or .mid file
+          * @param output  a .pdf or .svg file
+          * @return process exit code
+          */
+        int run(const wxString& input, const wxString& output);
+    }
+
+}
+
+#endif
@@ -25,6 +25,8 @@
 #include <wx/image.h>
 #include <wx/graphics.h>
 
+#include <map>
+
 using namespace AriaMaestosa;
 using namespace AriaMaestosa::RenderRoutines;
 
@@ -978,7 +980,7 @@ void AriaMaestosa::RenderRoutines::drawSilence(wxDC* dc, const Range<int> x, con
     }
     else if ( type == 4 )
     {
-        static wxBitmap silenceBigger = getScaledBitmap(wxT("silence4.png"), 6.5f);
+        const wxBitmap silenceBigger = getScaledBitmap(wxT("silence4.png"), 6.5f);
         
         silence_radius = silenceBigger.GetWidth()/2;
         // take the average of 'center-aligned' and 'right-aligned'
@@ -997,7 +999,7 @@ void AriaMaestosa::RenderRoutines::drawSilence(wxDC* dc, const Range<int> x, con
     }
     else if ( type == 8 )
     {
-        static wxBitmap silenceBigger = getScaledBitmap(wxT("silence8.png"), 6.5f);
+        const wxBitmap silenceBigger = getScaledBitmap(wxT("silence8.png"), 6.5f);
         
         silence_radius = silenceBigger.GetWidth()/2;
         
@@ -1013,7 +1015,7 @@ void AriaMaestosa::RenderRoutines::drawSilence(wxDC* dc, const Range<int> x, con
     }
     else if ( type == 16 )
     {
-        static wxBitmap silenceBigger = getScaledBitmap(wxT("silence8.png"), 6.5f);
+        const wxBitmap silenceBigger = getScaledBitmap(wxT("silence8.png"), 6.5f);
         
         silence_radius = silenceBigger.GetWidth()/2;
         
@@ -1159,12 +1161,57 @@ void AriaMaestosa::RenderRoutines::renderArc(wxGraphicsContext& dc, const int ce
 
 // -------------------------------------------------------------------------------------------------------
 
-wxBitmap AriaMaestosa::RenderRoutines::getScaledBitmap(const wxString& fileName, float scale)
+namespace AriaMaestosa
 {
-    wxImage tempImage(getResourcePrefix() + wxT("score") + wxFileName::GetPathSeparator() + fileName,
-                      wxBITMAP_TYPE_PNG);
-    wxImage image = getPrintableImage(tempImage);
-    return wxBitmap(image.Scale(image.GetWidth()*scale, image.GetHeight()*scale),wxIMAGE_QUALITY_HIGH);
+    namespace RenderRoutines
+    {
+        /** identifies a scaled symbol in the symbol cache */
+        struct SymbolKey
+        {
+            wxString m_file_name;
+            
+            /** scale, in thousandths, so that equal scales computed differently still match */
+            int m_scale;
+            
+            bool m_printable;
+            
+            bool operator<(const SymbolKey& other) const
+            {
+                if (m_scale     != other.m_scale)     return m_scale < other.m_scale;
+                if (m_printable != other.m_printable) return other.m_printable;
+                return m_file_name < other.m_file_name;
+            }
+        };
+        
+        /** Number of scaled symbols kept; the cache is emptied when it grows larger */
+        const unsigned int SYMBOL_CACHE_CAPACITY = 64;
+        
+        std::map<SymbolKey, wxBitmap> g_symbol_cache;
+    }
+}
+
+wxBitmap AriaMaestosa::RenderRoutines::getScaledBitmap(const wxString& fileName, float scale, bool printable)
+{
+    SymbolKey key;
+    key.m_file_name = fileName;
+    key.m_scale     = (int)round(scale*1000.0f);
+    key.m_printable = printable;
+    
+    std::map<SymbolKey, wxBitmap>::iterator it = g_symbol_cache.find(key);
+    if (it != g_symbol_cache.end()) return it->second;
+    
+    wxImage image(getResourcePrefix() + wxT("score") + wxFileName::GetPathSeparator() + fileName,
+                  wxBITMAP_TYPE_PNG);
+    if (printable) image = getPrintableImage(image);
+    
+    // scale from the quantized value, so that the bitmap doesn't depend on which caller created it
+    const float cachedScale = key.m_scale / 1000.0f;
+    wxBitmap bitmap(image.Scale(image.GetWidth()*cachedScale, image.GetHeight()*cachedScale,
+                                wxIMAGE_QUALITY_HIGH));
+    
+    if (g_symbol_cache.size() >= SYMBOL_CACHE_CAPACITY) g_symbol_cache.clear();
+    g_symbol_cache[key] = bitmap;
+    return bitmap;
 }
 
 // -------------------------------------------------------------------------------------------------------
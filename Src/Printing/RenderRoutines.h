@@ -80,10 +80,14 @@ namespace AriaMaestosa
 #endif
         
         /**
-         * @brief  loads an image from file and scales it
+         * @brief  loads an image of the 'score' resource directory and scales it
+         *
+         * Results are cached (per file, scale and variant) and shared by all pages and print previews,
+         * so calling this for every line or page only loads and resamples the image once.
+         * @param printable  whether to pass the image through getPrintableImage
          * @return the scaled image
          */
-        wxBitmap getScaledBitmap(const wxString& fileName, float scale);
+        wxBitmap getScaledBitmap(const wxString& fileName, float scale, bool printable = true);
         
         /**
          * @brief  make an image more print-friendly on Windows
@@ -31,9 +31,12 @@
 
 #include "AriaCore.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <cmath>
 #include <map>
+#include <thread>
 
 #define BE_VERBOSE 0
 
@@ -305,30 +308,30 @@ void PrintLayoutAbstract::calculateRelativeLengths(std::vector<LayoutElement>& l
 {
     std::cout << "\n====\ncalculateRelativeLengths\n====\n";
 
-    // calculate approximative width of each element
+    // measures whose placement must be calculated, and the element each belongs to
+    std::vector<RelativePlacementManager*> placements;
+    std::vector<int> placementElements;
+    std::vector<bool> measureCollected(m_measures.size(), false);
+    
+    // ---- determine a list of all ticks on which a note starts in each measure.
+    //      then we can determine where within the measure should each note be drawn.
+    //      This is done serially, since editors share their conversion state across measures.
     const int layoutElementsAmount = layoutElements.size();
     for (int n=0; n<layoutElementsAmount; n++)
     {
         if ((n & 3) == 0) // only update progress one element out of 4
         {
-            WaitWindow::setProgress( 35 + n*25/layoutElementsAmount );
+            WaitWindow::setProgress( 35 + n*15/layoutElementsAmount );
         }
         
 #if BE_VERBOSE
         std::cout << "= layout element " << n << " =\n";
 #endif
         
-        //layoutElements[n].width_in_print_units = LAYOUT_ELEMENT_MIN_WIDTH;
-
         if (layoutElements[n].getType() == SINGLE_MEASURE or layoutElements[n].getType() == EMPTY_MEASURE)
         {     
             layoutElements[n].width_in_print_units = LAYOUT_ELEMENT_MIN_WIDTH;
             
-            // determine a list of all ticks on which a note starts.
-            // then we can determine where within this measure should this note be drawn
-            
-            std::vector<int> all_ticks_vector;
-            
             // Ask all editors to add their symbols to the list
             PrintLayoutMeasure& meas = m_measures[layoutElements[n].m_measure];
             RelativePlacementManager& ticks_relative_position = meas.getTicksPlacementManager();
@@ -348,35 +351,105 @@ void PrintLayoutAbstract::calculateRelativeLengths(std::vector<LayoutElement>& l
                 editorPrintable->addUsedTicks(meas, i, track_ref, ticks_relative_position);
             }
             
-            ticks_relative_position.calculateRelativePlacement();
-            
-            /*
-            layoutElements[n].width_in_units = ticks_relative_position.getUnitCount();
-            if (layoutElements[n].width_in_units < MIN_UNIT_WIDTH)
+            // the same measure must not be placed by two threads at once
+            if (not measureCollected[layoutElements[n].m_measure])
             {
-                layoutElements[n].width_in_units = MIN_UNIT_WIDTH;
-            }*/
-            
-            layoutElements[n].width_in_print_units = ticks_relative_position.getWidth();
-
-            if (layoutElements[n].width_in_print_units < LAYOUT_ELEMENT_MIN_WIDTH)
-            {
-                layoutElements[n].width_in_print_units = LAYOUT_ELEMENT_MIN_WIDTH;
+                measureCollected[layoutElements[n].m_measure] = true;
+                placements.push_back(&ticks_relative_position);
             }
-            
+            placementElements.push_back(n);
+        }
+    } // end for elements
+    
+    // ---- calculate approximative width of each measure
+    calculatePlacements(placements, 50, 60);
+    
+    const int placedAmount = placementElements.size();
+    for (int i=0; i<placedAmount; i++)
+    {
+        LayoutElement& element = layoutElements[placementElements[i]];
+        element.width_in_print_units = std::max(m_measures[element.m_measure].getTicksPlacementManager().getWidth(),
+                                                LAYOUT_ELEMENT_MIN_WIDTH);
+        
 #if BE_VERBOSE
-            std::cout << "  -> Layout element " << n << " is " << layoutElements[n].width_in_print_units
-                      << " unit(s) wide" << std::endl;
+        std::cout << "  -> Layout element " << placementElements[i] << " is " << element.width_in_print_units
+                  << " unit(s) wide" << std::endl;
 #endif
-        }
-        /*
-        else if (layoutElements[n].getType() == REPEATED_RIFF)
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------
+
+namespace AriaMaestosa
+{
+    /** Work shared by the threads calculating the placement of measures */
+    struct PlacementJob
+    {
+        std::vector<RelativePlacementManager*>* m_placements;
+        
+        /** index of the next measure to be taken by a thread */
+        std::atomic<int> m_next;
+        
+        /** number of measures placed so far */
+        std::atomic<int> m_done;
+    };
+    
+    /** Don't start a thread for less measures than this, it would cost more than it saves */
+    const int MIN_MEASURES_PER_THREAD = 16;
+    
+    static void placeMeasures(PlacementJob* job, const int progressFrom, const int progressTo)
+    {
+        std::vector<RelativePlacementManager*>& placements = *job->m_placements;
+        const int count = placements.size();
+        
+        for (int n = job->m_next++; n < count; n = job->m_next++)
         {
-            layoutElements[n].width_in_print_units = LAYOUT_ELEMENT_MIN_WIDTH;
-        }*/
+            placements[n]->calculateRelativePlacement();
+            const int done = ++job->m_done;
+            
+            // only the main thread may update the wait window
+            if (progressFrom >= 0 and (n & 7) == 0)
+            {
+                WaitWindow::setProgress( progressFrom + done*(progressTo - progressFrom)/count );
+            }
+        }
+    }
+    
+    static void placeMeasuresInWorker(PlacementJob* job)
+    {
+        placeMeasures(job, -1, -1);
+    }
+}
 
-        //std::cout << "$$ setting charwidth for element " << n << " : " << layoutElements[n].width_in_units << std::endl;
-    } // end for elements
+void PrintLayoutAbstract::calculatePlacements(std::vector<RelativePlacementManager*>& placements,
+                                              const int progressFrom, const int progressTo)
+{
+    PlacementJob job;
+    job.m_placements = &placements;
+    job.m_next = 0;
+    job.m_done = 0;
+    
+    // the calling thread works too
+    const int count = placements.size();
+    const int workerAmount = std::min((int)std::thread::hardware_concurrency() - 1,
+                                      count/MIN_MEASURES_PER_THREAD - 1);
+    
+    std::vector<std::thread> workers;
+    for (int n=0; n<workerAmount; n++)
+    {
+        workers.push_back( std::thread(placeMeasuresInWorker, &job) );
+    }
+    
+    placeMeasures(&job, progressFrom, progressTo);
+    
+    for (unsigned int n=0; n<workers.size(); n++)
+    {
+        workers[n].join();
+    }
+    
+    const int placed = job.m_done;
+    ASSERT_E(placed, ==, count);
+    WaitWindow::setProgress(progressTo);
 }
 
 // -----------------------------------------------------------------------------------------------------
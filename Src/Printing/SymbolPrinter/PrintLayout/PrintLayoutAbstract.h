@@ -35,6 +35,7 @@ namespace AriaMaestosa
     class Track;
     class SymbolPrintableSequence;
     class PrintLayoutMeasure;
+    class RelativePlacementManager;
     
     int  getRepetitionMinimalLength();
     void setRepetitionMinimalLength(const int newvalue);
@@ -66,6 +67,15 @@ namespace AriaMaestosa
         /** The main goal of this method is to set the 'width_in_print_units' member of each LayoutElement */
         void calculateRelativeLengths(std::vector<LayoutElement>& layoutElements);
         
+        /**
+          * @brief calculate the placement of the given measures, spreading the work across several
+          *        threads when there are enough measures (each measure is placed independently)
+          * @param progressFrom, progressTo  range of the wait window's progress to cover
+          * @pre   each placement manager appears only once in the list
+          */
+        void calculatePlacements(std::vector<RelativePlacementManager*>& placements,
+                                 const int progressFrom, const int progressTo);
+        
         /**
           * Populates the 'layoutElements' vector with elements that represent the current sequence.
           *
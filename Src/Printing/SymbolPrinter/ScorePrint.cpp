@@ -262,21 +262,9 @@ namespace AriaMaestosa
         const int bottom_on_image = 49;
         const float scale = (score_bottom - b_line_y) / (float)(bottom_on_image - b_on_image);
         const int y = score_bottom - bottom_on_image*scale;
-        static wxString path = getResourcePrefix() + wxT("score") + wxFileName::GetPathSeparator() +
-                               wxT("keyG.png");
+        // cached : the scale is the same for every line
+        wxBitmap scaled = RenderRoutines::getScaledBitmap(wxT("keyG.png"), scale);
         
-        /*
-        static wxBitmap gclef(path, wxBITMAP_TYPE_PNG);
-        wxBitmap scaled = wxBitmap(gclef.ConvertToImage().Scale(gclef.GetWidth()*scale,
-                                   gclef.GetHeight()*scale));
-        */
-        
-        wxImage inputGClef(path, wxBITMAP_TYPE_PNG);
-        wxImage gclef = RenderRoutines::getPrintableImage(inputGClef);
-        wxBitmap scaled = wxBitmap(gclef.Scale(gclef.GetWidth()*scale, gclef.GetHeight()*scale),
-                                   wxIMAGE_QUALITY_HIGH);
-        
-
         dc.DrawBitmap(scaled, x, y, true);
 #endif
     }
@@ -291,18 +279,7 @@ namespace AriaMaestosa
 #else
         const int e_on_image = 15;
         const float scale = (float)(e_line_y - score_top) / (float)e_on_image;
-        wxString path =  getResourcePrefix() + wxT("score") + wxFileName::GetPathSeparator() +
-                         wxT("FKey.png");
-        
-        wxImage inputFClef(path, wxBITMAP_TYPE_PNG);
-        wxImage fclef = RenderRoutines::getPrintableImage(inputFClef);
-        wxBitmap scaled = wxBitmap(fclef.Scale(fclef.GetWidth()*scale, fclef.GetHeight()*scale),
-                                   wxIMAGE_QUALITY_HIGH);
-        /*
-        static wxBitmap fclef( , wxBITMAP_TYPE_PNG );
-        wxBitmap scaled = wxBitmap(fclef.ConvertToImage().Scale(fclef.GetWidth()*scale,
-                                   fclef.GetHeight()*scale));
-        */
+        wxBitmap scaled = RenderRoutines::getScaledBitmap(wxT("FKey.png"), scale);
         
         dc.DrawBitmap(scaled, x, score_top, true);
 #endif
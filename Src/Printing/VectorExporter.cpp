@@ -0,0 +1,188 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Printing/VectorExporter.h"
+#include "Printing/wxEasyPrintWrapper.h"
+
+#include <iostream>
+#include <wx/graphics.h>
+
+#if defined(__WXGTK__) && wxCHECK_VERSION(2,9,1) && wxUSE_GRAPHICS_CONTEXT
+#define ARIA_VECTOR_EXPORT 1
+#include <wx/dcgraph.h>
+#include <cairo.h>
+#include <cairo-pdf.h>
+#include <cairo-svg.h>
+#endif
+
+using namespace AriaMaestosa;
+
+/** Number of points (the unit of PDF and SVG pages) per millimeter */
+const double POINTS_PER_MM = 72.0 / 25.4;
+
+// ----------------------------------------------------------------------------------------------------------
+
+VectorExporter::VectorExporter(IPrintCallback* callback, VectorFormat format, int paperWidth, int paperHeight,
+                               int leftMargin, int topMargin, int unitWidth, int unitHeight, float unitsPerCm)
+{
+    ASSERT(callback != NULL);
+    ASSERT_E(unitWidth,  >, 0);
+    ASSERT_E(unitHeight, >, 0);
+    ASSERT(unitsPerCm > 0.0f);
+
+    m_print_callback = callback;
+    m_format         = format;
+    m_page_width     = paperWidth  * POINTS_PER_MM;
+    m_page_height    = paperHeight * POINTS_PER_MM;
+    m_origin_x       = leftMargin  * POINTS_PER_MM;
+    m_origin_y       = topMargin   * POINTS_PER_MM;
+    m_unit_scale     = POINTS_PER_MM * 10.0 / unitsPerCm;
+    m_unit_width     = unitWidth;
+    m_unit_height    = unitHeight;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool VectorExporter::isAvailable()
+{
+#ifdef ARIA_VECTOR_EXPORT
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool VectorExporter::formatFromFileName(const wxString& path, VectorFormat* format)
+{
+    const wxString lower = path.Lower();
+    if (lower.EndsWith(wxT(".pdf")))
+    {
+        *format = VECTOR_FORMAT_PDF;
+        return true;
+    }
+    else if (lower.EndsWith(wxT(".svg")))
+    {
+        *format = VECTOR_FORMAT_SVG;
+        return true;
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+#ifdef ARIA_VECTOR_EXPORT
+
+/** @return whether cairo reports no error, printing it otherwise */
+static bool checkSurface(cairo_surface_t* surface, const wxString& path)
+{
+    const cairo_status_t status = cairo_surface_status(surface);
+    if (status == CAIRO_STATUS_SUCCESS) return true;
+
+    std::cerr << "[VectorExporter] ERROR: cannot write '" << (const char*)path.utf8_str() << "' : "
+              << cairo_status_to_string(status) << std::endl;
+    return false;
+}
+
+#endif
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool VectorExporter::exportPages(const wxString& path, const int pageCount)
+{
+    ASSERT_E(pageCount, >, 0);
+
+#ifdef ARIA_VECTOR_EXPORT
+    wxString basePath = path;
+    if (m_format == VECTOR_FORMAT_SVG and pageCount > 1 and path.Lower().EndsWith(wxT(".svg")))
+    {
+        basePath = path.Left(path.Length() - 4);
+    }
+
+    cairo_surface_t* surface = NULL;
+    bool success = true;
+
+    for (int page=1; page<=pageCount and success; page++)
+    {
+        // a PDF surface takes all pages, whereas each SVG page is a surface (and file) of its own
+        wxString pagePath = path;
+        if (m_format == VECTOR_FORMAT_SVG)
+        {
+            if (pageCount > 1) pagePath = basePath + wxString::Format(wxT("-%i.svg"), page);
+            surface = cairo_svg_surface_create(pagePath.utf8_str(), m_page_width, m_page_height);
+        }
+        else if (surface == NULL)
+        {
+            surface = cairo_pdf_surface_create(pagePath.utf8_str(), m_page_width, m_page_height);
+        }
+
+        if (not checkSurface(surface, pagePath))
+        {
+            success = false;
+            break;
+        }
+
+        cairo_t* cr = cairo_create(surface);
+
+        wxGraphicsContext* gc = wxGraphicsRenderer::GetDefaultRenderer()->CreateContextFromNativeContext(cr);
+        ASSERT(gc != NULL);
+
+        // same coordinate system as on paper : 'm_unit_width' units across the printable area
+        gc->Translate(m_origin_x, m_origin_y);
+        gc->Scale(m_unit_scale, m_unit_scale);
+
+        {
+            // the DC owns the graphics context
+            wxGCDC dc(gc);
+            m_print_callback->printPage(page, dc, gc, 0, 0, m_unit_width, m_unit_height);
+        }
+
+        cairo_show_page(cr);
+        cairo_destroy(cr);
+
+        if (m_format == VECTOR_FORMAT_SVG)
+        {
+            // finishing the surface is what writes the page to disk
+            cairo_surface_finish(surface);
+            success = checkSurface(surface, pagePath);
+            cairo_surface_destroy(surface);
+            surface = NULL;
+        }
+        else
+        {
+            cairo_surface_flush(surface);
+            success = checkSurface(surface, pagePath);
+        }
+
+        std::cout << "[VectorExporter] page " << page << " / " << pageCount << " written" << std::endl;
+    }
+
+    if (surface != NULL)
+    {
+        cairo_surface_finish(surface);
+        success = checkSurface(surface, path) and success;
+        cairo_surface_destroy(surface);
+    }
+
+    return success;
+#else
+    std::cerr << "[VectorExporter] ERROR: PDF and SVG export are not supported in this build" << std::endl;
+    return false;
+#endif
+}
+
+// ----------------------------------------------------------------------------------------------------------
@@ -0,0 +1,93 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __VECTOR_EXPORTER_H__
+#define __VECTOR_EXPORTER_H__
+
+#include "Utils.h"
+#include <wx/string.h>
+
+namespace AriaMaestosa
+{
+    class IPrintCallback;
+
+    enum VectorFormat
+    {
+        VECTOR_FORMAT_PDF,
+        VECTOR_FORMAT_SVG
+    };
+
+    /**
+      * @brief Writes printable pages to a PDF or SVG file, without going through wxPrinter
+      *
+      * Pages are requested from the IPrintCallback one at a time and each one is written out
+      * before the next is drawn, so memory use does not grow with the length of the song.
+      * A PDF holds all pages; with SVG, which has no notion of pages, each page goes to its own
+      * file ('name-1.svg', 'name-2.svg', ...) unless there is only one.
+      *
+      * @note Vector output goes through cairo and is thus currently only available with wxGTK.
+      * @ingroup printing
+      */
+    class VectorExporter
+    {
+        IPrintCallback* m_print_callback;
+        VectorFormat    m_format;
+
+        /** size of the page, in points */
+        double m_page_width, m_page_height;
+
+        /** where the printable area begins on the page, in points */
+        double m_origin_x, m_origin_y;
+
+        /** size of a printing unit, in points */
+        double m_unit_scale;
+
+        int m_unit_width, m_unit_height;
+
+    public:
+        LEAK_CHECK();
+
+        /**
+          * @param paperWidth    paper width, in millimeters, in the wanted orientation
+          * @param paperHeight   paper height, in millimeters, in the wanted orientation
+          * @param leftMargin    in millimeters
+          * @param topMargin     in millimeters
+          * @param unitWidth     width of the printable area, in units (see wxEasyPrintWrapper)
+          * @param unitHeight    height of the printable area, in units
+          * @param unitsPerCm    number of units per centimeter
+          */
+        VectorExporter(IPrintCallback* callback, VectorFormat format, int paperWidth, int paperHeight,
+                       int leftMargin, int topMargin, int unitWidth, int unitHeight, float unitsPerCm);
+
+        /** @return whether vector export is supported by this build */
+        static bool isAvailable();
+
+        /**
+          * @brief guess the format from the extension of a file name ('.pdf' or '.svg')
+          * @return whether the extension was recognized
+          */
+        static bool formatFromFileName(const wxString& path, VectorFormat* format);
+
+        /**
+          * @brief draw pages 1 to 'pageCount' and write them to disk
+          * @return whether all pages could be written
+          */
+        bool exportPages(const wxString& path, const int pageCount);
+    };
+
+}
+
+#endif
@@ -238,6 +238,18 @@ PageSetupSummary wxEasyPrintWrapper::getPageSetupSummary() const
 
 // ----------------------------------------------------------------------------------------------------------
 
+wxSize wxEasyPrintWrapper::getPaperSize() const
+{
+    const wxSize paperSize = m_page_setup.GetPaperSize();
+    const int large_side = std::max(paperSize.GetWidth(), paperSize.GetHeight());
+    const int small_side = std::min(paperSize.GetWidth(), paperSize.GetHeight());
+    
+    if (m_orient == wxPORTRAIT) return wxSize(small_side, large_side);
+    else                        return wxSize(large_side, small_side);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 void wxEasyPrintWrapper::setPageCount(const int pageCount)
 {
     ASSERT_E(pageCount,>,0);
@@ -342,8 +354,10 @@ bool wxEasyPrintWrapper::OnPrintPage(int pageNum)
     {
         gc = wxGraphicsContext::Create( dynamic_cast<wxMemoryDC&>(dc) );
     }
+    // the DC owns the graphics context
     wxGCDC* gcdc = new wxGCDC(gc);
     m_print_callback->printPage(pageNum, *gcdc, gc, x0, y0, x1, y1);
+    delete gcdc;
 #else
     m_print_callback->printPage(pageNum, dc, NULL, x0, y0, x1, y1);
 #endif
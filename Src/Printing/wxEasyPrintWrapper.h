@@ -38,10 +38,11 @@ namespace AriaMaestosa
         virtual ~IPrintCallback() {}
         
         /**
-         * Called (by wxEasyPrintWrapper) when it is time to print a page.
+         * Called (by wxEasyPrintWrapper or VectorExporter) when it is time to print a page.
          *
          * @param pageNum      ID of the page we want to print
          * @param dc           The wxDC onto which stuff to print is to be rendered
+         * @param gc           Graphics context drawing on the same page (remains owned by the caller)
          * @param x0           x origin coordinate from which drawing can occur
          * @param y0           y origin coordinate from which drawing can occur
          */
@@ -127,6 +128,15 @@ namespace AriaMaestosa
             return m_units_per_cm;
         }
         
+        /** @return size of the selected paper in millimeters, in the selected orientation */
+        wxSize getPaperSize() const;
+        
+        /** @return left margin, in millimeters */
+        int getLeftMargin() const { return m_left_margin; }
+        
+        /** @return top margin, in millimeters */
+        int getTopMargin () const { return m_top_margin;  }
+        
         /** 
           * @return the number of units vertically on the printable area of the paper
           * @pre  'performPageSetup' must have been called at least once prior to calling this
@@ -0,0 +1,269 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef RENDERER_OPENGL
+
+#include "Renderers/GLGlyphAtlas.h"
+#include "OpenGL.h"
+#include "Utils.h"
+
+#include <wx/bitmap.h>
+#include <wx/dcmemory.h>
+#include <wx/image.h>
+#include <wx/settings.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace AriaMaestosa;
+
+/** Empty pixels left between glyphs, so that linear filtering does not bleed into neighbours */
+const int GLYPH_PADDING = 1;
+
+namespace AriaMaestosa
+{
+    /** Atlases by font description; they live as long as the OpenGL context, i.e. until the app quits */
+    std::map<wxString, GlyphAtlas*> g_atlases;
+
+    static inline wxChar charAt(const wxString& text, const int n) { return text[n];                }
+    static inline wxChar charAt(const char* text, const int n)     { return (unsigned char)text[n]; }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+GlyphAtlas::GlyphAtlas(const wxFont& font)
+{
+    m_font       = font;
+    m_texture    = 0;
+    m_next_x     = 0;
+    m_next_y     = 0;
+    m_generation = 0;
+
+    wxBitmap bmp(1, 1);
+    wxMemoryDC dc(bmp);
+    dc.SetFont(m_font);
+    m_line_height = dc.GetTextExtent(wxT("Xg")).GetHeight();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+GlyphAtlas* GlyphAtlas::get(const wxFont& font)
+{
+    const wxFont& actualFont = (font.IsOk() ? font : wxSystemSettings::GetFont(wxSYS_SYSTEM_FONT));
+    const wxString key = actualFont.GetNativeFontInfoDesc();
+
+    std::map<wxString, GlyphAtlas*>::iterator it = g_atlases.find(key);
+    if (it != g_atlases.end()) return it->second;
+
+    GlyphAtlas* atlas = new GlyphAtlas(actualFont);
+    g_atlases[key] = atlas;
+    return atlas;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+GlyphAtlas::Glyph& GlyphAtlas::getGlyph(const wxChar c)
+{
+    Glyph& glyph = ((unsigned int)c < 256 ? m_latin1[(unsigned int)c] : m_others[c]);
+    if (not glyph.m_measured) measure(c, glyph);
+    return glyph;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GlyphAtlas::measure(const wxChar c, Glyph& glyph)
+{
+    wxBitmap bmp(1, 1);
+    wxMemoryDC dc(bmp);
+    dc.SetFont(m_font);
+
+    glyph.m_advance  = dc.GetTextExtent(wxString(c)).GetWidth();
+    if (glyph.m_advance > TEXTURE_SIZE) glyph.m_advance = TEXTURE_SIZE;
+    glyph.m_measured = true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GlyphAtlas::clearTexture()
+{
+    if (m_texture == 0)
+    {
+        glGenTextures(1, (GLuint*)&m_texture);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+
+    GLubyte* empty = (GLubyte*)calloc(TEXTURE_SIZE * TEXTURE_SIZE * 4, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, TEXTURE_SIZE, TEXTURE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, empty);
+    free(empty);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+
+    for (int n=0; n<256; n++) m_latin1[n].m_uploaded = false;
+
+    std::map<wxChar, Glyph>::iterator it;
+    for (it = m_others.begin(); it != m_others.end(); it++) it->second.m_uploaded = false;
+
+    m_next_x = 0;
+    m_next_y = 0;
+    m_generation++;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GlyphAtlas::upload(const wxChar c, Glyph& glyph)
+{
+    const int w = std::max(glyph.m_advance, 1);
+    const int h = m_line_height;
+
+    if (m_texture == 0) clearTexture();
+
+    // find a slot; when the texture is full, start over (glyphs will be uploaded again as they are used)
+    if (m_next_x + w > TEXTURE_SIZE)
+    {
+        m_next_x = 0;
+        m_next_y += h + GLYPH_PADDING;
+    }
+    if (m_next_y + h > TEXTURE_SIZE) clearTexture();
+
+    // rasterize black on white, then convert to white with an alpha channel (not all platforms
+    // support transparency in wxDCs so it's the easiest way to go)
+    wxBitmap bmp(w, h);
+    {
+        wxMemoryDC dc(bmp);
+        dc.SetBackground(*wxWHITE_BRUSH);
+        dc.Clear();
+        dc.SetFont(m_font);
+        dc.SetTextForeground(*wxBLACK);
+        dc.DrawText(wxString(c), 0, 0);
+    }
+    wxImage img = bmp.ConvertToImage();
+    const unsigned char* rgb = img.GetData();
+
+    GLubyte* pixels = (GLubyte*)malloc(w * h * 4);
+    for (int n=0; n<w*h; n++)
+    {
+        pixels[n*4 + 0] = 255;
+        pixels[n*4 + 1] = 255;
+        pixels[n*4 + 2] = 255;
+        pixels[n*4 + 3] = 255 - rgb[n*3];
+    }
+
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, m_next_x, m_next_y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    free(pixels);
+
+    glyph.m_x        = m_next_x;
+    glyph.m_y        = m_next_y;
+    glyph.m_uploaded = true;
+
+    m_next_x += w + GLYPH_PADDING;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int GlyphAtlas::getTextWidth(const wxString& text)
+{
+    int width = 0;
+    const int length = text.size();
+    for (int n=0; n<length; n++)
+    {
+        width += getGlyph(text[n]).m_advance;
+    }
+    return width;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GlyphAtlas::bind()
+{
+    if (m_texture == 0) clearTexture();
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+template<typename STRING>
+void GlyphAtlas::renderText(const STRING& text, const int length, const int x, const int y, const int maxWidth)
+{
+    // upload missing glyphs before emitting any quad. If the texture fills up meanwhile, it is
+    // cleared, and the glyphs of this string that were uploaded before must be uploaded again
+    for (int attempt=0; attempt<2; attempt++)
+    {
+        const int generation = m_generation;
+        for (int n=0; n<length; n++)
+        {
+            const wxChar c = charAt(text, n);
+            Glyph& glyph = getGlyph(c);
+            if (not glyph.m_uploaded) upload(c, glyph);
+        }
+        if (generation == m_generation) break;
+    }
+
+    const float k = 1.0f / TEXTURE_SIZE;
+    const int top = y - m_line_height;
+    int pen = x;
+
+    glBegin(GL_QUADS);
+    for (int n=0; n<length; n++)
+    {
+        const Glyph& glyph = getGlyph(charAt(text, n));
+
+        int w = glyph.m_advance;
+        if (maxWidth != -1 and pen + w > x + maxWidth)
+        {
+            // cut the last visible glyph
+            w = x + maxWidth - pen;
+            if (w <= 0) break;
+        }
+
+        const float u1 = glyph.m_x * k;
+        const float u2 = (glyph.m_x + w) * k;
+        const float v1 = glyph.m_y * k;
+        const float v2 = (glyph.m_y + m_line_height) * k;
+
+        glTexCoord2f(u1, v1); glVertex2f( pen*10,     top*10 );
+        glTexCoord2f(u2, v1); glVertex2f( (pen+w)*10, top*10 );
+        glTexCoord2f(u2, v2); glVertex2f( (pen+w)*10, y*10   );
+        glTexCoord2f(u1, v2); glVertex2f( pen*10,     y*10   );
+
+        pen += glyph.m_advance;
+    }
+    glEnd();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GlyphAtlas::renderString(const wxString& text, const int x, const int y, const int maxWidth)
+{
+    renderText(text, text.size(), x, y, maxWidth);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void GlyphAtlas::renderString(const char* text, const int x, const int y, const int maxWidth)
+{
+    renderText(text, strlen(text), x, y, maxWidth);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+#endif
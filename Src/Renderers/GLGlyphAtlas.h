@@ -0,0 +1,114 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef RENDERER_OPENGL
+#ifndef __GL_GLYPH_ATLAS_H__
+#define __GL_GLYPH_ATLAS_H__
+
+#include <map>
+#include <wx/font.h>
+#include <wx/string.h>
+
+namespace AriaMaestosa
+{
+
+    /**
+      * @brief OpenGL render backend : all glyphs of a font, packed in a single texture
+      *
+      * Glyphs are rasterized once, the first time they are rendered, and strings are then drawn as one
+      * textured quad per character. Any string in the same font can thus be rendered with no texture
+      * creation or upload, and consecutive strings share the same texture binding.
+      *
+      * Text is laid out from glyph advances; kerning is not applied.
+      *
+      * @ingroup renderers
+      */
+    class GlyphAtlas
+    {
+        struct Glyph
+        {
+            /** whether this glyph has been measured */
+            bool m_measured;
+
+            /** whether this glyph is present in the current texture */
+            bool m_uploaded;
+
+            /** location of the glyph in the texture, in pixels */
+            int m_x, m_y;
+
+            /** horizontal advance of the glyph, which is also the width of its quad */
+            int m_advance;
+
+            Glyph() { m_measured = false; m_uploaded = false; }
+        };
+
+        wxFont m_font;
+
+        /** glyphs of the latin-1 range are in a plain array, others in a map */
+        Glyph m_latin1[256];
+        std::map<wxChar, Glyph> m_others;
+
+        /** here I don't use GLuint to avoid including OpenGL everywhere in the project */
+        unsigned int m_texture;
+
+        int m_line_height;
+
+        /** next free slot in the texture (glyphs are packed in rows of m_line_height pixels) */
+        int m_next_x, m_next_y;
+
+        /** incremented each time the texture fills up and is cleared */
+        int m_generation;
+
+        GlyphAtlas(const wxFont& font);
+
+        Glyph& getGlyph(const wxChar c);
+        void measure(const wxChar c, Glyph& glyph);
+        void upload(const wxChar c, Glyph& glyph);
+        void clearTexture();
+
+        template<typename STRING>
+        void renderText(const STRING& text, const int length, const int x, const int y, const int maxWidth);
+
+    public:
+
+        /** Width and height of the texture holding the glyphs */
+        static const int TEXTURE_SIZE = 512;
+
+        /** @return the atlas for this font, created the first time it's requested */
+        static GlyphAtlas* get(const wxFont& font);
+
+        int getLineHeight() const { return m_line_height; }
+
+        /** @return the width the given text will occupy when rendered (does not need an OpenGL context) */
+        int getTextWidth(const wxString& text);
+
+        /** @brief bind the texture of this atlas; call before rendering strings */
+        void bind();
+
+        /**
+          * @brief render a single line of text, the bottom of the line at 'y'. Must be called after bind().
+          * @param maxWidth  text is cut beyond this width, pass -1 for no limit
+          */
+        void renderString(const wxString& text, const int x, const int y, const int maxWidth = -1);
+
+        /** @brief same as above for plain ASCII strings, like numbers */
+        void renderString(const char* text, const int x, const int y, const int maxWidth = -1);
+    };
+
+}
+
+#endif
+#endif
@@ -21,6 +21,8 @@
 #include "Singleton.h"
 #include "PreferencesData.h"
 #include "Renderers/RenderAPI.h"
+#include "Renderers/GLGlyphAtlas.h"
+#include "Renderers/RenderLayer.h"
 #include "OpenGL.h"
 #include <cmath>
 #include <iostream>
@@ -31,6 +33,8 @@ namespace AriaMaestosa
 namespace AriaRender
 {
 
+int primitive_count = 0;
+
 void primitives()
 {
     glDisable(GL_TEXTURE_2D);
@@ -84,6 +88,7 @@ void color(const float r, const float g, const float b, const float a)
 
 void line(const int x1, const int y1, const int x2, const int y2)
 {
+    primitive_count++;
     glBegin(GL_LINES);
     glVertex2f(x1*10.0, y1*10.0);
     glVertex2f(x2*10.0, y2*10.0);
@@ -103,6 +108,7 @@ void lineSmooth(const bool enabled)
 
 void point(const int x, const int y)
 {
+    primitive_count++;
     glBegin(GL_POINTS);
     glVertex2f(x*10.0, y*10.0);
     glEnd();
@@ -115,6 +121,7 @@ void pointSize(const int n)
 
 void rect(const int x1, const int y1, const int x2, const int y2)
 {
+    primitive_count++;
     glBegin(GL_QUADS);
     glVertex2f(x1*10.0, y1*10.0);
     glVertex2f(x2*10.0, y1*10.0);
@@ -172,6 +179,7 @@ void bordered_rect(const int x1, const int y1, const int x2, const int y2)
 
 void hollow_rect(const int x1, const int y1, const int x2, const int y2)
 {
+    primitive_count++;
     glBegin(GL_LINES);
 
     glVertex2f(x1*10.0, y1*10.0);
@@ -192,6 +200,7 @@ void hollow_rect(const int x1, const int y1, const int x2, const int y2)
 
 void select_rect(const int x1, const int y1, const int x2, const int y2)
 {
+    primitive_count++;
     glColor4f(0.0f, 0.83f, 0.16f, 0.3f);
 
     glBegin(GL_QUADS);
@@ -222,6 +231,7 @@ void select_rect(const int x1, const int y1, const int x2, const int y2)
 
 void triangle(const int x1, const int y1, const int x2, const int y2, const int x3, const int y3)
 {
+    primitive_count++;
     glBegin(GL_TRIANGLES);
     glVertex2f(x1*10.0, y1*10.0);
     glVertex2f(x2*10.0, y2*10.0);
@@ -231,6 +241,7 @@ void triangle(const int x1, const int y1, const int x2, const int y2, const int
 
 void arc(int center_x, int center_y, int radius_x, int radius_y, bool show_above)
 {
+    primitive_count++;
     glLoadIdentity();
 
     const int y_mult = (show_above ? -radius_y*10.0 : radius_y*10.0);
@@ -253,6 +264,7 @@ void quad(const int x1, const int y1,
           const int x3, const int y3,
           const int x4, const int y4)
 {
+    primitive_count++;
     glBegin(GL_QUADS);
     glVertex2f(x1*10.0, y1*10.0);
     glVertex2f(x2*10.0, y2*10.0);
@@ -320,6 +332,7 @@ void renderNumber(const float number, const int x, const int y)
 
 void renderNumber(const char* number, const int x, const int y)
 {
+    primitive_count++;
     NumberRendererSingleton* singleton = NumberRendererSingleton::getInstance();
     singleton->bind();
     singleton->renderNumber(number, x, y-1);
@@ -328,12 +341,13 @@ void renderNumber(const char* number, const int x, const int y)
 
 void renderString(const wxString& string, const int x, const int y, const int maxWidth)
 {
-    Model<wxString> model(string);
-    wxGLString glString(&model, false);
-    glString.setFont(getNoteNamesFont());
-    glString.setMaxWidth(maxWidth, false);
-    glString.bind();
-    glString.render(x, y);
+    primitive_count++;
+    // the font never changes, no need to look its atlas up each time
+    static GlyphAtlas* atlas = NULL;
+    if (atlas == NULL) atlas = GlyphAtlas::get(getNoteNamesFont());
+
+    atlas->bind();
+    atlas->renderString(string, x, y, maxWidth);
 }
 
 
@@ -349,6 +363,44 @@ void endScissors()
     glDisable(GL_SCISSOR_TEST);
 }
 
+int getPrimitiveCount()
+{
+    return primitive_count;
+}
+
+void resetPrimitiveCount()
+{
+    primitive_count = 0;
+}
+
+// the GL backend redraws everything each frame, layers are not supported
+bool beginLayer(RenderLayer& layer, const int x, const int y, const int width, const int height)
+{
+    return false;
+}
+
+void endLayer(RenderLayer& layer)
+{
+}
+
+bool drawLayer(RenderLayer& layer)
+{
+    return false;
+}
+
+}
+
+RenderLayer::RenderLayer()
+{
+    m_valid  = false;
+    m_x      = 0;
+    m_y      = 0;
+    m_width  = 0;
+    m_height = 0;
+}
+
+RenderLayer::~RenderLayer()
+{
 }
 
 DEFINE_SINGLETON( AriaRender::NumberRendererSingleton );
@@ -6,8 +6,7 @@
 
 #include <wx/font.h>
 #include <wx/string.h>
-class wxImage;
-class wxBitmap;
+#include <wx/arrstr.h>
 class wxDC;
 
 #include "ptr_vector.h"
@@ -15,105 +14,13 @@ class wxDC;
 namespace AriaMaestosa
 {
 
-    class wxGLString;
-    class wxGLStringArray;
-    class wxGLStringNumber;
-
-    /**
-     * @brief   OpenGL render backend : text renderer helper class (OpenGL backend)
-     * @ingroup renderers
-     */
-    class TextTexture
-    {
-        friend class wxGLString;
-        friend class wxGLStringArray;
-        friend class wxGLStringNumber;
-    private:
-
-        /** here I don't use GLuint to avoid including OpenGL everywhere in the project */
-        unsigned int* ID;
-    protected:
-
-        /** here I don't use GLuint to avoid including OpenGL everywhere in the project */
-        unsigned int* getID();
-
-        TextTexture();
-        TextTexture(wxBitmap& bmp);
-        void load(wxImage* img);
-    public:
-        LEAK_CHECK();
-
-        ~TextTexture();
-    };
-
-    /**
-      * @brief OpenGL render backend : utility class for text rendering
-      *
-      * Base class for renderable elements. You won't create this one directly,
-      * but may use its public members from wxGLString since it inherits from TextGLDrawable.
-      * This class will be useful if you wish to apply effects to the text like rotation or
-      * scaling.
-      *
-      * @ingroup renderers
-      */
-    class TextGLDrawable
-    {
-        friend class wxGLString;
-        friend class wxGLStringArray;
-        friend class wxGLStringNumber;
-    protected:
-
-        int m_x, m_y, m_angle;
-        float m_x_scale, m_y_scale;
-        OwnerPtr<TextTexture> m_image;
-        bool m_x_flip, m_y_flip;
-
-        int y_offset;
-
-        float tex_coord_x1, tex_coord_y1;
-        float tex_coord_x2, tex_coord_y2;
-        int m_w, m_h, texw, texh;
-
-        int m_max_width;
-
-        TextGLDrawable(TextTexture* image=(TextTexture*)0);
-        void render();
-        void setImage(TextTexture* image, bool giveUpOwnership=false);
-        void move(int x, int y);
-    public:
-
-        LEAK_CHECK();
-
-        virtual ~TextGLDrawable() {}
-
-        /** allows you to flip the rendering vertically and/or horizontally */
-        void setFlip(bool x, bool y);
-
-        /** scale the rendering , horizontally and vertically (allows stretching) */
-        void scale(float x, float y);
-
-        /** scale the rendering and keep the same aspect ratio */
-        void scale(float k);
-
-        /** rotate the rendering by 'angle' degrees */
-        void rotate(int angle);
-
-        void setMaxWidth(const int w);
-
-        /** returns the width of this element */
-        int getWidth() const { return m_w; }
-        /** returns the height of this element */
-        int getHeight() const { return m_h; }
-
-    };
-
-    class wxGLStringArray;
+    class GlyphAtlas;
 
     /**
      @brief OpenGL render backend : text renderer
 
-     It draws a single string on a single line.
-     If you plan to render multiple strings, this class is not the fastest.
+     It draws a single string on a single line (or on a few lines, when warping).
+     Glyphs come from the GlyphAtlas of the string's font, so changing the string is cheap.
 
      Use example :
 
@@ -130,23 +37,27 @@ namespace AriaMaestosa
 
      @ingroup renderers
      */
-    class wxGLString : public TextGLDrawable, public IModelListener<wxString>
+    class wxGLString : public IModelListener<wxString>
     {
     protected:
         wxFont m_font;
 
-        int m_warp_after;
+        /** glyphs of m_font; set by consolidate() */
+        GlyphAtlas* m_atlas;
 
-        bool m_consolidated;
+        /** the lines to render (there is more than one only when warping) */
+        wxArrayString m_lines;
 
-        friend class wxGLStringArray;
+        int m_w, m_h;
+        int m_max_width;
+        int m_warp_after;
 
-        void calculateSize(wxDC* dc, const bool ignore_font=false /* when from array */);
-        void consolidateFromArray(wxDC* dc, int x, int y);
+        bool m_consolidated;
 
         OwnerPtr< Model<wxString> > m_model;
 
     public:
+        LEAK_CHECK();
 
         /**
           * Constructs a string with the given model
@@ -157,17 +68,17 @@ namespace AriaMaestosa
 
         virtual ~wxGLString();
 
-        /** call just before render() - binds the OpenGL. If you render the same string many
-         times, or render from an array, bind only once, this will improve performance */
+        /** call just before render() - binds the glyph atlas of this string's font. Strings that
+         use the same font share the same texture, so rendering many of them needs a single bind */
         void bind();
 
         /** set how to draw string for next consolidate() - has no immediate effect,
          you need to call consolidate() to get results  */
         void setFont(wxFont font);
 
-        /** consolidates the current string info into a GL string. call this after
+        /** consolidates the current string info (layout and size) for rendering. call this after
          setting up strings, font and color (if necessary), and before rendering.
-         The wxDC argument is only used to calculate text extents and will not be rendered on. */
+         Glyphs are measured by their atlas, the wxDC argument is only kept for compatibility. */
         virtual void consolidate(wxDC* dc);
 
         Model<wxString>*       getModel()       { return m_model; }
@@ -178,6 +89,11 @@ namespace AriaMaestosa
         /** render this string at coordinates (x,y). Must be called after bind(). */
         void render(const int x, const int y);
 
+        /** returns the width of this element */
+        int getWidth() const { return m_w; }
+        /** returns the height of this element */
+        int getHeight() const { return m_h; }
+
         virtual void onModelChanged(wxString newval) { m_consolidated = false; }
     };
 
@@ -201,25 +117,26 @@ namespace AriaMaestosa
 
      @ingroup renderers
      */
-    class wxGLNumberRenderer : public wxGLString
+    class wxGLNumberRenderer
     {
-        int* number_location;
-        int space_w;
+        wxFont m_font;
+        GlyphAtlas* m_atlas;
     public:
+        LEAK_CHECK();
+
         wxGLNumberRenderer();
         virtual ~wxGLNumberRenderer();
 
         /** inits the class to be ready to render.
-         The wxDC argument is only used to calculate text extents and will not be rendered on. */
+         The wxDC argument is only kept for compatibility. */
         void consolidate(wxDC* dc);
 
+        /** call just before renderNumber() - binds the glyph atlas of the number font */
+        void bind();
+
         /** render this number at coordinates (x,y), where wxString s contains the string
          representation of a number. Must be called after bind(). */
         void renderNumber(const char* s, int x, int y);
-        /** render this number at coordinates (x,y). Must be called after bind(). */
-        //void renderNumber(int i, int x, int y);
-        /** render this number at coordinates (x,y). Must be called after bind(). */
-        //void renderNumber(float f, int x, int y);
     };
 
     typedef wxGLNumberRenderer AriaRenderNumber;
@@ -227,8 +144,8 @@ namespace AriaMaestosa
     /**
      @brief OpenGL render backend : text array renderer
 
-     This class is useful to render a serie of strings that are usually rendered at the same time.
-     It behaves exactly like wxGLString but is more efficient.
+     This class is useful to render a serie of strings that are usually rendered at the same time,
+     in the same font.
 
 
      Use example :
@@ -254,7 +171,6 @@ namespace AriaMaestosa
     class wxGLStringArray
     {
         ptr_vector<wxGLString, HOLD> strings;
-        OwnerPtr<TextTexture> img;
         wxFont m_font;
         bool consolidated;
     public:
@@ -284,9 +200,8 @@ namespace AriaMaestosa
          you need to call consolidate() to get results  */
         void setFont(wxFont font);
 
-        /** consolidates the current string info into a GL string. call this after
-         setting up strings, font and color (if necessary), and before rendering.
-         The wxDC argument is only used to calculate text extents and will not be rendered on.  */
+        /** consolidates all strings for rendering. call this after setting up strings,
+         font and color (if necessary), and before rendering.  */
         void consolidate(wxDC* dc);
 
         LEAK_CHECK();
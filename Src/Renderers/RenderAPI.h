@@ -32,6 +32,8 @@ class wxString;
 
 namespace AriaMaestosa
 {
+    class RenderLayer;
+
     /**
       * @brief   holds the rendering functions of Aria
       * @ingroup renderers
@@ -175,6 +177,33 @@ namespace AriaMaestosa
                   const int x2, const int y2,
                   const int x3, const int y3,
                   const int x4, const int y4);
+
+        /**
+         * @brief number of primitives, images and texts drawn since the last call to resetPrimitiveCount
+         * @note  what exactly counts as one depends on the renderer; this is meant to compare frames
+         */
+        int getPrimitiveCount();
+        
+        /** @brief see getPrimitiveCount */
+        void resetPrimitiveCount();
+
+        /**
+         * @brief start drawing into a layer covering the given area, instead of the frame
+         * @return false if the renderer doesn't support layers; drawing then goes to the frame and
+         *         endLayer must not be called
+         */
+        bool beginLayer(RenderLayer& layer, const int x, const int y, const int width, const int height);
+
+        /**
+         * @brief stop drawing into the layer started with beginLayer, and draw the layer on the frame
+         */
+        void endLayer(RenderLayer& layer);
+
+        /**
+         * @brief draw again a layer rendered in a previous frame
+         * @return false if the layer could not be drawn; it must then be rendered again
+         */
+        bool drawLayer(RenderLayer& layer);
     }
 }
 #endif
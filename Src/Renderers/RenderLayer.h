@@ -0,0 +1,74 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __RENDER_LAYER_H__
+#define __RENDER_LAYER_H__
+
+#include "Utils.h"
+
+#ifdef RENDERER_SOFTWARE
+#include "Renderers/SoftwareRasterizer.h"
+#elif defined(RENDERER_WXWIDGETS)
+#include <wx/bitmap.h>
+class wxDC;
+class wxMemoryDC;
+#endif
+
+namespace AriaMaestosa
+{
+
+    /**
+      * @brief a rendered area of the frame that can be drawn again in later frames without redoing the
+      *        drawing calls (see AriaRender::beginLayer)
+      *
+      * What a layer holds depends on the render backend : a bitmap with the wxWidgets renderer, the
+      * recorded drawing commands with the software renderer. The OpenGL renderer does not support layers.
+      *
+      * @ingroup renderers
+      */
+    class RenderLayer
+    {
+    public:
+        LEAK_CHECK();
+
+        /** whether the layer holds a rendering */
+        bool m_valid;
+
+        /** area of the frame covered by the layer */
+        int m_x, m_y, m_width, m_height;
+
+#ifdef RENDERER_SOFTWARE
+        SoftwareRasterizer::Recording m_recording;
+#elif defined(RENDERER_WXWIDGETS)
+        wxBitmap m_bitmap;
+
+        /** only set while drawing into the layer */
+        OwnerPtr<wxMemoryDC> m_dc;
+        wxDC* m_previous_dc;
+#endif
+
+        RenderLayer();
+        ~RenderLayer();
+
+        bool isValid() const { return m_valid; }
+
+        /** @brief forget the rendering (it will not be drawn by AriaRender::drawLayer until rendered again) */
+        void invalidate() { m_valid = false; }
+    };
+
+}
+
+#endif
@@ -0,0 +1,671 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef RENDERER_SOFTWARE
+
+#include "Renderers/SoftwareRasterizer.h"
+
+#include <wx/dc.h>
+#include <wx/image.h>
+#include <wx/rawbmp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace AriaMaestosa;
+
+namespace AriaMaestosa
+{
+    /** At most this many threads rasterize a frame, the GUI thread included */
+    const int MAX_RENDER_THREADS = 8;
+
+    /** Textures not used for this many frames are released */
+    const int TEXTURE_KEEP_FRAMES = 120;
+
+    const uint32_t OPAQUE_BLACK = 0xFF000000;
+
+    SoftwareRasterizer* g_current_rasterizer = NULL;
+
+    static inline uint32_t premultiply(const unsigned char r, const unsigned char g, const unsigned char b,
+                                       const unsigned char a)
+    {
+        return ((uint32_t)a << 24) | ((uint32_t)((r*a + 127)/255) << 16) |
+               ((uint32_t)((g*a + 127)/255) << 8) | (uint32_t)((b*a + 127)/255);
+    }
+
+    /**
+      * @brief 'src over dst' for one premultiplied pixel. Destination components are scaled by
+      *        (256 - alpha) / 256, which is exact for alpha 0 and 255, and the same as the SSE2 code does
+      */
+    static inline uint32_t blendPixel(const uint32_t dst, const uint32_t src)
+    {
+        const uint32_t ia = 256 - (src >> 24);
+        const uint32_t rb = (((dst & 0x00FF00FF) * ia) >> 8) & 0x00FF00FF;
+        const uint32_t ag = (((dst >> 8) & 0x00FF00FF) * ia) & 0xFF00FF00;
+        return src + (rb | ag);
+    }
+
+    /** @brief fill 'count' pixels with a premultiplied colour */
+    static void fillSpan(uint32_t* dst, const int count, const uint32_t colour)
+    {
+        const uint32_t alpha = colour >> 24;
+        if (alpha == 255)
+        {
+            std::fill(dst, dst + count, colour);
+            return;
+        }
+        if (alpha == 0) return;
+
+        int n = 0;
+
+#ifdef __SSE2__
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i src  = _mm_set1_epi32(colour);
+        const __m128i ia   = _mm_set1_epi16(256 - alpha);
+        for (; n + 4 <= count; n += 4)
+        {
+            __m128i d  = _mm_loadu_si128((const __m128i*)(dst + n));
+            __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), ia), 8);
+            __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), ia), 8);
+            _mm_storeu_si128((__m128i*)(dst + n), _mm_add_epi8(_mm_packus_epi16(lo, hi), src));
+        }
+#endif
+
+        for (; n < count; n++) dst[n] = blendPixel(dst[n], colour);
+    }
+
+    /** @brief draw 'count' premultiplied pixels over the destination */
+    static void blendSpan(uint32_t* dst, const uint32_t* src, const int count)
+    {
+        int n = 0;
+
+#ifdef __SSE2__
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i full = _mm_set1_epi16(256);
+        for (; n + 4 <= count; n += 4)
+        {
+            const __m128i s = _mm_loadu_si128((const __m128i*)(src + n));
+            const __m128i d = _mm_loadu_si128((const __m128i*)(dst + n));
+
+            // broadcast the alpha of each pixel to its 4 components
+            __m128i alo = _mm_unpacklo_epi8(s, zero);
+            __m128i ahi = _mm_unpackhi_epi8(s, zero);
+            alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(alo, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+            ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(ahi, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+
+            __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(full, alo));
+            __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(full, ahi));
+            lo = _mm_srli_epi16(lo, 8);
+            hi = _mm_srli_epi16(hi, 8);
+            _mm_storeu_si128((__m128i*)(dst + n), _mm_add_epi8(_mm_packus_epi16(lo, hi), s));
+        }
+#endif
+
+        for (; n < count; n++)
+        {
+            const uint32_t alpha = src[n] >> 24;
+            if      (alpha == 255) dst[n] = src[n];
+            else if (alpha != 0)   dst[n] = blendPixel(dst[n], src[n]);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+SoftwareRasterizer::Rect SoftwareRasterizer::Rect::intersect(const Rect& other) const
+{
+    return Rect(std::max(x1, other.x1), std::max(y1, other.y1), std::min(x2, other.x2), std::min(y2, other.y2));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------------------------
+#if 0
+#pragma mark -
+#pragma mark Frame
+#endif
+
+SoftwareRasterizer::SoftwareRasterizer()
+{
+    m_width        = 0;
+    m_height       = 0;
+    m_tiles_x      = 0;
+    m_tiles_y      = 0;
+    m_clipping     = false;
+    m_frame        = 0;
+    m_texture_epoch = 0;
+    m_job          = 0;
+    m_busy_workers = 0;
+    m_quit         = false;
+    m_next_tile    = 0;
+
+    // the GUI thread renders tiles too, so start one less worker than there are threads
+    const int threads = std::min((int)std::thread::hardware_concurrency(), MAX_RENDER_THREADS);
+    for (int n=1; n<threads; n++)
+    {
+        m_workers.push_back( std::thread(&SoftwareRasterizer::workerLoop, this) );
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+
+    for (unsigned int n=0; n<m_workers.size(); n++) m_workers[n].join();
+
+    if (g_current_rasterizer == this) g_current_rasterizer = NULL;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+SoftwareRasterizer* SoftwareRasterizer::getCurrent()
+{
+    return g_current_rasterizer;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::beginFrame(const int width, const int height)
+{
+    m_width  = std::max(width,  0);
+    m_height = std::max(height, 0);
+    m_pixels.resize(m_width * m_height);
+
+    m_commands.clear();
+    m_points.clear();
+    m_clipping = false;
+    m_clip = Rect(0, 0, m_width, m_height);
+    m_frame++;
+
+    m_tiles_x = (m_width  + TILE_SIZE - 1) / TILE_SIZE;
+    m_tiles_y = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+    m_bins.resize(m_tiles_x * m_tiles_y);
+    for (unsigned int n=0; n<m_bins.size(); n++) m_bins[n].clear();
+
+    g_current_rasterizer = this;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::endFrame(wxDC* dc)
+{
+    g_current_rasterizer = NULL;
+    if (m_width == 0 or m_height == 0) return;
+
+    // sort commands into the tiles they touch
+    const int commandCount = m_commands.size();
+    for (int c=0; c<commandCount; c++)
+    {
+        const Rect& bounds = m_commands[c].m_bounds;
+        const int lastX = (bounds.x2 - 1) / TILE_SIZE;
+        const int lastY = (bounds.y2 - 1) / TILE_SIZE;
+        for (int ty = bounds.y1 / TILE_SIZE; ty <= lastY; ty++)
+        {
+            for (int tx = bounds.x1 / TILE_SIZE; tx <= lastX; tx++)
+            {
+                m_bins[ty * m_tiles_x + tx].push_back(c);
+            }
+        }
+    }
+
+    // rasterize on all threads
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_next_tile = 0;
+        m_busy_workers = m_workers.size();
+        m_job++;
+    }
+    m_wake.notify_all();
+
+    renderTiles();
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_busy_workers > 0) m_done.wait(lock);
+    }
+
+    // convert for the screen, and draw the whole frame at once
+    if (not m_output.IsOk() or m_output.GetWidth() != m_width or m_output.GetHeight() != m_height)
+    {
+        m_output = wxBitmap(m_width, m_height, 24);
+    }
+
+    {
+        wxNativePixelData data(m_output);
+        if (data)
+        {
+            wxNativePixelData::Iterator row(data);
+            for (int y=0; y<m_height; y++)
+            {
+                wxNativePixelData::Iterator p = row;
+                const uint32_t* src = &m_pixels[y * m_width];
+                for (int x=0; x<m_width; x++, ++p)
+                {
+                    p.Red()   = (src[x] >> 16) & 0xFF;
+                    p.Green() = (src[x] >> 8)  & 0xFF;
+                    p.Blue()  =  src[x]        & 0xFF;
+                }
+                row.OffsetY(data, 1);
+            }
+        }
+    }
+
+    dc->DrawBitmap(m_output, 0, 0, false);
+
+    // forget images that are not displayed anymore
+    std::map<const void*, Texture>::iterator it = m_textures.begin();
+    while (it != m_textures.end())
+    {
+        if (m_frame - it->second.m_last_frame > TEXTURE_KEEP_FRAMES)
+        {
+            m_textures.erase(it++);
+            m_texture_epoch++;
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::setClip(const Rect& rect, const bool enabled)
+{
+    m_clipping = enabled;
+    m_clip = (enabled ? rect.intersect(Rect(0, 0, m_width, m_height)) : Rect(0, 0, m_width, m_height));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------------------------
+#if 0
+#pragma mark -
+#pragma mark Recording
+#endif
+
+SoftwareRasterizer::Rect SoftwareRasterizer::getVisibleArea(const Rect& bounds) const
+{
+    return bounds.intersect(m_clip);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::addCommand(Command& command)
+{
+    command.m_bounds = getVisibleArea(command.m_bounds);
+    if (command.m_bounds.isEmpty()) return;
+    m_commands.push_back(command);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::fillRect(const Rect& rect, const unsigned char r, const unsigned char g,
+                                  const unsigned char b, const unsigned char a)
+{
+    if (a == 0) return;
+
+    Command command;
+    command.m_type   = COMMAND_FILL;
+    command.m_bounds = Rect(std::min(rect.x1, rect.x2), std::min(rect.y1, rect.y2),
+                            std::max(rect.x1, rect.x2), std::max(rect.y1, rect.y2));
+    command.m_colour = premultiply(r, g, b, a);
+    addCommand(command);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::fillPolygon(const int* xy, const int count, const unsigned char r,
+                                     const unsigned char g, const unsigned char b, const unsigned char a)
+{
+    if (a == 0 or count < 3) return;
+
+    Command command;
+    command.m_type        = COMMAND_POLYGON;
+    command.m_colour      = premultiply(r, g, b, a);
+    command.m_first_point = m_points.size();
+    command.m_point_count = count;
+
+    int minX = xy[0], maxX = xy[0], minY = xy[1], maxY = xy[1];
+    for (int n=0; n<count; n++)
+    {
+        minX = std::min(minX, xy[n*2]);
+        maxX = std::max(maxX, xy[n*2]);
+        minY = std::min(minY, xy[n*2 + 1]);
+        maxY = std::max(maxY, xy[n*2 + 1]);
+    }
+    command.m_bounds = Rect(minX, minY, maxX + 1, maxY + 1);
+
+    m_points.insert(m_points.end(), xy, xy + count*2);
+    addCommand(command);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::line(const int x1, const int y1, const int x2, const int y2, const int width,
+                              const unsigned char r, const unsigned char g, const unsigned char b,
+                              const unsigned char a)
+{
+    if (a == 0 or width < 1) return;
+
+    // horizontal and vertical lines, by far the most common, are rectangles
+    const int before = width / 2;
+    if (y1 == y2)
+    {
+        fillRect(Rect(std::min(x1, x2), y1 - before, std::max(x1, x2), y1 - before + width), r, g, b, a);
+        return;
+    }
+    if (x1 == x2)
+    {
+        fillRect(Rect(x1 - before, std::min(y1, y2), x1 - before + width, std::max(y1, y2)), r, g, b, a);
+        return;
+    }
+
+    Command command;
+    command.m_type        = COMMAND_LINE;
+    command.m_colour      = premultiply(r, g, b, a);
+    command.m_first_point = m_points.size();
+    command.m_point_count = 2;
+    command.m_width       = width;
+    command.m_bounds      = Rect(std::min(x1, x2) - width, std::min(y1, y2) - width,
+                                 std::max(x1, x2) + width + 1, std::max(y1, y2) + width + 1);
+
+    m_points.push_back(x1);
+    m_points.push_back(y1);
+    m_points.push_back(x2);
+    m_points.push_back(y2);
+    addCommand(command);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const SoftwareRasterizer::Texture* SoftwareRasterizer::getTexture(const wxBitmap& bitmap)
+{
+    const void* key = bitmap.GetRefData();
+
+    std::map<const void*, Texture>::iterator it = m_textures.find(key);
+    if (it != m_textures.end())
+    {
+        it->second.m_last_frame = m_frame;
+        return &it->second;
+    }
+
+    Texture& texture = m_textures[key];
+    texture.m_source     = bitmap;
+    texture.m_width      = bitmap.GetWidth();
+    texture.m_height     = bitmap.GetHeight();
+    texture.m_last_frame = m_frame;
+    texture.m_pixels.resize(texture.m_width * texture.m_height);
+
+    const wxImage image = bitmap.ConvertToImage();
+    const unsigned char* rgb   = image.GetData();
+    const unsigned char* alpha = (image.HasAlpha() ? image.GetAlpha() : NULL);
+    const bool hasMask = image.HasMask();
+    const unsigned char maskR = image.GetMaskRed(), maskG = image.GetMaskGreen(), maskB = image.GetMaskBlue();
+
+    const int count = texture.m_width * texture.m_height;
+    for (int n=0; n<count; n++)
+    {
+        const unsigned char r = rgb[n*3], g = rgb[n*3 + 1], b = rgb[n*3 + 2];
+        unsigned char a = (alpha == NULL ? 255 : alpha[n]);
+        if (hasMask and r == maskR and g == maskG and b == maskB) a = 0;
+        texture.m_pixels[n] = premultiply(r, g, b, a);
+    }
+
+    return &texture;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::blit(const wxBitmap& bitmap, const int x, const int y)
+{
+    if (not bitmap.IsOk()) return;
+
+    Command command;
+    command.m_type    = COMMAND_BLIT;
+    command.m_bounds  = Rect(x, y, x + bitmap.GetWidth(), y + bitmap.GetHeight());
+    command.m_x       = x;
+    command.m_y       = y;
+    command.m_texture = NULL;
+
+    // don't convert images that are entirely clipped out
+    if (getVisibleArea(command.m_bounds).isEmpty()) return;
+
+    command.m_texture = getTexture(bitmap);
+    addCommand(command);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::beginRecording(Recording& recording)
+{
+    recording.m_first_command = m_commands.size();
+    recording.m_first_point   = m_points.size();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::endRecording(Recording& recording)
+{
+    ASSERT(recording.m_first_command >= 0);
+
+    recording.m_commands.assign(m_commands.begin() + recording.m_first_command, m_commands.end());
+    recording.m_points.assign(m_points.begin() + recording.m_first_point, m_points.end());
+
+    // make point indices relative to the recording
+    const int commandCount = recording.m_commands.size();
+    for (int n=0; n<commandCount; n++)
+    {
+        Command& command = recording.m_commands[n];
+        if (command.m_type == COMMAND_POLYGON or command.m_type == COMMAND_LINE)
+        {
+            command.m_first_point -= recording.m_first_point;
+        }
+    }
+
+    recording.m_texture_epoch = m_texture_epoch;
+    recording.m_first_command = -1;
+    recording.m_first_point   = -1;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool SoftwareRasterizer::replay(const Recording& recording, const Rect& area)
+{
+    if (recording.m_texture_epoch != m_texture_epoch) return false;
+
+    const int firstPoint = m_points.size();
+    m_points.insert(m_points.end(), recording.m_points.begin(), recording.m_points.end());
+
+    const int commandCount = recording.m_commands.size();
+    for (int n=0; n<commandCount; n++)
+    {
+        Command command = recording.m_commands[n];
+        command.m_bounds = command.m_bounds.intersect(area);
+        if (command.m_type == COMMAND_POLYGON or command.m_type == COMMAND_LINE)
+        {
+            command.m_first_point += firstPoint;
+        }
+        else if (command.m_type == COMMAND_BLIT)
+        {
+            command.m_texture->m_last_frame = m_frame;
+        }
+        addCommand(command);
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------------------------
+#if 0
+#pragma mark -
+#pragma mark Rasterization
+#endif
+
+void SoftwareRasterizer::workerLoop()
+{
+    int lastJob = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (not m_quit and m_job == lastJob) m_wake.wait(lock);
+            if (m_quit) return;
+            lastJob = m_job;
+        }
+
+        renderTiles();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy_workers--;
+        }
+        m_done.notify_one();
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::renderTiles()
+{
+    const int tileCount = m_tiles_x * m_tiles_y;
+    int tile;
+    while ((tile = m_next_tile++) < tileCount)
+    {
+        renderTile(tile);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::renderTile(const int tile)
+{
+    const int tileX = (tile % m_tiles_x) * TILE_SIZE;
+    const int tileY = (tile / m_tiles_x) * TILE_SIZE;
+    const Rect area(tileX, tileY, std::min(tileX + TILE_SIZE, m_width), std::min(tileY + TILE_SIZE, m_height));
+
+    for (int y=area.y1; y<area.y2; y++)
+    {
+        std::fill(&m_pixels[y*m_width + area.x1], &m_pixels[y*m_width] + area.x2, OPAQUE_BLACK);
+    }
+
+    const std::vector<int>& bin = m_bins[tile];
+    const int count = bin.size();
+    for (int c=0; c<count; c++)
+    {
+        const Command& command = m_commands[bin[c]];
+        const Rect r = command.m_bounds.intersect(area);
+        if (r.isEmpty()) continue;
+
+        switch (command.m_type)
+        {
+            case COMMAND_FILL:
+            {
+                for (int y=r.y1; y<r.y2; y++)
+                {
+                    fillSpan(&m_pixels[y*m_width + r.x1], r.x2 - r.x1, command.m_colour);
+                }
+                break;
+            }
+
+            case COMMAND_POLYGON:
+            {
+                // convex polygon : on each row, the covered pixels are between the leftmost and the
+                // rightmost edge crossing (sampled at pixel centers)
+                const int* xy = &m_points[command.m_first_point];
+                const int n = command.m_point_count;
+                for (int y=r.y1; y<r.y2; y++)
+                {
+                    const double center = y + 0.5;
+                    double left = r.x2, right = r.x1;
+                    bool crossed = false;
+                    for (int e=0; e<n; e++)
+                    {
+                        const int ax = xy[e*2], ay = xy[e*2 + 1];
+                        const int bx = xy[((e + 1) % n)*2], by = xy[((e + 1) % n)*2 + 1];
+                        if (ay == by) continue;
+                        if (center < std::min(ay, by) or center >= std::max(ay, by)) continue;
+
+                        const double x = ax + (center - ay) * (bx - ax) / (double)(by - ay);
+                        left  = (crossed ? std::min(left,  x) : x);
+                        right = (crossed ? std::max(right, x) : x);
+                        crossed = true;
+                    }
+                    if (not crossed) continue;
+
+                    const int from = std::max(r.x1, (int)ceil(left  - 0.5));
+                    const int to   = std::min(r.x2, (int)ceil(right - 0.5));
+                    if (to > from) fillSpan(&m_pixels[y*m_width + from], to - from, command.m_colour);
+                }
+                break;
+            }
+
+            case COMMAND_LINE:
+            {
+                // step along the major axis, and draw 'width' pixels across it at each step
+                const int* xy = &m_points[command.m_first_point];
+                const int dx = xy[2] - xy[0], dy = xy[3] - xy[1];
+                const bool horizontal = (abs(dx) >= abs(dy));
+                const int steps = (horizontal ? abs(dx) : abs(dy));
+                const int before = command.m_width / 2;
+
+                for (int i=0; i<steps; i++)
+                {
+                    const int x = xy[0] + (int)floor((double)i * dx / steps + 0.5);
+                    const int y = xy[1] + (int)floor((double)i * dy / steps + 0.5);
+
+                    Rect dot = (horizontal ? Rect(x, y - before, x + 1, y - before + command.m_width)
+                                           : Rect(x - before, y, x - before + command.m_width, y + 1));
+                    dot = dot.intersect(r);
+                    for (int py=dot.y1; py<dot.y2; py++)
+                    {
+                        for (int px=dot.x1; px<dot.x2; px++)
+                        {
+                            uint32_t& pixel = m_pixels[py*m_width + px];
+                            pixel = blendPixel(pixel, command.m_colour);
+                        }
+                    }
+                }
+                break;
+            }
+
+            case COMMAND_BLIT:
+            {
+                const Texture* texture = command.m_texture;
+                for (int y=r.y1; y<r.y2; y++)
+                {
+                    const uint32_t* src = &texture->m_pixels[(y - command.m_y)*texture->m_width +
+                                                              (r.x1 - command.m_x)];
+                    blendSpan(&m_pixels[y*m_width + r.x1], src, r.x2 - r.x1);
+                }
+                break;
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef RENDERER_SOFTWARE
+#ifndef __SOFTWARE_RASTERIZER_H__
+#define __SOFTWARE_RASTERIZER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include <wx/bitmap.h>
+
+#include "Utils.h"
+
+class wxDC;
+
+namespace AriaMaestosa
+{
+
+    /**
+      * @brief Software render backend : rasterizes a frame into a framebuffer in memory
+      *
+      * Drawing calls made between beginFrame and endFrame are only recorded. At the end of the frame, the
+      * framebuffer is split into tiles, each tile replays the commands that touch it (so a tile is only
+      * written by one thread) and the tiles are rendered by a pool of worker threads. The framebuffer is
+      * then blitted to the window in one call.
+      *
+      * Pixels are stored as premultiplied 0xAARRGGBB; spans are filled and blended 4 pixels at a time
+      * with SSE2 when it is available.
+      *
+      * @ingroup renderers
+      */
+    class SoftwareRasterizer
+    {
+    public:
+
+        /** A rectangle of pixels, the right and bottom edges excluded */
+        struct Rect
+        {
+            int x1, y1, x2, y2;
+
+            Rect() { x1 = y1 = x2 = y2 = 0; }
+            Rect(int x1_arg, int y1_arg, int x2_arg, int y2_arg)
+            {
+                x1 = x1_arg; y1 = y1_arg; x2 = x2_arg; y2 = y2_arg;
+            }
+
+            bool isEmpty() const { return x2 <= x1 or y2 <= y1; }
+            Rect intersect(const Rect& other) const;
+        };
+
+    private:
+
+        /** A bitmap converted to premultiplied pixels, kept as long as it's used */
+        struct Texture
+        {
+            /** keeps the bitmap data alive, so that its address stays a unique key */
+            wxBitmap m_source;
+
+            std::vector<uint32_t> m_pixels;
+            int m_width, m_height;
+
+            /** updated when a recording that uses the texture is replayed */
+            mutable int m_last_frame;
+        };
+
+        enum CommandType
+        {
+            COMMAND_FILL,
+            COMMAND_POLYGON,
+            COMMAND_LINE,
+            COMMAND_BLIT
+        };
+
+        struct Command
+        {
+            CommandType m_type;
+
+            /** area touched by the command, already clipped to the frame and scissors */
+            Rect m_bounds;
+
+            /** premultiplied colour, for all types but COMMAND_BLIT */
+            uint32_t m_colour;
+
+            /** COMMAND_POLYGON and COMMAND_LINE : first coordinate in m_points, and number of points */
+            int m_first_point;
+            int m_point_count;
+
+            /** COMMAND_LINE : width of the line */
+            int m_width;
+
+            /** COMMAND_BLIT : the image, and where its top-left corner goes */
+            const Texture* m_texture;
+            int m_x, m_y;
+        };
+
+    public:
+
+        /**
+          * @brief drawing commands recorded in a frame, that can be replayed in later frames (see
+          *        beginRecording)
+          */
+        class Recording
+        {
+            friend class SoftwareRasterizer;
+
+            std::vector<Command> m_commands;
+            std::vector<int> m_points;
+
+            /** the textures the commands point to are only valid as long as this matches the rasterizer */
+            int m_texture_epoch;
+
+            /** where the recording started in the frame, while recording */
+            int m_first_command, m_first_point;
+
+        public:
+            Recording()
+            {
+                m_texture_epoch = -1;
+                m_first_command = -1;
+                m_first_point   = -1;
+            }
+        };
+
+    private:
+
+        int m_width, m_height;
+        std::vector<uint32_t> m_pixels;
+
+        std::vector<Command> m_commands;
+        std::vector<int> m_points;
+
+        /** for each tile, the indices of the commands that touch it, in drawing order */
+        std::vector< std::vector<int> > m_bins;
+        int m_tiles_x, m_tiles_y;
+
+        Rect m_clip;
+        bool m_clipping;
+
+        std::map<const void*, Texture> m_textures;
+        int m_frame;
+
+        /** incremented whenever a texture is forgotten, which invalidates recordings */
+        int m_texture_epoch;
+
+        /** the framebuffer, converted for the screen */
+        wxBitmap m_output;
+
+        // ---- worker threads
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        int m_job;
+        int m_busy_workers;
+        bool m_quit;
+        std::atomic<int> m_next_tile;
+
+        void workerLoop();
+        void renderTiles();
+        void renderTile(const int tile);
+
+        Rect getVisibleArea(const Rect& bounds) const;
+        void addCommand(Command& command);
+        const Texture* getTexture(const wxBitmap& bitmap);
+
+    public:
+        LEAK_CHECK();
+
+        /** Width and height of the tiles the frame is split in */
+        static const int TILE_SIZE = 64;
+
+        SoftwareRasterizer();
+        ~SoftwareRasterizer();
+
+        /** @return the rasterizer of the frame being drawn, NULL outside of beginFrame/endFrame */
+        static SoftwareRasterizer* getCurrent();
+
+        /** @brief start recording a frame of the given size; the frame starts black */
+        void beginFrame(const int width, const int height);
+
+        /** @brief rasterize the recorded frame and draw it on the given DC */
+        void endFrame(wxDC* dc);
+
+        /** @brief limit subsequent drawing to a rectangle, or stop clipping if 'enabled' is false */
+        void setClip(const Rect& rect, const bool enabled);
+
+        // ---- drawing. colours are 8 bits per component, not premultiplied
+
+        /** @brief fill the given rectangle */
+        void fillRect(const Rect& rect, const unsigned char r, const unsigned char g, const unsigned char b,
+                      const unsigned char a);
+
+        /** @brief fill a convex polygon, given as 'count' pairs of coordinates */
+        void fillPolygon(const int* xy, const int count, const unsigned char r, const unsigned char g,
+                         const unsigned char b, const unsigned char a);
+
+        /** @brief draw a line, the end point excluded */
+        void line(const int x1, const int y1, const int x2, const int y2, const int width,
+                  const unsigned char r, const unsigned char g, const unsigned char b, const unsigned char a);
+
+        /** @brief draw a bitmap, using its alpha channel or mask */
+        void blit(const wxBitmap& bitmap, const int x, const int y);
+
+        // ---- recordings
+
+        /** @brief start keeping a copy of the commands drawn from now on in the given recording */
+        void beginRecording(Recording& recording);
+
+        /** @brief stop recording; the commands drawn since beginRecording are part of the frame too */
+        void endRecording(Recording& recording);
+
+        /**
+          * @brief draw again the commands of a recording made in a previous frame, clipped to 'area' and
+          *        to the current scissors
+          * @return false if the recording can't be used anymore (the images it draws were forgotten)
+          */
+        bool replay(const Recording& recording, const Rect& area);
+    };
+
+}
+
+#endif
+#endif
@@ -0,0 +1,331 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef RENDERER_SOFTWARE
+
+#include "Utils.h"
+#include "AriaCore.h"
+#include <wx/wx.h>
+
+#include "PreferencesData.h"
+#include "Renderers/RenderAPI.h"
+#include "Renderers/Drawable.h"
+#include "Renderers/RenderLayer.h"
+#include "Renderers/SoftwareRasterizer.h"
+#include "Renderers/wxTextCache.h"
+
+#include <cmath>
+#include <cstdio>
+
+/** Number of straight segments used to draw arcs */
+const int ARC_SEGMENTS = 16;
+
+namespace AriaMaestosa
+{
+namespace AriaRender
+{
+
+    bool mode_primitives = false, mode_images = false;
+
+static inline SoftwareRasterizer* raster()
+{
+    SoftwareRasterizer* rasterizer = SoftwareRasterizer::getCurrent();
+    ASSERT(rasterizer != NULL);
+    return rasterizer;
+}
+
+void primitives()
+{
+    mode_primitives = true;
+    mode_images = false;
+}
+
+ImageState current_state = STATE_NORMAL;
+void images()
+{
+    mode_primitives = false;
+    mode_images = true;
+    current_state = STATE_NORMAL;
+}
+
+unsigned char rc = 255;
+unsigned char gc = 255;
+unsigned char bc = 255;
+unsigned char ac = 255;
+int lineWidth_i = 1;
+int pointSize_i = 1;
+
+int primitive_count = 0;
+
+void renderNumber(const int number, const int x, const int y)
+{
+    char digits[16];
+    snprintf(digits, sizeof(digits), "%i", number);
+    renderNumber(digits, x, y);
+}
+
+
+void renderNumber(const float number, const int x, const int y)
+{
+    char digits[32];
+    snprintf(digits, sizeof(digits), "%f", number);
+    renderNumber(digits, x, y);
+}
+
+void renderNumber(const char* number, const int x, const int y)
+{
+    static const wxFont numberFont = getNumberFont();
+    wxTextCache::getInstance()->renderNumber(number, numberFont, x, y);
+}
+
+void renderString(const wxString& string, const int x, const int y, const int maxWidth)
+{
+    static const wxFont noteNamesFont = getNoteNamesFont();
+    wxTextCache::getInstance()->renderString(string, noteNamesFont, x, y, maxWidth);
+}
+
+void drawBitmap(const wxBitmap& bitmap, const int x, const int y)
+{
+    primitive_count++;
+    raster()->blit(bitmap, x, y);
+}
+
+void drawText(const wxString& text, const int x, const int y)
+{
+    primitive_count++;
+    // the text is rasterized with the DC, then handled like any other bitmap
+    wxTextCache::getInstance()->drawText(text, Display::renderDC->GetFont(), x, y);
+}
+
+void setImageState(const ImageState imgst)
+{
+    current_state = imgst;
+    drawable_set_state(current_state);
+}
+
+void color(const float r, const float g, const float b)
+{
+    rc = (unsigned char)(r*255);
+    gc = (unsigned char)(g*255);
+    bc = (unsigned char)(b*255);
+
+    if (mode_primitives) ac = 255;
+    else                 Display::renderDC->SetTextForeground( wxColour(rc, gc, bc) );
+}
+
+void color(const float r, const float g, const float b, const float a)
+{
+    rc = (unsigned char)(r*255);
+    gc = (unsigned char)(g*255);
+    bc = (unsigned char)(b*255);
+    ac = (unsigned char)(a*255);
+
+    if (not mode_primitives) Display::renderDC->SetTextForeground( wxColour(rc, gc, bc) );
+}
+
+void line(const int x1, const int y1, const int x2, const int y2)
+{
+    primitive_count++;
+    raster()->line(x1, y1, x2, y2, lineWidth_i, rc, gc, bc, ac);
+}
+
+void lineWidth(const int n)
+{
+    lineWidth_i = n;
+}
+
+void lineSmooth(const bool enabled)
+{
+}
+
+void point(const int x, const int y)
+{
+    primitive_count++;
+    const int from = pointSize_i/2;
+    raster()->fillRect( SoftwareRasterizer::Rect(x - from, y - from, x - from + pointSize_i, y - from + pointSize_i),
+                        rc, gc, bc, ac );
+}
+
+void pointSize(const int n)
+{
+    pointSize_i = n;
+}
+
+void rect(const int x1, const int y1, const int x2, const int y2)
+{
+    primitive_count++;
+    raster()->fillRect( SoftwareRasterizer::Rect(x1, y1, x2, y2), rc, gc, bc, ac );
+}
+
+void bordered_rect_no_start(const int x1, const int y1, const int x2, const int y2)
+{
+    primitive_count++;
+    SoftwareRasterizer* r = raster();
+    r->fillRect( SoftwareRasterizer::Rect(x1, y1, x2+1, y2+1), rc, gc, bc, ac );
+
+    // right line
+    r->fillRect( SoftwareRasterizer::Rect(x2+1, y1, x2+2, y2+1), 0, 0, 0, 255 );
+
+    // top line
+    r->fillRect( SoftwareRasterizer::Rect(x1, y1-1, x2+1, y1), 0, 0, 0, 255 );
+
+    // bottom line
+    r->fillRect( SoftwareRasterizer::Rect(x1, y2+1, x2+1, y2+2), 0, 0, 0, 255 );
+}
+
+void bordered_rect(const int x1, const int y1, const int x2, const int y2)
+{
+    primitive_count++;
+    SoftwareRasterizer* r = raster();
+    r->fillRect( SoftwareRasterizer::Rect(x1, y1, x2+1, y2+1), rc, gc, bc, ac );
+
+    r->fillRect( SoftwareRasterizer::Rect(x1,   y1, x1+1, y2+1), 0, 0, 0, 255 );
+    r->fillRect( SoftwareRasterizer::Rect(x2+1, y1, x2+2, y2+1), 0, 0, 0, 255 );
+
+    r->fillRect( SoftwareRasterizer::Rect(x1+1, y1-1, x2+1, y1),   0, 0, 0, 255 );
+    r->fillRect( SoftwareRasterizer::Rect(x1+1, y2+1, x2+1, y2+2), 0, 0, 0, 255 );
+}
+
+/** @brief outline of the rectangle {x1, y1} - {x2, y2} (right and bottom edges excluded) */
+static void outline(const int x1, const int y1, const int x2, const int y2, const int width,
+                    const unsigned char r, const unsigned char g, const unsigned char b, const unsigned char a)
+{
+    SoftwareRasterizer* rasterizer = raster();
+    rasterizer->line(x1,   y1,   x2,   y1,   width, r, g, b, a);
+    rasterizer->line(x1,   y2-1, x2,   y2-1, width, r, g, b, a);
+    rasterizer->line(x1,   y1+1, x1,   y2-1, width, r, g, b, a);
+    rasterizer->line(x2-1, y1+1, x2-1, y2-1, width, r, g, b, a);
+}
+
+void hollow_rect(const int x1, const int y1, const int x2, const int y2)
+{
+    primitive_count++;
+    outline(x1, y1, x2, y2, lineWidth_i, rc, gc, bc, ac);
+}
+
+void select_rect(const int x1, const int y1, const int x2, const int y2)
+{
+    primitive_count++;
+    outline(x1, y1, x2, y2, 1, 0, 0, 0, 255);
+}
+
+void triangle(const int x1, const int y1, const int x2, const int y2, const int x3, const int y3)
+{
+    primitive_count++;
+    const int points[] = { x1, y1, x2, y2, x3, y3 };
+    raster()->fillPolygon(points, 3, rc, gc, bc, ac);
+}
+
+void arc(int center_x, int center_y, int radius_x, int radius_y, bool show_above)
+{
+    primitive_count++;
+    const float sign = (show_above ? -1.0f : 1.0f);
+
+    int last_x = center_x + radius_x;
+    int last_y = center_y;
+    for (int n=1; n<=ARC_SEGMENTS; n++)
+    {
+        const float angle = M_PI * n / ARC_SEGMENTS;
+        const int x = center_x + (int)round(cos(angle) * radius_x);
+        const int y = center_y + (int)round(sign * sin(angle) * radius_y);
+        raster()->line(last_x, last_y, x, y, 1, rc, gc, bc, ac);
+        last_x = x;
+        last_y = y;
+    }
+}
+
+void quad(const int x1, const int y1,
+          const int x2, const int y2,
+          const int x3, const int y3,
+          const int x4, const int y4)
+{
+    primitive_count++;
+    const int points[] = { x1, y1, x2, y2, x3, y3, x4, y4 };
+    raster()->fillPolygon(points, 4, rc, gc, bc, ac);
+}
+
+void beginScissors(const int x, const int y, const int width, const int height)
+{
+    raster()->setClip( SoftwareRasterizer::Rect(x, y, x + width, y + height), true );
+}
+
+void endScissors()
+{
+    raster()->setClip( SoftwareRasterizer::Rect(), false );
+}
+
+// a layer is not a separate image here : the commands drawn in the layer are kept and replayed
+int getPrimitiveCount()
+{
+    return primitive_count;
+}
+
+void resetPrimitiveCount()
+{
+    primitive_count = 0;
+}
+
+bool beginLayer(RenderLayer& layer, const int x, const int y, const int width, const int height)
+{
+    if (width <= 0 or height <= 0) return false;
+
+    layer.m_x      = x;
+    layer.m_y      = y;
+    layer.m_width  = width;
+    layer.m_height = height;
+    layer.m_valid  = false;
+
+    raster()->beginRecording(layer.m_recording);
+    return true;
+}
+
+void endLayer(RenderLayer& layer)
+{
+    raster()->endRecording(layer.m_recording);
+    layer.m_valid = true;
+}
+
+bool drawLayer(RenderLayer& layer)
+{
+    if (not layer.m_valid) return false;
+
+    const SoftwareRasterizer::Rect area(layer.m_x, layer.m_y, layer.m_x + layer.m_width,
+                                        layer.m_y + layer.m_height);
+    if (not raster()->replay(layer.m_recording, area))
+    {
+        layer.m_valid = false;
+        return false;
+    }
+    return true;
+}
+
+}
+
+RenderLayer::RenderLayer()
+{
+    m_valid  = false;
+    m_x      = 0;
+    m_y      = 0;
+    m_width  = 0;
+    m_height = 0;
+}
+
+RenderLayer::~RenderLayer()
+{
+}
+
+}
+#endif
@@ -10,6 +10,7 @@
 #include "AriaCore.h"
 #include "PreferencesData.h"
 #include "Renderers/RenderAPI.h"
+#include "Renderers/Drawable.h"
 
 namespace AriaMaestosa
 {
@@ -105,7 +106,7 @@ namespace AriaMaestosa
                 {
                     shortened = shortened.Truncate(shortened.size()-1);
                 }
-                Display::renderDC->DrawText(shortened, x, y - m_h);
+                AriaRender::drawText(shortened, x, y - m_h);
             }
             else // wrap
             {
@@ -118,14 +119,14 @@ namespace AriaMaestosa
                 while ( tkz.HasMoreTokens() )
                 {
                     wxString token = tkz.GetNextToken();
-                    Display::renderDC->DrawText(token, x, my_y);
+                    AriaRender::drawText(token, x, my_y);
                     my_y += m_h;
                 }
             }
         }
         else
         {
-            Display::renderDC->DrawText(m_model->getValue(), x, y - m_h);
+            AriaRender::drawText(m_model->getValue(), x, y - m_h);
         }
     }
     
@@ -164,7 +165,7 @@ namespace AriaMaestosa
         ASSERT_E(m_h, <, 90000);
 
         Display::renderDC->SetFont( getNumberFont() );
-        Display::renderDC->DrawText(s, x, y - m_h);
+        AriaRender::drawText(s, x, y - m_h);
     }
     
     void wxDCNumberRenderer::renderNumber(int i, int x, int y)
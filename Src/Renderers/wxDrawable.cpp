@@ -103,10 +103,10 @@ void Drawable::render()
                     const int max_x = m_x - hotspotX_mod + new_w - m_image->width;
                     for (int x = m_x - hotspotX_mod; x <= max_x; x += m_image->width)
                     {
-                        Display::renderDC->DrawBitmap( it->m_bitmap, x, m_y - hotspotY_mod, true);
+                        AriaRender::drawBitmap(it->m_bitmap, x, m_y - hotspotY_mod);
                     }
                     
-                    Display::renderDC->DrawBitmap( it->m_bitmap, max_x, m_y - hotspotY_mod, true);
+                    AriaRender::drawBitmap(it->m_bitmap, max_x, m_y - hotspotY_mod);
                 }
                 else if (m_y_scale != 1)
                 {
@@ -118,13 +118,13 @@ void Drawable::render()
                     const int max_y = m_y - hotspotY_mod + new_h - m_image->height;
                     for (int y = m_y - hotspotY_mod; y <= max_y; y += m_image->height)
                     {
-                        Display::renderDC->DrawBitmap( it->m_bitmap, m_x - hotspotX_mod, y, true);
+                        AriaRender::drawBitmap(it->m_bitmap, m_x - hotspotX_mod, y);
                     }
-                    Display::renderDC->DrawBitmap( it->m_bitmap, m_x - hotspotX_mod, max_y, true);
+                    AriaRender::drawBitmap(it->m_bitmap, m_x - hotspotX_mod, max_y);
                 }
                 else
                 {
-                    Display::renderDC->DrawBitmap(it->m_bitmap, m_x - hotspotX_mod, m_y - hotspotY_mod, true);
+                    AriaRender::drawBitmap(it->m_bitmap, m_x - hotspotX_mod, m_y - hotspotY_mod);
                 }
                 
                 return;
@@ -155,9 +155,9 @@ void Drawable::render()
             const int max_x = m_x - hotspotX_mod + new_w - m_image->width;
             for (int x = m_x - hotspotX_mod; x < max_x; x += m_image->width)
             {
-                Display::renderDC->DrawBitmap( modbitmap, x, m_y - hotspotY_mod, true);
+                AriaRender::drawBitmap(modbitmap, x, m_y - hotspotY_mod);
             }
-            Display::renderDC->DrawBitmap( modbitmap, max_x, m_y - hotspotY_mod, true);
+            AriaRender::drawBitmap(modbitmap, max_x, m_y - hotspotY_mod);
         }
         else if (m_y_scale != 1)
         {
@@ -169,19 +169,19 @@ void Drawable::render()
             const int max_y = m_y - hotspotY_mod + new_h - m_image->height;
             for (int y = m_y - hotspotY_mod; y < max_y; y += m_image->height)
             {
-                Display::renderDC->DrawBitmap( modbitmap, m_x - hotspotX_mod, y, true);
+                AriaRender::drawBitmap(modbitmap, m_x - hotspotX_mod, y);
             }
-            Display::renderDC->DrawBitmap( modbitmap, m_x - hotspotX_mod, max_y, true);
+            AriaRender::drawBitmap(modbitmap, m_x - hotspotX_mod, max_y);
         }
         else
         {
-            Display::renderDC -> DrawBitmap( modbitmap, m_x - hotspotX_mod, m_y - hotspotY_mod, true);
+            AriaRender::drawBitmap(modbitmap, m_x - hotspotX_mod, m_y - hotspotY_mod);
         }
     }
     else
     {
-        Display::renderDC -> DrawBitmap( *m_image->getBitmapForState(g_state),
-                                         m_x - m_hotspot_x, m_y - m_hotspot_y, true);
+        AriaRender::drawBitmap(*m_image->getBitmapForState(g_state),
+                               m_x - m_hotspot_x, m_y - m_hotspot_y);
     }
 
 }
@@ -18,11 +18,23 @@
 
 #include "Renderers/AbstractDrawable.h"
 
+class wxBitmap;
+class wxString;
+
 namespace AriaMaestosa
 {
     
     void drawable_set_state(AriaRender::ImageState arg);
     
+    namespace AriaRender
+    {
+        /** @brief draw a bitmap, honouring its mask or alpha channel, its top-left corner at {x, y} */
+        void drawBitmap(const wxBitmap& bitmap, const int x, const int y);
+        
+        /** @brief draw text in the font and text colour set on Display::renderDC, its top-left corner at {x, y} */
+        void drawText(const wxString& text, const int x, const int y);
+    }
+    
     class Drawable : public AbstractDrawable
     {
     public:
@@ -14,7 +14,7 @@
  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#ifdef RENDERER_WXWIDGETS
+#if defined(RENDERER_WXWIDGETS) && !defined(RENDERER_SOFTWARE)
 
 #include "Utils.h"
 #include "AriaCore.h"
@@ -23,6 +23,11 @@
 #include "PreferencesData.h"
 #include "Renderers/RenderAPI.h"
 #include "Renderers/Drawable.h"
+#include "Renderers/RenderLayer.h"
+#include "Renderers/wxTextCache.h"
+
+#include <cstdio>
+#include <wx/dcmemory.h>
 
 namespace AriaMaestosa
 {
@@ -52,66 +57,49 @@ unsigned char ac = 255;
 int lineWidth_i = 1;
 int pointSize_i = 1;
 
+int primitive_count = 0;
+
 void renderNumber(const int number, const int x, const int y)
 {
-    static wxString commonNumbers[] = {
-                wxString(wxT("0")),
-                wxString(wxT("1")),
-                wxString(wxT("2")),
-                wxString(wxT("3")),
-                wxString(wxT("4")),
-                wxString(wxT("5")),
-                wxString(wxT("6")),
-                wxString(wxT("7")),
-                wxString(wxT("8")),
-                wxString(wxT("9")),
-                wxString(wxT("10")),
-                wxString(wxT("11")),
-                wxString(wxT("12")),
-                wxString(wxT("13")),
-                wxString(wxT("14")),
-                wxString(wxT("15")),
-                wxString(wxT("16")),
-                wxString(wxT("17")),
-                wxString(wxT("18")),
-                wxString(wxT("19"))};
-    
-    if (number >= 0 and number < 20)
-    {
-        const wxString* number_s;
-        number_s = &commonNumbers[number];
-        renderNumber( number_s->mb_str(), x, y );
-    }
-    else
-    {
-        renderNumber( to_wxString(number).mb_str(), x, y );
-    }
+    char digits[16];
+    snprintf(digits, sizeof(digits), "%i", number);
+    renderNumber(digits, x, y);
 }
 
 
 void renderNumber(const float number, const int x, const int y)
 {
-    renderNumber( to_wxString(number).mb_str(), x, y );
+    char digits[32];
+    snprintf(digits, sizeof(digits), "%f", number);
+    renderNumber(digits, x, y);
 }
 
 void renderNumber(const char* number, const int x, const int y)
 {
-    wxDCNumberRenderer* renderer = wxDCNumberRenderer::getInstance();
-    renderer->bind();
-    renderer->renderNumber(wxString(number, wxConvUTF8), x, y);
+    // these fonts never change while the app runs, don't create them anew for each string
+    static const wxFont numberFont = getNumberFont();
+    wxTextCache::getInstance()->renderNumber(number, numberFont, x, y);
 }
 
 void renderString(const wxString& string, const int x, const int y, const int maxWidth)
 {
-    Model<wxString> model(string);
-    wxDCString dcString(&model, false);
-    dcString.setFont(getNoteNamesFont());
-    dcString.setMaxWidth(maxWidth, false);
-    dcString.bind();
-    dcString.render(x, y);
+    static const wxFont noteNamesFont = getNoteNamesFont();
+    wxTextCache::getInstance()->renderString(string, noteNamesFont, x, y, maxWidth);
 }
 
 
+void drawBitmap(const wxBitmap& bitmap, const int x, const int y)
+{
+    primitive_count++;
+    Display::renderDC->DrawBitmap(bitmap, x, y, true);
+}
+
+void drawText(const wxString& text, const int x, const int y)
+{
+    primitive_count++;
+    Display::renderDC->DrawText(text, x, y);
+}
+
 void setImageState(const ImageState imgst)
 {
     current_state = imgst;
@@ -175,6 +163,7 @@ void color(const float r, const float g, const float b, const float a)
 
 void line(const int x1, const int y1, const int x2, const int y2)
 {
+    primitive_count++;
     Display::renderDC -> DrawLine( x1, y1, x2, y2 );
 }
 
@@ -191,6 +180,7 @@ void lineSmooth(const bool enabled)
 
 void point(const int x, const int y)
 {
+    primitive_count++;
     if (pointSize_i == 1) Display::renderDC -> DrawPoint( x, y );
     else
     {
@@ -207,6 +197,7 @@ void pointSize(const int n)
 
 void rect(const int x1, const int y1, const int x2, const int y2)
 {
+    primitive_count++;
     disablePen();
     Display::renderDC -> DrawRectangle( x1, y1, x2-x1, y2-y1 );
     updatePen();
@@ -214,6 +205,7 @@ void rect(const int x1, const int y1, const int x2, const int y2)
 
 void bordered_rect_no_start(const int x1, const int y1, const int x2, const int y2)
 {
+    primitive_count++;
     disablePen();
     Display::renderDC -> DrawRectangle( x1, y1, x2-x1+1, y2-y1+1 );
 
@@ -233,6 +225,7 @@ void bordered_rect_no_start(const int x1, const int y1, const int x2, const int
 
 void bordered_rect(const int x1, const int y1, const int x2, const int y2)
 {
+    primitive_count++;
 
     disablePen();
     Display::renderDC -> DrawRectangle( x1, y1, x2-x1+1, y2-y1+1 );
@@ -249,6 +242,7 @@ void bordered_rect(const int x1, const int y1, const int x2, const int y2)
 
 void hollow_rect(const int x1, const int y1, const int x2, const int y2)
 {
+    primitive_count++;
     disableBrush();
     Display::renderDC -> DrawRectangle( x1, y1, x2-x1, y2-y1 );
     updateBrush();
@@ -256,6 +250,7 @@ void hollow_rect(const int x1, const int y1, const int x2, const int y2)
     
 void select_rect(const int x1, const int y1, const int x2, const int y2)
 {
+    primitive_count++;
     Display::renderDC -> SetPen( *wxBLACK_PEN );
     disableBrush();
     Display::renderDC -> DrawRectangle( x1, y1, x2-x1, y2-y1 );
@@ -265,6 +260,7 @@ void select_rect(const int x1, const int y1, const int x2, const int y2)
 
 void triangle(const int x1, const int y1, const int x2, const int y2, const int x3, const int y3)
 {
+    primitive_count++;
     disablePen();
     wxPoint array[] = { wxPoint(x1, y1), wxPoint(x2, y2), wxPoint(x3, y3) };
     Display::renderDC -> DrawPolygon( 3, array );
@@ -273,6 +269,7 @@ void triangle(const int x1, const int y1, const int x2, const int y2, const int
 
 void arc(int center_x, int center_y, int radius_x, int radius_y, bool show_above)
 {
+    primitive_count++;
     Display::renderDC -> SetPen( wxPen( wxColour( rc, gc, bc, ac ), 1 ) );
     disableBrush();
     Display::renderDC -> DrawEllipticArc( center_x - radius_x, center_y - radius_y, radius_x*2, radius_y*2, 0, (show_above ? 180 : -180) );
@@ -285,6 +282,7 @@ void quad(const int x1, const int y1,
           const int x3, const int y3,
           const int x4, const int y4)
 {
+    primitive_count++;
     disablePen();
     wxPoint array[] = { wxPoint(x1, y1), wxPoint(x2, y2), wxPoint(x3, y3), wxPoint(x4, y4) };
     Display::renderDC -> DrawPolygon( 4, array );
@@ -304,6 +302,86 @@ void endScissors()
     Display::renderDC -> DestroyClippingRegion();
 }
 
+int getPrimitiveCount()
+{
+    return primitive_count;
+}
+
+void resetPrimitiveCount()
+{
+    primitive_count = 0;
 }
+
+bool beginLayer(RenderLayer& layer, const int x, const int y, const int width, const int height)
+{
+    ASSERT(layer.m_dc.raw_ptr == NULL);
+    if (width <= 0 or height <= 0) return false;
+
+    layer.m_x      = x;
+    layer.m_y      = y;
+    layer.m_width  = width;
+    layer.m_height = height;
+    layer.m_valid  = false;
+
+    if (not layer.m_bitmap.IsOk() or layer.m_bitmap.GetWidth() != width or layer.m_bitmap.GetHeight() != height)
+    {
+        layer.m_bitmap = wxBitmap(width, height);
+    }
+
+    wxMemoryDC* dc = new wxMemoryDC(layer.m_bitmap);
+    layer.m_dc = dc;
+    dc->SetBackground(*wxBLACK_BRUSH);
+    dc->Clear();
+    dc->SetDeviceOrigin(-x, -y);
+    dc->SetFont( Display::renderDC->GetFont() );
+
+    layer.m_previous_dc = Display::renderDC;
+    Display::renderDC = dc;
+    updatePen();
+    updateBrush();
+    updateFontColor();
+    return true;
+}
+
+void endLayer(RenderLayer& layer)
+{
+    ASSERT(layer.m_dc.raw_ptr != NULL);
+
+    Display::renderDC = layer.m_previous_dc;
+    layer.m_dc->SelectObject(wxNullBitmap);
+    layer.m_dc = NULL;
+    layer.m_valid = true;
+
+    // the layer changed the current pen and colours, not the frame's DC
+    updatePen();
+    updateBrush();
+    updateFontColor();
+
+    drawLayer(layer);
+}
+
+bool drawLayer(RenderLayer& layer)
+{
+    if (not layer.m_valid) return false;
+    Display::renderDC->DrawBitmap(layer.m_bitmap, layer.m_x, layer.m_y, false);
+    return true;
+}
+
+}
+
+RenderLayer::RenderLayer()
+{
+    m_valid       = false;
+    m_x           = 0;
+    m_y           = 0;
+    m_width       = 0;
+    m_height      = 0;
+    m_previous_dc = NULL;
+}
+
+RenderLayer::~RenderLayer()
+{
+}
+
 }
 #endif
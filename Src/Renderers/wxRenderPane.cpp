@@ -18,6 +18,7 @@
 #include "Utils.h"
 
 #include "Renderers/wxRenderPane.h"
+#include "Renderers/SoftwareRasterizer.h"
 #include "AriaCore.h"
 
 #include <wx/wx.h>
@@ -41,6 +42,10 @@ wxRenderPane::wxRenderPane(wxWindow* parent, int* args) :
 #else
     SetBackgroundStyle(wxBG_STYLE_CUSTOM);
 #endif
+
+#ifdef RENDERER_SOFTWARE
+    m_rasterizer = new SoftwareRasterizer();
+#endif
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -87,14 +92,21 @@ bool wxRenderPane::prepareFrame()
 
 void wxRenderPane::beginFrame()
 {
+#ifdef RENDERER_SOFTWARE
+    m_rasterizer->beginFrame(GetSize().x, GetSize().y);
+#else
     Display::renderDC -> SetBackground( *wxBLACK_BRUSH );
     Display::renderDC -> Clear();
+#endif
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
 void wxRenderPane::endFrame()
 {
+#ifdef RENDERER_SOFTWARE
+    m_rasterizer->endFrame(Display::renderDC);
+#endif
 }
 
 // ----------------------------------------------------------------------------------------------------------
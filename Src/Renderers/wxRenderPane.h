@@ -28,6 +28,7 @@ namespace AriaMaestosa
 {
 
     class MainFrame;
+    class SoftwareRasterizer;
 
     /**
      * @brief   wxWidgets render backend : main render panel
@@ -35,6 +36,10 @@ namespace AriaMaestosa
      */
     class wxRenderPane : public wxPanel
     {
+#ifdef RENDERER_SOFTWARE
+        /** Frames are drawn into this framebuffer, then blitted to the panel */
+        OwnerPtr<SoftwareRasterizer> m_rasterizer;
+#endif
 
     public:
         LEAK_CHECK();
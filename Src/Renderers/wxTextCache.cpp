@@ -0,0 +1,282 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef RENDERER_WXWIDGETS
+
+#include "Renderers/wxTextCache.h"
+#include "Renderers/Drawable.h"
+#include "AriaCore.h"
+#include "Utils.h"
+
+#include <wx/dc.h>
+#include <wx/dcmemory.h>
+#include <wx/image.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace AriaMaestosa;
+
+/** Characters found in the digit strip, at most 16 */
+static const char* DIGIT_STRIP_CHARS = "0123456789.-+%";
+
+DEFINE_SINGLETON( wxTextCache );
+
+namespace AriaMaestosa
+{
+    /**
+      * @brief render text in the given colour into a bitmap with an alpha channel
+      *
+      * The text is drawn black on white then converted to coverage, since not all platforms support
+      * transparency in wxDCs (same technique as the OpenGL glyph atlas)
+      */
+    static wxBitmap renderToBitmap(const wxString& text, const wxFont& font, const wxColour& colour,
+                                   const int w, const int h)
+    {
+        wxBitmap bmp(w, h);
+        {
+            wxMemoryDC dc(bmp);
+            dc.SetBackground(*wxWHITE_BRUSH);
+            dc.Clear();
+            dc.SetFont(font);
+            dc.SetTextForeground(*wxBLACK);
+            dc.DrawText(text, 0, 0);
+        }
+
+        wxImage img = bmp.ConvertToImage();
+        img.InitAlpha();
+
+        unsigned char* rgb   = img.GetData();
+        unsigned char* alpha = img.GetAlpha();
+        const unsigned char r = colour.Red(), g = colour.Green(), b = colour.Blue();
+        for (int n=0; n<w*h; n++)
+        {
+            alpha[n]     = 255 - rgb[n*3];
+            rgb[n*3 + 0] = r;
+            rgb[n*3 + 1] = g;
+            rgb[n*3 + 2] = b;
+        }
+
+        return wxBitmap(img);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+wxTextCache::wxTextCache()
+{
+    m_digits_valid  = false;
+    m_hits          = 0;
+    m_misses        = 0;
+    m_number_hits   = 0;
+    m_number_misses = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const wxString& wxTextCache::getFontDesc(const wxFont& font)
+{
+    // comparing fonts is much cheaper than building their native description
+    if (not m_last_font.IsOk() or not (m_last_font == font))
+    {
+        m_last_font      = font;
+        m_last_font_desc = font.GetNativeFontInfoDesc();
+    }
+    return m_last_font_desc;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxTextCache::makeEntry(CachedText& entry, const wxString& text, const wxFont& font,
+                            const wxColour& colour, const int maxWidth)
+{
+    wxDC* dc = Display::renderDC;
+    dc->SetFont(font);
+
+    wxString shown = text;
+    int w, h;
+    dc->GetTextExtent(shown, &w, &h);
+
+    if (maxWidth != -1)
+    {
+        while (w > maxWidth and not shown.IsEmpty())
+        {
+            shown.Truncate(shown.size() - 1);
+            dc->GetTextExtent(shown, &w, &h);
+        }
+    }
+
+    // the height of the full string is kept even if it was truncated, so that the baseline doesn't move
+    int fullW;
+    dc->GetTextExtent(text, &fullW, &entry.m_height);
+    entry.m_width = w;
+
+    if (w > 0 and entry.m_height > 0)
+    {
+        entry.m_bitmap = renderToBitmap(shown, font, colour, w, entry.m_height);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const wxTextCache::CachedText& wxTextCache::lookup(const wxString& text, const wxFont& font, const int maxWidth)
+{
+    const wxColour colour = Display::renderDC->GetTextForeground();
+
+    wxString key = text;
+    key << wxT('\1') << getFontDesc(font) << wxT('\1') << maxWidth << wxT('\1') << colour.GetRGB();
+
+    std::map<wxString, std::list<CachedText>::iterator>::iterator found = m_index.find(key);
+    if (found != m_index.end())
+    {
+        m_hits++;
+
+        // move to the front of the LRU list
+        m_entries.splice(m_entries.begin(), m_entries, found->second);
+    }
+    else
+    {
+        m_misses++;
+
+        if ((int)m_entries.size() >= CAPACITY)
+        {
+            m_index.erase(m_entries.back().m_key);
+            m_entries.pop_back();
+        }
+
+        m_entries.push_front(CachedText());
+        CachedText& entry = m_entries.front();
+        entry.m_key = key;
+        makeEntry(entry, text, font, colour, maxWidth);
+        m_index[key] = m_entries.begin();
+    }
+
+    return m_entries.front();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxTextCache::renderString(const wxString& text, const wxFont& font, const int x, const int y,
+                               const int maxWidth)
+{
+    const CachedText& entry = lookup(text, font, maxWidth);
+    if (entry.m_bitmap.IsOk()) AriaRender::drawBitmap(entry.m_bitmap, x, y - entry.m_height);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxTextCache::drawText(const wxString& text, const wxFont& font, const int x, const int y)
+{
+    const CachedText& entry = lookup(text, font, -1);
+    if (entry.m_bitmap.IsOk()) AriaRender::drawBitmap(entry.m_bitmap, x, y);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxTextCache::makeDigitStrip(const wxFont& font, const wxColour& colour)
+{
+    const int count = strlen(DIGIT_STRIP_CHARS);
+    ASSERT_E(count, <=, 16);
+
+    wxDC* dc = Display::renderDC;
+    dc->SetFont(font);
+
+    m_digits.m_font   = font;
+    m_digits.m_colour = colour;
+    m_digits.m_height = 0;
+
+    for (int n=0; n<count; n++)
+    {
+        const wxString c(wxChar(DIGIT_STRIP_CHARS[n]));
+        int w, h;
+        dc->GetTextExtent(c, &w, &h);
+        m_digits.m_advance[n] = w;
+        m_digits.m_height = std::max(m_digits.m_height, h);
+    }
+
+    // render the strip once and cut it into glyphs
+    int stripWidth = 0;
+    for (int n=0; n<count; n++) stripWidth += m_digits.m_advance[n];
+
+    const wxString stripText(DIGIT_STRIP_CHARS, wxConvUTF8);
+    wxBitmap strip = renderToBitmap(stripText, font, colour, std::max(stripWidth, 1),
+                                    std::max(m_digits.m_height, 1));
+
+    int from = 0;
+    for (int n=0; n<count; n++)
+    {
+        if (m_digits.m_advance[n] > 0)
+        {
+            m_digits.m_glyphs[n] = strip.GetSubBitmap( wxRect(from, 0, m_digits.m_advance[n],
+                                                              std::max(m_digits.m_height, 1)) );
+        }
+        from += m_digits.m_advance[n];
+    }
+
+    m_digits_valid = true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxTextCache::renderNumber(const char* number, const wxFont& font, const int x, const int y)
+{
+    const wxColour colour = Display::renderDC->GetTextForeground();
+
+    if (m_digits_valid and m_digits.m_font == font and m_digits.m_colour == colour)
+    {
+        m_number_hits++;
+    }
+    else
+    {
+        m_number_misses++;
+        makeDigitStrip(font, colour);
+    }
+
+    const int top = y - m_digits.m_height;
+    int pen = x;
+
+    for (const char* c = number; *c != 0; c++)
+    {
+        const char* slot = strchr(DIGIT_STRIP_CHARS, *c);
+        if (slot != NULL)
+        {
+            const int id = slot - DIGIT_STRIP_CHARS;
+            if (m_digits.m_glyphs[id].IsOk()) AriaRender::drawBitmap(m_digits.m_glyphs[id], pen, top);
+            pen += m_digits.m_advance[id];
+        }
+        else
+        {
+            // not in the strip, draw it the slow way
+            const wxString s(wxChar((unsigned char)*c));
+            Display::renderDC->SetFont(font);
+            AriaRender::drawText(s, pen, top);
+            pen += Display::renderDC->GetTextExtent(s).GetWidth();
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxTextCache::clear()
+{
+    m_entries.clear();
+    m_index.clear();
+    m_digits_valid = false;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef RENDERER_WXWIDGETS
+#ifndef __WX_TEXT_CACHE_H__
+#define __WX_TEXT_CACHE_H__
+
+#include <list>
+#include <map>
+#include <wx/bitmap.h>
+#include <wx/colour.h>
+#include <wx/font.h>
+#include <wx/string.h>
+
+#include "Singleton.h"
+
+namespace AriaMaestosa
+{
+
+    /**
+      * @brief wxWidgets render backend : cache of rendered strings, for AriaRender::renderString and
+      *        AriaRender::renderNumber
+      *
+      * Each (string, font, colour, max width) combination is measured and drawn once into a bitmap with an
+      * alpha channel; later renders of the same text are a single DrawBitmap. The least recently used
+      * entries are dropped when the cache is full.
+      *
+      * Numbers don't go through the LRU : the characters they are made of are rendered once per font
+      * and colour, in a "digit strip", and numbers are drawn by blitting one glyph after the other.
+      *
+      * @ingroup renderers
+      */
+    class wxTextCache : public Singleton<wxTextCache>
+    {
+        friend class Singleton<wxTextCache>;
+
+        struct CachedText
+        {
+            wxString m_key;
+
+            /** invalid for strings that render nothing (e.g. empty strings) */
+            wxBitmap m_bitmap;
+
+            int m_width, m_height;
+        };
+
+        struct DigitStrip
+        {
+            wxFont m_font;
+            wxColour m_colour;
+
+            /** one entry per character of DIGIT_STRIP_CHARS */
+            wxBitmap m_glyphs[16];
+            int m_advance[16];
+
+            int m_height;
+        };
+
+        std::list<CachedText> m_entries;
+        std::map<wxString, std::list<CachedText>::iterator> m_index;
+
+        /** GetNativeFontInfoDesc is not cheap, so remember it for the last font used */
+        wxFont m_last_font;
+        wxString m_last_font_desc;
+
+        DigitStrip m_digits;
+        bool m_digits_valid;
+
+        int m_hits, m_misses;
+        int m_number_hits, m_number_misses;
+
+        wxTextCache();
+
+        const wxString& getFontDesc(const wxFont& font);
+        void makeEntry(CachedText& entry, const wxString& text, const wxFont& font, const wxColour& colour,
+                       const int maxWidth);
+        void makeDigitStrip(const wxFont& font, const wxColour& colour);
+
+        /** @return the cache entry for this text in the current text foreground colour, created if needed */
+        const CachedText& lookup(const wxString& text, const wxFont& font, const int maxWidth);
+
+    public:
+
+        /** Number of strings kept in the cache */
+        static const int CAPACITY = 512;
+
+        /**
+          * @brief draw a string on Display::renderDC, in the current text foreground colour, the bottom of
+          *        the text at 'y'
+          * @param maxWidth  text is truncated to fit in this width, pass -1 for no limit
+          */
+        void renderString(const wxString& text, const wxFont& font, const int x, const int y,
+                          const int maxWidth);
+
+        /** @brief same as renderString, but the top of the text is at 'y' and it's never truncated */
+        void drawText(const wxString& text, const wxFont& font, const int x, const int y);
+
+        /**
+          * @brief draw a number on Display::renderDC, in the current text foreground colour
+          * @param number    digits, signs, '.' and '%' are supported; other characters are drawn directly
+          */
+        void renderNumber(const char* number, const wxFont& font, const int x, const int y);
+
+        /** @brief empty the cache (statistics are kept) */
+        void clear();
+
+        int getHitCount()        const { return m_hits;          }
+        int getMissCount()       const { return m_misses;        }
+        int getNumberHitCount()  const { return m_number_hits;   }
+        int getNumberMissCount() const { return m_number_misses; }
+
+        /** @return the proportion of renderString calls that were served from the cache, between 0 and 1 */
+        float getHitRate() const
+        {
+            return (m_hits + m_misses == 0 ? 0.0f : (float)m_hits / (m_hits + m_misses));
+        }
+    };
+
+}
+
+#endif
+#endif
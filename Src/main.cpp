@@ -25,9 +25,13 @@
 
 #include "GUI/MainFrame.h"
 #include "GUI/MainPane.h"
+#include "GUI/RenderBenchmark.h"
+#include "IO/BatchConvert.h"
 #include "Midi/Players/PlatformMidiManager.h"
+#include "Midi/Players/PlaybackBenchmark.h"
 #include "Midi/KeyPresets.h"
 #include "PreferencesData.h"
+#include "Printing/NotationExport.h"
 #include "languages.h"
 #include "UnitTest.h"
 #include "Utils.h"
@@ -195,18 +199,44 @@ bool wxWidgetApp::OnInit()
     m_render_loop_on = false;
     appName = GetAppName();
     
+    // the modes below open no window, but the toolkit is already initialized here : with wxGTK they
+    // still need a display (a virtual X server such as Xvfb will do)
     for (int n=0; n<argc; n++)
     {
         if (wxString(argv[n]) == wxT("--utest"))
         {
-            okToLog = false;
-            Core::setPlayDuringEdit(PLAY_NEVER);
-            prefs = PreferencesData::getInstance();
-            prefs->init();
+            initHeadlessMode(n + 1);
 
             UnitTestCase::showMenu();
             exit(0);
         }
+        else if (wxString(argv[n]) == wxT("--benchmark-playback"))
+        {
+            // all following arguments are songs to play
+            exit( PlaybackBenchmark::run(initHeadlessMode(n + 1)) );
+        }
+        else if (wxString(argv[n]) == wxT("--benchmark-render"))
+        {
+            // all following arguments are songs to render
+            exit( RenderBenchmark::run(initHeadlessMode(n + 1)) );
+        }
+        else if (wxString(argv[n]) == wxT("--export-notation"))
+        {
+            const wxArrayString args = initHeadlessMode(n + 1);
+            if (args.GetCount() < 2)
+            {
+                std::cerr << "usage : --export-notation <song.aria|song.mid> <output.pdf|output.svg>" << std::endl;
+                std::cerr << "        (with wxGTK, an X server is needed ; use e.g. xvfb-run on a server)" << std::endl;
+                exit(1);
+            }
+            
+            exit( NotationExport::run(args[0], args[1]) );
+        }
+        else if (wxString(argv[n]) == wxT("--convert"))
+        {
+            // all following arguments are the output format, options and songs to convert
+            exit( BatchConvert::run(initHeadlessMode(n + 1)) );
+        }
         else if (wxString(argv[n]) == wxT("--verbose"))
         {
             wxLog::SetLogLevel(wxLOG_Info);
@@ -263,8 +293,9 @@ bool wxWidgetApp::OnInit()
     AriaMaestosa::setCurrentSequenceProvider(frame);
     
     wxArrayString filesToOpen;
+    wxArrayString sessionFiles;
     
-    addLastSessionFiles(prefs, filesToOpen);
+    addLastSessionFiles(prefs, sessionFiles);
     
     // check if filenames to open were given on the command-line
     for (int n=1 ; n<argc ; n++)
@@ -276,7 +307,7 @@ bool wxWidgetApp::OnInit()
         }
     }
     
-    frame->init(filesToOpen, argc>1);
+    frame->init(filesToOpen, sessionFiles, argc>1);
 
     wxLogVerbose( wxT("[main] init main frame 2") );
 
@@ -406,7 +437,20 @@ void wxWidgetApp::loadFile(const wxString& fileName)
 }
 
 
-void wxWidgetApp::addLastSessionFiles(PreferencesData* prefs, wxArrayString& filesToOpen)
+wxArrayString wxWidgetApp::initHeadlessMode(const int first)
+{
+    okToLog = false;
+    Core::setPlayDuringEdit(PLAY_NEVER);
+    prefs = PreferencesData::getInstance();
+    prefs->init();
+    
+    wxArrayString args;
+    for (int i=first; i<argc; i++) args.Add( cleanPath(wxString(argv[i])) );
+    return args;
+}
+
+
+void wxWidgetApp::addLastSessionFiles(PreferencesData* prefs, wxArrayString& sessionFiles)
 {
     if ( prefs->getBoolValue(SETTING_ID_LOAD_LAST_SESSION, false) )
     {
@@ -415,7 +459,7 @@ void wxWidgetApp::addLastSessionFiles(PreferencesData* prefs, wxArrayString& fil
         while ( tokenizer.HasMoreTokens() )
         {
             wxString path = tokenizer.GetNextToken();
-            filesToOpen.Add(path);
+            sessionFiles.Add(path);
         }
     }
 }
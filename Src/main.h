@@ -40,7 +40,15 @@ namespace AriaMaestosa
         
     private:
         void addLastSessionFiles(PreferencesData* prefs,
-                                  wxArrayString& filesToOpen);
+                                  wxArrayString& sessionFiles);
+        
+        /**
+          * @brief setup shared by the modes that run without opening the main frame (unit tests,
+          *        benchmarks, notation export, batch conversion)
+          * @param first  index of the first command line argument given to the mode
+          * @return the command line arguments from 'first' on, cleaned with cleanPath
+          */
+        wxArrayString initHeadlessMode(const int first);
         
     public:
         MainFrame* frame;
@@ -48,11 +48,15 @@ namespace AriaMaestosa
         DECLARE_MAGIC_NUMBER();
         std::vector<TYPE*> contentsVector;
         
+        /** Incremented each time items are added, removed or moved; see getStructureRevision */
+        unsigned int m_structure_revision;
+        
         ptr_vector()
         {
 #ifdef _MORE_DEBUG_CHECKS
             m_performing_deletion = false;
 #endif
+            m_structure_revision = 0;
         }
         
         ~ptr_vector()
@@ -79,6 +83,7 @@ namespace AriaMaestosa
             ASSERT( not m_performing_deletion );
             
             contentsVector.push_back(t);
+            m_structure_revision++;
         }
         
         void add(TYPE* t, int index)
@@ -87,6 +92,19 @@ namespace AriaMaestosa
             ASSERT( not m_performing_deletion );
 
             contentsVector.insert(contentsVector.begin()+index, t);
+            m_structure_revision++;
+        }
+        
+        /** @brief insert a block of items at once, the first one ending up at 'index' */
+        void add(const std::vector<TYPE*>& items, int index)
+        {
+            ASSERT( MAGIC_NUMBER_OK() );
+            ASSERT( not m_performing_deletion );
+            ASSERT_E(index,>=,0);
+            ASSERT_E((unsigned int)index,<=,contentsVector.size());
+            
+            contentsVector.insert(contentsVector.begin()+index, items.begin(), items.end());
+            m_structure_revision++;
         }
         
         
@@ -104,6 +122,30 @@ namespace AriaMaestosa
             return contentsVector.size();
         }
         
+        /**
+          * @return a number that changes whenever the index of an item may have changed (items added,
+          *         removed or reordered), so that data keyed by index can tell when it is out of date
+          */
+        unsigned int getStructureRevision() const { return m_structure_revision; }
+        
+        /**
+          * @return index of the first item whose sort field is greater than 'value' (or size() if there is
+          *         none), found by binary search ; the vector must be in order of that field
+          */
+        template<typename F, typename T>
+        int findFirstAfter(F (*getSortFieldFn)(T*), const F value) const
+        {
+            int low  = 0;
+            int high = contentsVector.size();
+            while (low < high)
+            {
+                const int mid = (low + high) / 2;
+                if (getSortFieldFn(contentsVector[mid]) <= value) low  = mid + 1;
+                else                                              high = mid;
+            }
+            return low;
+        }
+        
        
 #if 0
 #pragma mark -
@@ -206,6 +248,7 @@ namespace AriaMaestosa
             delete contentsVector[ID];
             
             contentsVector.erase(contentsVector.begin()+ID);
+            m_structure_revision++;
         }
         
         /** remove (but do not delete) an object from the vector. */
@@ -217,6 +260,7 @@ namespace AriaMaestosa
             ASSERT_E((unsigned int)ID,<,contentsVector.size());
             
             contentsVector.erase(contentsVector.begin()+ID);
+            m_structure_revision++;
         }
         
         /** delete and remove an object from the vector. */
@@ -234,6 +278,7 @@ namespace AriaMaestosa
                 {
                     delete obj;
                     contentsVector.erase(contentsVector.begin()+n);
+                    m_structure_revision++;
                     return true;
                 }
             }
@@ -254,6 +299,7 @@ namespace AriaMaestosa
                 if (pointer == obj)
                 {
                     contentsVector.erase(contentsVector.begin()+n);
+                    m_structure_revision++;
                     return true;
                 }
             }
@@ -276,6 +322,7 @@ namespace AriaMaestosa
             }
             
             contentsVector.clear();
+            m_structure_revision++;
             
 #ifdef _MORE_DEBUG_CHECKS
             m_performing_deletion = false;
@@ -289,6 +336,7 @@ namespace AriaMaestosa
             ASSERT( not m_performing_deletion );
 
             contentsVector.clear();
+            m_structure_revision++;
         }
 
 #if 0
@@ -311,6 +359,7 @@ namespace AriaMaestosa
             
             contentsVector[ID2] = contentsVector[ID1];
             contentsVector[ID1] = temp;
+            m_structure_revision++;
         }
                 
 #if 0
@@ -333,6 +382,7 @@ namespace AriaMaestosa
             delete contentsVector[ID];
             
             contentsVector[ID] = 0;
+            m_structure_revision++;
             
         }
         
@@ -348,6 +398,7 @@ namespace AriaMaestosa
             ASSERT_E((unsigned int)ID,<,contentsVector.size());
             
             contentsVector[ID] = 0;
+            m_structure_revision++;
             
         }
         
@@ -368,19 +419,19 @@ namespace AriaMaestosa
             ASSERT( MAGIC_NUMBER_OK() );
             ASSERT( not m_performing_deletion );
 
-            int vectorSize = contentsVector.size();
+            // compact the remaining items in a single pass rather than erasing marked items one by one
+            const int vectorSize = contentsVector.size();
+            int kept = 0;
             for (int n=0; n<vectorSize; n++)
             {
-                
-                if ( contentsVector[n] == 0 )
-                {
-                    contentsVector.erase(contentsVector.begin()+n);
-                    vectorSize = contentsVector.size();
-                    n -= 2;
-                    if (n < -1) n=-1;
-                }
+                if (contentsVector[n] != 0) contentsVector[kept++] = contentsVector[n];
             }//next
             
+            if (kept < vectorSize)
+            {
+                contentsVector.resize(kept);
+                m_structure_revision++;
+            }
         }
         // ------------------------------------------------------------------------
         
@@ -401,17 +452,18 @@ namespace AriaMaestosa
                     i--;
                 } while (i>start && *t < *(contentsVector[i-1]));
                 contentsVector[i] = t;
+                m_structure_revision++;
             }
         }
         
         // ------------------------------------------------------------------------
         
         template<typename F, typename T>
-        void insertionSort(F (*getSortFieldFn)(T*))
+        void insertionSort(F (*getSortFieldFn)(T*), unsigned int start=0)
         {
             // We should not used unsigned ints here, because if the vector is 
             // empty j needs to be compared against -1
-            for (int j=0; j<(int)contentsVector.size()-1; j++)
+            for (int j=(int)start; j<(int)contentsVector.size()-1; j++)
             {
                 if (getSortFieldFn(contentsVector[j]) < getSortFieldFn(contentsVector[j+1])) continue;
                 // Now search the proper place for m_contents_vector[j+1] 
@@ -422,8 +474,9 @@ namespace AriaMaestosa
                 {
                     contentsVector[i] = contentsVector[i-1];
                     i--;
-                } while (i>0 && getSortFieldFn(t) < getSortFieldFn(contentsVector[i-1]));
+                } while (i>start && getSortFieldFn(t) < getSortFieldFn(contentsVector[i-1]));
                 contentsVector[i] = t;
+                m_structure_revision++;
             }
         }
     };
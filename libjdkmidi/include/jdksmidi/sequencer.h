@@ -259,11 +259,14 @@ public:
 
     const MIDISequencerState & operator = ( const MIDISequencerState &s );
 
+    /// most tracks a sequencer can play
+    enum { MAX_TRACKS = 256 };
+
     MIDISequencerGUIEventNotifier *notifier;
     const MIDIMultiTrack *multitrack;
     int num_tracks;
 
-    MIDISequencerTrackState *track_state[64];
+    MIDISequencerTrackState *track_state[MAX_TRACKS];
     MIDIMultiTrackIterator iterator;
     MIDIClockTime cur_clock;
     float cur_time_ms;
@@ -338,11 +341,93 @@ protected:
     int tempo_scale;
 
     int num_tracks;
-    MIDISequencerTrackProcessor *track_processors[64];
+    MIDISequencerTrackProcessor *track_processors[MIDISequencerState::MAX_TRACKS];
 
     MIDISequencerState state;
 } ;
 
+///
+/// A lightweight alternative to MIDISequencer::GetNextEvent() for playback loops.
+///
+/// The cursor walks the events of all tracks in time order and hands out pointers
+/// into the track storage instead of copies. The time in milliseconds of every event
+/// comes from a table of tempo segments built once by the constructor, so stepping
+/// to the next event does not recompute the tempo. Beat markers are only generated
+/// on request.
+///
+/// Unlike MIDISequencer, no track processing is done: solo, mute, transposition,
+/// track states and GUI notifications are not applied. The multitrack must not be
+/// modified while a cursor is in use.
+///
+class MIDISequencerCursor
+{
+public:
+
+    MIDISequencerCursor (
+        const MIDIMultiTrack *m,
+        bool beat_markers = false
+    );
+
+    virtual ~MIDISequencerCursor();
+
+    void GoToZero();
+    void GoToTime ( MIDIClockTime time_clk );
+    void GoToTimeMs ( double time_ms );
+
+    /// time of the last event returned
+    MIDIClockTime GetCurrentMIDIClockTime() const
+    {
+        return cur_clock;
+    }
+
+    double GetCurrentTimeInMs() const
+    {
+        return cur_time_ms;
+    }
+
+    bool GetNextEventTime ( MIDIClockTime *t ) const;
+    bool GetNextEventTimeMs ( double *t ) const;
+
+    /// returns the next event without copying it. *msg stays valid as long as the
+    /// multitrack is not modified (beat markers: until the next call). time_clk and
+    /// time_ms, when not null, receive the time of the event.
+    bool GetNextEvent (
+        int *tracknum,
+        const MIDITimedBigMessage **msg,
+        MIDIClockTime *time_clk = 0,
+        double *time_ms = 0
+    );
+
+    /// time in milliseconds of the given clock, according to the tempo events of the multitrack
+    double ClockToMs ( MIDIClockTime clk ) const;
+
+protected:
+
+    struct TempoSegment
+    {
+        MIDIClockTime clock;
+        double time_ms;
+        double ms_per_clock;
+    };
+
+    int FindSegment ( MIDIClockTime clk ) const;
+    double SegmentClockToMs ( int segment, MIDIClockTime clk ) const;
+
+    const MIDIMultiTrack *multitrack;
+    MIDIMultiTrackIterator iterator;
+    bool beat_markers;
+
+    std::vector<TempoSegment> segments;
+    int cur_segment;
+
+    MIDIClockTime cur_clock;
+    double cur_time_ms;
+    MIDIClockTime next_beat_time;
+    MIDIClockTime beat_length;
+
+    MIDITimedBigMessage beat_marker_msg;
+};
+
 }
 
 #endif
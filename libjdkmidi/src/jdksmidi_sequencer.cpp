@@ -1130,4 +1130,268 @@ double MIDISequencer::GetMisicDurationInSeconds()
 }
 
 
+static bool TempoEventIsBefore ( const MIDITimedBigMessage *a, const MIDITimedBigMessage *b )
+{
+    return a->GetTime() < b->GetTime();
+}
+
+static double MsPerClock ( unsigned long tempo32, int clks_per_beat )
+{
+    // tempo32 is in 1/32 bpm
+    return ( 60000. * 32. ) / ( ( double ) tempo32 * clks_per_beat );
+}
+
+MIDISequencerCursor::MIDISequencerCursor (
+    const MIDIMultiTrack *m,
+    bool beat_markers_
+)
+    :
+    multitrack ( m ),
+    iterator ( m ),
+    beat_markers ( beat_markers_ )
+{
+    const int clks_per_beat = multitrack->GetClksPerBeat();
+    // gather the tempo changes of all tracks, in time order
+    std::vector<const MIDITimedBigMessage *> tempos;
+
+    for ( int i = 0; i < multitrack->GetNumTracks(); ++i )
+    {
+        const MIDITrack *track = multitrack->GetTrack ( i );
+
+        for ( int n = 0; n < track->GetNumEvents(); ++n )
+        {
+            const MIDITimedBigMessage *msg = track->GetEventAddress ( n );
+
+            // tempos below 1 bpm are ignored, like MIDISequencerTrackState does
+            if ( msg->IsTempo() && msg->GetTempo32() >= 32 )
+            {
+                tempos.push_back ( msg );
+            }
+        }
+    }
+
+    std::stable_sort ( tempos.begin(), tempos.end(), TempoEventIsBefore );
+    // until the first tempo event, the default tempo of 120 bpm applies
+    TempoSegment first;
+    first.clock = 0;
+    first.time_ms = 0.0;
+    first.ms_per_clock = MsPerClock ( 120 * 32, clks_per_beat );
+    segments.push_back ( first );
+
+    for ( size_t i = 0; i < tempos.size(); ++i )
+    {
+        const MIDIClockTime clk = tempos[i]->GetTime();
+        const double ms_per_clock = MsPerClock ( tempos[i]->GetTempo32(), clks_per_beat );
+
+        if ( clk == segments.back().clock )
+        {
+            // several tempo changes at the same time, the last one wins
+            segments.back().ms_per_clock = ms_per_clock;
+        }
+
+        else
+        {
+            TempoSegment segment;
+            segment.clock = clk;
+            segment.time_ms = SegmentClockToMs ( segments.size() - 1, clk );
+            segment.ms_per_clock = ms_per_clock;
+            segments.push_back ( segment );
+        }
+    }
+
+    GoToZero();
+}
+
+MIDISequencerCursor::~MIDISequencerCursor()
+{
+}
+
+void MIDISequencerCursor::GoToZero()
+{
+    iterator.GoToTime ( 0 );
+    cur_segment = 0;
+    cur_clock = 0;
+    cur_time_ms = 0.0;
+    // same beat grid as MIDISequencer : the first marker is one beat after time zero
+    beat_length = multitrack->GetClksPerBeat();
+    next_beat_time = beat_length;
+}
+
+void MIDISequencerCursor::GoToTime ( MIDIClockTime time_clk )
+{
+    if ( time_clk < cur_clock || time_clk == 0 )
+    {
+        GoToZero();
+    }
+
+    MIDIClockTime t;
+    int trk;
+    const MIDITimedBigMessage *msg;
+
+    while (
+        GetNextEventTime ( &t )
+        && t < time_clk
+        && GetNextEvent ( &trk, &msg )
+    )
+    {
+        ;
+    }
+}
+
+void MIDISequencerCursor::GoToTimeMs ( double time_ms )
+{
+    if ( time_ms < cur_time_ms || time_ms == 0.0 )
+    {
+        GoToZero();
+    }
+
+    double t;
+    int trk;
+    const MIDITimedBigMessage *msg;
+
+    while (
+        GetNextEventTimeMs ( &t )
+        && t < time_ms
+        && GetNextEvent ( &trk, &msg )
+    )
+    {
+        ;
+    }
+}
+
+bool MIDISequencerCursor::GetNextEventTime ( MIDIClockTime *t ) const
+{
+    if ( !iterator.GetCurEventTime ( t ) )
+    {
+        return false;
+    }
+
+    if ( beat_markers && next_beat_time <= *t )
+    {
+        *t = next_beat_time;
+    }
+
+    return true;
+}
+
+bool MIDISequencerCursor::GetNextEventTimeMs ( double *t ) const
+{
+    MIDIClockTime clk;
+
+    if ( !GetNextEventTime ( &clk ) )
+    {
+        return false;
+    }
+
+    // events come in time order, so the segment is at or after the current one
+    int segment = cur_segment;
+
+    while ( segment + 1 < ( int ) segments.size() && segments[segment + 1].clock <= clk )
+    {
+        ++segment;
+    }
+
+    *t = SegmentClockToMs ( segment, clk );
+    return true;
+}
+
+bool MIDISequencerCursor::GetNextEvent (
+    int *tracknum,
+    const MIDITimedBigMessage **msg,
+    MIDIClockTime *time_clk,
+    double *time_ms
+)
+{
+    MIDIClockTime t;
+
+    if ( !iterator.GetCurEventTime ( &t ) )
+    {
+        return false;
+    }
+
+    const bool is_beat = beat_markers && next_beat_time <= t;
+
+    if ( is_beat )
+    {
+        t = next_beat_time;
+    }
+
+    else if ( !iterator.GetCurEvent ( tracknum, msg ) )
+    {
+        return false;
+    }
+
+    while ( cur_segment + 1 < ( int ) segments.size() && segments[cur_segment + 1].clock <= t )
+    {
+        ++cur_segment;
+    }
+
+    cur_clock = t;
+    cur_time_ms = SegmentClockToMs ( cur_segment, t );
+
+    if ( time_clk )
+    {
+        *time_clk = cur_clock;
+    }
+
+    if ( time_ms )
+    {
+        *time_ms = cur_time_ms;
+    }
+
+    if ( is_beat )
+    {
+        // say this event came on track 0, the conductor track
+        *tracknum = 0;
+        beat_marker_msg.SetBeatMarker();
+        beat_marker_msg.SetTime ( next_beat_time );
+        *msg = &beat_marker_msg;
+        next_beat_time += beat_length;
+        return true;
+    }
+
+    // the beat length follows the time signature of the conductor track
+    if ( *tracknum == 0 && ( *msg )->IsTimeSig() && ( *msg )->GetTimeSigDenominator() > 0 )
+    {
+        beat_length = multitrack->GetClksPerBeat() * 4 / ( *msg )->GetTimeSigDenominator();
+    }
+
+    iterator.GoToNextEvent();
+    return true;
+}
+
+double MIDISequencerCursor::ClockToMs ( MIDIClockTime clk ) const
+{
+    return SegmentClockToMs ( FindSegment ( clk ), clk );
+}
+
+int MIDISequencerCursor::FindSegment ( MIDIClockTime clk ) const
+{
+    int low = 0;
+    int high = ( int ) segments.size() - 1;
+
+    while ( low < high )
+    {
+        const int mid = ( low + high + 1 ) / 2;
+
+        if ( segments[mid].clock <= clk )
+        {
+            low = mid;
+        }
+
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    return low;
+}
+
+double MIDISequencerCursor::SegmentClockToMs ( int segment, MIDIClockTime clk ) const
+{
+    const TempoSegment &s = segments[segment];
+    return s.time_ms + ( double ) ( clk - s.clock ) * s.ms_per_clock;
+}
+
 }